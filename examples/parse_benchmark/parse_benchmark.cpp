@@ -0,0 +1,63 @@
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <citygml/citygml.h>
+#include <citygml/citymodel.h>
+
+#include <plateau/dataset/gml_filter.h>
+
+using namespace plateau::dataset;
+
+namespace {
+    /**
+     * gml_path を repeat_count 回読み込み、1回あたりの平均時間をミリ秒で返します。
+     */
+    double measureLoadMilliseconds(const std::string& gml_path, const GmlFilterParams& filter_params, int repeat_count) {
+        citygml::ParserParams params;
+        params.tesselate = true;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < repeat_count; ++i) {
+            const auto city_model = GmlFilter::load(gml_path, params, filter_params);
+            if (city_model == nullptr)
+                throw std::runtime_error("Failed to load " + gml_path);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::milli>(elapsed).count() / repeat_count;
+    }
+}
+
+/**
+ * data フォルダのサンプルの GMLファイルについて、通常のパースと、形状だけを読み込むパースの時間を比較します。
+ * 引数で GMLファイルのパスを指定すると、サンプルの代わりにそのファイルを計測します。
+ */
+int main(int argc, char* argv[]) {
+    std::vector<std::string> gml_paths;
+    for (int i = 1; i < argc; ++i) {
+        gml_paths.emplace_back(argv[i]);
+    }
+    if (gml_paths.empty()) {
+        gml_paths = {
+                u8"../data/日本語パステスト/udx/bldg/53392642_bldg_6697_op2.gml",
+                u8"../data/日本語パステスト/udx/tran/533925_tran_6697_op.gml"
+        };
+    }
+    constexpr int repeat_count = 10;
+
+    try {
+        for (const auto& gml_path : gml_paths) {
+            const auto full_ms = measureLoadMilliseconds(gml_path, GmlFilterParams(), repeat_count);
+            const auto geometry_only_ms = measureLoadMilliseconds(gml_path, GmlFilterParams::geometryOnly(), repeat_count);
+            std::cout << gml_path << std::endl
+                      << "  full          : " << full_ms << " ms" << std::endl
+                      << "  geometry only : " << geometry_only_ms << " ms"
+                      << " (x" << full_ms / geometry_only_ms << ")" << std::endl;
+        }
+    } catch (std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -2,6 +2,7 @@
 
 #include <libplateau_api.h>
 #include <plateau/dataset/mesh_code.h>
+#include <plateau/dataset/zip_archive.h>
 #include <set>
 #include <optional>
 #include "plateau/network/client.h"
@@ -10,6 +11,7 @@ namespace plateau::dataset {
 
     /**
      * \brief GMLファイルに関する情報を保持するクラスです。
+     * パスが zip 内のファイルを表す仮想的なパス (ZipArchive を参照) であれば、zip を展開せずにそのファイルを読み込みます。
      */
     class LIBPLATEAU_EXPORT GmlFile {
     public:
@@ -42,6 +44,7 @@ namespace plateau::dataset {
         /**
          * \brief GmlFileのパスがローカルマシンを指す場合、CityGMLファイルとその関連ファイル(テクスチャ、コードリスト)をコピーします。コピー先にすでにファイルが存在する場合はスキップします。
          * パスが http で始まる場合、GMLファイルとその関連ファイルをダウンロードします。
+         * パスが zip 内のファイルを指す場合、GMLファイルとその関連ファイルだけを zip から展開します。
          * \param destination_root_path コピー先のフォルダへのパス。このパスの配下に3D都市モデルデータ製品のルートフォルダが配置されます。
          * \param copied_gml_file コピーされたCityGMLファイル
          */
@@ -68,6 +71,11 @@ namespace plateau::dataset {
         /// サーバーモード(is_local_ が falseのとき)のみ利用します。ダウンロードに使用するクライアントです。
         std::optional<network::Client> client_;
 
+        /// パスが zip 内のファイルを指すときのみ利用します。GMLファイルを含む zip と、zip 内のパスです。
+        std::shared_ptr<const ZipArchive> zip_archive_;
+        std::string zip_entry_path_;
+
         void applyPath();
+        std::string loadContent() const;
     };
 }
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+
+#include <citygml/citygml.h>
+#include <libplateau_api.h>
+#include <plateau/geometry/geo_coordinate.h>
+#include <plateau/polygon_mesh/mesh_extract_options.h>
+
+namespace plateau::dataset {
+
+    /**
+     * \brief GmlFilter で GMLファイルから取り除く要素の条件です。
+     * デフォルト値では何も取り除きません。
+     */
+    struct LIBPLATEAU_EXPORT GmlFilterParams {
+        /**
+         * \brief 残す LOD のビットマスクです。LOD n の形状を残すとき、下から n ビット目を立てます。
+         * 0 のときは LOD で絞り込みません。
+         */
+        unsigned lod_mask;
+
+        /**
+         * \brief true のとき、位置が extent の範囲外である都市オブジェクトを取り除きます。
+         * 位置の判定は MeshExtractOptions::exclude_city_object_outside_extent (PolygonMeshUtils::cityObjPos) と同様に、
+         * 主要地物自身の Envelope があればその中心、なければ最も低い LOD の最初のポリゴンの頂点で行います。
+         * 同じ LOD では子の都市オブジェクトのポリゴンを優先します。位置が不明な都市オブジェクトも取り除きます。
+         */
+        bool exclude_city_object_outside_extent;
+        plateau::geometry::Extent extent;
+
+        /**
+         * \brief 残す都市オブジェクトの型のビットマスクです。COT_All のときは型で絞り込みません。
+         * 含まれない型の都市オブジェクトは、子の都市オブジェクトと、それを包むプロパティ要素ごと取り除きます。
+         */
+        citygml::CityObject::CityObjectsType city_object_type_mask;
+
+        /// true のとき、汎用属性 (gen:*Attribute) 、拡張属性 (uro:*Attribute) 、住所を取り除きます。
+        bool remove_attributes;
+
+        /// true のとき、アピアランス (マテリアル、テクスチャ、テクスチャ座標) を取り除きます。
+        bool remove_appearance;
+
+        GmlFilterParams() :
+            lod_mask(0),
+            exclude_city_object_outside_extent(false),
+            extent(plateau::geometry::Extent::all()),
+            city_object_type_mask(citygml::CityObject::CityObjectsType::COT_All),
+            remove_attributes(false),
+            remove_appearance(false) {
+        }
+
+        /// min_lod 以上 max_lod 以下の LOD を残すビットマスクを返します。
+        static unsigned lodMaskOf(unsigned min_lod, unsigned max_lod);
+
+        /**
+         * 位置だけが必要な用途 (範囲選択のプレビュー、当たり判定用のメッシュなど) のため、
+         * 属性とアピアランスを取り除き、形状だけを残す条件を返します。
+         */
+        static GmlFilterParams geometryOnly();
+
+        /// MeshExtractOptions で抽出されない要素を取り除く条件を返します。
+        static GmlFilterParams fromExtractOptions(const plateau::polygonMesh::MeshExtractOptions& options);
+
+        /// 取り除く条件が1つでもあれば true を返します。
+        bool filtersAnything() const;
+    };
+
+    /**
+     * \brief GMLファイルをパースする前に、不要な要素を文字列の走査で取り除きます。
+     *
+     * libcitygml はすべての LOD の形状をパースし、テッセレーションしてメモリに保持します。
+     * 抽出に使わない要素をパースの前に取り除くことで、パースの時間とメモリ使用量を減らします。
+     * 走査は LodSearcher と同様に XML の DOM を作らずに行うため、GMLファイルの大きさによらず少ないメモリで動作します。
+     *
+     * 取り除く要素は次のとおりです。
+     * ・lod_mask に含まれない LOD の形状プロパティ (bldg:lod3MultiSurface など、"lod(番号)" で始まる形状の要素)
+     * ・exclude_city_object_outside_extent が true のとき、位置が extent の範囲外である core:cityObjectMember
+     *   (位置が分かるまでは出力を保留します。主要地物の Envelope で範囲外と分かった時点で、それ以降の形状、アピアランス、属性を読み飛ばします)
+     * ・city_object_type_mask に含まれない型の都市オブジェクト (bldg:BuildingFurniture, bldg:Room など)
+     * ・remove_attributes が true のとき、属性のプロパティ要素 (gen:stringAttribute, uro:buildingDetailAttribute, bldg:address など)
+     * ・remove_appearance が true のとき、app:appearanceMember と app:appearance
+     */
+    class LIBPLATEAU_EXPORT GmlFilter {
+    public:
+        /**
+         * \brief in の GML を、params の条件に合う要素を取り除きながら out に書き出します。
+         */
+        static void filter(std::istream& in, std::ostream& out, const GmlFilterParams& params);
+
+        /**
+         * \brief params の条件に合う要素を取り除いたうえで GMLファイルを読み込みます。
+         *
+         * コードリストやテクスチャの相対パスが変わらないよう、取り除いた結果は元の GMLファイルと同じフォルダの一時ファイルに書き出し、
+         * 読み込み後に削除します。一時ファイルを作れないときは、取り除かずにそのまま読み込みます。
+         * 何も取り除かない条件のときは citygml::load と同じです。
+         * gzip で圧縮された GMLファイル (.gml.gz) は、条件によらず loadFromStream と同様に展開しながら一時ファイルに書き出して読み込みます。
+         * 一時ファイルの拡張子は .tmp であり、GMLファイルの検索やフォルダの監視の対象にはなりません。
+         */
+        static std::shared_ptr<const citygml::CityModel> load(
+                const std::string& gml_path, const citygml::ParserParams& parser_params, const GmlFilterParams& params,
+                const std::shared_ptr<citygml::CityGMLLogger>& logger = nullptr);
+
+        /**
+         * \brief in の GML を、gml_path と同じフォルダにあるものとして、params の条件に合う要素を取り除いたうえで読み込みます。
+         * params が何も取り除かない条件でも、一時ファイルを経由して読み込みます。
+         * gml_path と同じフォルダに一時ファイルを作れないとき (読み込み専用のフォルダなど) は、システムの一時フォルダに作ります。
+         * このときテクスチャやコードリストの相対パスは解決できません。どちらにも作れないときは nullptr を返します。
+         */
+        static std::shared_ptr<const citygml::CityModel> loadFromStream(
+                std::istream& in, const std::string& gml_path, const citygml::ParserParams& parser_params,
+                const GmlFilterParams& params, const std::shared_ptr<citygml::CityGMLLogger>& logger = nullptr);
+    };
+}
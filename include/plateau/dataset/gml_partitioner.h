@@ -0,0 +1,101 @@
+#pragma once
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <citygml/citygml.h>
+#include <libplateau_api.h>
+#include <plateau/dataset/gml_filter.h>
+
+namespace plateau::dataset {
+
+    /**
+     * \brief GMLファイルのルート要素と、その直下にある要素の位置 (ファイル先頭からのバイト数) です。
+     */
+    struct LIBPLATEAU_EXPORT GmlTopLevelLayout {
+        /// [begin, end) の範囲です。
+        struct Range {
+            size_t begin;
+            size_t end;
+        };
+
+        /// ルート要素の開始タグの終わりの位置です。XML宣言とルート要素の開始タグはこの位置より前にあります。
+        size_t root_content_begin;
+
+        /// ルート要素の終了タグの位置です。
+        size_t root_end_begin;
+
+        /// ルート要素の直下にある core:cityObjectMember の範囲です。
+        std::vector<Range> city_object_members;
+
+        /// ルート要素の直下にある、core:cityObjectMember 以外の要素 (gml:boundedBy, app:appearanceMember など) の範囲です。
+        std::vector<Range> shared_elements;
+
+        GmlTopLevelLayout() :
+            root_content_begin(0), root_end_begin(0) {
+        }
+
+        /// ルート要素の開始タグと終了タグが見つかっていれば true を返します。
+        bool isValid() const;
+    };
+
+    /**
+     * \brief 1つの GMLファイルを core:cityObjectMember の単位で分割し、複数のスレッドで並列にパースします。
+     *
+     * cityObjectMember は互いに独立しているため、GMLファイルを LodSearcher と同様の文字列の走査で分割できます。
+     * 分割した各部分には、ルート要素と、cityObjectMember 以外の直下の要素 (範囲やアピアランスなど) を含めます。
+     * ただし app:appearanceMember からは、その部分の cityObjectMember に含まれないポリゴンを対象とする app:target を取り除きます。
+     * テクスチャ座標はファイル全体のポリゴンの分があるため、そのまま各部分に含めると分割数に比例してパースの量が増えるからです。
+     * アピアランスとコードリストの解決は、各部分のパースで通常どおり行われます。
+     * libcitygml の CityModel は後から結合できないため、結果は部分ごとの CityModel として返します。
+     * MeshExtractor::extract の複数の CityModel を受け取る版に渡すと、1つの Model として抽出できます。
+     */
+    class LIBPLATEAU_EXPORT GmlPartitioner {
+    public:
+        /**
+         * \brief in の GML を走査し、ルート要素の直下にある要素の位置を返します。
+         */
+        static GmlTopLevelLayout scan(std::istream& in);
+
+        /**
+         * \brief layout の cityObjectMember を、ファイル内の順序を保ったまま partition_count 個以下の組に分けます。
+         * 各組のバイト数がおおむね等しくなるように分けます。cityObjectMember がなければ空の配列を返します。
+         */
+        static std::vector<std::vector<GmlTopLevelLayout::Range>> partition(
+                const GmlTopLevelLayout& layout, unsigned partition_count);
+
+        /**
+         * \brief layout の cityObjectMember を、ファイル内の順序を保ったまま、各組のバイト数が max_bytes 以下になるように分けます。
+         * max_bytes を超える cityObjectMember は、それだけで1つの組とします。
+         */
+        static std::vector<std::vector<GmlTopLevelLayout::Range>> batch(
+                const GmlTopLevelLayout& layout, size_t max_bytes);
+
+        /**
+         * \brief GMLファイルのうち、ルート要素、cityObjectMember 以外の直下の要素、members の cityObjectMember だけを読み込みます。
+         * app:appearanceMember は、members に含まれるポリゴンを対象とする部分だけを読み込みます。
+         * filter_params の条件に合う要素を取り除いたうえで、元の GMLファイルと同じフォルダの一時ファイルを経由して読み込みます。
+         * 読み込めないときは nullptr を返します。
+         */
+        static std::shared_ptr<const citygml::CityModel> loadPart(
+                const std::string& gml_path, const GmlTopLevelLayout& layout,
+                const std::vector<GmlTopLevelLayout::Range>& members,
+                const citygml::ParserParams& parser_params, const GmlFilterParams& filter_params,
+                const std::shared_ptr<citygml::CityGMLLogger>& logger = nullptr);
+
+        /**
+         * \brief GMLファイルを分割して並列にパースし、部分ごとの CityModel を返します。
+         *
+         * 各部分は filter_params の条件に合う要素を取り除いたうえで、元の GMLファイルと同じフォルダの一時ファイルを経由して読み込みます。
+         * partition_count が 0 のときは、ハードウェアのスレッド数を上限に、GMLファイルの大きさに応じて分割数を決めます。
+         * 分割できないとき (cityObjectMember が1つ以下のときや、gzip で圧縮されたファイルのときなど) は、GmlFilter::load で1つの CityModel として読み込みます。
+         * パースに失敗した部分があれば、空の配列を返します。
+         */
+        static std::vector<std::shared_ptr<const citygml::CityModel>> loadParallel(
+                const std::string& gml_path, const citygml::ParserParams& parser_params,
+                const GmlFilterParams& filter_params, unsigned partition_count = 0,
+                const std::shared_ptr<citygml::CityGMLLogger>& logger = nullptr);
+    };
+}
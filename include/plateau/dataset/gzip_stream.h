@@ -0,0 +1,42 @@
+#pragma once
+
+#include <istream>
+#include <memory>
+#include <string>
+
+#include <libplateau_api.h>
+
+namespace plateau::dataset {
+
+    /**
+     * \brief gzip で圧縮されたファイル (.gz) を、展開しながら読み込むストリームを作ります。
+     *
+     * GMLファイルは gzip で圧縮すると数分の一の大きさになるため、 "53392642_bldg_6697_op2.gml.gz" のように圧縮したまま保管できるようにします。
+     * 展開は読み込み側とは別のスレッドで先行して行い、展開済みのデータを一定量までためておきます。
+     * これにより、展開と、読み込んだデータのパース等を並行して進めます。
+     */
+    class LIBPLATEAU_EXPORT GzipStream {
+    public:
+        /// path の拡張子が .gz (大文字小文字を区別しない) であれば true を返します。
+        static bool isGzipPath(const std::string& path);
+
+        /**
+         * \brief path が GMLファイル、または gzip で圧縮された GMLファイルであれば true を返します。
+         * すなわち、拡張子が .gml であるか、 .gml.gz で終わるパスです。
+         */
+        static bool isGmlPath(const std::string& path);
+
+        /**
+         * \brief gzip で圧縮された path のファイルを、展開しながら読み込むストリームとして開きます。
+         * 開けないときは nullptr を返します。データが壊れているときは、読み込み中にストリームが bad になります。
+         */
+        static std::unique_ptr<std::istream> open(const std::string& path);
+
+        /**
+         * \brief path のファイルを読み込むストリームを開きます。
+         * path が gzip で圧縮されたファイルであれば open と同じく展開しながら読み込み、そうでなければそのまま読み込みます。
+         * 開けないときは nullptr を返します。
+         */
+        static std::unique_ptr<std::istream> openFile(const std::string& path);
+    };
+}
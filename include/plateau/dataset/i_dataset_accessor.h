@@ -1,5 +1,9 @@
 #pragma once
 
+#include <chrono>
+#include <functional>
+#include <set>
+
 #include <libplateau_api.h>
 #include <plateau/dataset/gml_file.h>
 #include <plateau/dataset/city_model_package.h>
@@ -87,8 +91,22 @@ namespace plateau::dataset {
         static const std::string gen;
     };
 
+    /// 都市モデルデータの監視で検出したGMLファイルの変化です。
+    enum class LocalDatasetChange {
+        //! GMLファイルが追加されました。
+        Added,
+        //! GMLファイルが削除されました。
+        Removed
+    };
+
     class LIBPLATEAU_EXPORT IDatasetAccessor {
     public:
+        /**
+         * \brief 監視で検出したGMLファイルの変化を受け取る関数です。
+         * 監視スレッドから、アクセサに変化を反映した後に呼ばれます。
+         */
+        using ChangeCallback = std::function<void(LocalDatasetChange change, const GmlFile& gml_file)>;
+
         /**
          * \brief GMLファイル群のうち、範囲が extent の内部であり、パッケージ種が package であるものを vector で返します。
          * なお、 package はフラグの集合と見なされるので、複数のビットを立てることで複数の指定が可能です。
@@ -128,14 +146,31 @@ namespace plateau::dataset {
 
         /**
          * \brief 都市モデルデータが存在する地域メッシュのリストを取得します。
+         * 監視中も他のスレッドの変更を受けないよう、コピーを返します。
          */
-        virtual std::set<MeshCode>& getMeshCodes() = 0;
+        virtual std::set<MeshCode> getMeshCodes() = 0;
 
         virtual TVec3d calculateCenterPoint(const plateau::geometry::GeoReference& geo_reference) = 0;
 
         /// 含まれるパッケージ種をフラグで返します。
         virtual PredefinedCityModelPackage getPackages() = 0;
 
+        /**
+         * \brief 都市モデルデータのGMLファイルの追加と削除を監視し、変化があるたびにアクセサへ反映してから callback を呼びます。
+         * 監視はアクセサの破棄時、または stopWatching で止まります。callback の中から stopWatching を呼ばないでください。
+         * \param poll_interval 変更通知を使えない環境でフォルダを走査する間隔
+         * \return 監視を始めたら true を返します。監視できないデータ (サーバーや zip ファイル内のデータ) では false を返します。
+         */
+        virtual bool startWatching(ChangeCallback callback,
+                                   std::chrono::milliseconds poll_interval = std::chrono::milliseconds(1000)) = 0;
+
+        /**
+         * \brief startWatching で始めた監視を止めます。監視していなければ何もしません。
+         */
+        virtual void stopWatching() = 0;
+
+        virtual bool isWatching() const = 0;
+
         /// 仮想コンストラクタのイディオムです。
         virtual IDatasetAccessor* create() const = 0;
         virtual IDatasetAccessor* clone() const = 0;
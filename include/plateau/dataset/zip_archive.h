@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <libplateau_api.h>
+
+namespace plateau::dataset {
+
+    /**
+     * \brief zip ファイルを展開せずに、中のファイルを1つずつ読み込みます。
+     *
+     * PLATEAUの3D都市モデルデータ製品は大きな zip ファイルで配布されます。
+     * open 時に zip の末尾にある中央ディレクトリを1度だけ読んでファイルの索引を作り、
+     * 以後は索引から各ファイルの位置を引いて、そのファイルだけを読みながら展開します。
+     * 4GB を超える zip (Zip64) と、無圧縮 (stored) および Deflate で格納されたファイルに対応します。
+     *
+     * zip 内のファイルは "(zip ファイルのパス)/(zip 内のパス)" の形の仮想的なパスで表します。
+     * 例: "C:/data/13100_tokyo.zip/13100_tokyo23-ku_2020_citygml_3_op/udx/bldg/53392642_bldg_6697_op2.gml"
+     *
+     * open 後の読み込みは、呼び出しごとに zip ファイルを開き直すため、複数のスレッドから同時に行えます。
+     */
+    class LIBPLATEAU_EXPORT ZipArchive {
+    public:
+        /// zip 内のファイル1つの、中央ディレクトリから読み取った情報です。
+        struct Entry {
+            /// zip 内のパスです。区切り文字は '/' です。
+            std::string path;
+            uint16_t compression_method;
+            /// 展開後のデータの CRC-32 です。
+            uint32_t crc32;
+            uint64_t compressed_size;
+            uint64_t uncompressed_size;
+            uint64_t local_header_offset;
+        };
+
+        /**
+         * \brief zip_path の zip ファイルを開き、中央ディレクトリから索引を作ります。
+         * 同じパスの zip ファイルが開かれたままであれば、索引を作り直さずにそれを返します。
+         * zip ファイルとして読めないときは nullptr を返します。
+         */
+        static std::shared_ptr<const ZipArchive> open(const std::string& zip_path);
+
+        /**
+         * \brief path が zip 内のファイルを表す仮想的なパスであれば、zip ファイルのパスと zip 内のパスに分けて true を返します。
+         * 拡張子が .zip であるパスの要素のうち、実在するファイルであるものを zip ファイルとみなします。
+         */
+        static bool splitPath(const std::string& path, std::string& out_zip_path, std::string& out_entry_path);
+
+        const std::string& getPath() const;
+
+        /// zip 内のすべてのファイル (フォルダを除く) を、中央ディレクトリの順に返します。
+        const std::vector<Entry>& getEntries() const;
+
+        /// zip 内のパスに対応するファイルを返します。なければ nullptr を返します。
+        const Entry* findEntry(const std::string& entry_path) const;
+
+        /**
+         * \brief zip 内のファイルを、読みながら展開するストリームとして開きます。
+         * ファイルがないとき、または対応していない圧縮方式のときは nullptr を返します。
+         * データが壊れているとき (展開できない、大きさや CRC-32 が中央ディレクトリと異なる) は、読み終える時点でストリームが bad になります。
+         */
+        std::unique_ptr<std::istream> openEntry(const std::string& entry_path) const;
+
+        /**
+         * \brief zip 内のファイルを destination_path に展開します。destination_path のフォルダは作成します。
+         * ファイルがないとき、または展開できないときは false を返します。データが壊れているときは、途中まで書き込んだファイルを削除して false を返します。
+         */
+        bool extractEntry(const std::string& entry_path, const std::string& destination_path) const;
+
+    private:
+        explicit ZipArchive(std::string path);
+        bool readCentralDirectory();
+
+        std::string path_;
+        std::vector<Entry> entries_;
+        std::map<std::string, size_t> entry_indices_;
+    };
+}
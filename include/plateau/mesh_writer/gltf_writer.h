@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include <string>
+#include <vector>
 
 #include <citygml/citygml.h>
 #include <libplateau_api.h>
@@ -31,20 +32,57 @@ namespace plateau::meshWriter {
          */
         std::string texture_directory_path;
 
+        /**
+         * \brief ノードごとにメッシュを分けず、ルートノード (LOD) ごとにテクスチャ単位のプリミティブへ結合して出力するかどうかです。
+         * true のとき、UV4 の地物インデックスを頂点ごとの地物ID (EXT_mesh_features) として書き出し、
+         * 地物IDに対応する gml:id と feature_attribute_keys の属性を、バイナリの表 (EXT_structural_metadata) として書き出します。
+         * 地物の数が多いモデルでも、ノードと描画呼び出しの数を抑えたまま地物を識別できます。
+         */
+        bool write_feature_metadata;
+
+        /**
+         * \brief write_feature_metadata が true のとき、表に含める属性のキーです。
+         * 属性の値は、write に渡した CityModel から gml:id で地物を引いて文字列で取得します。
+         */
+        std::vector<std::string> feature_attribute_keys;
+
+        /**
+         * \brief 頂点を量子化して出力するかどうかです (KHR_mesh_quantization)。
+         * 座標はメッシュの範囲に対する int16 で表し、ノードの移動と拡大縮小で元に戻します。
+         * 精度は各軸でメッシュの幅の約 1/65534 となります。
+         * 0〜1 に収まる UV は正規化した uint16 で表します。
+         */
+        bool quantize_vertices;
+
         GltfWriteOptions() :
-            mesh_file_format(GltfFileFormat::GLB), texture_directory_path("") {
+            mesh_file_format(GltfFileFormat::GLB), texture_directory_path(""), write_feature_metadata(false),
+            quantize_vertices(false) {
         }
     };
 
+    /**
+     * \brief Model を glTF 形式で出力します。
+     *
+     * 書き出しの途中の状態は write の呼び出しごとに作るため、GltfWriter は状態を持ちません。
+     * 1つの GltfWriter を複数のスレッドで共有して、別々のファイルへ同時に write してかまいません。
+     * 出力先が同じテクスチャのコピーは TextureCopier により1度だけ行われます。
+     */
     class LIBPLATEAU_EXPORT GltfWriter {
     public:
         GltfWriter();
         ~GltfWriter();
 
-        bool write(const std::string& gltf_file_path, const plateau::polygonMesh::Model& model, GltfWriteOptions options);
+        bool write(const std::string& gltf_file_path, const plateau::polygonMesh::Model& model, GltfWriteOptions options) const;
+
+        /**
+         * \brief write と同じですが、GltfWriteOptions::write_feature_metadata で出力する属性を city_model から取得します。
+         * city_model が nullptr のときは、属性を含めず gml:id のみを出力します。
+         */
+        bool write(const std::string& gltf_file_path, const plateau::polygonMesh::Model& model, GltfWriteOptions options,
+                   const citygml::CityModel* city_model) const;
 
     private:
+        /// write の呼び出し1回分の、書き出しの途中の状態です。
         class Impl;
-        std::unique_ptr<Impl> impl;
     };
 }
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <filesystem>
+
+#include <libplateau_api.h>
+
+namespace plateau::meshWriter {
+    /**
+     * \brief 各ライターが出力先にテクスチャファイルをコピーするときに使う、スレッドセーフなコピー処理です。
+     *
+     * 複数のスレッドから同じ出力先へのコピーが同時に要求されても、コピーは1度だけ行われ、
+     * どの呼び出しも戻った時点で出力先のファイルは完全に書き込まれています。
+     * コピーは一時ファイルに書き込んでから名前を変更して行うため、
+     * 別のプロセスから途中まで書き込まれたファイルが見えることもありません。
+     */
+    class LIBPLATEAU_EXPORT TextureCopier {
+    public:
+        /**
+         * \brief src_path を dst_path にコピーします。dst_path が既にあるときは何もしません。
+         * dst_path のディレクトリがなければ作成します。コピーに失敗したときは std::filesystem::filesystem_error を投げます。
+         */
+        static void copy(const std::filesystem::path& src_path, const std::filesystem::path& dst_path);
+    };
+}
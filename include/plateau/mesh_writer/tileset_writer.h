@@ -0,0 +1,57 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include <libplateau_api.h>
+#include <plateau/polygon_mesh/mesh_extract_options.h>
+
+namespace plateau::meshWriter {
+    /**
+     * \brief タイル分割出力の設定です。
+     */
+    struct TilesetWriteOptions {
+        /**
+         * \brief 粗いタイルに含める最大の LOD です。
+         * この LOD 以下の形状は GMLファイルごとの粗いタイルに、これより高い LOD の形状はグリッドごとの詳細なタイルに出力します。
+         */
+        unsigned coarse_max_lod;
+
+        /**
+         * \brief 同時に処理する GMLファイルの数の上限です。0 のときはハードウェアのスレッド数とします。
+         * 読み込んだ CityModel は GMLファイルごとに処理後すぐ解放するため、メモリ使用量はおおむねこの数に比例します。
+         */
+        unsigned max_parallel_files;
+
+        TilesetWriteOptions() :
+            coarse_max_lod(1), max_parallel_files(0) {
+        }
+    };
+
+    /**
+     * \brief 複数の GMLファイルの範囲を空間的な階層に分割し、3D Tiles 形式のタイルセットとして出力します。
+     *
+     * 出力先には tileset.json と、タイルごとの GLB ファイル (tiles フォルダ) を書き出します。
+     * タイルの階層は次の通りです。
+     * - ルート : 全体の範囲です。内容は持ちません。
+     * - 2次メッシュ : GMLファイルの2次メッシュごとにまとめます。内容は持ちません。
+     * - GMLファイル : LOD が coarse_max_lod 以下の形状を、地物ごとに持つ最大の LOD で結合した粗いタイルです。
+     * - グリッド : MeshExtractOptions のグリッド分けに従い、各地物を持つ最大の LOD で結合した詳細なタイルです。
+     *   粗いタイルより高い LOD を持つ地物がないGMLファイルでは作りません。
+     *
+     * タイルの座標は MeshExtractOptions の基準点からの相対座標です。
+     * glTF の Y-up から 3D Tiles の Z-up への変換と整合させるため、座標軸は MeshExtractOptions によらず WUN で出力し、
+     * 基準点の緯度経度から求めた地心直交座標への変換をルートタイルの transform に設定します。
+     * 高さは GMLファイルの値 (標高) をそのまま楕円体高とみなします。
+     */
+    class LIBPLATEAU_EXPORT TilesetWriter {
+    public:
+        /**
+         * \brief gml_paths の GMLファイルを読み込み、タイルセットを output_directory に出力します。
+         * 読み込めなかった GMLファイルはスキップします。
+         * \return タイルを1つ以上出力できたら true を返します。
+         */
+        bool write(const std::string& output_directory, const std::vector<std::string>& gml_paths,
+                   const plateau::polygonMesh::MeshExtractOptions& extract_options,
+                   const TilesetWriteOptions& options);
+    };
+}
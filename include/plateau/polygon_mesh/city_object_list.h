@@ -1,8 +1,14 @@
 #pragma once
 
 #include <libplateau_api.h>
-#include <map>
+#include <citygml/vecs.hpp>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #include <cmath>
 
 namespace plateau::polygonMesh {
@@ -64,25 +70,51 @@ namespace plateau::polygonMesh {
                 ? false
                 : atomic_index < other.atomic_index;
         }
+
+        bool operator==(const CityObjectIndex& other) const {
+            return primary_index == other.primary_index && atomic_index == other.atomic_index;
+        }
+    };
+
+    /**
+     * gml:id の文字列を重複なく格納する領域です。
+     * 格納した文字列のアドレスは変わらないため、 CityObjectList はコピーせずに参照できます。
+     * CityObjectList をコピーすると領域も共有されるため、メッシュの結合などで gml:id の文字列が複製されません。
+     * 複数のスレッドから同時に intern を呼んでも安全です。
+     */
+    class LIBPLATEAU_EXPORT GmlIdArena {
+    public:
+        /// str と同じ文字列を格納し、その参照を返します。既に格納済みであれば、その参照を返します。
+        const std::string& intern(std::string_view str);
+
+        /// 格納している文字列の数を返します。
+        size_t size() const;
+
+    private:
+        std::deque<std::string> strings_;
+        std::unordered_map<std::string_view, const std::string*> index_;
+        mutable std::mutex mutex_;
     };
 
     /**
      * @brief CityObjectListは、地物インデックスと地物IDの対応関係を保持するために、Modelに含まれる地物のリストを保持する目的で設計されています。
      *
-     * plateau::polygonMesh::Meshに次のメンバー変数を追加します。
-     * 上記のUVに記録したID ( CityObjectIndex ) と、 gml:id を対応付けるデータ構造  CityObjectListを作成します。
-     * CityObjectListは、 std::map<CityObjectIndex, std::string> city_object_index_to_gml_idから構成されます。
-     * なお、std::map のキーに自作の構造体をとるには、比較演算子< を定義する必要があることに注意してください。
-     * 参考: 逆引き！ C++でMapのキーとして、自分で定義した構造体を利用する
-     * 「https://programming-tips.info/use_struct_as_key_of_map/cpp/index.html」
+     * Mesh の UV4 に記録した地物インデックス ( CityObjectIndex ) と、 gml:id を双方向に対応付けます。
+     * ・地物インデックスから gml:id へは、地物インデックス順に並べた配列を二分探索して引きます。
+     * ・gml:id から地物インデックスへは、ハッシュマップで引きます。
+     * gml:id の文字列は GmlIdArena に格納し、両方向の表からはその参照を持ちます。
      *
-     * mesh_extractor の処理において、上記の city_object_indexが構築されるようにし、ゲームエンジンから読めるようにします。
+     * mesh_extractor の処理において CityObjectList が構築されるようにし、ゲームエンジンから読めるようにします。
      */
     class LIBPLATEAU_EXPORT CityObjectList {
 
     public:
         CityObjectList() = default;
 
+        /// gml:id の文字列を、引数の領域に格納する CityObjectList を作ります。
+        explicit CityObjectList(std::shared_ptr<GmlIdArena> arena);
+
+        /// 地物インデックスに対応する gml:id を返します。存在しないときは std::out_of_range を投げます。
         const std::string& getAtomicGmlID(const CityObjectIndex& city_object_index) const;
         const std::string& getPrimaryGmlID(int index) const;
 
@@ -90,12 +122,29 @@ namespace plateau::polygonMesh {
 
         std::shared_ptr<std::vector<CityObjectIndex>> getAllKeys() const;
 
-        CityObjectIndex getCityObjectIndex(const std::string& gml_id) const;
+        /**
+         * gml:id に対応する地物インデックスを返します。存在しないときは (-1, -1) を返します。
+         * 同じ gml:id を持つ地物インデックスが複数あるときは、最も小さいものを返します。
+         */
+        CityObjectIndex getCityObjectIndex(std::string_view gml_id) const;
+
+        /// 複数の gml:id に対応する地物インデックスをまとめて out_indices に追加します。
+        void getCityObjectIndices(const std::vector<std::string_view>& gml_ids, std::vector<CityObjectIndex>& out_indices) const;
 
         void add(const CityObjectIndex& key, const std::string& value);
 
+        size_t size() const;
+
     private:
-        std::map<CityObjectIndex, std::string> city_object_index_to_gml_id_;
+        using Entry = std::pair<CityObjectIndex, const std::string*>;
+
+        std::vector<Entry>::const_iterator find(const CityObjectIndex& key) const;
+        void updateReverseIndex(const std::string& gml_id, const CityObjectIndex& key);
+
+        std::shared_ptr<GmlIdArena> arena_;
+        /// 地物インデックスの昇順に並んでいます。
+        std::vector<Entry> entries_;
+        std::unordered_map<std::string_view, CityObjectIndex> gml_id_to_index_;
     };
 
 }
@@ -35,9 +35,36 @@ namespace plateau::polygonMesh {
         Mesh(std::vector<TVec3d>&& vertices, std::vector<unsigned>&& indices, UV&& uv_1,
             std::vector<SubMesh>&& sub_meshes, CityObjectList&& city_object_list);
 
+        Mesh(std::vector<TVec3d>&& vertices, std::vector<unsigned>&& indices, UV&& uv_1, UV&& uv_4,
+            std::vector<SubMesh>&& sub_meshes, CityObjectList&& city_object_list);
+
+        /// 頂点座標を float で保持するメッシュを生成します。
+        Mesh(std::vector<TVec3f>&& float_vertices, std::vector<unsigned>&& indices, UV&& uv_1, UV&& uv_4,
+            std::vector<SubMesh>&& sub_meshes, CityObjectList&& city_object_list);
+
+        /// 頂点座標を double で取得します。 hasFloatVertices() が true のときは空です。
         std::vector<TVec3d>& getVertices();
         const std::vector<TVec3d>& getVertices() const;
 
+        /// 頂点座標を float で取得します。 hasFloatVertices() が false のときは空です。
+        const std::vector<TVec3f>& getFloatVertices() const;
+
+        /// 頂点座標を float で保持しているときに true を返します。
+        bool hasFloatVertices() const;
+
+        /// 保持形式によらず頂点数を返します。
+        size_t getVertexCount() const;
+
+        /// 保持形式によらず index 番目の頂点座標を返します。
+        TVec3d getVertexAt(size_t index) const;
+
+        /**
+         * 頂点座標の保持形式を double から float に変換します。頂点座標のメモリ使用量が半分になります。
+         * 変換後は getVertices() が空になり、座標は getFloatVertices() から取得します。
+         * GeoReference::project で基準点を引いた後の座標であれば、float でも十分な精度があることを想定しています。
+         */
+        void convertVerticesToFloat();
+
         const std::vector<unsigned>& getIndices() const;
         const UV& getUV1() const;
         UV& getUV1();
@@ -51,6 +78,12 @@ namespace plateau::polygonMesh {
         /// 頂点リストの末尾に追加します。
         void addVerticesList(const std::vector<TVec3d>& other_vertices);
 
+        /**
+         * 他のメッシュの頂点を、頂点リストの末尾に追加します。
+         * どちらか一方でも float で保持している場合、結果は float で保持します。
+         */
+        void addVerticesList(const Mesh& other_mesh);
+
         void addIndicesList(const std::vector<unsigned>& other_indices, unsigned prev_num_vertices,
                             bool invert_mesh_front_back);
 
@@ -88,7 +121,12 @@ namespace plateau::polygonMesh {
 
     private:
         friend class MeshFactory;
+        friend class MeshOptimizer;
+        friend class MeshSimplifier;
+        friend class MeshInstancer;
         std::vector<TVec3d> vertices_;
+        std::vector<TVec3f> float_vertices_;
+        bool has_float_vertices_;
         std::vector<unsigned> indices_;
         UV uv1_;
         UV uv4_;
@@ -2,6 +2,7 @@
 
 #include <plateau/geometry/geo_coordinate.h>
 #include <citygml/vecs.hpp>
+#include <citygml/cityobject.h>
 #include <plateau/polygon_mesh/polygon_mesh_utils.h>
 
 namespace plateau::polygonMesh {
@@ -35,7 +36,17 @@ namespace plateau::polygonMesh {
             exclude_polygons_outside_extent(false),
             extent(geometry::Extent::all()), // 全範囲をデフォルトとします。
             enable_texture_packing(false),
-            texture_packing_resolution(2048)
+            texture_packing_resolution(2048),
+            store_vertices_as_float(false),
+            enable_mesh_optimization(false),
+            generate_proxy_lod(false),
+            proxy_lod_target_ratio(0.25f),
+            align_grid_to_mesh_code(false),
+            enable_adaptive_grid(false),
+            adaptive_grid_triangle_budget(200000),
+            enable_instancing(false),
+            city_object_type_mask(citygml::CityObject::CityObjectsType::COT_All),
+            enable_lazy_tessellation(false)
             {}
 
     public:
@@ -85,5 +96,68 @@ namespace plateau::polygonMesh {
          */
         unsigned texture_packing_resolution;
         geometry::Extent extent;
+
+        /**
+         * 出力する Mesh の頂点座標を float で保持するかどうかを bool で指定します。
+         * true にすると頂点座標のメモリ使用量が半分になり、各ライターや C API が変換なしで頂点を渡せるようになります。
+         * 基準点 (reference_point) を引いた後の座標を保持するため、通常は float でも十分な精度があります。
+         */
+        bool store_vertices_as_float;
+
+        /**
+         * 出力する Mesh に MeshOptimizer による最適化 (頂点の溶接、三角形と頂点の並べ替え) を行うかどうかを bool で指定します。
+         * 頂点数と Indices のメモリ使用量が減り、描画時の頂点キャッシュのヒット率が上がります。
+         */
+        bool enable_mesh_optimization;
+
+        /**
+         * LOD ごとに、メッシュを MeshSimplifier で縮約した遠景用の代替ノードを追加するかどうかを bool で指定します。
+         * 代替ノードはルートノードとして、元の LOD ノードの名前に "_proxy" を付けた名前で追加されます。
+         */
+        bool generate_proxy_lod;
+
+        /**
+         * 代替ノードのメッシュの三角形の数を、元のメッシュの何倍 (0 〜 1) にするかを指定します。
+         */
+        float proxy_lod_target_ratio;
+
+        /**
+         * PerCityModelArea のグリッドを、GMLファイルの範囲ではなく地域メッシュ (3次メッシュ) に揃えるかどうかを bool で指定します。
+         * true のとき、3次メッシュ1つを grid_count_of_side × grid_count_of_side に分割したものをグリッドとします。
+         * グリッドの位置が GMLファイルによらず決まるため、隣り合うファイルのグリッドが揃い、
+         * 複数の CityModel をまとめて抽出すると、ファイルをまたぐグリッドが1つのメッシュに結合されます。
+         */
+        bool align_grid_to_mesh_code;
+
+        /**
+         * PerCityModelArea のグリッドを、三角形の数に応じて適応的に分割するかどうかを bool で指定します。
+         * true のとき、三角形の数が adaptive_grid_triangle_budget を超えるグリッドを4分木で再帰的に分割し、
+         * 分割後に疎になった隣り合うグリッドは予算の範囲でまとめます。
+         * 三角形の数は、各地物で三角形が最も多い LOD を基準にします。
+         */
+        bool enable_adaptive_grid;
+
+        /// 適応的な分割で、1つのグリッドに含める三角形の数の目安です。
+        unsigned adaptive_grid_triangle_budget;
+
+        /**
+         * 平行移動を除いて同一の形状を持つメッシュを、MeshInstancer で1つのメッシュと複数のインスタンスにまとめるかどうかを bool で指定します。
+         * 街路灯や樹木など、同じ形状が繰り返し現れる地物を PerPrimaryFeatureObject または PerAtomicFeatureObject で抽出するときに有効です。
+         */
+        bool enable_instancing;
+
+        /**
+         * 抽出する都市オブジェクトの型のビットマスクです。マスクに含まれない型の都市オブジェクトは、その子も含めて抽出しません。
+         * GmlFilterParams::fromExtractOptions で GMLファイルを読み込むと、マスクに含まれない型はパースする前に取り除かれます。
+         */
+        citygml::CityObject::CityObjectsType city_object_type_mask;
+
+        /**
+         * ポリゴンの三角形分割を、パース時ではなく抽出時に行うかどうかを bool で指定します。
+         * true のとき、MeshFactory は抽出するポリゴンの外周と穴を PolygonTessellator で三角形に分割し、
+         * 主要地物ごとのメッシュを並列に作ります。抽出しない LOD や範囲外のポリゴンは分割しません。
+         * CityModel は ParserParams の tesselate を false、keepVertices を true にして読み込んでください。
+         */
+        bool enable_lazy_tessellation;
     };
 }
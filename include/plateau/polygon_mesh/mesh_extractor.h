@@ -2,6 +2,7 @@
 
 #include <libplateau_api.h>
 #include <memory>
+#include <vector>
 #include <plateau/polygon_mesh/mesh.h>
 #include <plateau/polygon_mesh/mesh_extract_options.h>
 #include "citygml/citymodel.h"
@@ -33,6 +34,17 @@ namespace plateau::polygonMesh {
          */
         static void extract(Model& out_model, const citygml::CityModel& city_model, const MeshExtractOptions& options);
 
+        /**
+         * 複数の CityModel から1つの Model を取り出します。
+         * MeshGranularity::PerCityModelArea では、全 CityModel の主要地物をまとめてグリッドに分類するため、
+         * MeshExtractOptions::align_grid_to_mesh_code と組み合わせると、GMLファイルをまたぐグリッドが1つのメッシュになります。
+         * それ以外の粒度では、各 CityModel から取り出したノードを LODノードの下に順に並べます。
+         */
+        static std::shared_ptr<Model> extract(const std::vector<const citygml::CityModel*>& city_models, const MeshExtractOptions& options);
+
+        /// 複数の CityModel を受け取る extract関数について、引数の Model に結果を格納する版です。
+        static void extract(Model& out_model, const std::vector<const citygml::CityModel*>& city_models, const MeshExtractOptions& options);
+
         /**
          * 引数で与えられた LOD の主要地物について、次を判定して bool で返します。
          * GMLファイルからメッシュを作るとき、主要地物と [子の最小地物を結合したもの] のメッシュが同じなので、
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <plateau/polygon_mesh/mesh.h>
+#include <plateau/polygon_mesh/model.h>
+
+namespace plateau::polygonMesh {
+
+    /**
+     * 平行移動を除いて同一の形状を持つメッシュを探し、1つのメッシュと複数のインスタンスにまとめます。
+     * 街路灯や標識、樹木など、同じ形状が繰り返し現れる都市設備・植生のメッシュ容量と描画呼び出しを減らすことを目的としています。
+     *
+     * 形状が同一とみなす条件は次のとおりです。
+     * ・メッシュの範囲の最小点を原点としたときの頂点座標が、許容誤差で量子化して一致すること
+     * ・Indices、UV1、SubMesh (範囲、テクスチャ、マテリアル) が一致すること
+     * 回転や拡大縮小を伴う配置は検出しません。
+     *
+     * まとめたメッシュは最初に見つかったノードに残り、頂点座標は原点からの相対座標に変わります。
+     * 各インスタンスの名前には元のノード名を、translation には元の原点を記録します。
+     * 同一形状の検索はルートノード (LOD) ごとに行い、異なるルートノードのメッシュはまとめません。
+     * 元のノードのうち、メッシュがなくなり子もないものは Model から削除します。
+     * UV4 と CityObjectList は最初のノードのものが残るため、地物の識別にはインスタンスの名前を使ってください。
+     */
+    class LIBPLATEAU_EXPORT MeshInstancer {
+    public:
+        /// 頂点座標を比較するときの許容誤差 (メートル) のデフォルト値です。
+        static constexpr double default_tolerance = 0.001;
+
+        /**
+         * model 内の同一形状のメッシュをインスタンスにまとめます。
+         * \return インスタンスにまとめたことで削除したメッシュの数を返します。
+         */
+        static size_t instantiate(Model& model, double tolerance = default_tolerance);
+
+    private:
+        /**
+         * root_node 以下の同一形状のメッシュをインスタンスにまとめ、削除したメッシュの数を返します。
+         * LODごとのルートノードをまたいでまとめると、あるLODのメッシュが別のLODのプロトタイプを参照してしまうため、
+         * ルートノード単位で処理します。
+         */
+        static size_t instantiateInRoot(Node& root_node, double tolerance);
+    };
+}
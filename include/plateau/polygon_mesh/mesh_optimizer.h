@@ -0,0 +1,50 @@
+#pragma once
+
+#include <plateau/polygon_mesh/mesh.h>
+#include <plateau/polygon_mesh/model.h>
+
+namespace plateau::polygonMesh {
+
+    /**
+     * メッシュ抽出後の Mesh に対して、GPUメモリの削減と描画の高速化のための最適化を行います。
+     * 最適化の内容は次のとおりです。
+     * ・位置、UV1、UV4 が同一の頂点を1つにまとめます (溶接)。
+     * ・SubMesh ごとに三角形の順番を並べ替え、頂点キャッシュのヒット率を上げます (Forsyth のアルゴリズム)。
+     * ・頂点を Indices で最初に参照される順に並べ替え、参照されない頂点を削除します。
+     *
+     * SubMesh の範囲と CityObjectList は変わりません。
+     * 溶接後の頂点数が 65535 以下であれば、ライターや C API は 16bit の Indices で出力できます。 fitsIn16BitIndices を参照してください。
+     */
+    class LIBPLATEAU_EXPORT MeshOptimizer {
+    public:
+        /**
+         * 頂点を溶接するときの位置の許容誤差です。
+         * この値で量子化した位置が一致する頂点を同一とみなします。
+         */
+        static constexpr double default_weld_tolerance = 0.00001;
+
+        /**
+         * メッシュを最適化します。
+         * UV1, UV4 の要素数が頂点数と一致しないメッシュは最適化せずにそのままにします。
+         */
+        static void optimize(Mesh& mesh, double weld_tolerance = default_weld_tolerance);
+
+        /// Model に含まれるすべてのメッシュを最適化します。
+        static void optimize(Model& model, double weld_tolerance = default_weld_tolerance);
+
+        /**
+         * 頂点の溶接のみを行います。
+         * 面の向きが異なる頂点は溶接しないため、建物の角などの鋭いエッジは保たれます。
+         */
+        static void weldVertices(Mesh& mesh, double weld_tolerance = default_weld_tolerance);
+
+        /// SubMesh ごとに三角形を頂点キャッシュ効率の良い順に並べ替えます。
+        static void optimizeVertexCache(Mesh& mesh);
+
+        /// 頂点を Indices で最初に参照される順に並べ替え、参照されない頂点を削除します。
+        static void optimizeVertexFetch(Mesh& mesh);
+
+        /// メッシュの Indices が 16bit で表現できるときに true を返します。
+        static bool fitsIn16BitIndices(const Mesh& mesh);
+    };
+}
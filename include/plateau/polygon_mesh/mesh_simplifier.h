@@ -0,0 +1,40 @@
+#pragma once
+
+#include <plateau/polygon_mesh/mesh.h>
+#include <plateau/polygon_mesh/model.h>
+
+namespace plateau::polygonMesh {
+
+    /**
+     * Quadric Error Metrics (Garland & Heckbert) による辺の縮約で Mesh のポリゴン数を削減します。
+     * 遠景用の低ポリゴンな LOD を、手作業なしで生成することを目的としています。
+     *
+     * 縮約は頂点を隣の頂点へ寄せる方式 (half-edge collapse) で行うため、残る頂点の UV はそのまま保たれます。
+     * 次の頂点は動かしません。
+     * ・SubMesh の境目、UV1 の境目、UV4 (CityObjectIndex) の境目にある頂点
+     * ・穴や面の縁など、1つの三角形にしか使われない辺の頂点
+     * これにより、SubMesh の範囲と地物の区別は縮約後も保たれます。
+     */
+    class LIBPLATEAU_EXPORT MeshSimplifier {
+    public:
+        /// 縮約で許容する形状の誤差 (メートル) のデフォルト値です。
+        static constexpr double default_max_error = 1.0;
+
+        /**
+         * メッシュの三角形の数が target_ratio 倍 (0 〜 1) になるまで縮約します。
+         * 縮約による誤差が max_error を超える場合は、目標に届かなくてもそこで止めます。
+         */
+        static void simplify(Mesh& mesh, float target_ratio, double max_error = default_max_error);
+
+        /// Model に含まれるすべてのメッシュを縮約します。メッシュごとに並列で処理します。
+        static void simplify(Model& model, float target_ratio, double max_error = default_max_error);
+
+        /**
+         * source 以下の階層構造をコピーし、各メッシュを縮約したノードを返します。
+         * 返すノードの名前は name となり、子ノードの名前は source と同じです。
+         * 遠景用の代替 LOD (プロキシ) として Model に追加することを想定しています。
+         */
+        static Node createProxyLodNode(const Node& source, const std::string& name,
+                                       float target_ratio, double max_error = default_max_error);
+    };
+}
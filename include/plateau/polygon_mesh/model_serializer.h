@@ -0,0 +1,107 @@
+#pragma once
+
+#include <libplateau_api.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <iosfwd>
+#include "model.h"
+
+namespace plateau::polygonMesh {
+
+    /**
+     * Model をバイナリ形式で保存・復元します。
+     * OBJ/glTF/FBX への出力では CityObjectList や UV4 が失われますが、この形式では Model の情報をすべて保持します。
+     *
+     * ファイルの構成 (リトルエンディアン) :
+     * [ヘッダ] -> [Node表] -> [Mesh表] -> [SubMesh表] -> [Material表] -> [地物表] -> [文字列表] -> [インスタンス表] -> [頂点データ]
+     * 各表は固定長のレコードの配列です。
+     * 頂点 (double または float)、Indices、UV1、UV4 はメッシュごとに 16バイト境界に揃えて連続配置されるため、
+     * ファイルをメモリマップしたうえで SerializedModelView を通じてパースせずにゲームエンジンへ渡すことができます。
+     *
+     * フォーマットを変更した場合は format_version を上げてください。
+     * 読み込み時にバージョンが一致しなければ例外を投げます。
+     */
+    class LIBPLATEAU_EXPORT ModelSerializer {
+    public:
+        static constexpr uint32_t format_version = 3;
+
+        /// Model をバイナリ形式でストリームに書き込みます。
+        static void write(const Model& model, std::ostream& out);
+
+        /// Model をバイナリ形式でファイルに書き込みます。
+        static void write(const Model& model, const std::string& file_path);
+
+        /// ファイルから Model を復元します。形式が不正なときは std::runtime_error を投げます。
+        static std::shared_ptr<Model> read(const std::string& file_path);
+
+        /// メモリ上のバイナリから Model を復元します。形式が不正なときは std::runtime_error を投げます。
+        static std::shared_ptr<Model> read(const void* data, size_t size);
+
+        /**
+         * read関数について、戻り値がスマートポインタの代わりに、引数にデータを追加するようになった版です。
+         * DLL利用者との間でModelをやりとりするための措置です。
+         */
+        static void read(Model& out_model, const void* data, size_t size);
+
+        /// read関数のファイル版について、引数の Model に結果を格納する版です。
+        static void read(Model& out_model, const std::string& file_path);
+    };
+
+    /**
+     * ModelSerializer で書き込んだバイナリを、コピーせずに参照するためのビューです。
+     * メモリマップしたファイルなどのバッファを渡すと、ヘッダを検証したうえで各配列へのポインタを返します。
+     * 返すポインタはバッファ内を指すため、バッファはビューより長く生存する必要があります。
+     * バッファは 16バイト境界に揃っていることを前提とします。
+     */
+    class LIBPLATEAU_EXPORT SerializedModelView {
+    public:
+        /**
+         * メッシュが持つ頂点ストリームへのポインタと要素数です。
+         * 頂点座標は Mesh の保持形式に応じて vertices と float_vertices のどちらか一方に入ります。
+         */
+        struct MeshStreams {
+            const TVec3d* vertices;
+            size_t vertex_count;
+            const TVec3f* float_vertices;
+            size_t float_vertex_count;
+            const unsigned* indices;
+            size_t index_count;
+            const TVec2f* uv1;
+            size_t uv1_count;
+            const TVec2f* uv4;
+            size_t uv4_count;
+        };
+
+        /// 形式が不正なときは std::runtime_error を投げます。
+        SerializedModelView(const void* data, size_t size);
+
+        size_t getRootNodeCount() const;
+        size_t getNodeCount() const;
+        std::string_view getNodeName(size_t node_index) const;
+
+        /// ノードがメッシュを持たないときは -1 を返します。
+        int getNodeMeshIndex(size_t node_index) const;
+
+        /// ノードの子は Node表の中で連続して並びます。その先頭のインデックスと個数を返します。
+        size_t getNodeFirstChild(size_t node_index) const;
+        size_t getNodeChildCount(size_t node_index) const;
+
+        /// ノードが持つインスタンスの数と、各インスタンスの名前と平行移動量を返します。
+        size_t getNodeInstanceCount(size_t node_index) const;
+        std::string_view getNodeInstanceName(size_t node_index, size_t instance_index) const;
+        TVec3d getNodeInstanceTranslation(size_t node_index, size_t instance_index) const;
+
+        size_t getMeshCount() const;
+        MeshStreams getMeshStreams(size_t mesh_index) const;
+
+        size_t getSubMeshCount(size_t mesh_index) const;
+        void getSubMeshRange(size_t mesh_index, size_t sub_mesh_index, size_t& out_start, size_t& out_end) const;
+        std::string_view getSubMeshTexturePath(size_t mesh_index, size_t sub_mesh_index) const;
+
+    private:
+        const uint8_t* data_;
+        size_t size_;
+    };
+}
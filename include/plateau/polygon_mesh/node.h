@@ -7,6 +7,12 @@
 #include "mesh.h"
 
 namespace plateau::polygonMesh {
+    /// 同じメッシュを平行移動して配置する1つ分の情報です。
+    struct NodeInstance {
+        std::string name;
+        TVec3d translation;
+    };
+
     /**
      * Model 以下の階層構造を構成するノードです。
      * Node は 0個以上の 子Node を持つため階層構造になります。
@@ -15,6 +21,10 @@ namespace plateau::polygonMesh {
      *
      * Node::name_ はゲームエンジン側ではゲームオブジェクトの名前として解釈されることが想定されます。
      * Node::mesh_ はそのゲームオブジェクトの持つメッシュとして解釈されることが想定されます。
+     *
+     * インスタンスを持つノードでは、メッシュはインスタンスの原点からの相対座標で、
+     * インスタンスごとに translation だけ平行移動した位置に配置されることが想定されます。
+     * このときノード自身の位置にはメッシュを配置しません。
      */
     class LIBPLATEAU_EXPORT Node {
     public:
@@ -47,11 +57,18 @@ namespace plateau::polygonMesh {
         /// このノードがメッシュを持ち、かつそのメッシュがポリゴンを持つときに true を返します。
         bool polygonExists() const;
 
+        /// メッシュを配置するインスタンスを追加します。
+        void addInstance(std::string name, const TVec3d& translation);
+        const std::vector<NodeInstance>& getInstances() const;
+        /// インスタンスを持つとき true を返します。
+        bool isInstanced() const;
+
         /// Node 以下の階層構造を stringstream に書き込みます。
         void debugString(std::stringstream& ss, int indent) const;
     private:
         std::string name_;
         std::vector<Node> child_nodes_;
         std::unique_ptr<Mesh> mesh_;
+        std::vector<NodeInstance> instances_;
     };
 }
@@ -1,12 +1,13 @@
 #pragma once
 
 #include <list>
+#include <vector>
 #include <citygml/vecs.hpp>
+#include <citygml/cityobject.h>
 #include <libplateau_api.h>
 
 namespace citygml {
     class CityModel;
-    class CityObject;
     class Polygon;
 }
 
@@ -26,8 +27,11 @@ namespace plateau::polygonMesh {
         /**
          * city_obj の子を再帰的に検索して返します。
          * ただし引数のcityObj自身は含めません。
+         * type_mask に含まれない型の都市オブジェクトは、その子も含めて除外します。
          */
-        static std::list<const citygml::CityObject*> getChildCityObjectsRecursive(const citygml::CityObject& city_obj);
+        static std::list<const citygml::CityObject*> getChildCityObjectsRecursive(
+                const citygml::CityObject& city_obj,
+                citygml::CityObject::CityObjectsType type_mask = citygml::CityObject::CityObjectsType::COT_All);
 
         /**
          * cityObjの位置を表現するにふさわしい1点の座標を返します。
@@ -38,9 +42,23 @@ namespace plateau::polygonMesh {
         static TVec3d cityObjPos(const citygml::CityObject& city_obj);
 
         /**
-         * cityObjのポリゴンであり、頂点数が1以上であるものを検索します。
+         * polygon の頂点を返します。
+         * テッセレーションせずにパースしたポリゴン (ParserParams::tesselate が false のとき) は getVertices が空になるため、
+         * 代わりに外周の頂点を返します。外周もなければ空を返します。
+         */
+        static const std::vector<TVec3d>& getPolygonVertices(const citygml::Polygon& polygon);
+
+        /**
+         * cityObjのポリゴンであり、頂点数 (getPolygonVertices の数) が1以上であるものを検索します。
          * 最初に見つかったポリゴンを返します。なければ nullptr を返します。
          */
         static const citygml::Polygon* findFirstPolygon(const citygml::CityObject* city_obj, unsigned int lod);
+
+        /**
+         * city_obj (子を含む) が持つポリゴンの LOD を1度の走査で調べ、ビットマスクで返します。
+         * LOD i の、頂点数が1以上のポリゴンがあれば i ビット目が立ちます。
+         * 各 LOD について findFirstPolygon を呼ぶのと同じ結果になります。
+         */
+        static unsigned getLodMask(const citygml::CityObject& city_obj);
     };
 }
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <libplateau_api.h>
+#include <plateau/polygon_mesh/mesh_extract_options.h>
+#include <plateau/polygon_mesh/node.h>
+
+namespace plateau::polygonMesh {
+
+    /**
+     * \brief GMLファイル全体の CityModel をメモリに保持せずに、主要地物ごとのノードを順に取り出します。
+     *
+     * libcitygml は1つのファイルをまとめてパースするため、GMLファイルを cityObjectMember の単位で
+     * batch_bytes 以下の組に分け、組ごとにパース、抽出し、ノードを sink に渡したあと CityModel を解放します。
+     * メモリ使用量は GMLファイル全体ではなく1つの組 (batch_bytes を超える cityObjectMember はそれ単体) の大きさで決まります。
+     *
+     * 注意 :
+     * ・cityObjectMember 以外の直下の要素 (共有のアピアランスなど) は、組ごとにパースし直します。
+     * ・MeshGranularity::PerCityModelArea はファイル全体でグリッドに分類するため対応しません。
+     * ・テクスチャ結合とインスタンス化は組ごとに行います。
+     * ・組ごとにファイル内の位置へ移動して読み込むため、gzip で圧縮されたファイルには対応しません。
+     */
+    class LIBPLATEAU_EXPORT StreamingMeshExtractor {
+    public:
+        /**
+         * 取り出したノードを受け取る関数です。
+         * lod_node_name は MeshExtractor の Model でそのノードが属する LODノードの名前 ("LOD2", "LOD2_proxy" など) です。
+         */
+        using NodeSink = std::function<void(const std::string& lod_node_name, Node&& node)>;
+
+        static constexpr size_t default_batch_bytes = 16 * 1024 * 1024;
+
+        /**
+         * gml_path の GMLファイルから、options に従って主要地物ごとのノードを取り出し、取り出した順に sink に渡します。
+         * GMLファイルを読み込めないときは false を返します。
+         * options.mesh_granularity が PerCityModelArea のときは例外 std::invalid_argument を投げます。
+         */
+        static bool extract(const std::string& gml_path, const MeshExtractOptions& options,
+                            const NodeSink& sink, size_t batch_bytes = default_batch_bytes);
+    };
+}
@@ -40,6 +40,30 @@ extern "C" {
                    return APIResult::Success,
                    ,const char* const gml_id)
 
+    /**
+     * 複数の gml:id に対応する地物インデックスをまとめて out_indices に書き込みます。
+     * 存在しない gml:id に対しては (-1, -1) を書き込みます。 out_indices は count 個分の領域が必要です。
+     */
+    LIBPLATEAU_C_EXPORT APIResult LIBPLATEAU_C_API plateau_city_object_list_get_city_object_indices(
+            const CityObjectList* const handle,
+            const char* const* const gml_ids,
+            const int count,
+            plateau_city_object_index* const out_indices
+    ) {
+        API_TRY{
+            for (int i = 0; i < count; ++i) {
+                out_indices[i] = plateau_city_object_index::convert_from(handle->getCityObjectIndex(gml_ids[i]));
+            }
+            return APIResult::Success;
+        } API_CATCH;
+        return APIResult::ErrorUnknown;
+    }
+
+    DLL_VALUE_FUNC(plateau_city_object_list_get_count,
+                   CityObjectList,
+                   int,
+                   handle->size())
+
     LIBPLATEAU_C_EXPORT APIResult LIBPLATEAU_C_API plateau_city_object_list_get_all_keys(
             const CityObjectList* list,
             std::vector<CityObjectIndex>* out_vector
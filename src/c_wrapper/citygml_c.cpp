@@ -2,6 +2,8 @@
 #include <iostream>
 #include <citygml/citygml.h>
 #include <plateau_dll_logger.h>
+#include <plateau/dataset/gml_filter.h>
+#include <plateau/dataset/gml_partitioner.h>
 #include "libplateau_c.h"
 #include "city_model_c.h"
 
@@ -13,15 +15,54 @@ extern "C" {
         bool keep_vertices;
         bool tessellate;
         bool ignore_geometries;
+        /// 残す LOD のビットマスクです。0 のときは LOD で絞り込みません。詳しくは GmlFilterParams を参照してください。
+        unsigned lod_mask;
+        /// true のとき、位置が extent の範囲外である都市オブジェクトをパースする前に取り除きます。
+        bool exclude_city_object_outside_extent;
+        plateau::geometry::Extent extent;
+        /// 残す都市オブジェクトの型のビットマスクです。0 のときは COT_All と同じく型で絞り込みません。
+        citygml::CityObject::CityObjectsType city_object_type_mask;
+        /// true のとき、属性とアピアランスをパースする前に取り除き、形状だけを読み込みます。
+        bool geometry_only;
 
         plateau_citygml_parser_params()
             : optimize(true)
             , keep_vertices(true)
             , tessellate(true)
-            , ignore_geometries(false) {
+            , ignore_geometries(false)
+            , lod_mask(0)
+            , exclude_city_object_outside_extent(false)
+            , extent(plateau::geometry::Extent::all())
+            , city_object_type_mask(citygml::CityObject::CityObjectsType::COT_All)
+            , geometry_only(false) {
         }
     };
+}
+
+namespace {
+    citygml::ParserParams toParserParams(const plateau_citygml_parser_params& params) {
+        citygml::ParserParams parser_params;
+        parser_params.optimize = params.optimize;
+        parser_params.tesselate = params.tessellate;
+        parser_params.keepVertices = params.keep_vertices;
+        parser_params.ignoreGeometries = params.ignore_geometries;
+        return parser_params;
+    }
 
+    plateau::dataset::GmlFilterParams toFilterParams(const plateau_citygml_parser_params& params) {
+        auto filter_params = params.geometry_only
+                             ? plateau::dataset::GmlFilterParams::geometryOnly()
+                             : plateau::dataset::GmlFilterParams();
+        filter_params.lod_mask = params.lod_mask;
+        filter_params.exclude_city_object_outside_extent = params.exclude_city_object_outside_extent;
+        filter_params.extent = params.extent;
+        if (params.city_object_type_mask != static_cast<citygml::CityObject::CityObjectsType>(0))
+            filter_params.city_object_type_mask = params.city_object_type_mask;
+        return filter_params;
+    }
+}
+
+extern "C" {
     LIBPLATEAU_C_EXPORT APIResult LIBPLATEAU_C_API plateau_load_citygml(
             const char* gml_path,
             const plateau_citygml_parser_params params,
@@ -31,15 +72,11 @@ extern "C" {
             LogCallbackFuncPtr logWarnCallback,
             LogCallbackFuncPtr logInfoCallback) {
         API_TRY{
-            citygml::ParserParams parser_params;
-            parser_params.optimize = params.optimize;
-            parser_params.tesselate = params.tessellate;
-            parser_params.keepVertices = params.keep_vertices;
-            parser_params.ignoreGeometries = params.ignore_geometries;
             auto logger = std::make_shared<PlateauDllLogger>(logLevel);
             logger->setLogCallbacks(logErrorCallback, logWarnCallback, logInfoCallback);
             logger->log(DllLogLevel::LL_INFO, std::string("Started Parsing gml file.\ngml path = ") + gml_path);
-            auto city_model = citygml::load(gml_path, parser_params, logger);
+            auto city_model = plateau::dataset::GmlFilter::load(
+                    gml_path, toParserParams(params), toFilterParams(params), logger);
             if (city_model == nullptr) { // 例えば Codelists が見つからない時にエラーになります。
                 return APIResult::ErrorLoadingCityGml;
             }
@@ -50,4 +87,42 @@ extern "C" {
         API_CATCH;
         return APIResult::ErrorUnknown;
     }
+
+    /**
+     * GMLファイルを cityObjectMember の単位で最大 max_partitions 個に分割して並列にパースします。
+     * out_city_model_ptrs は max_partitions 個の要素を持つ配列で、先頭から out_count 個に部分ごとの CityModelHandle を格納します。
+     * 各 CityModelHandle は plateau_delete_city_model で破棄してください。
+     */
+    LIBPLATEAU_C_EXPORT APIResult LIBPLATEAU_C_API plateau_load_citygml_parallel(
+            const char* gml_path,
+            const plateau_citygml_parser_params params,
+            const int max_partitions,
+            const CityModelHandle** out_city_model_ptrs,
+            int* const out_count,
+            const DllLogLevel logLevel,
+            LogCallbackFuncPtr logErrorCallback,
+            LogCallbackFuncPtr logWarnCallback,
+            LogCallbackFuncPtr logInfoCallback) {
+        API_TRY{
+            if (max_partitions <= 0)
+                return APIResult::ErrorInvalidArgument;
+            auto logger = std::make_shared<PlateauDllLogger>(logLevel);
+            logger->setLogCallbacks(logErrorCallback, logWarnCallback, logInfoCallback);
+            logger->log(DllLogLevel::LL_INFO, std::string("Started Parsing gml file in parallel.\ngml path = ") + gml_path);
+            const auto city_models = plateau::dataset::GmlPartitioner::loadParallel(
+                    gml_path, toParserParams(params), toFilterParams(params),
+                    static_cast<unsigned>(max_partitions), logger);
+            if (city_models.empty()) {
+                return APIResult::ErrorLoadingCityGml;
+            }
+            for (size_t i = 0; i < city_models.size(); ++i) {
+                out_city_model_ptrs[i] = new CityModelHandle(city_models[i]);
+            }
+            *out_count = static_cast<int>(city_models.size());
+            logger->log(DllLogLevel::LL_INFO, "Completed parsing gml.");
+            return APIResult::Success;
+        }
+        API_CATCH;
+        return APIResult::ErrorUnknown;
+    }
 }
@@ -1,16 +1,19 @@
 #include "libplateau_c.h"
 #include <plateau/mesh_writer/gltf_writer.h>
+#include "city_model_c.h"
 
 using namespace libplateau;
 using namespace plateau::meshWriter;
 
 extern "C" {
     LIBPLATEAU_C_EXPORT APIResult LIBPLATEAU_C_API plateau_gltf_writer_write(GltfWriter* handle, bool* out,
-            const char* gltf_file_path, const plateau::polygonMesh::Model* model, const char* tex_path, GltfFileFormat format) {
+            const char* gltf_file_path, const plateau::polygonMesh::Model* model, const char* tex_path, GltfFileFormat format,
+            bool quantize_vertices) {
         API_TRY{
             plateau::meshWriter::GltfWriteOptions gltf_options;
             gltf_options.texture_directory_path = tex_path;
             gltf_options.mesh_file_format = format;
+            gltf_options.quantize_vertices = quantize_vertices;
             *out = handle->write(gltf_file_path, *model, gltf_options);
             return APIResult::Success;
         }
@@ -18,6 +21,29 @@ extern "C" {
         return APIResult::ErrorUnknown;
     }
 
+    /**
+     * ルートノードごとにテクスチャ単位のプリミティブへ結合し、地物IDと地物の属性の表を付けて出力します。
+     * city_model が nullptr のときは、属性を含めず gml:id のみを出力します。
+     */
+    LIBPLATEAU_C_EXPORT APIResult LIBPLATEAU_C_API plateau_gltf_writer_write_with_feature_metadata(
+            GltfWriter* handle, bool* out, const char* gltf_file_path, const plateau::polygonMesh::Model* model,
+            const char* tex_path, GltfFileFormat format, const CityModelHandle* city_model,
+            const char* const* attribute_keys, const int attribute_key_count, bool quantize_vertices) {
+        API_TRY{
+            plateau::meshWriter::GltfWriteOptions gltf_options;
+            gltf_options.texture_directory_path = tex_path;
+            gltf_options.mesh_file_format = format;
+            gltf_options.quantize_vertices = quantize_vertices;
+            gltf_options.write_feature_metadata = true;
+            gltf_options.feature_attribute_keys.assign(attribute_keys, attribute_keys + attribute_key_count);
+            *out = handle->write(gltf_file_path, *model, gltf_options,
+                                 city_model == nullptr ? nullptr : &city_model->getCityModel());
+            return APIResult::Success;
+        }
+        API_CATCH;
+        return APIResult::ErrorUnknown;
+    }
+
     DLL_CREATE_FUNC(plateau_create_gltf_writer,
                     GltfWriter)
 
@@ -1,6 +1,10 @@
 #include "libplateau_c.h"
 #include <plateau/dataset/i_dataset_accessor.h>
 
+/// 監視で検出した変化を受け取る関数です。gml_path は UTF-8 で、呼び出しの間だけ有効です。
+typedef void(* DatasetChangeCallbackFuncPtr)(plateau::dataset::LocalDatasetChange change,
+                                             const char* gml_path, int gml_path_byte_length);
+
 extern "C" {
     using namespace plateau::dataset;
     using namespace plateau::geometry;
@@ -20,7 +24,7 @@ extern "C" {
             std::vector<MeshCode>* const out_mesh_codes
     ) {
         API_TRY{
-            const auto& mesh_codes = dataset_accessor->getMeshCodes();
+            const auto mesh_codes = dataset_accessor->getMeshCodes();
             for (const auto& mesh_code : mesh_codes)
                 out_mesh_codes->push_back(mesh_code);
             return APIResult::Success;
@@ -48,4 +52,40 @@ extern "C" {
                    *out_dataset_accessor_ptr = filtered;
     )
 
+    /**
+     * GMLファイルの追加と削除の監視を始めます。
+     * callback は監視スレッドから呼ばれます。監視を始めたかどうかを out_started に格納します。
+     */
+    LIBPLATEAU_C_EXPORT APIResult LIBPLATEAU_C_API plateau_i_dataset_accessor_start_watching(
+            IDatasetAccessor* const accessor,
+            const DatasetChangeCallbackFuncPtr callback,
+            const int poll_interval_milliseconds,
+            bool* const out_started
+    ) {
+        API_TRY{
+            *out_started = accessor->startWatching(
+                    [callback](LocalDatasetChange change, const GmlFile& gml_file) {
+                        const auto& path = gml_file.getPath();
+                        callback(change, path.c_str(), (int)path.size());
+                    },
+                    std::chrono::milliseconds(poll_interval_milliseconds));
+            return APIResult::Success;
+        } API_CATCH;
+        return APIResult::ErrorUnknown;
+    }
+
+    LIBPLATEAU_C_EXPORT APIResult LIBPLATEAU_C_API plateau_i_dataset_accessor_stop_watching(
+            IDatasetAccessor* const accessor
+    ) {
+        API_TRY{
+            accessor->stopWatching();
+            return APIResult::Success;
+        } API_CATCH;
+        return APIResult::ErrorUnknown;
+    }
+
+    DLL_VALUE_FUNC(plateau_i_dataset_accessor_is_watching,
+                   IDatasetAccessor,
+                   bool,
+                   handle->isWatching())
 }
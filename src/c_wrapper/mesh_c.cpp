@@ -1,11 +1,48 @@
 #include <plateau/polygon_mesh/mesh.h>
+#include <plateau/polygon_mesh/mesh_optimizer.h>
 #include "libplateau_c.h"
 #include <cassert>
+#include <algorithm>
 using namespace citygml;
 using namespace libplateau;
 using namespace plateau::polygonMesh;
+
+namespace {
+    /// 頂点座標を float で out_vertices にコピーします。 double で保持している場合は変換します。
+    void copyVerticesAsFloat(const Mesh& mesh, TVec3f* out_vertices) {
+        if (mesh.hasFloatVertices()) {
+            const auto& vertices = mesh.getFloatVertices();
+            std::copy(vertices.begin(), vertices.end(), out_vertices);
+            return;
+        }
+        const auto& vertices = mesh.getVertices();
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            out_vertices[i] = TVec3f((float)vertices[i].x, (float)vertices[i].y, (float)vertices[i].z);
+        }
+    }
+}
+
 extern "C" {
 
+    /**
+     * Mesh が内部に持つ配列の先頭アドレスと要素数です。
+     * アドレスは Mesh 内部の配列を直接指すため、コピーなしで読み取れます。
+     * Mesh が削除されるか、マージ等で変更されるまで有効です。
+     * 頂点座標は Mesh の保持形式に応じて vertices と float_vertices のどちらか一方に入り、もう一方は要素数 0 となります。
+     */
+    struct plateau_mesh_buffers {
+        const TVec3d* vertices;
+        int vertices_count;
+        const TVec3f* float_vertices;
+        int float_vertices_count;
+        const unsigned* indices;
+        int indices_count;
+        const TVec2f* uv1;
+        int uv1_count;
+        const TVec2f* uv4;
+        int uv4_count;
+    };
+
     DLL_CREATE_FUNC(plateau_create_mesh,
                     Mesh)
 
@@ -43,13 +80,30 @@ extern "C" {
         DLL_VALUE_FUNC(plateau_mesh_get_vertices_count,
                            Mesh,
                            int,
-                           handle->getVertices().size())
+                           handle->getVertexCount())
 
         DLL_VALUE_FUNC_WITH_INDEX_CHECK(plateau_mesh_get_vertex_at_index,
                                         Mesh,
                                         TVec3d,
-                                        handle->getVertices().at(index),
-                                        index >= handle->getVertices().size())
+                                        handle->getVertexAt(index),
+                                        index >= handle->getVertexCount())
+
+        DLL_VALUE_FUNC(plateau_mesh_has_float_vertices,
+                       Mesh,
+                       bool,
+                       handle->hasFloatVertices())
+
+        /// 頂点座標を float で out_vertices にコピーします。 out_vertices は頂点数分の領域が必要です。
+        LIBPLATEAU_C_EXPORT APIResult LIBPLATEAU_C_API plateau_mesh_get_float_vertices(
+                const Mesh* const mesh,
+                TVec3f* out_vertices
+        ) {
+            API_TRY{
+                copyVerticesAsFloat(*mesh, out_vertices);
+                return APIResult::Success;
+            } API_CATCH
+            return APIResult::ErrorUnknown;
+        }
 
         DLL_VALUE_FUNC(plateau_mesh_get_indices_count,
                       Mesh,
@@ -101,9 +155,7 @@ extern "C" {
     ){ \
         API_TRY{ \
             auto& uv = mesh->getUV ## UV_INDEX (); \
-            for(int i=0; i<uv.size(); i++){ \
-                out_uvs[i] = uv.at(i); \
-            } \
+            std::copy(uv.begin(), uv.end(), out_uvs); \
             return APIResult::Success; \
         } \
         API_CATCH; \
@@ -113,18 +165,98 @@ extern "C" {
          // UV1 を取得する関数
         PLATEAU_MESH_GET_UV(1)
         // UV4 を取得する関数
-        LIBPLATEAU_C_EXPORT APIResult LIBPLATEAU_C_API plateau_mesh_get_uv4(const Mesh* const mesh, TVec2f* out_uvs) {
-        try {
-            auto& uv = mesh->getUV4();
-            for (int i = 0; i < uv.size(); i++) {
-                out_uvs[i] = uv.at(i);
-            } return APIResult::Success;
-        }
-        catch (std::exception& e) {
-            std::cout << e.what() << std::endl;
-        }
-        catch (...) {
-            std::cout << "Unknown error occurred." << std::endl;
-        }; return APIResult::ErrorUnknown;
+        PLATEAU_MESH_GET_UV(4)
+
+    /// Indices を out_indices にコピーします。 out_indices は Indices の数だけの領域が必要です。
+    LIBPLATEAU_C_EXPORT APIResult LIBPLATEAU_C_API plateau_mesh_get_indices(
+            const Mesh* const mesh,
+            unsigned* out_indices
+    ) {
+        API_TRY{
+            const auto& indices = mesh->getIndices();
+            std::copy(indices.begin(), indices.end(), out_indices);
+            return APIResult::Success;
+        } API_CATCH;
+        return APIResult::ErrorUnknown;
+    }
+
+    DLL_VALUE_FUNC(plateau_mesh_fits_in_16bit_indices,
+                   Mesh,
+                   bool,
+                   MeshOptimizer::fitsIn16BitIndices(*handle))
+
+    /**
+     * Indices を 16bit に変換して out_indices にコピーします。 out_indices は Indices の数分の領域が必要です。
+     * plateau_mesh_fits_in_16bit_indices が false のメッシュでは ErrorInvalidArgument を返します。
+     */
+    LIBPLATEAU_C_EXPORT APIResult LIBPLATEAU_C_API plateau_mesh_get_indices_u16(
+            const Mesh* const mesh,
+            uint16_t* out_indices
+    ) {
+        API_TRY{
+            if (!MeshOptimizer::fitsIn16BitIndices(*mesh))
+                return APIResult::ErrorInvalidArgument;
+            const auto& indices = mesh->getIndices();
+            std::transform(indices.begin(), indices.end(), out_indices,
+                           [](unsigned index) { return static_cast<uint16_t>(index); });
+            return APIResult::Success;
+        } API_CATCH;
+        return APIResult::ErrorUnknown;
+    }
+
+    /**
+     * Mesh 内部の配列のアドレスと要素数を out_buffers に書き込みます。
+     * 配列はコピーされないため、DLL利用者は1回の memcpy でエンジン側のバッファに転送するか、直接参照できます。
+     * アドレスの有効期間は plateau_mesh_buffers のコメントを参照してください。
+     */
+    LIBPLATEAU_C_EXPORT APIResult LIBPLATEAU_C_API plateau_mesh_get_buffers(
+            const Mesh* const mesh,
+            plateau_mesh_buffers* out_buffers
+    ) {
+        API_TRY{
+            out_buffers->vertices = mesh->getVertices().data();
+            out_buffers->vertices_count = static_cast<int>(mesh->getVertices().size());
+            out_buffers->float_vertices = mesh->getFloatVertices().data();
+            out_buffers->float_vertices_count = static_cast<int>(mesh->getFloatVertices().size());
+            out_buffers->indices = mesh->getIndices().data();
+            out_buffers->indices_count = static_cast<int>(mesh->getIndices().size());
+            out_buffers->uv1 = mesh->getUV1().data();
+            out_buffers->uv1_count = static_cast<int>(mesh->getUV1().size());
+            out_buffers->uv4 = mesh->getUV4().data();
+            out_buffers->uv4_count = static_cast<int>(mesh->getUV4().size());
+            return APIResult::Success;
+        } API_CATCH;
+        return APIResult::ErrorUnknown;
+    }
+
+    /**
+     * 頂点座標(float)、Indices、UV1、UV4 を1回の呼び出しでまとめて引数の領域にコピーします。
+     * 不要なストリームには nullptr を渡すとコピーを省略します。
+     * 各領域は plateau_mesh_get_buffers で得られる要素数だけ確保されている必要があります。
+     * 頂点座標を double で保持している場合は float に変換してコピーします。
+     */
+    LIBPLATEAU_C_EXPORT APIResult LIBPLATEAU_C_API plateau_mesh_fill_buffers(
+            const Mesh* const mesh,
+            TVec3f* out_vertices,
+            unsigned* out_indices,
+            TVec2f* out_uv1,
+            TVec2f* out_uv4
+    ) {
+        API_TRY{
+            if (out_vertices != nullptr) {
+                copyVerticesAsFloat(*mesh, out_vertices);
+            }
+            if (out_indices != nullptr) {
+                std::copy(mesh->getIndices().begin(), mesh->getIndices().end(), out_indices);
+            }
+            if (out_uv1 != nullptr) {
+                std::copy(mesh->getUV1().begin(), mesh->getUV1().end(), out_uv1);
+            }
+            if (out_uv4 != nullptr) {
+                std::copy(mesh->getUV4().begin(), mesh->getUV4().end(), out_uv4);
+            }
+            return APIResult::Success;
+        } API_CATCH;
+        return APIResult::ErrorUnknown;
     }
 }
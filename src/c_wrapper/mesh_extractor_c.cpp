@@ -21,4 +21,25 @@ extern "C"{
         API_CATCH;
         return APIResult::ErrorUnknown;
     }
+
+    /**
+     * 複数の CityModel から MeshExtractor::extract して結果を out_model に格納します。
+     * city_model_handles は count 個の CityModelHandle へのポインタの配列です。
+     */
+    LIBPLATEAU_C_EXPORT APIResult LIBPLATEAU_C_API plateau_mesh_extractor_extract_multiple(
+            const CityModelHandle* const* const city_model_handles,
+            const int count,
+            const MeshExtractOptions options,
+            Model* const out_model){
+        API_TRY{
+            std::vector<const citygml::CityModel*> city_models;
+            for (int i = 0; i < count; ++i) {
+                city_models.push_back(&city_model_handles[i]->getCityModel());
+            }
+            MeshExtractor::extract(*out_model, city_models, options);
+            return APIResult::Success;
+        }
+        API_CATCH;
+        return APIResult::ErrorUnknown;
+    }
 }
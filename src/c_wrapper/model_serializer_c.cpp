@@ -0,0 +1,29 @@
+#include "libplateau_c.h"
+#include <plateau/polygon_mesh/model_serializer.h>
+
+using namespace libplateau;
+using namespace plateau::polygonMesh;
+
+extern "C" {
+    LIBPLATEAU_C_EXPORT APIResult LIBPLATEAU_C_API plateau_model_serializer_write(
+            const Model* model, const char* file_path) {
+        API_TRY{
+            ModelSerializer::write(*model, file_path);
+            return APIResult::Success;
+        }
+        API_CATCH;
+        return APIResult::ErrorUnknown;
+    }
+
+    /// ファイルから読み込んだ結果を out_model に格納します。
+    /// out_model は plateau_create_model で生成された空の Model であることを想定します。
+    LIBPLATEAU_C_EXPORT APIResult LIBPLATEAU_C_API plateau_model_serializer_read(
+            Model* out_model, const char* file_path) {
+        API_TRY{
+            ModelSerializer::read(*out_model, file_path);
+            return APIResult::Success;
+        }
+        API_CATCH;
+        return APIResult::ErrorUnknown;
+    }
+}
@@ -31,6 +31,22 @@ extern "C" {
                 &handle->getChildAt(index),
                 index >= handle->getChildCount())
 
+    DLL_VALUE_FUNC(plateau_node_get_instance_count,
+                   Node,
+                   int,
+                   (int)handle->getInstances().size())
+
+    DLL_VALUE_FUNC_WITH_INDEX_CHECK(plateau_node_get_instance_translation_at_index,
+                                    Node,
+                                    TVec3d,
+                                    handle->getInstances().at(index).translation,
+                                    index < 0 || index >= (int)handle->getInstances().size())
+
+    DLL_STRING_PTR_FUNC(plateau_node_get_instance_name_at_index,
+                        Node,
+                        handle->getInstances().at(index).name,
+                        , int index)
+
     LIBPLATEAU_C_EXPORT APIResult LIBPLATEAU_C_API plateau_node_get_mesh(
             Node* node,
             Mesh** out_mesh_ptr
@@ -0,0 +1,25 @@
+#include "libplateau_c.h"
+#include <plateau/mesh_writer/tileset_writer.h>
+
+using namespace libplateau;
+using namespace plateau::meshWriter;
+
+extern "C" {
+    LIBPLATEAU_C_EXPORT APIResult LIBPLATEAU_C_API plateau_tileset_writer_write(TilesetWriter* handle, bool* out,
+            const char* output_directory, const char* const* gml_paths, const int gml_path_count,
+            const plateau::polygonMesh::MeshExtractOptions extract_options, const TilesetWriteOptions options) {
+        API_TRY{
+            std::vector<std::string> paths(gml_paths, gml_paths + gml_path_count);
+            *out = handle->write(output_directory, paths, extract_options, options);
+            return APIResult::Success;
+        }
+        API_CATCH;
+        return APIResult::ErrorUnknown;
+    }
+
+    DLL_CREATE_FUNC(plateau_create_tileset_writer,
+                    TilesetWriter)
+
+    DLL_DELETE_FUNC(plateau_delete_tileset_writer,
+                    TilesetWriter)
+}
@@ -9,6 +9,7 @@
 #include <plateau/dataset/mesh_code.h>
 #include <plateau/network/client.h>
 #include <plateau/dataset/lod_searcher.h>
+#include <plateau/dataset/gzip_stream.h>
 
 using namespace plateau::network;
 namespace fs = std::filesystem;
@@ -75,7 +76,15 @@ namespace plateau::dataset {
         if (isMaxLodCalculated())
             return max_lod_;
 
-        auto lods = LodSearcher::searchLodsInFile(fs::u8path(path_));
+        LodFlag lods;
+        if (zip_archive_ != nullptr) {
+            const auto stream = zip_archive_->openEntry(zip_entry_path_);
+            if (stream == nullptr)
+                throw std::runtime_error("Failed to read file in zip.");
+            lods = LodSearcher::searchLodsInIstream(*stream);
+        } else {
+            lods = LodSearcher::searchLodsInFile(fs::u8path(path_));
+        }
         max_lod_ = lods.getMax();
         if (max_lod_ < 0) max_lod_ = 0; // MaxLodが取得できなかった場合のフェイルセーフです。
         return max_lod_;
@@ -93,6 +102,13 @@ namespace plateau::dataset {
         auto path = fs::u8path(path_);
         is_local_ = checkLocal(path);
 
+        zip_archive_ = nullptr;
+        zip_entry_path_.clear();
+        std::string zip_path;
+        if (is_local_ && ZipArchive::splitPath(path_, zip_path, zip_entry_path_)) {
+            zip_archive_ = ZipArchive::open(zip_path);
+        }
+
         const auto filename = path.filename().u8string();
         std::vector<std::string> filename_parts;
         std::string current;
@@ -210,13 +226,25 @@ namespace plateau::dataset {
 
         // TODO GMLファイルの全文をメモリにコピーするので重いです。LodSearcher::searchLOD の実装を参考にすると速くなりそうです。
         std::string loadFile(const fs::path& file_path) {
-            std::ifstream ifs(file_path);
-            if (!ifs) {
+            // gzip で圧縮されたファイルは展開して読み込みます。
+            const auto stream = GzipStream::openFile(file_path.u8string());
+            if (stream == nullptr) {
                 throw std::runtime_error(
                         "loadFile : Could not open file " + file_path.u8string());
             }
             std::ostringstream buffer;
-            buffer << ifs.rdbuf();
+            buffer << stream->rdbuf();
+            return buffer.str();
+        }
+
+        std::string loadFileInZip(const ZipArchive& zip_archive, const std::string& entry_path) {
+            const auto stream = zip_archive.openEntry(entry_path);
+            if (stream == nullptr) {
+                throw std::runtime_error(
+                        "loadFileInZip : Could not open file " + entry_path + " in " + zip_archive.getPath());
+            }
+            std::ostringstream buffer;
+            buffer << stream->rdbuf();
             return buffer.str();
         }
 
@@ -284,6 +312,50 @@ namespace plateau::dataset {
             copyFiles(path_to_download, gml_dir_path, app_destination_path);
         }
 
+        /**
+         * zip 内のGMLファイルと、そこから参照されるテクスチャとコードリストだけを展開します。
+         * 展開先のフォルダ構成は fetchLocal と同じです。zip 内のパスは実在しないため、パスの計算は文字列上で行います。
+         */
+        void fetchZip(const ZipArchive& zip_archive, const std::string& gml_entry_path,
+                      const fs::path& destination_root_path, GmlFile& copied_gml_file) {
+            const auto udx_pos = (u8"/" + gml_entry_path).rfind(u8"/udx/");
+            if (udx_pos == std::string::npos) {
+                throw std::runtime_error("Invalid gml path. Could not find udx folder");
+            }
+            const auto gml_relative_path_from_udx = fs::u8path(gml_entry_path.substr(udx_pos + 4));
+            // udx の親フォルダがルートフォルダです。zip の直下に udx があるときは zip ファイル名をルートフォルダ名とします。
+            const auto root_folder_name = udx_pos == 0
+                                          ? fs::u8path(zip_archive.getPath()).stem()
+                                          : fs::u8path(gml_entry_path.substr(0, udx_pos - 1)).filename();
+            const auto destination_udx_path = (destination_root_path / root_folder_name).append(u8"udx");
+            const auto gml_destination_path = (destination_udx_path / gml_relative_path_from_udx).make_preferred();
+
+            if (!fs::exists(gml_destination_path) &&
+                !zip_archive.extractEntry(gml_entry_path, gml_destination_path.u8string())) {
+                throw std::runtime_error("Could not extract " + gml_entry_path + " from " + zip_archive.getPath());
+            }
+            copied_gml_file.setPath(gml_destination_path.u8string());
+
+            // GMLファイルを読み込み、関連するテクスチャパスとコードリストパスを取得します。
+            const auto codelist_paths = copied_gml_file.searchAllCodelistPathsInGML();
+            const auto image_paths = copied_gml_file.searchAllImagePathsInGML();
+
+            // テクスチャとコードリストファイルを展開します。
+            const auto gml_entry_dir_path = fs::u8path(gml_entry_path).parent_path();
+            const auto app_destination_path = gml_destination_path.parent_path();
+            auto path_to_extract = image_paths;
+            path_to_extract.insert(codelist_paths.cbegin(), codelist_paths.cend());
+            for (const auto& relative_path: path_to_extract) {
+                const auto entry_path = (gml_entry_dir_path / fs::u8path(relative_path)).lexically_normal().generic_u8string();
+                const auto dest = (app_destination_path / fs::u8path(relative_path)).make_preferred().lexically_normal();
+                if (fs::exists(dest))
+                    continue;
+                if (!zip_archive.extractEntry(entry_path, dest.u8string())) {
+                    std::cout << "file not exist : " << zip_archive.getPath() << "/" << entry_path << std::endl;
+                }
+            }
+        }
+
         void fetchServer(const fs::path& gml_file_path, const fs::path& gml_relative_path_from_udx,
                          const fs::path& destination_udx_path,
                          const fs::path& gml_destination_path, GmlFile& copied_gml_file,
@@ -334,6 +406,11 @@ namespace plateau::dataset {
 
     void GmlFile::fetch(const std::string& destination_root_path, GmlFile& copied_gml_file) const {
         if (!isValid()) throw std::runtime_error("gml file is invalid.");
+        if (zip_archive_ != nullptr) {
+            // zip 内のファイル
+            fetchZip(*zip_archive_, zip_entry_path_, fs::u8path(destination_root_path), copied_gml_file);
+            return;
+        }
         auto gml_relative_path_from_udx = fs::path();
         auto destination_udx_path = fs::path();
         auto gml_destination_path = fs::path();
@@ -354,8 +431,14 @@ namespace plateau::dataset {
         }
     }
 
+    std::string GmlFile::loadContent() const {
+        if (zip_archive_ != nullptr)
+            return loadFileInZip(*zip_archive_, zip_entry_path_);
+        return loadFile(fs::u8path(getPath()));
+    }
+
     std::set<std::string> GmlFile::searchAllCodelistPathsInGML() const {
-        const auto gml_content = loadFile(fs::u8path(getPath()));
+        const auto gml_content = loadContent();
         // 開始タグは codeSpace=" です。ただし =(イコール), "(ダブルクォーテーション)の前後に半角スペースがあっても良いものとします。
         static const auto begin_tag = std::regex(R"(codeSpace *= *")", regex_options);
         // 終了タグは、開始タグの次の "(ダブルクォーテーション)です。
@@ -366,7 +449,7 @@ namespace plateau::dataset {
     }
 
     std::set<std::string> GmlFile::searchAllImagePathsInGML() const {
-        const auto gml_content = loadFile(fs::u8path(getPath()));
+        const auto gml_content = loadContent();
         // 開始タグは <app:imageURI> です。ただし、<括弧> の前後に半角スペースがあっても良いものとします。
         static const auto begin_tag = std::regex(R"(< *app:imageURI *>)", regex_options);
         // 終了タグは </app:imageURI> です。ただし、<括弧> と /(スラッシュ) の前後に半角スペースがあっても良いものとします。
@@ -0,0 +1,640 @@
+#include <plateau/dataset/gml_filter.h>
+#include <plateau/dataset/gzip_stream.h>
+#include "gml_tag_scanner.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace plateau::dataset {
+    namespace fs = std::filesystem;
+
+    namespace {
+        /// "lod(番号)" の後に続く、形状を表すプロパティ名です。
+        constexpr const char* lod_geometry_suffixes[] = {
+                "MultiSurface", "MultiCurve", "MultiSolid", "Solid", "Geometry", "FootPrint", "RoofEdge",
+                "TerrainIntersection", "ImplicitRepresentation", "Network", "Point"
+        };
+
+        /**
+         * local_name が属性のプロパティ要素であれば true を返します。
+         * 汎用属性 (gen:stringAttribute, gen:genericAttributeSet など) と、
+         * i-UR の拡張属性 (uro:buildingDetailAttribute, uro:extendedAttribute など) が該当します。
+         * いずれも小文字で始まり "Attribute" または "AttributeSet" で終わります。
+         */
+        bool isAttributeProperty(std::string_view local_name) {
+            if (local_name.empty() || local_name[0] < 'a' || local_name[0] > 'z')
+                return false;
+            const auto ends_with = [local_name](std::string_view suffix) {
+                return local_name.size() > suffix.size() &&
+                       local_name.compare(local_name.size() - suffix.size(), suffix.size(), suffix) == 0;
+            };
+            return ends_with("Attribute") || ends_with("AttributeSet") || local_name == "address";
+        }
+
+        bool isAppearanceProperty(std::string_view local_name) {
+            return local_name == "appearanceMember" || local_name == "appearance";
+        }
+
+        /**
+         * local_name が "lod(番号)(形状)" の形式であれば LOD 番号を返し、そうでなければ -1 を返します。
+         */
+        int lodOfGeometryProperty(std::string_view local_name) {
+            if (local_name.size() < 5 || local_name.compare(0, 3, "lod") != 0)
+                return -1;
+            const auto digit = local_name[3];
+            if (digit < '0' || digit > '9')
+                return -1;
+            const auto suffix = local_name.substr(4);
+            for (const auto lod_suffix : lod_geometry_suffixes) {
+                if (suffix == lod_suffix)
+                    return digit - '0';
+            }
+            return -1;
+        }
+
+        /// 座標を記述する GML の要素の種類です。
+        enum class CoordinateElement {
+            None,
+            Pos,
+            LowerCorner,
+            UpperCorner
+        };
+
+        CoordinateElement coordinateElementOf(std::string_view local_name) {
+            if (local_name == "pos" || local_name == "posList")
+                return CoordinateElement::Pos;
+            if (local_name == "lowerCorner")
+                return CoordinateElement::LowerCorner;
+            if (local_name == "upperCorner")
+                return CoordinateElement::UpperCorner;
+            return CoordinateElement::None;
+        }
+
+        /**
+         * 空白区切りの座標の文字列から、最初の (緯度, 経度, 高さ) を読み取ります。高さがなければ 0 とします。
+         */
+        bool parseFirstCoordinate(const std::string& text, TVec3d& out_coordinate) {
+            double values[3] = {0, 0, 0};
+            const char* current = text.c_str();
+            int count = 0;
+            for (; count < 3; ++count) {
+                char* end = nullptr;
+                values[count] = std::strtod(current, &end);
+                if (end == current)
+                    break;
+                current = end;
+            }
+            if (count < 2)
+                return false;
+            out_coordinate = TVec3d(values[0], values[1], values[2]);
+            return true;
+        }
+
+        /**
+         * GML を GmlTagScanner で先頭から走査し、条件に合う要素を取り除きながら書き出します。
+         */
+        class GmlStreamFilter {
+        public:
+            GmlStreamFilter(std::istream& in, std::ostream& out, const GmlFilterParams& params) :
+                scanner_(in), out_(out), params_(params), flushed_size_(0), skip_depth_(0),
+                member_pending_(false), member_output_start_(0), member_depth_(0),
+                capturing_(CoordinateElement::None), has_lower_corner_(false),
+                capturing_slot_(0), geometry_lod_(no_geometry_lod), geometry_lod_depth_(0), ring_depth_(0), envelope_depth_(0) {
+            }
+
+            void run() {
+                std::string_view token;
+                bool is_tag = false;
+                while (scanner_.next(token, is_tag)) {
+                    if (is_tag) {
+                        handleTag(token);
+                    } else {
+                        handleText(token);
+                    }
+                }
+                flush();
+            }
+
+        private:
+            static constexpr size_t output_flush_size = 1024 * 1024;
+
+            void handleText(std::string_view text) {
+                if (skip_depth_ > 0)
+                    return;
+                write(text);
+                if (capturing_ != CoordinateElement::None)
+                    coordinate_text_.append(text);
+            }
+
+            void handleTag(std::string_view tag) {
+                if (GmlTagScanner::isMarkup(tag)) {
+                    if (skip_depth_ == 0)
+                        write(tag);
+                    return;
+                }
+
+                if (GmlTagScanner::isEndTag(tag)) {
+                    if (skip_depth_ > 0) {
+                        --skip_depth_;
+                        return;
+                    }
+                    handleEndTag(tag);
+                    return;
+                }
+
+                const bool is_empty_element = GmlTagScanner::isEmptyElement(tag);
+                if (skip_depth_ > 0) {
+                    if (!is_empty_element)
+                        ++skip_depth_;
+                    return;
+                }
+
+                const auto local_name = GmlTagScanner::localNameOfTag(tag);
+                if (shouldRemove(local_name)) {
+                    if (!is_empty_element)
+                        skip_depth_ = 1;
+                    return;
+                }
+                const auto& type_info = cityObjectTypeOf(local_name);
+                if (type_info.masked_out) {
+                    removeCityObject(is_empty_element);
+                    return;
+                }
+                if (is_empty_element) {
+                    write(tag);
+                    return;
+                }
+
+                // CityModel 直下の cityObjectMember は、位置が分かるまで出力を保留します。
+                if (params_.exclude_city_object_outside_extent && depth() == 1 && local_name == "cityObjectMember") {
+                    member_pending_ = true;
+                    member_output_start_ = outputPosition();
+                    member_depth_ = depth() + 1;
+                    has_lower_corner_ = false;
+                    object_positions_.clear();
+                    geometry_lod_ = no_geometry_lod;
+                    ring_depth_ = 0;
+                    envelope_depth_ = 0;
+                }
+                open_element_starts_.push_back(outputPosition());
+                write(tag);
+                if (member_pending_)
+                    trackPosition(local_name, type_info.is_city_object);
+            }
+
+            /**
+             * 保留中の cityObjectMember の中で開いた要素から、PolygonMeshUtils::cityObjPos と同じ規則で位置を求めるための情報を集めます。
+             * 主要地物の gml:boundedBy の Envelope と、各都市オブジェクトの LOD ごとの最初のポリゴンの外周の頂点を調べます。
+             */
+            void trackPosition(std::string_view local_name, bool is_city_object) {
+                capturing_ = CoordinateElement::None;
+                coordinate_text_.clear();
+                if (is_city_object) {
+                    object_positions_.emplace_back();
+                    object_positions_.back().depth = depth();
+                    return;
+                }
+                if (object_positions_.empty())
+                    return;
+
+                const auto element = coordinateElementOf(local_name);
+                // 主要地物自身の Envelope は、主要地物 > gml:boundedBy > gml:Envelope の位置にあります。
+                if (object_positions_.size() == 1 && local_name == "Envelope" &&
+                    depth() == object_positions_.front().depth + 2) {
+                    envelope_depth_ = depth();
+                    return;
+                }
+                if (envelope_depth_ != 0) {
+                    if (depth() == envelope_depth_ + 1 && element != CoordinateElement::Pos)
+                        capturing_ = element;
+                    return;
+                }
+
+                if (geometry_lod_ == no_geometry_lod) {
+                    const auto lod = lodOfGeometryProperty(local_name);
+                    if (lod >= 0) {
+                        // cityObjPos は仕様上の最大 LOD を超える形状と、インスタンス化された形状を調べません。
+                        const auto is_used = lod <= static_cast<int>(max_lod_of_position) &&
+                                             local_name.substr(4) != "ImplicitRepresentation";
+                        geometry_lod_ = is_used ? lod : unused_geometry_lod;
+                        geometry_lod_depth_ = depth();
+                        return;
+                    }
+                }
+                if (geometry_lod_ == unused_geometry_lod)
+                    return;
+                if (local_name == "LinearRing" && ring_depth_ == 0) {
+                    ring_depth_ = depth();
+                    return;
+                }
+                // LOD の分からない形状 (dem:tin など) は、すべての LOD の後に調べます。
+                const auto slot = geometry_lod_ == no_geometry_lod ? max_lod_of_position + 1 : geometry_lod_;
+                if (ring_depth_ != 0 && element == CoordinateElement::Pos && !object_positions_.back().own[slot]) {
+                    capturing_ = element;
+                    capturing_slot_ = slot;
+                }
+            }
+
+            void handleEndTag(std::string_view tag) {
+                write(tag);
+                open_element_starts_.pop_back();
+                if (capturing_ != CoordinateElement::None) {
+                    const auto element = capturing_;
+                    capturing_ = CoordinateElement::None;
+                    onCoordinate(element);
+                }
+                if (member_pending_)
+                    closeTrackedElements();
+                if (member_pending_ && depth() < member_depth_) {
+                    // 位置が分からないまま cityObjectMember が閉じました。位置が不明な都市オブジェクトは取り除きます。
+                    dropMember();
+                }
+            }
+
+            void onCoordinate(CoordinateElement element) {
+                TVec3d coordinate;
+                if (!parseFirstCoordinate(coordinate_text_, coordinate))
+                    return;
+                switch (element) {
+                    case CoordinateElement::LowerCorner:
+                        lower_corner_ = coordinate;
+                        has_lower_corner_ = true;
+                        return;
+                    case CoordinateElement::UpperCorner:
+                        if (!has_lower_corner_)
+                            return;
+                        // 主要地物の Envelope があれば、その中心で判定します。
+                        decideMember((lower_corner_ + coordinate) * 0.5);
+                        return;
+                    default:
+                        object_positions_.back().own[capturing_slot_] = coordinate;
+                        return;
+                }
+            }
+
+            /**
+             * 閉じた要素に応じて、位置を求めるための状態を戻します。
+             * 都市オブジェクトが閉じたときは、PolygonMeshUtils::findFirstPolygon と同じく子の都市オブジェクトを自身の形状より優先して、
+             * LOD ごとの最初の頂点を親に伝えます。主要地物が閉じたときは、最も低い LOD の頂点で判定します。
+             */
+            void closeTrackedElements() {
+                if (ring_depth_ > depth())
+                    ring_depth_ = 0;
+                if (geometry_lod_ != no_geometry_lod && geometry_lod_depth_ > depth()) {
+                    geometry_lod_ = no_geometry_lod;
+                    ring_depth_ = 0;
+                }
+                if (envelope_depth_ > depth())
+                    envelope_depth_ = 0;
+                if (object_positions_.empty() || object_positions_.back().depth <= depth())
+                    return;
+
+                auto closed = object_positions_.back();
+                object_positions_.pop_back();
+                for (unsigned slot = 0; slot < position_slot_count; ++slot) {
+                    if (!closed.from_children[slot])
+                        closed.from_children[slot] = closed.own[slot];
+                }
+                if (!object_positions_.empty()) {
+                    auto& parent = object_positions_.back();
+                    for (unsigned slot = 0; slot < position_slot_count; ++slot) {
+                        if (!parent.from_children[slot])
+                            parent.from_children[slot] = closed.from_children[slot];
+                    }
+                    return;
+                }
+                for (const auto& position : closed.from_children) {
+                    if (position) {
+                        decideMember(*position);
+                        return;
+                    }
+                }
+                // 主要地物の位置が不明なため取り除きます。
+                rejectMember();
+            }
+
+            void decideMember(const TVec3d& position) {
+                if (params_.extent.contains(position)) {
+                    member_pending_ = false;
+                    return;
+                }
+                rejectMember();
+            }
+
+            /// 保留した出力を捨てて cityObjectMember の終わりまで読み飛ばします。
+            void rejectMember() {
+                skip_depth_ = depth() - member_depth_ + 1;
+                open_element_starts_.resize(member_depth_ - 1);
+                dropMember();
+            }
+
+            void dropMember() {
+                retract(member_output_start_);
+                member_pending_ = false;
+            }
+
+            /// 要素名が都市オブジェクトの型を表すかどうかと、その型が型のマスクに含まれないかどうかです。
+            struct CityObjectTypeInfo {
+                bool is_city_object;
+                bool masked_out;
+            };
+
+            /// local_name の要素が都市オブジェクトであるかどうかを調べます。
+            const CityObjectTypeInfo& cityObjectTypeOf(std::string_view local_name) {
+                static const CityObjectTypeInfo not_city_object = { false, false };
+                // 都市オブジェクトの要素名は大文字で始まります。小文字で始まるプロパティ要素は調べません。
+                if (local_name.empty() || local_name[0] < 'A' || local_name[0] > 'Z')
+                    return not_city_object;
+                // 位置による絞り込みも型による絞り込みもしないときは調べません。
+                const auto filters_type = params_.city_object_type_mask != citygml::CityObject::CityObjectsType::COT_All;
+                if (!filters_type && !params_.exclude_city_object_outside_extent)
+                    return not_city_object;
+                // 要素名ごとの判定結果を覚えておき、同じ要素名では文字列を確保せずに判定します。
+                auto found = type_cache_.find(local_name);
+                if (found == type_cache_.end()) {
+                    bool valid = false;
+                    const auto name = std::string(local_name);
+                    const auto type = citygml::cityObjectsTypeFromString(name, valid);
+                    const auto masked_out = filters_type && valid &&
+                            (type & params_.city_object_type_mask) == static_cast<citygml::CityObject::CityObjectsType>(0);
+                    found = type_cache_.emplace(name, CityObjectTypeInfo{ valid, masked_out }).first;
+                }
+                return found->second;
+            }
+
+            /**
+             * 型のマスクに含まれない都市オブジェクトを、それを包むプロパティ要素 (core:cityObjectMember, bldg:interiorRoom など) ごと取り除きます。
+             * 包む要素がルート要素であるか、すでに書き出していて取り消せないときは、都市オブジェクトの要素だけを取り除きます。
+             */
+            void removeCityObject(bool is_empty_element) {
+                const auto can_remove_parent = depth() >= 2 && open_element_starts_.back() >= flushed_size_;
+                if (!can_remove_parent) {
+                    skip_depth_ = is_empty_element ? 0 : 1;
+                    return;
+                }
+                retract(open_element_starts_.back());
+                open_element_starts_.pop_back();
+                skip_depth_ = is_empty_element ? 1 : 2;
+                if (member_pending_ && depth() < member_depth_)
+                    member_pending_ = false;
+            }
+
+            int depth() const {
+                return static_cast<int>(open_element_starts_.size());
+            }
+
+            /// これまでに出力した文字数です。
+            size_t outputPosition() const {
+                return flushed_size_ + output_.size();
+            }
+
+            /// 出力を position の位置まで取り消します。
+            void retract(size_t position) {
+                output_.resize(position - flushed_size_);
+            }
+
+            bool shouldRemove(std::string_view local_name) const {
+                if (params_.remove_attributes && isAttributeProperty(local_name))
+                    return true;
+                if (params_.remove_appearance && isAppearanceProperty(local_name))
+                    return true;
+                if (params_.lod_mask != 0) {
+                    const auto lod = lodOfGeometryProperty(local_name);
+                    if (lod >= 0 && (params_.lod_mask & (1u << lod)) == 0)
+                        return true;
+                }
+                return false;
+            }
+
+            void write(std::string_view str) {
+                output_.append(str);
+                // 保留中の cityObjectMember は、取り除く可能性があるため書き出しません。
+                if (output_.size() >= output_flush_size && !member_pending_)
+                    flush();
+            }
+
+            void flush() {
+                out_.write(output_.data(), static_cast<std::streamsize>(output_.size()));
+                flushed_size_ += output_.size();
+                output_.clear();
+            }
+
+            GmlTagScanner scanner_;
+            std::ostream& out_;
+            const GmlFilterParams& params_;
+            std::string output_;
+            /// output_ より前に書き出した文字数です。
+            size_t flushed_size_;
+            /// 出力した要素のうち、閉じていない要素の開始タグの出力位置です。
+            std::vector<size_t> open_element_starts_;
+            /// 取り除いている要素の中での、要素の深さです。0 のときは取り除いていません。
+            int skip_depth_;
+
+            /// 位置が分かるまで出力を保留している cityObjectMember があれば true です。
+            bool member_pending_;
+            size_t member_output_start_;
+            int member_depth_;
+            CoordinateElement capturing_;
+            std::string coordinate_text_;
+            TVec3d lower_corner_;
+            bool has_lower_corner_;
+
+            /// 位置を求めるために調べる LOD の最大値です。PolygonMeshUtils::cityObjPos と同じく仕様上の最大 LOD までとします。
+            static constexpr unsigned max_lod_of_position = plateau::polygonMesh::PolygonMeshUtils::max_lod_in_specification_;
+            /// LOD ごとの頂点に、LOD の分からない形状の頂点を加えた数です。
+            static constexpr unsigned position_slot_count = max_lod_of_position + 2;
+            /// 形状プロパティの中にいないことを表す geometry_lod_ の値です。
+            static constexpr int no_geometry_lod = -1;
+            /// 位置を求めるのに使わない形状プロパティ (lod1ImplicitRepresentation など) の中にいることを表す geometry_lod_ の値です。
+            static constexpr int unused_geometry_lod = -2;
+
+            /// 保留中の cityObjectMember の中で開いている都市オブジェクトごとの、LOD ごとの最初のポリゴンの頂点です。
+            struct CityObjectPosition {
+                int depth = 0;
+                /// 自身の形状のうち、LOD ごとに最初のポリゴンの頂点です。
+                std::optional<TVec3d> own[position_slot_count];
+                /// 閉じた子の都市オブジェクトから伝わった、LOD ごとの最初の頂点です。
+                std::optional<TVec3d> from_children[position_slot_count];
+            };
+            std::vector<CityObjectPosition> object_positions_;
+            /// 頂点を読み取っている座標を格納する、CityObjectPosition::own の添字です。
+            unsigned capturing_slot_;
+            /// 開いている形状プロパティ (lod2MultiSurface など) の LOD と、その要素の深さです。
+            int geometry_lod_;
+            int geometry_lod_depth_;
+            /// 開いている gml:LinearRing の深さです。開いていないときは 0 です。
+            int ring_depth_;
+            /// 開いている主要地物の gml:Envelope の深さです。開いていないときは 0 です。
+            int envelope_depth_;
+            /// 要素名ごとに、都市オブジェクトであるかどうかと、型のマスクに含まれないかどうかを覚えておきます。
+            std::map<std::string, CityObjectTypeInfo, std::less<>> type_cache_;
+        };
+
+        int currentProcessId() {
+#ifdef _WIN32
+            return _getpid();
+#else
+            return static_cast<int>(getpid());
+#endif
+        }
+
+        /**
+         * gml_path を directory に書き出すときの一時ファイルのパスを返します。
+         * 同じGMLファイルを同時に読み込む別のスレッドやプロセスと衝突しないよう、プロセスID、プロセスごとの乱数、連番を名前に含めます。
+         * GMLファイルの検索やフォルダの監視の対象にならないよう、拡張子は .gml や .gml.gz ではなく .tmp とします。
+         */
+        fs::path temporaryPathOf(const fs::path& gml_path, const fs::path& directory) {
+            static const auto process_random = std::random_device()();
+            static std::atomic<uint64_t> next_serial(0);
+            std::stringstream ss;
+            ss << ".filtered_" << currentProcessId() << "_" << std::hex << process_random << std::dec
+               << "_" << next_serial.fetch_add(1) << ".tmp";
+            return directory / fs::u8path(gml_path.filename().u8string() + ss.str());
+        }
+
+        /**
+         * in の GML から params の条件に合う要素を取り除いて一時ファイルに書き出し、読み込んでから削除します。
+         * 一時ファイルは directories のうち、最初に作れたフォルダに書き出します。
+         * 一時ファイルを書き込めなければ nullptr を返し、out_written を false にします。
+         */
+        std::shared_ptr<const citygml::CityModel> loadThroughTemporaryFile(
+                std::istream& in, const std::string& gml_path, const std::vector<fs::path>& directories,
+                const citygml::ParserParams& parser_params, const GmlFilterParams& params,
+                const std::shared_ptr<citygml::CityGMLLogger>& logger, bool& out_written) {
+            out_written = false;
+            fs::path temp_path;
+            {
+                std::ofstream ofs;
+                for (const auto& directory : directories) {
+                    temp_path = temporaryPathOf(fs::u8path(gml_path), directory);
+                    ofs.open(temp_path, std::ios::binary);
+                    if (ofs)
+                        break;
+                    ofs.clear();
+                }
+                if (!ofs.is_open())
+                    return nullptr;
+                GmlFilter::filter(in, ofs, params);
+                out_written = static_cast<bool>(ofs);
+            }
+            if (!out_written) {
+                std::error_code ignored;
+                fs::remove(temp_path, ignored);
+                return nullptr;
+            }
+
+            std::shared_ptr<const citygml::CityModel> city_model;
+            try {
+                city_model = citygml::load(temp_path.u8string(), parser_params, logger);
+            } catch (...) {
+                std::error_code ignored;
+                fs::remove(temp_path, ignored);
+                throw;
+            }
+            std::error_code ignored;
+            fs::remove(temp_path, ignored);
+            return city_model;
+        }
+    }
+
+    unsigned GmlFilterParams::lodMaskOf(unsigned min_lod, unsigned max_lod) {
+        unsigned mask = 0;
+        for (auto lod = min_lod; lod <= std::min(max_lod, 31u); ++lod) {
+            mask |= 1u << lod;
+        }
+        return mask;
+    }
+
+    GmlFilterParams GmlFilterParams::geometryOnly() {
+        GmlFilterParams params;
+        params.remove_attributes = true;
+        params.remove_appearance = true;
+        return params;
+    }
+
+    GmlFilterParams GmlFilterParams::fromExtractOptions(const plateau::polygonMesh::MeshExtractOptions& options) {
+        GmlFilterParams params;
+        const auto covers_all_lods = options.min_lod == 0 &&
+                                     options.max_lod >= plateau::polygonMesh::PolygonMeshUtils::max_lod_in_specification_;
+        // 範囲が空のときに lod_mask が 0 となり、全LODが残ってしまわないよう、そのときは絞り込みません。
+        if (!covers_all_lods && options.min_lod <= options.max_lod)
+            params.lod_mask = lodMaskOf(options.min_lod, options.max_lod);
+
+        // 全範囲を含む extent では位置による絞り込みは不要なため、GMLファイルの走査を省けるよう絞り込みません。
+        const auto all = plateau::geometry::Extent::all();
+        const auto covers_all_area = options.extent.contains(all.min) && options.extent.contains(all.max);
+        if (options.exclude_city_object_outside_extent && !covers_all_area) {
+            params.exclude_city_object_outside_extent = true;
+            params.extent = options.extent;
+        }
+        params.city_object_type_mask = options.city_object_type_mask;
+        params.remove_appearance = !options.export_appearance;
+        return params;
+    }
+
+    bool GmlFilterParams::filtersAnything() const {
+        return lod_mask != 0 || exclude_city_object_outside_extent || remove_attributes || remove_appearance ||
+               city_object_type_mask != citygml::CityObject::CityObjectsType::COT_All;
+    }
+
+    void GmlFilter::filter(std::istream& in, std::ostream& out, const GmlFilterParams& params) {
+        GmlStreamFilter(in, out, params).run();
+    }
+
+    std::shared_ptr<const citygml::CityModel> GmlFilter::load(
+            const std::string& gml_path, const citygml::ParserParams& parser_params, const GmlFilterParams& params,
+            const std::shared_ptr<citygml::CityGMLLogger>& logger) {
+        if (GzipStream::isGzipPath(gml_path)) {
+            // libcitygml は圧縮されたファイルを読めないため、展開しながら一時ファイルに書き出して読み込みます。
+            const auto stream = GzipStream::open(gml_path);
+            if (stream == nullptr)
+                return nullptr;
+            return loadFromStream(*stream, gml_path, parser_params, params, logger);
+        }
+
+        if (!params.filtersAnything())
+            return citygml::load(gml_path, parser_params, logger);
+
+        std::ifstream ifs(fs::u8path(gml_path), std::ios::binary);
+        if (!ifs) {
+            // 読み込めないときのエラーは citygml::load に任せます。
+            return citygml::load(gml_path, parser_params, logger);
+        }
+        bool temporary_file_written = false;
+        auto city_model = loadThroughTemporaryFile(ifs, gml_path, { fs::u8path(gml_path).parent_path() }, parser_params,
+                                                   params, logger, temporary_file_written);
+        if (!temporary_file_written) {
+            // 一時ファイルを書き込めないときは、取り除かずに読み込みます。
+            return citygml::load(gml_path, parser_params, logger);
+        }
+        return city_model;
+    }
+
+    std::shared_ptr<const citygml::CityModel> GmlFilter::loadFromStream(
+            std::istream& in, const std::string& gml_path, const citygml::ParserParams& parser_params,
+            const GmlFilterParams& params, const std::shared_ptr<citygml::CityGMLLogger>& logger) {
+        // 読み込み専用のフォルダなどで書き込めないときは、システムの一時フォルダに書き出します。
+        std::vector<fs::path> directories = { fs::u8path(gml_path).parent_path() };
+        std::error_code error;
+        const auto system_temp_directory = fs::temp_directory_path(error);
+        if (!error)
+            directories.push_back(system_temp_directory);
+        bool temporary_file_written = false;
+        return loadThroughTemporaryFile(in, gml_path, directories, parser_params, params, logger, temporary_file_written);
+    }
+}
@@ -0,0 +1,349 @@
+#include <plateau/dataset/gml_partitioner.h>
+#include <plateau/dataset/gzip_stream.h>
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+#include "gml_tag_scanner.h"
+#include "../util/parallel_for.h"
+
+namespace plateau::dataset {
+    namespace fs = std::filesystem;
+
+    namespace {
+        /// partition_count が 0 のとき、分割した1つの部分に含める cityObjectMember のバイト数の目安です。
+        constexpr size_t min_auto_partition_bytes = 8 * 1024 * 1024;
+
+        /// in の [begin, end) を out に追記します。
+        void appendRange(std::istream& in, size_t begin, size_t end, std::string& out) {
+            const auto old_size = out.size();
+            out.resize(old_size + (end - begin));
+            in.seekg(static_cast<std::streamoff>(begin));
+            in.read(&out[old_size], static_cast<std::streamsize>(end - begin));
+            out.resize(old_size + static_cast<size_t>(in.gcount()));
+        }
+
+        /// element に含まれる gml:id 属性の値を out_gml_ids に追加します。
+        void collectGmlIds(const std::string& element, std::unordered_set<std::string>& out_gml_ids) {
+            static const std::string attribute = "gml:id=";
+            for (auto pos = element.find(attribute); pos != std::string::npos; pos = element.find(attribute, pos)) {
+                pos += attribute.size();
+                if (pos >= element.size() || (element[pos] != '"' && element[pos] != '\''))
+                    continue;
+                const auto value_end = element.find(element[pos], pos + 1);
+                if (value_end == std::string::npos)
+                    return;
+                out_gml_ids.insert(element.substr(pos + 1, value_end - pos - 1));
+                pos = value_end;
+            }
+        }
+
+        /// 開始タグまたは空要素タグ tag から、属性 name の値を返します。なければ空を返します。
+        std::string_view attributeValue(std::string_view tag, std::string_view name) {
+            for (auto pos = tag.find(name); pos != std::string_view::npos; pos = tag.find(name, pos + 1)) {
+                const auto value_begin = pos + name.size() + 1;
+                if (pos == 0 || !std::isspace(static_cast<unsigned char>(tag[pos - 1])) || value_begin >= tag.size() ||
+                    tag[pos + name.size()] != '=' || (tag[value_begin] != '"' && tag[value_begin] != '\''))
+                    continue;
+                const auto value_end = tag.find(tag[value_begin], value_begin + 1);
+                if (value_end == std::string_view::npos)
+                    break;
+                return tag.substr(value_begin + 1, value_end - value_begin - 1);
+            }
+            return {};
+        }
+
+        /**
+         * app:appearanceMember の要素から、gml_ids に含まれないポリゴンを対象とする app:target を取り除きます。
+         * すべての app:target を取り除いた app:surfaceDataMember も取り除きます。
+         * テクスチャ座標の大半は app:target の中にあるため、部分ごとにパースするアピアランスはその部分のポリゴンの分だけになります。
+         */
+        std::string filterAppearanceTargets(const std::string& element, const std::unordered_set<std::string>& gml_ids) {
+            std::istringstream in(element);
+            GmlTagScanner scanner(in);
+            std::string filtered;
+            filtered.reserve(element.size());
+
+            // 読み込み中の app:target の状態です。target_depth が 0 のときは app:target の外にいます。
+            int target_depth = 0;
+            size_t target_begin = 0;
+            bool target_has_uri = false;
+            std::string target_reference;
+            // 読み込み中の app:surfaceDataMember の状態です。
+            bool in_surface_data_member = false;
+            size_t surface_data_member_begin = 0;
+            size_t target_count = 0;
+            size_t kept_target_count = 0;
+
+            const auto finish_target = [&](size_t target_end) {
+                // 対象は ParameterizedTexture では uri 属性、X3DMaterial と GeoreferencedTexture では要素の内容で "#gml:id" の形式で表されます。
+                const auto begin = target_reference.find_first_not_of(" \t\r\n#");
+                const auto end = target_reference.find_last_not_of(" \t\r\n");
+                const auto target_id = begin == std::string::npos ? "" : target_reference.substr(begin, end - begin + 1);
+                ++target_count;
+                if (gml_ids.find(target_id) != gml_ids.end()) {
+                    filtered.append(element, target_begin, target_end - target_begin);
+                    ++kept_target_count;
+                }
+            };
+
+            std::string_view token;
+            bool is_tag = false;
+            while (scanner.next(token, is_tag)) {
+                const auto offset = scanner.tokenOffset();
+                if (target_depth > 0) {
+                    if (!is_tag) {
+                        if (target_depth == 1 && !target_has_uri)
+                            target_reference += token;
+                    } else if (!GmlTagScanner::isMarkup(token)) {
+                        if (GmlTagScanner::isEndTag(token)) {
+                            if (--target_depth == 0)
+                                finish_target(offset + token.size());
+                        } else if (!GmlTagScanner::isEmptyElement(token)) {
+                            ++target_depth;
+                        }
+                    }
+                    continue;
+                }
+
+                if (is_tag && !GmlTagScanner::isMarkup(token)) {
+                    if (GmlTagScanner::isEndTag(token)) {
+                        const auto name = GmlTagScanner::localNameOf(token.substr(2, token.find_first_of(" \t\r\n>", 2) - 2));
+                        if (name == "surfaceDataMember" && in_surface_data_member) {
+                            in_surface_data_member = false;
+                            if (target_count > 0 && kept_target_count == 0) {
+                                filtered.resize(surface_data_member_begin);
+                                continue;
+                            }
+                        }
+                    } else {
+                        const auto name = GmlTagScanner::localNameOfTag(token);
+                        if (name == "target") {
+                            target_begin = offset;
+                            target_reference = std::string(attributeValue(token, "uri"));
+                            target_has_uri = !target_reference.empty();
+                            if (GmlTagScanner::isEmptyElement(token)) {
+                                finish_target(offset + token.size());
+                            } else {
+                                target_depth = 1;
+                            }
+                            continue;
+                        }
+                        if (name == "surfaceDataMember" && !GmlTagScanner::isEmptyElement(token)) {
+                            in_surface_data_member = true;
+                            surface_data_member_begin = filtered.size();
+                            target_count = 0;
+                            kept_target_count = 0;
+                        }
+                    }
+                }
+                filtered += token;
+            }
+            return filtered;
+        }
+
+        /**
+         * 元の GMLファイルから、ルート要素、共有する要素、members の cityObjectMember だけを含む GML を作ります。
+         * 共有する要素のうち app:appearanceMember は、members に含まれるポリゴンを対象とする部分だけを残します。
+         * 要素の順序は元の GMLファイルと同じにします。
+         */
+        std::string buildPartGml(std::istream& in, const GmlTopLevelLayout& layout,
+                                 const std::vector<GmlTopLevelLayout::Range>& members) {
+            // アピアランスの対象を絞り込むため、先に cityObjectMember を読んで gml:id を集めます。
+            std::vector<std::pair<size_t, std::string>> elements;
+            std::unordered_set<std::string> gml_ids;
+            for (const auto& member : members) {
+                std::string text;
+                appendRange(in, member.begin, member.end, text);
+                collectGmlIds(text, gml_ids);
+                elements.emplace_back(member.begin, std::move(text));
+            }
+            for (const auto& shared_element : layout.shared_elements) {
+                std::string text;
+                appendRange(in, shared_element.begin, shared_element.end, text);
+                if (GmlTagScanner::localNameOfTag(text) == "appearanceMember")
+                    text = filterAppearanceTargets(text, gml_ids);
+                elements.emplace_back(shared_element.begin, std::move(text));
+            }
+            std::sort(elements.begin(), elements.end(), [](const auto& lhs, const auto& rhs) {
+                return lhs.first < rhs.first;
+            });
+
+            std::string gml;
+            appendRange(in, 0, layout.root_content_begin, gml);
+            for (const auto& [_, text] : elements) {
+                gml += "\n";
+                gml += text;
+            }
+            gml += "\n";
+            in.clear();
+            in.seekg(static_cast<std::streamoff>(layout.root_end_begin));
+            std::stringstream footer;
+            footer << in.rdbuf();
+            gml += footer.str();
+            return gml;
+        }
+    }
+
+    bool GmlTopLevelLayout::isValid() const {
+        return root_content_begin != 0 && root_end_begin >= root_content_begin;
+    }
+
+    GmlTopLevelLayout GmlPartitioner::scan(std::istream& in) {
+        GmlTopLevelLayout layout;
+        GmlTagScanner scanner(in);
+        std::string_view token;
+        bool is_tag = false;
+        int depth = 0;
+        size_t child_begin = 0;
+        bool child_is_member = false;
+
+        const auto add_child = [&](size_t end) {
+            const GmlTopLevelLayout::Range range{child_begin, end};
+            if (child_is_member) {
+                layout.city_object_members.push_back(range);
+            } else {
+                layout.shared_elements.push_back(range);
+            }
+        };
+
+        while (scanner.next(token, is_tag)) {
+            if (!is_tag || GmlTagScanner::isMarkup(token))
+                continue;
+            const auto offset = scanner.tokenOffset();
+            if (GmlTagScanner::isEndTag(token)) {
+                --depth;
+                if (depth == 1) {
+                    add_child(offset + token.size());
+                } else if (depth == 0) {
+                    layout.root_end_begin = offset;
+                    break;
+                }
+                continue;
+            }
+
+            const bool is_empty_element = GmlTagScanner::isEmptyElement(token);
+            if (depth == 0) {
+                layout.root_content_begin = offset + token.size();
+            } else if (depth == 1) {
+                child_begin = offset;
+                child_is_member = GmlTagScanner::localNameOfTag(token) == "cityObjectMember";
+                if (is_empty_element)
+                    add_child(offset + token.size());
+            }
+            if (!is_empty_element)
+                ++depth;
+        }
+        return layout;
+    }
+
+    std::vector<std::vector<GmlTopLevelLayout::Range>> GmlPartitioner::partition(
+            const GmlTopLevelLayout& layout, unsigned partition_count) {
+        std::vector<std::vector<GmlTopLevelLayout::Range>> partitions;
+        const auto& members = layout.city_object_members;
+        if (members.empty())
+            return partitions;
+
+        size_t total_bytes = 0;
+        for (const auto& member : members) {
+            total_bytes += member.end - member.begin;
+        }
+        const auto count = std::clamp<size_t>(partition_count, 1, members.size());
+
+        // 先頭から順に、累計のバイト数が全体の (i + 1) / count を超えたところで区切ります。
+        partitions.emplace_back();
+        size_t accumulated_bytes = 0;
+        for (const auto& member : members) {
+            const auto boundary = total_bytes * partitions.size() / count;
+            if (accumulated_bytes >= boundary && !partitions.back().empty() && partitions.size() < count)
+                partitions.emplace_back();
+            partitions.back().push_back(member);
+            accumulated_bytes += member.end - member.begin;
+        }
+        return partitions;
+    }
+
+    std::vector<std::vector<GmlTopLevelLayout::Range>> GmlPartitioner::batch(
+            const GmlTopLevelLayout& layout, size_t max_bytes) {
+        std::vector<std::vector<GmlTopLevelLayout::Range>> batches;
+        size_t batch_bytes = 0;
+        for (const auto& member : layout.city_object_members) {
+            const auto member_bytes = member.end - member.begin;
+            if (batches.empty() || (batch_bytes + member_bytes > max_bytes && !batches.back().empty())) {
+                batches.emplace_back();
+                batch_bytes = 0;
+            }
+            batches.back().push_back(member);
+            batch_bytes += member_bytes;
+        }
+        return batches;
+    }
+
+    std::shared_ptr<const citygml::CityModel> GmlPartitioner::loadPart(
+            const std::string& gml_path, const GmlTopLevelLayout& layout,
+            const std::vector<GmlTopLevelLayout::Range>& members,
+            const citygml::ParserParams& parser_params, const GmlFilterParams& filter_params,
+            const std::shared_ptr<citygml::CityGMLLogger>& logger) {
+        std::ifstream ifs(fs::u8path(gml_path), std::ios::binary);
+        if (!ifs)
+            return nullptr;
+        std::istringstream part(buildPartGml(ifs, layout, members));
+        return GmlFilter::loadFromStream(part, gml_path, parser_params, filter_params, logger);
+    }
+
+    std::vector<std::shared_ptr<const citygml::CityModel>> GmlPartitioner::loadParallel(
+            const std::string& gml_path, const citygml::ParserParams& parser_params,
+            const GmlFilterParams& filter_params, unsigned partition_count,
+            const std::shared_ptr<citygml::CityGMLLogger>& logger) {
+        const auto load_whole = [&]() {
+            std::vector<std::shared_ptr<const citygml::CityModel>> city_models;
+            auto city_model = GmlFilter::load(gml_path, parser_params, filter_params, logger);
+            if (city_model != nullptr)
+                city_models.push_back(std::move(city_model));
+            return city_models;
+        };
+
+        // gzip で圧縮されたファイルは、部分ごとに読み込む位置へ移動できないため分割しません。
+        if (GzipStream::isGzipPath(gml_path))
+            return load_whole();
+
+        GmlTopLevelLayout layout;
+        {
+            std::ifstream ifs(fs::u8path(gml_path), std::ios::binary);
+            if (!ifs)
+                return load_whole();
+            layout = scan(ifs);
+        }
+        if (!layout.isValid())
+            return load_whole();
+
+        if (partition_count == 0) {
+            size_t member_bytes = 0;
+            for (const auto& member : layout.city_object_members) {
+                member_bytes += member.end - member.begin;
+            }
+            const auto by_size = std::max<size_t>(member_bytes / min_auto_partition_bytes, 1);
+            partition_count = static_cast<unsigned>(
+                    std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), by_size));
+        }
+        const auto partitions = partition(layout, partition_count);
+        if (partitions.size() <= 1)
+            return load_whole();
+
+        std::vector<std::shared_ptr<const citygml::CityModel>> city_models(partitions.size());
+        plateau::util::parallelFor(partitions.size(), [&](size_t i) {
+            city_models[i] = loadPart(gml_path, layout, partitions[i], parser_params, filter_params, logger);
+        });
+
+        for (const auto& city_model : city_models) {
+            if (city_model == nullptr)
+                return {};
+        }
+        return city_models;
+    }
+}
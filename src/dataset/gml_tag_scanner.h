@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstring>
+#include <istream>
+#include <string>
+#include <string_view>
+
+namespace plateau::dataset {
+    /**
+     * GML をタグとテキストに分けながら先頭から読み込みます。
+     *
+     * 巨大な GMLファイルを対象とするため、XML の DOM は作らず、タグの境界だけを調べます。
+     * 入力はチャンクごとに読み込み、タグがチャンクの境界をまたぐときは次のチャンクを継ぎ足してから調べます。
+     */
+    class GmlTagScanner {
+    public:
+        explicit GmlTagScanner(std::istream& in) :
+            in_(in), pos_(0), buffer_offset_(0), token_offset_(0) {
+        }
+
+        /**
+         * 次のタグ (コメント、CDATA、処理命令を含みます) またはテキストを token に格納します。
+         * token は次に next を呼ぶまで有効です。入力の終わりに達したら false を返します。
+         */
+        bool next(std::string_view& token, bool& is_tag) {
+            while (true) {
+                if (pos_ >= buffer_.size() && !readChunk())
+                    return false;
+                token_offset_ = buffer_offset_ + pos_;
+                if (buffer_[pos_] != '<') {
+                    const auto next_tag = buffer_.find('<', pos_);
+                    const auto end = next_tag == std::string::npos ? buffer_.size() : next_tag;
+                    token = std::string_view(buffer_).substr(pos_, end - pos_);
+                    is_tag = false;
+                    pos_ = end;
+                    return true;
+                }
+
+                const auto tag_end = findTagEnd();
+                if (tag_end == std::string::npos) {
+                    // タグがチャンクの境界をまたいでいます。次のチャンクを継ぎ足して調べ直します。
+                    if (readChunk())
+                        continue;
+                    // 閉じていないタグで終わっているため、テキストとして返します。
+                    token = std::string_view(buffer_).substr(pos_);
+                    is_tag = false;
+                    pos_ = buffer_.size();
+                    return true;
+                }
+                token = std::string_view(buffer_).substr(pos_, tag_end - pos_);
+                is_tag = true;
+                pos_ = tag_end;
+                return true;
+            }
+        }
+
+        static bool isMarkup(std::string_view tag) {
+            return tag.size() >= 2 && (tag[1] == '!' || tag[1] == '?');
+        }
+
+        static bool isEndTag(std::string_view tag) {
+            return tag.size() >= 2 && tag[1] == '/';
+        }
+
+        static bool isEmptyElement(std::string_view tag) {
+            return tag.size() >= 2 && tag[tag.size() - 2] == '/';
+        }
+
+        /// 名前空間の接頭辞を除いた要素名を返します。
+        static std::string_view localNameOf(std::string_view qualified_name) {
+            const auto colon = qualified_name.find(':');
+            return colon == std::string_view::npos ? qualified_name : qualified_name.substr(colon + 1);
+        }
+
+        /// 開始タグまたは空要素タグから、名前空間の接頭辞を除いた要素名を返します。
+        static std::string_view localNameOfTag(std::string_view tag) {
+            const auto name_end = tag.find_first_of(" \t\r\n/>", 1);
+            const auto qualified_name = tag.substr(1, name_end == std::string_view::npos ? std::string_view::npos : name_end - 1);
+            return localNameOf(qualified_name);
+        }
+
+        /// 直前に next で返したトークンの、入力の先頭からの位置です。
+        size_t tokenOffset() const {
+            return token_offset_;
+        }
+
+    private:
+        static constexpr size_t chunk_size = 1024 * 1024;
+
+        /// 読み込み済みの部分を捨てて、次のチャンクを継ぎ足します。読み込めなければ false を返します。
+        bool readChunk() {
+            buffer_.erase(0, pos_);
+            buffer_offset_ += pos_;
+            pos_ = 0;
+            const auto old_size = buffer_.size();
+            buffer_.resize(old_size + chunk_size);
+            in_.read(&buffer_[old_size], static_cast<std::streamsize>(chunk_size));
+            const auto read_size = static_cast<size_t>(in_.gcount());
+            buffer_.resize(old_size + read_size);
+            return read_size > 0;
+        }
+
+        /// pos_ から始まるタグの終わりの次の位置を返します。タグがバッファ内で閉じていなければ npos を返します。
+        size_t findTagEnd() const {
+            const auto starts_with = [this](const char* prefix) {
+                return buffer_.compare(pos_, std::strlen(prefix), prefix) == 0;
+            };
+            const auto find_terminator = [this](const char* terminator) {
+                const auto found = buffer_.find(terminator, pos_);
+                return found == std::string::npos ? found : found + std::strlen(terminator);
+            };
+            // 判定に必要な文字数がまだ読み込まれていなければ、継ぎ足してから判定します。
+            if (buffer_.size() - pos_ < 9)
+                return in_.eof() ? find_terminator(">") : std::string::npos;
+            if (starts_with("<!--"))
+                return find_terminator("-->");
+            if (starts_with("<![CDATA["))
+                return find_terminator("]]>");
+            if (starts_with("<?"))
+                return find_terminator("?>");
+
+            // 属性値の中の '>' はタグの終わりとみなしません。
+            char quote = '\0';
+            for (auto i = pos_ + 1; i < buffer_.size(); ++i) {
+                const auto c = buffer_[i];
+                if (quote != '\0') {
+                    if (c == quote)
+                        quote = '\0';
+                } else if (c == '"' || c == '\'') {
+                    quote = c;
+                } else if (c == '>') {
+                    return i + 1;
+                }
+            }
+            return std::string::npos;
+        }
+
+        std::istream& in_;
+        std::string buffer_;
+        size_t pos_;
+        /// buffer_ の先頭の、入力の先頭からの位置です。
+        size_t buffer_offset_;
+        size_t token_offset_;
+    };
+}
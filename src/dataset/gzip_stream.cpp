@@ -0,0 +1,206 @@
+#include <plateau/dataset/gzip_stream.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <zlib.h>
+
+namespace plateau::dataset {
+    namespace fs = std::filesystem;
+
+    namespace {
+        constexpr size_t input_buffer_size = 64 * 1024;
+        constexpr size_t chunk_size = 256 * 1024;
+        /// 展開済みで読み込まれていないチャンクを最大いくつためておくかです。
+        constexpr size_t max_pending_chunks = 4;
+
+        /**
+         * gzip のデータを別スレッドで展開し、展開済みのチャンクを順に返す streambuf です。
+         * 展開スレッドは max_pending_chunks 個のチャンクがたまると、読み込み側がチャンクを受け取るまで待ちます。
+         * 複数の gzip メンバーを連結したファイルにも対応します。
+         */
+        class GzipStreamBuf : public std::streambuf {
+        public:
+            explicit GzipStreamBuf(std::unique_ptr<std::ifstream> ifs) :
+                ifs_(std::move(ifs)) {
+                inflater_ = std::thread([this] { inflateAll(); });
+            }
+
+            ~GzipStreamBuf() override {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    stopped_ = true;
+                }
+                chunk_consumed_.notify_all();
+                inflater_.join();
+            }
+
+        protected:
+            int_type underflow() override {
+                if (gptr() < egptr())
+                    return traits_type::to_int_type(*gptr());
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    chunk_produced_.wait(lock, [this] { return !chunks_.empty() || finished_; });
+                    if (chunks_.empty()) {
+                        if (failed_)
+                            throw std::runtime_error("Failed to inflate gzip data.");
+                        return traits_type::eof();
+                    }
+                    current_ = std::move(chunks_.front());
+                    chunks_.pop_front();
+                }
+                chunk_consumed_.notify_one();
+                setg(current_.data(), current_.data(), current_.data() + current_.size());
+                return traits_type::to_int_type(*gptr());
+            }
+
+        private:
+            std::unique_ptr<std::ifstream> ifs_;
+            std::thread inflater_;
+            std::mutex mutex_;
+            std::condition_variable chunk_produced_;
+            std::condition_variable chunk_consumed_;
+            std::deque<std::vector<char>> chunks_;
+            /// 読み込み側が現在読んでいるチャンクです。
+            std::vector<char> current_;
+            bool finished_ = false;
+            bool failed_ = false;
+            bool stopped_ = false;
+
+            /// 展開したチャンクを渡します。読み込み側が破棄されたときは false を返します。
+            bool push(std::vector<char>&& chunk) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    chunk_consumed_.wait(lock, [this] { return chunks_.size() < max_pending_chunks || stopped_; });
+                    if (stopped_)
+                        return false;
+                    chunks_.push_back(std::move(chunk));
+                }
+                chunk_produced_.notify_one();
+                return true;
+            }
+
+            void finish(bool failed) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    finished_ = true;
+                    failed_ = failed;
+                }
+                chunk_produced_.notify_one();
+            }
+
+            /// 展開スレッドの処理です。
+            void inflateAll() {
+                z_stream z{};
+                // windowBits に 16 を足すと、zlib は gzip のヘッダーとフッターを扱います。
+                if (inflateInit2(&z, 16 + MAX_WBITS) != Z_OK) {
+                    finish(true);
+                    return;
+                }
+                std::vector<char> in_buffer(input_buffer_size);
+                std::vector<char> chunk(chunk_size);
+                size_t chunk_filled = 0;
+                bool failed = false;
+                bool at_member_end = false;
+                while (true) {
+                    if (z.avail_in == 0) {
+                        ifs_->read(in_buffer.data(), static_cast<std::streamsize>(in_buffer.size()));
+                        const auto read_size = static_cast<size_t>(ifs_->gcount());
+                        if (read_size == 0) {
+                            // gzip メンバーの途中でファイルが終わったときは、途切れたデータです。
+                            failed = !at_member_end;
+                            break;
+                        }
+                        z.next_in = reinterpret_cast<Bytef*>(in_buffer.data());
+                        z.avail_in = static_cast<uInt>(read_size);
+                    }
+                    if (at_member_end) {
+                        // 連結された次の gzip メンバーを展開します。
+                        inflateReset(&z);
+                        at_member_end = false;
+                    }
+                    z.next_out = reinterpret_cast<Bytef*>(chunk.data() + chunk_filled);
+                    z.avail_out = static_cast<uInt>(chunk.size() - chunk_filled);
+                    const auto result = inflate(&z, Z_NO_FLUSH);
+                    if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR) {
+                        failed = true;
+                        break;
+                    }
+                    chunk_filled = chunk.size() - z.avail_out;
+                    at_member_end = result == Z_STREAM_END;
+                    if (chunk_filled == chunk.size()) {
+                        if (!push(std::move(chunk))) {
+                            inflateEnd(&z);
+                            return;
+                        }
+                        chunk = std::vector<char>(chunk_size);
+                        chunk_filled = 0;
+                    }
+                }
+                inflateEnd(&z);
+                if (chunk_filled > 0) {
+                    chunk.resize(chunk_filled);
+                    if (!push(std::move(chunk)))
+                        return;
+                }
+                finish(failed);
+            }
+        };
+
+        /// GzipStreamBuf を所有する istream です。
+        class GzipIStream : public std::istream {
+        public:
+            explicit GzipIStream(std::unique_ptr<std::ifstream> ifs) :
+                std::istream(nullptr),
+                buf_(std::move(ifs)) {
+                rdbuf(&buf_);
+            }
+
+        private:
+            GzipStreamBuf buf_;
+        };
+
+        bool endsWithIgnoreCase(const std::string& str, const std::string& suffix) {
+            if (str.size() < suffix.size())
+                return false;
+            return std::equal(suffix.rbegin(), suffix.rend(), str.rbegin(), [](char lhs, char rhs) {
+                const auto to_lower = [](char c) {
+                    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+                };
+                return to_lower(lhs) == to_lower(rhs);
+            });
+        }
+    }
+
+    bool GzipStream::isGzipPath(const std::string& path) {
+        return endsWithIgnoreCase(path, ".gz");
+    }
+
+    bool GzipStream::isGmlPath(const std::string& path) {
+        return fs::u8path(path).extension() == ".gml" || endsWithIgnoreCase(path, ".gml.gz");
+    }
+
+    std::unique_ptr<std::istream> GzipStream::open(const std::string& path) {
+        auto ifs = std::make_unique<std::ifstream>(fs::u8path(path), std::ios::binary);
+        if (!*ifs)
+            return nullptr;
+        return std::make_unique<GzipIStream>(std::move(ifs));
+    }
+
+    std::unique_ptr<std::istream> GzipStream::openFile(const std::string& path) {
+        if (isGzipPath(path))
+            return open(path);
+        auto ifs = std::make_unique<std::ifstream>(fs::u8path(path), std::ios::binary);
+        if (!*ifs)
+            return nullptr;
+        return ifs;
+    }
+}
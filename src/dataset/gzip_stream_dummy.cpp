@@ -0,0 +1,47 @@
+#include <plateau/dataset/gzip_stream.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace plateau::dataset {
+    /**
+     * gzip の展開に使う zlib はモバイル向けにはビルドしないので、CMakeによって gzip_stream.cpp が gzip_stream_dummy.cpp に置き換えられます。
+     * gzip で圧縮されたファイルは開けないものとして扱います。
+     */
+    namespace fs = std::filesystem;
+
+    namespace {
+        bool endsWithIgnoreCase(const std::string& str, const std::string& suffix) {
+            if (str.size() < suffix.size())
+                return false;
+            return std::equal(suffix.rbegin(), suffix.rend(), str.rbegin(), [](char lhs, char rhs) {
+                const auto to_lower = [](char c) {
+                    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+                };
+                return to_lower(lhs) == to_lower(rhs);
+            });
+        }
+    }
+
+    bool GzipStream::isGzipPath(const std::string& path) {
+        return endsWithIgnoreCase(path, ".gz");
+    }
+
+    bool GzipStream::isGmlPath(const std::string& path) {
+        return fs::u8path(path).extension() == ".gml" || endsWithIgnoreCase(path, ".gml.gz");
+    }
+
+    std::unique_ptr<std::istream> GzipStream::open(const std::string& path) {
+        return nullptr;
+    }
+
+    std::unique_ptr<std::istream> GzipStream::openFile(const std::string& path) {
+        if (isGzipPath(path))
+            return nullptr;
+        auto ifs = std::make_unique<std::ifstream>(fs::u8path(path), std::ios::binary);
+        if (!*ifs)
+            return nullptr;
+        return ifs;
+    }
+}
@@ -3,8 +3,13 @@
 #include <queue>
 #include <set>
 #include <regex>
+#include <algorithm>
+#include <functional>
+#include <iterator>
 
 #include <plateau/geometry/geo_reference.h>
+#include <plateau/dataset/zip_archive.h>
+#include <plateau/dataset/gzip_stream.h>
 #include "local_dataset_accessor.h"
 
 namespace plateau::dataset {
@@ -94,6 +99,32 @@ namespace plateau::dataset {
         return CityModelPackageInfo::getPredefined(getPackage(folder_name));
     }
 
+    LocalDatasetAccessor::LocalDatasetAccessor() = default;
+
+    LocalDatasetAccessor::LocalDatasetAccessor(const LocalDatasetAccessor& other) :
+        IDatasetAccessor(other) {
+        std::lock_guard<std::mutex> lock(other.mutex_);
+        udx_path_ = other.udx_path_;
+        files_ = other.files_;
+        mesh_codes_ = other.mesh_codes_;
+        files_by_code_ = other.files_by_code_;
+    }
+
+    LocalDatasetAccessor& LocalDatasetAccessor::operator=(const LocalDatasetAccessor& other) {
+        if (this == &other)
+            return *this;
+        // 監視中のフォルダとデータが食い違わないよう、監視は止めます。
+        stopWatching();
+        std::scoped_lock lock(mutex_, other.mutex_);
+        udx_path_ = other.udx_path_;
+        files_ = other.files_;
+        mesh_codes_ = other.mesh_codes_;
+        files_by_code_ = other.files_by_code_;
+        return *this;
+    }
+
+    LocalDatasetAccessor::~LocalDatasetAccessor() = default;
+
     std::shared_ptr<LocalDatasetAccessor> LocalDatasetAccessor::find(const std::string& source) {
         auto result = std::make_shared<LocalDatasetAccessor>();
         find(source, *result);
@@ -106,6 +137,7 @@ namespace plateau::dataset {
          * 検索の高速化のため、GMLファイルの配置場所の深さはすべて同じであるという前提に立ち、
          * 最初のGMLファイルが見つかった地点でこれ以上深いフォルダの探索は中止します。
          * 同じ深さにある別のフォルダは探索対象とします。
+         * gzip で圧縮されたGMLファイル (.gml.gz) もGMLファイルとして扱います。
          * @param dir_path  検索の起点となるパスです。
          * @param result 結果はこの vector に追加されます。
          * @return GMLファイルのパスの vector です。
@@ -121,7 +153,7 @@ namespace plateau::dataset {
                 for (const auto& entry : fs::directory_iterator(next_dir)) {
                     if (entry.is_directory()) continue;
                     const auto& path = entry.path();
-                    if (path.extension() == ".gml") {
+                    if (GzipStream::isGmlPath(path.u8string())) {
                         result.emplace_back(path.u8string());
                         // 最初のGMLファイルが見つかったら、これ以上探索キューに入れないようにします。
                         // 同じ深さにあるフォルダはすでにキューに入っているので、「深さは同じだけどフォルダが違う」という状況は検索対象に含まれます。
@@ -136,21 +168,106 @@ namespace plateau::dataset {
                 }
             }
         }
+
+        /**
+         * source が zip ファイル、または zip 内のフォルダを指す場合、その zip を開き、zip 内の udx フォルダのパスを out_udx_entry_path に格納します。
+         * zip ファイルを指す場合は、zip 内で最も浅い階層にある udx フォルダを探します。
+         * zip を指さない場合や、zip 内に udx フォルダがない場合は nullptr を返します。
+         */
+        std::shared_ptr<const ZipArchive> openZipDataset(const std::string& source, std::string& out_udx_entry_path) {
+            std::string zip_path;
+            std::string root_entry_path;
+            if (!ZipArchive::splitPath(source + "/", zip_path, root_entry_path))
+                return nullptr;
+            auto zip_archive = ZipArchive::open(zip_path);
+            if (zip_archive == nullptr)
+                return nullptr;
+
+            while (!root_entry_path.empty() && root_entry_path.back() == '/') {
+                root_entry_path.pop_back();
+            }
+            if (!root_entry_path.empty()) {
+                out_udx_entry_path = root_entry_path + "/udx";
+                return zip_archive;
+            }
+
+            out_udx_entry_path.clear();
+            auto min_depth = std::string::npos;
+            for (const auto& entry : zip_archive->getEntries()) {
+                const auto udx_pos = ("/" + entry.path).find("/udx/");
+                if (udx_pos == std::string::npos) continue;
+                const auto udx_entry_path = entry.path.substr(0, udx_pos + 3);
+                const auto depth = static_cast<size_t>(std::count(udx_entry_path.begin(), udx_entry_path.end(), '/'));
+                if (depth < min_depth) {
+                    min_depth = depth;
+                    out_udx_entry_path = udx_entry_path;
+                }
+            }
+            return out_udx_entry_path.empty() ? nullptr : zip_archive;
+        }
+
+        /**
+         * zip 内の udx フォルダから、findGMLsBFS と同じ規則でGMLファイルを検索し、udx直下のフォルダ名ごとに返します。
+         * すなわち、udx直下のフォルダごとに、最も浅い階層にあるGMLファイルだけを結果とします。
+         * 中央ディレクトリの索引を1度走査するだけで、zip の中身は読みません。
+         * GMLファイルのパスは zip 内のファイルを表す仮想的なパスです。
+         */
+        std::map<std::string, std::vector<std::string>> findGMLsInZip(const ZipArchive& zip_archive,
+                                                                      const std::string& udx_entry_path) {
+            const auto udx_prefix = udx_entry_path + "/";
+            std::map<std::string, std::vector<std::pair<size_t, std::string>>> found;
+            for (const auto& entry : zip_archive.getEntries()) {
+                if (entry.path.compare(0, udx_prefix.size(), udx_prefix) != 0) continue;
+                if (fs::u8path(entry.path).extension() != ".gml") continue;
+                const auto path_in_udx = entry.path.substr(udx_prefix.size());
+                const auto sub_folder_end = path_in_udx.find('/');
+                // udx直下のファイルは、どのフォルダにも属さないので対象外です。
+                if (sub_folder_end == std::string::npos) continue;
+                const auto depth = static_cast<size_t>(std::count(path_in_udx.begin(), path_in_udx.end(), '/'));
+                found[path_in_udx.substr(0, sub_folder_end)].emplace_back(depth, entry.path);
+            }
+
+            std::map<std::string, std::vector<std::string>> result;
+            for (const auto& [sub_folder_name, gml_entries] : found) {
+                auto min_depth = std::string::npos;
+                for (const auto& [depth, _] : gml_entries) {
+                    min_depth = std::min(min_depth, depth);
+                }
+                auto& gml_paths = result[sub_folder_name];
+                for (const auto& [depth, entry_path] : gml_entries) {
+                    if (depth != min_depth) continue;
+                    gml_paths.push_back(fs::u8path(zip_archive.getPath()).append(entry_path).make_preferred().u8string());
+                }
+            }
+            return result;
+        }
+
+        /**
+         * path の base からの相対パスを返します。
+         * zip 内のファイルを表す仮想的なパスは実在しないため、文字列上で相対パスを求めます。
+         */
+        fs::path relativePath(const fs::path& path, const fs::path& base) {
+            std::string zip_path;
+            std::string entry_path;
+            if (ZipArchive::splitPath(base.u8string() + "/", zip_path, entry_path))
+                return path.lexically_relative(base);
+            return fs::relative(path, base);
+        }
     }
 
     void LocalDatasetAccessor::find(const std::string& source, LocalDatasetAccessor& collection) {
-        collection.udx_path_ = fs::u8path(source).append(u8"udx").make_preferred().u8string();
-        // udxフォルダ内の各フォルダについて
-        for (const auto& entry : fs::directory_iterator(fs::u8path(collection.udx_path_))) {
-            if (!entry.is_directory()) continue;
-            auto udx_sub_folder = UdxSubFolder(entry.path().filename().string());
+        std::lock_guard<std::mutex> lock(collection.mutex_);
+        // udxフォルダ内の1つのフォルダについて、find_gmls で検索したGMLファイルを登録します。
+        const auto add_sub_folder = [&collection](const std::string& folder_name,
+                                                  const std::function<void(std::vector<GmlFile>&)>& find_gmls) {
+            auto udx_sub_folder = UdxSubFolder(folder_name);
             const auto package = udx_sub_folder.getPackage(udx_sub_folder.getName());
             auto& file_map = collection.files_;
             if (file_map.count(package) == 0) {
                 file_map.emplace(package, std::vector<GmlFile>());
             }
             auto& gml_files = collection.files_.at(package);
-            findGMLsBFS(entry.path(), gml_files);
+            find_gmls(gml_files);
             for (const auto& gml_file: gml_files) {
                 auto mesh_code = gml_file.getMeshCode();
                 if (!gml_file.isValid()) continue;
@@ -159,6 +276,29 @@ namespace plateau::dataset {
                 }
                 collection.files_by_code_[mesh_code.get()].push_back(gml_file);
             }
+        };
+
+        // zip ファイルであれば、展開せずに中央ディレクトリの索引からGMLファイルを探します。
+        std::string udx_entry_path;
+        if (const auto zip_archive = openZipDataset(source, udx_entry_path)) {
+            collection.udx_path_ = fs::u8path(zip_archive->getPath()).append(udx_entry_path).make_preferred().u8string();
+            for (const auto& [folder_name, gml_paths] : findGMLsInZip(*zip_archive, udx_entry_path)) {
+                add_sub_folder(folder_name, [&gml_paths = gml_paths](std::vector<GmlFile>& gml_files) {
+                    for (const auto& gml_path : gml_paths) {
+                        gml_files.emplace_back(gml_path);
+                    }
+                });
+            }
+            return;
+        }
+
+        collection.udx_path_ = fs::u8path(source).append(u8"udx").make_preferred().u8string();
+        // udxフォルダ内の各フォルダについて
+        for (const auto& entry : fs::directory_iterator(fs::u8path(collection.udx_path_))) {
+            if (!entry.is_directory()) continue;
+            add_sub_folder(entry.path().filename().string(), [&entry](std::vector<GmlFile>& gml_files) {
+                findGMLsBFS(entry.path(), gml_files);
+            });
         }
     }
 
@@ -173,6 +313,7 @@ namespace plateau::dataset {
         if (out_collection_ptr == nullptr)
             return;
 
+        std::lock_guard<std::mutex> lock(mutex_);
         out_collection_ptr->setUdxPath(udx_path_);
         for (const auto& [code, files] : files_by_code_) {
             if (extent_filter.intersects2D(MeshCode(code).getExtent())) {
@@ -189,6 +330,7 @@ namespace plateau::dataset {
         if (out_collection_ptr == nullptr)
             return;
 
+        std::lock_guard<std::mutex> lock(mutex_);
         // これがないとフィルターの結果に対して fetch を実行するときにパスがずれます。
         out_collection_ptr->setUdxPath(udx_path_);
         // 検索用に、引数の mesh_codes を文字列のセットにします。
@@ -214,6 +356,7 @@ namespace plateau::dataset {
     }
 
     PredefinedCityModelPackage LocalDatasetAccessor::getPackages() {
+        std::lock_guard<std::mutex> lock(mutex_);
         auto result = PredefinedCityModelPackage::None;
         for (const auto& [key, _] : files_) {
             result = result | key;
@@ -226,6 +369,7 @@ namespace plateau::dataset {
     }
 
     const GmlFile& LocalDatasetAccessor::getGmlFile(PredefinedCityModelPackage package, int index) {
+        std::lock_guard<std::mutex> lock(mutex_);
         if (files_.find(package) == files_.end())
             throw std::out_of_range("Key not found");
 
@@ -236,6 +380,7 @@ namespace plateau::dataset {
     }
 
     int LocalDatasetAccessor::getGmlFileCount(PredefinedCityModelPackage package) {
+        std::lock_guard<std::mutex> lock(mutex_);
         if (files_.find(package) == files_.end())
             return 0;
 
@@ -249,6 +394,7 @@ namespace plateau::dataset {
     }
 
     void LocalDatasetAccessor::getGmlFiles(PredefinedCityModelPackage package_flags, std::vector<GmlFile>& gml_files) {
+        std::lock_guard<std::mutex> lock(mutex_);
         auto package_num = static_cast<std::underlying_type<PredefinedCityModelPackage>::type>(package_flags);
         int i = 0;
         while(package_num > 0){
@@ -272,10 +418,11 @@ namespace plateau::dataset {
     }
 
     std::string LocalDatasetAccessor::getU8RelativePath(const std::string& path) const {
-        return fs::relative(fs::u8path(path), fs::u8path(udx_path_)).u8string();
+        return relativePath(fs::u8path(path), fs::u8path(udx_path_)).u8string();
     }
 
     TVec3d LocalDatasetAccessor::calculateCenterPoint(const geometry::GeoReference& geo_reference) {
+        std::lock_guard<std::mutex> lock(mutex_);
         double lat_sum = 0;
         double lon_sum = 0;
         double height_sum = 0;
@@ -292,10 +439,11 @@ namespace plateau::dataset {
     }
 
     std::string LocalDatasetAccessor::getRelativePath(const std::string& path) const {
-        return fs::relative(fs::u8path(path).make_preferred(), fs::u8path(udx_path_)).make_preferred().string();
+        return relativePath(fs::u8path(path).make_preferred(), fs::u8path(udx_path_)).make_preferred().string();
     }
 
-    std::set<MeshCode>& LocalDatasetAccessor::getMeshCodes() {
+    std::set<MeshCode> LocalDatasetAccessor::getMeshCodes() {
+        std::lock_guard<std::mutex> lock(mutex_);
         if (mesh_codes_.empty()) {
             for (const auto& [_, files]: files_) {
                 for (const auto& file: files) {
@@ -309,6 +457,7 @@ namespace plateau::dataset {
     }
 
     void LocalDatasetAccessor::addFile(PredefinedCityModelPackage sub_folder, const GmlFile& gml_file_info) {
+        std::lock_guard<std::mutex> lock(mutex_);
         if (files_.count(sub_folder) <= 0) {
             files_.emplace(sub_folder, std::vector<GmlFile>());
         }
@@ -322,6 +471,130 @@ namespace plateau::dataset {
     }
 
     void LocalDatasetAccessor::setUdxPath(std::string udx_path) {
+        std::lock_guard<std::mutex> lock(mutex_);
         udx_path_ = std::move(udx_path);
     }
+
+    bool LocalDatasetAccessor::startWatching(ChangeCallback callback, std::chrono::milliseconds poll_interval) {
+        stopWatching();
+        std::string udx_path;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::error_code error;
+            if (!fs::is_directory(fs::u8path(udx_path_), error))
+                return false;
+            udx_path = udx_path_;
+            change_callback_ = std::move(callback);
+        }
+        watcher_ = std::make_unique<LocalDatasetWatcher>(
+                udx_path,
+                [this](LocalDatasetChange change, const std::string& gml_path) {
+                    applyChange(change, gml_path);
+                },
+                poll_interval);
+        return true;
+    }
+
+    void LocalDatasetAccessor::stopWatching() {
+        watcher_.reset();
+    }
+
+    bool LocalDatasetAccessor::isWatching() const {
+        return watcher_ != nullptr;
+    }
+
+    void LocalDatasetAccessor::applyChange(LocalDatasetChange change, const std::string& gml_path) {
+        // find と同じく、udx直下のフォルダごとに最も浅い階層にあるGMLファイルだけを対象とします。
+        // そのため1つの変化から、同じフォルダの他のファイルの追加や削除が起こることがあります。
+        std::vector<std::pair<LocalDatasetChange, GmlFile>> applied_changes;
+        ChangeCallback callback;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const auto udx_path = fs::u8path(udx_path_);
+            const auto relative_path = fs::u8path(gml_path).lexically_relative(udx_path);
+            const auto sub_folder = relative_path.begin()->u8string();
+            const auto package = UdxSubFolder::getPackage(sub_folder);
+            const auto depth_of = [](const fs::path& path) {
+                return static_cast<size_t>(std::distance(path.begin(), path.end()));
+            };
+
+            // 同じフォルダにあり、現在アクセサに含まれているGMLファイルです。これらは同じ深さにあります。
+            std::vector<GmlFile> same_folder_files;
+            const auto package_files = files_.find(package);
+            if (package_files != files_.end()) {
+                for (const auto& file : package_files->second) {
+                    const auto file_relative_path = fs::u8path(file.getPath()).lexically_relative(udx_path);
+                    if (file_relative_path.begin()->u8string() == sub_folder)
+                        same_folder_files.push_back(file);
+                }
+            }
+            const auto is_listed = std::any_of(same_folder_files.begin(), same_folder_files.end(),
+                                               [&gml_path](const GmlFile& file) {
+                                                   return file.getPath() == gml_path;
+                                               });
+
+            const auto add = [&](const GmlFile& gml_file) {
+                files_[package].push_back(gml_file);
+                if (gml_file.isValid())
+                    files_by_code_[gml_file.getMeshCode().get()].push_back(gml_file);
+                applied_changes.emplace_back(LocalDatasetChange::Added, gml_file);
+            };
+            const auto remove = [&](const GmlFile& gml_file) {
+                const auto remove_from = [&gml_file](auto& file_map, const auto& key) {
+                    const auto found = file_map.find(key);
+                    if (found == file_map.end())
+                        return;
+                    auto& files = found->second;
+                    files.erase(std::remove_if(files.begin(), files.end(), [&gml_file](const GmlFile& file) {
+                        return file.getPath() == gml_file.getPath();
+                    }), files.end());
+                    if (files.empty())
+                        file_map.erase(found);
+                };
+                remove_from(files_, package);
+                remove_from(files_by_code_, gml_file.getMeshCode().get());
+                applied_changes.emplace_back(LocalDatasetChange::Removed, gml_file);
+            };
+
+            if (change == LocalDatasetChange::Added) {
+                const auto depth = depth_of(relative_path);
+                const auto listed_depth = same_folder_files.empty()
+                                          ? depth
+                                          : depth_of(fs::u8path(same_folder_files.front().getPath()).lexically_relative(udx_path));
+                if (!is_listed && depth <= listed_depth) {
+                    // より浅い階層に追加されたら、それまでのファイルは find の結果に含まれなくなります。
+                    if (depth < listed_depth) {
+                        for (const auto& file : same_folder_files) {
+                            remove(file);
+                        }
+                    }
+                    add(GmlFile(gml_path));
+                }
+            } else if (is_listed) {
+                remove(GmlFile(gml_path));
+                // 最も浅い階層のファイルがなくなったら、次に浅い階層のファイルが find の結果に含まれるようになります。
+                std::error_code error;
+                const auto sub_folder_path = udx_path / fs::u8path(sub_folder);
+                if (same_folder_files.size() == 1 && fs::is_directory(sub_folder_path, error)) {
+                    std::vector<GmlFile> next_files;
+                    findGMLsBFS(sub_folder_path, next_files);
+                    for (const auto& file : next_files) {
+                        add(file);
+                    }
+                }
+            }
+
+            if (!applied_changes.empty()) {
+                // メッシュコードの一覧は、次の getMeshCodes で求め直します。
+                mesh_codes_.clear();
+                callback = change_callback_;
+            }
+        }
+        // callback がアクセサを参照できるよう、ロックを外してから呼びます。
+        if (callback) {
+            for (const auto& [applied_change, gml_file] : applied_changes) {
+                callback(applied_change, gml_file);
+            }
+        }
+    }
 }
@@ -2,6 +2,12 @@
 
 #include "plateau/geometry/geo_reference.h"
 #include <plateau/dataset/i_dataset_accessor.h>
+#include "local_dataset_watcher.h"
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
 
 namespace plateau::dataset {
     /**
@@ -10,16 +16,23 @@ namespace plateau::dataset {
      */
     class LIBPLATEAU_EXPORT LocalDatasetAccessor : public IDatasetAccessor {
     public:
+        LocalDatasetAccessor();
+        /// 監視の状態はコピーしません。
+        LocalDatasetAccessor(const LocalDatasetAccessor& other);
+        LocalDatasetAccessor& operator=(const LocalDatasetAccessor& other);
+        ~LocalDatasetAccessor() override;
 
         /**
          * \brief source内に含まれる3D都市モデルデータを全て取得します。
          * \param source 3D都市モデルデータ製品のルートフォルダ(udx, codelists等のフォルダを含むフォルダ)へのパス
+         *                3D都市モデルデータ製品の zip ファイル、または zip 内のルートフォルダへのパスも指定できます。その場合は zip を展開せずに検索します。
          */
         static std::shared_ptr<LocalDatasetAccessor> find(const std::string& source);
 
         /**
          * \brief source内に含まれる3D都市モデルデータを全て取得します。
          * \param source 3D都市モデルデータ製品のルートフォルダ(udx, codelists等のフォルダを含むフォルダ)へのパス
+         *                zip ファイルについては find(const std::string&) と同様です。
          * \param collection 取得されたデータの格納先
          */
         static void find(const std::string& source, LocalDatasetAccessor& collection);
@@ -68,7 +81,7 @@ namespace plateau::dataset {
         /**
          * \brief 都市モデルデータが存在する地域メッシュのリストを取得します。
          */
-        std::set<MeshCode>& getMeshCodes() override;
+        std::set<MeshCode> getMeshCodes() override;
 
         std::string getRelativePath(const std::string& path) const;
         std::string getU8RelativePath(const std::string& path) const;
@@ -81,12 +94,36 @@ namespace plateau::dataset {
         LocalDatasetAccessor* create() const override { return new LocalDatasetAccessor(); }
         LocalDatasetAccessor* clone() const override { return new LocalDatasetAccessor(*this); }
 
+        /**
+         * \brief udx フォルダ以下のGMLファイルの追加と削除を監視し、find で取得したデータに差分だけを反映します。
+         *
+         * 変化があるたびに、GMLファイルの一覧とメッシュコードのキャッシュを更新してから callback を呼びます。
+         * find と同じく、udx直下のフォルダごとに最も浅い階層にあるGMLファイルだけを対象とします。
+         * より浅い階層にGMLファイルが追加されるとそれまでのファイルを削除として、最も浅い階層のファイルがなくなると次に浅い階層のファイルを追加として通知します。
+         * 監視の方法については LocalDatasetWatcher を参照してください。 poll_interval は inotify を使えない環境で udx フォルダ以下を走査する間隔です。
+         * 監視中は、getGmlFile が返す参照は次の変化で無効になることがあります。
+         * 監視はアクセサの破棄時、または stopWatching で止まります。callback の中から stopWatching を呼ばないでください。
+         * \return 監視を始めたら true を返します。udx フォルダが実在するフォルダでないとき (zip ファイル内のときなど) は false を返します。
+         */
+        bool startWatching(ChangeCallback callback,
+                           std::chrono::milliseconds poll_interval = std::chrono::milliseconds(1000)) override;
+
+        void stopWatching() override;
+        bool isWatching() const override;
+
     private:
         std::string udx_path_;
         std::map<PredefinedCityModelPackage, std::vector<GmlFile>> files_;
         std::set<MeshCode> mesh_codes_;
         std::map<std::string, std::vector<GmlFile>> files_by_code_;
+        /// 監視スレッドによる変更と、他のスレッドからの参照を排他します。
+        mutable std::mutex mutex_;
+        ChangeCallback change_callback_;
+        /// 破棄時に他のメンバーより先に監視を止めるため、最後に宣言します。
+        std::unique_ptr<LocalDatasetWatcher> watcher_;
+
         void addFile(PredefinedCityModelPackage sub_folder, const GmlFile& gml_file_info);
         void setUdxPath(std::string udx_path);
+        void applyChange(LocalDatasetChange change, const std::string& gml_path);
     };
 }
@@ -0,0 +1,207 @@
+#include "local_dataset_watcher.h"
+
+#include <plateau/dataset/gzip_stream.h>
+
+#include <vector>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace plateau::dataset {
+    namespace fs = std::filesystem;
+
+    namespace {
+        /// 監視スレッドが停止の要求を確かめる間隔です。
+        constexpr int inotify_poll_timeout_ms = 200;
+
+        /// path が dir 自身か dir 以下にあれば true を返します。
+        bool isUnder(const std::string& path, const std::string& dir) {
+            if (path.compare(0, dir.size(), dir) != 0)
+                return false;
+            return path.size() == dir.size() || path[dir.size()] == static_cast<char>(fs::path::preferred_separator);
+        }
+    }
+
+    LocalDatasetWatcher::LocalDatasetWatcher(const std::string& udx_path, ChangeHandler handler,
+                                             std::chrono::milliseconds poll_interval) :
+        udx_path_(fs::u8path(udx_path)),
+        handler_(std::move(handler)),
+        poll_interval_(poll_interval) {
+#ifdef __linux__
+        inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        // 基準の走査より先に監視を始め、走査中の変化を取りこぼさないようにします。
+        if (inotify_fd_ >= 0)
+            addWatchRecursive(udx_path_);
+#endif
+        for (const auto& entry : fs::recursive_directory_iterator(
+                udx_path_, fs::directory_options::skip_permission_denied)) {
+            if (entry.is_regular_file() && isTarget(entry.path()))
+                known_gml_paths_.insert(entry.path().u8string());
+        }
+        thread_ = std::thread([this] {
+            try {
+                if (inotify_fd_ >= 0)
+                    runInotify();
+                else
+                    runPolling();
+            } catch (...) {
+                // 監視中にフォルダにアクセスできなくなったときなどは監視を終了します。
+            }
+        });
+    }
+
+    LocalDatasetWatcher::~LocalDatasetWatcher() {
+        {
+            std::lock_guard<std::mutex> lock(stop_mutex_);
+            stopped_ = true;
+        }
+        stop_condition_.notify_all();
+        thread_.join();
+#ifdef __linux__
+        if (inotify_fd_ >= 0)
+            close(inotify_fd_);
+#endif
+    }
+
+    bool LocalDatasetWatcher::isTarget(const fs::path& path) const {
+        // udx 直下のファイルはどのフォルダにも属さないので対象外です。
+        return path.parent_path() != udx_path_ && GzipStream::isGmlPath(path.u8string());
+    }
+
+    void LocalDatasetWatcher::syncDirectory(const fs::path& dir) {
+        std::set<std::string> current;
+        std::error_code error;
+        if (fs::is_directory(dir, error)) {
+            auto it = fs::recursive_directory_iterator(dir, fs::directory_options::skip_permission_denied, error);
+            for (; !error && it != fs::recursive_directory_iterator(); it.increment(error)) {
+                if (it->is_regular_file(error) && isTarget(it->path()))
+                    current.insert(it->path().u8string());
+            }
+        }
+
+        const auto dir_str = dir.u8string();
+        std::vector<std::string> removed;
+        for (const auto& path : known_gml_paths_) {
+            if (isUnder(path, dir_str) && current.count(path) == 0)
+                removed.push_back(path);
+        }
+        for (const auto& path : removed) {
+            known_gml_paths_.erase(path);
+            handler_(LocalDatasetChange::Removed, path);
+        }
+        for (const auto& path : current) {
+            if (known_gml_paths_.insert(path).second)
+                handler_(LocalDatasetChange::Added, path);
+        }
+    }
+
+    void LocalDatasetWatcher::syncFile(const fs::path& path) {
+        if (!isTarget(path))
+            return;
+        std::error_code error;
+        const auto exists = fs::is_regular_file(path, error);
+        const auto path_str = path.u8string();
+        if (exists && known_gml_paths_.insert(path_str).second) {
+            handler_(LocalDatasetChange::Added, path_str);
+        } else if (!exists && known_gml_paths_.erase(path_str) > 0) {
+            handler_(LocalDatasetChange::Removed, path_str);
+        }
+    }
+
+    void LocalDatasetWatcher::runPolling() {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(stop_mutex_);
+                if (stop_condition_.wait_for(lock, poll_interval_, [this] { return stopped_.load(); }))
+                    return;
+            }
+            syncDirectory(udx_path_);
+        }
+    }
+
+#ifdef __linux__
+    void LocalDatasetWatcher::addWatchRecursive(const fs::path& dir) {
+        constexpr uint32_t mask = IN_CREATE | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE;
+        std::error_code error;
+        if (!fs::is_directory(dir, error))
+            return;
+        std::vector<fs::path> dirs = {dir};
+        auto it = fs::recursive_directory_iterator(dir, fs::directory_options::skip_permission_denied, error);
+        for (; !error && it != fs::recursive_directory_iterator(); it.increment(error)) {
+            if (it->is_directory(error))
+                dirs.push_back(it->path());
+        }
+        for (const auto& watch_dir : dirs) {
+            const auto wd = inotify_add_watch(inotify_fd_, watch_dir.c_str(), mask);
+            if (wd >= 0)
+                watched_dirs_[wd] = watch_dir;
+        }
+    }
+
+    void LocalDatasetWatcher::removeWatchRecursive(const fs::path& dir) {
+        // 移動したフォルダの監視は移動先でも続くため、移動元のパスのままにならないよう監視を外します。
+        const auto dir_str = dir.u8string();
+        for (auto it = watched_dirs_.begin(); it != watched_dirs_.end();) {
+            if (isUnder(it->second.u8string(), dir_str)) {
+                inotify_rm_watch(inotify_fd_, it->first);
+                it = watched_dirs_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void LocalDatasetWatcher::runInotify() {
+        alignas(inotify_event) char buffer[64 * 1024];
+        while (!stopped_) {
+            pollfd poll_fd{inotify_fd_, POLLIN, 0};
+            if (poll(&poll_fd, 1, inotify_poll_timeout_ms) <= 0)
+                continue;
+            const auto read_size = read(inotify_fd_, buffer, sizeof(buffer));
+            if (read_size <= 0)
+                continue;
+            for (ssize_t offset = 0; offset < read_size;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+                if (event->mask & IN_Q_OVERFLOW) {
+                    // 通知があふれたときは、どの変化も失われた可能性があるため全体を調べ直します。
+                    addWatchRecursive(udx_path_);
+                    syncDirectory(udx_path_);
+                    continue;
+                }
+                if (event->mask & IN_IGNORED) {
+                    watched_dirs_.erase(event->wd);
+                    continue;
+                }
+                const auto dir = watched_dirs_.find(event->wd);
+                if (dir == watched_dirs_.end() || event->len == 0)
+                    continue;
+
+                const auto target = dir->second / fs::u8path(event->name);
+                if (event->mask & IN_ISDIR) {
+                    if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                        addWatchRecursive(target);
+                    if (event->mask & IN_MOVED_FROM)
+                        removeWatchRecursive(target);
+                    syncDirectory(target);
+                } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE)) {
+                    syncFile(target);
+                }
+            }
+        }
+    }
+#else
+    void LocalDatasetWatcher::addWatchRecursive(const fs::path& dir) {
+    }
+
+    void LocalDatasetWatcher::removeWatchRecursive(const fs::path& dir) {
+    }
+
+    void LocalDatasetWatcher::runInotify() {
+    }
+#endif
+}
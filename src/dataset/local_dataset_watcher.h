@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+#include <plateau/dataset/i_dataset_accessor.h>
+
+namespace plateau::dataset {
+    /**
+     * udx フォルダ以下のGMLファイルの追加と削除を、別スレッドで監視します。
+     *
+     * Linux (Android を含む) では inotify でフォルダごとの変更通知を受け取り、通知のあったファイルやフォルダだけを調べます。
+     * それ以外の環境、または inotify を使えないときは、一定間隔で udx フォルダ以下を走査して前回との差分を求めます。
+     * いずれの場合も、監視開始時に udx フォルダ以下を1度走査し、そのとき存在したGMLファイルを基準とします。
+     *
+     * 監視対象は udx 直下のフォルダ以下にあるGMLファイル (.gml または .gml.gz) です。
+     * inotify では書き込みを終えて閉じられたファイル、または移動してきたファイルを追加とみなすため、書き込み途中のファイルは通知しません。
+     */
+    class LocalDatasetWatcher {
+    public:
+        /// 変化を受け取る関数です。監視スレッドから呼ばれます。
+        using ChangeHandler = std::function<void(LocalDatasetChange change, const std::string& gml_path)>;
+
+        /**
+         * 監視を始めます。基準となる走査はこのコンストラクタの中で行います。
+         * poll_interval は inotify を使えないときに udx フォルダ以下を走査する間隔です。
+         */
+        LocalDatasetWatcher(const std::string& udx_path, ChangeHandler handler, std::chrono::milliseconds poll_interval);
+
+        /// 監視を止め、監視スレッドの終了を待ちます。
+        ~LocalDatasetWatcher();
+
+        LocalDatasetWatcher(const LocalDatasetWatcher&) = delete;
+        LocalDatasetWatcher& operator=(const LocalDatasetWatcher&) = delete;
+
+    private:
+        std::filesystem::path udx_path_;
+        ChangeHandler handler_;
+        std::chrono::milliseconds poll_interval_;
+        /// 監視スレッドが把握しているGMLファイルのパスです。監視スレッドだけが読み書きします。
+        std::set<std::string> known_gml_paths_;
+
+        /// inotify のファイルディスクリプタと、監視中のフォルダです。inotify を使えないときは -1 です。
+        int inotify_fd_ = -1;
+        std::map<int, std::filesystem::path> watched_dirs_;
+
+        std::mutex stop_mutex_;
+        std::condition_variable stop_condition_;
+        std::atomic<bool> stopped_{false};
+        std::thread thread_;
+
+        bool isTarget(const std::filesystem::path& path) const;
+
+        /// dir 以下のGMLファイルを走査し、把握しているものとの差分を通知します。
+        void syncDirectory(const std::filesystem::path& dir);
+
+        /// path のGMLファイルの有無を調べ、把握しているものとの差分を通知します。
+        void syncFile(const std::filesystem::path& path);
+
+        void addWatchRecursive(const std::filesystem::path& dir);
+        void removeWatchRecursive(const std::filesystem::path& dir);
+        void runInotify();
+        void runPolling();
+    };
+}
@@ -1,4 +1,5 @@
 #include <plateau/dataset/lod_searcher.h>
+#include <plateau/dataset/gzip_stream.h>
 #include <fstream>
 #include <stdexcept>
 #include <cstring>
@@ -29,11 +30,12 @@ namespace {
 }
 
 LodFlag LodSearcher::searchLodsInFile(const fs::path& file_path) {
-    auto ifs = std::ifstream(file_path);
-    if (!ifs) {
+    // gzip で圧縮されたファイルは展開しながら検索します。
+    const auto stream = GzipStream::openFile(file_path.u8string());
+    if (stream == nullptr) {
         throw std::runtime_error("Failed to read file.");
     }
-    return searchLodsInIstream(ifs);
+    return searchLodsInIstream(*stream);
 }
 
 LodFlag LodSearcher::searchLodsInIstream(std::istream& ifs) {
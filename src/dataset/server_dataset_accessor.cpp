@@ -18,7 +18,7 @@ namespace plateau::dataset {
         mesh_codes_.clear();
     }
 
-    std::set<MeshCode>& ServerDatasetAccessor::getMeshCodes() {
+    std::set<MeshCode> ServerDatasetAccessor::getMeshCodes() {
         if (mesh_codes_.empty()) {
             for (const auto& [_, files] : dataset_files_) {
                 for (const auto& file : files) {
@@ -57,13 +57,14 @@ namespace plateau::dataset {
         double lat_sum = 0;
         double lon_sum = 0;
         double height_sum = 0;
-        for (const auto& mesh_code : getMeshCodes()) {
+        const auto mesh_codes = getMeshCodes();
+        for (const auto& mesh_code : mesh_codes) {
             const auto& center = mesh_code.getExtent().centerPoint();
             lat_sum += center.latitude;
             lon_sum += center.longitude;
             height_sum += center.height;
         }
-        auto num = (double)getMeshCodes().size();
+        auto num = (double)mesh_codes.size();
         geometry::GeoCoordinate geo_average = geometry::GeoCoordinate(lat_sum / num, lon_sum / num, height_sum / num);
         auto euclid_average = geo_reference.project(geo_average);
         return euclid_average;
@@ -132,4 +133,15 @@ namespace plateau::dataset {
         filterByMeshCodes(mesh_codes, *result);
         return result;
     }
+
+    bool ServerDatasetAccessor::startWatching(ChangeCallback, std::chrono::milliseconds) {
+        return false;
+    }
+
+    void ServerDatasetAccessor::stopWatching() {
+    }
+
+    bool ServerDatasetAccessor::isWatching() const {
+        return false;
+    }
 }
@@ -18,7 +18,7 @@ namespace plateau::dataset {
 
         void loadFromServer();
 
-        std::set<MeshCode>& getMeshCodes() override;
+        std::set<MeshCode> getMeshCodes() override;
         std::shared_ptr<std::vector<GmlFile>> getGmlFiles(const PredefinedCityModelPackage package) override;
         void getGmlFiles(const PredefinedCityModelPackage package_flags, std::vector<GmlFile>& out_gml_files) override;
 
@@ -36,6 +36,11 @@ namespace plateau::dataset {
         void filterByMeshCodes(const std::vector<MeshCode>& mesh_codes, IDatasetAccessor& collection) const override;
         std::shared_ptr<IDatasetAccessor> filterByMeshCodes(const std::vector<MeshCode>& mesh_codes) const override;
 
+        /// サーバーのデータは監視できないため、常に false を返します。
+        bool startWatching(ChangeCallback callback, std::chrono::milliseconds poll_interval) override;
+        void stopWatching() override;
+        bool isWatching() const override;
+
         ServerDatasetAccessor* create() const override { return new ServerDatasetAccessor(dataset_id_, client_); }
         ServerDatasetAccessor* clone() const override { return new ServerDatasetAccessor(*this); }
 
@@ -0,0 +1,387 @@
+#include <plateau/dataset/zip_archive.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+
+#include <zlib.h>
+
+namespace plateau::dataset {
+    namespace fs = std::filesystem;
+
+    namespace {
+        constexpr uint32_t end_of_central_directory_signature = 0x06054b50;
+        constexpr uint32_t zip64_end_of_central_directory_locator_signature = 0x07064b50;
+        constexpr uint32_t zip64_end_of_central_directory_signature = 0x06064b50;
+        constexpr uint32_t central_directory_header_signature = 0x02014b50;
+        constexpr uint32_t local_file_header_signature = 0x04034b50;
+        constexpr uint16_t zip64_extra_field_id = 0x0001;
+
+        constexpr size_t end_of_central_directory_size = 22;
+        constexpr size_t max_comment_size = 0xFFFF;
+        constexpr size_t zip64_end_of_central_directory_locator_size = 20;
+        constexpr size_t zip64_end_of_central_directory_size = 56;
+        constexpr size_t central_directory_header_size = 46;
+        constexpr size_t local_file_header_size = 30;
+
+        constexpr uint16_t compression_stored = 0;
+        constexpr uint16_t compression_deflated = 8;
+
+        constexpr size_t stream_buffer_size = 64 * 1024;
+
+        uint16_t readU16(const unsigned char* p) {
+            return static_cast<uint16_t>(p[0] | p[1] << 8);
+        }
+
+        uint32_t readU32(const unsigned char* p) {
+            return static_cast<uint32_t>(readU16(p)) | static_cast<uint32_t>(readU16(p + 2)) << 16;
+        }
+
+        uint64_t readU64(const unsigned char* p) {
+            return static_cast<uint64_t>(readU32(p)) | static_cast<uint64_t>(readU32(p + 4)) << 32;
+        }
+
+        bool readAt(std::ifstream& ifs, uint64_t offset, std::vector<unsigned char>& buffer) {
+            ifs.clear();
+            ifs.seekg(static_cast<std::streamoff>(offset));
+            ifs.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+            return static_cast<size_t>(ifs.gcount()) == buffer.size();
+        }
+
+        /**
+         * zip 内のファイル1つのデータを、zip ファイルから少しずつ読みながら展開する streambuf です。
+         * 無圧縮のファイルはそのまま、Deflate のファイルは zlib で展開して返します。
+         * 読み終えたときに大きさと CRC-32 を中央ディレクトリの値と比べ、異なるときや展開できないときは例外を投げてストリームを bad にします。
+         */
+        class EntryStreamBuf : public std::streambuf {
+        public:
+            EntryStreamBuf(std::unique_ptr<std::ifstream> ifs, uint64_t data_offset, const ZipArchive::Entry& entry) :
+                ifs_(std::move(ifs)),
+                remaining_input_(entry.compressed_size),
+                expected_size_(entry.uncompressed_size),
+                expected_crc32_(entry.crc32),
+                deflated_(entry.compression_method == compression_deflated),
+                in_buffer_(stream_buffer_size),
+                out_buffer_(stream_buffer_size) {
+                ifs_->seekg(static_cast<std::streamoff>(data_offset));
+                if (deflated_) {
+                    // zip 内の Deflate データはヘッダーを持たないため、負の windowBits で初期化します。
+                    finished_ = failed_ = inflateInit2(&z_, -MAX_WBITS) != Z_OK;
+                    inflate_initialized_ = !finished_;
+                }
+            }
+
+            ~EntryStreamBuf() override {
+                if (inflate_initialized_)
+                    inflateEnd(&z_);
+            }
+
+        protected:
+            int_type underflow() override {
+                if (gptr() < egptr())
+                    return traits_type::to_int_type(*gptr());
+                const auto produced = deflated_ ? inflateNext() : readNext();
+                if (produced == 0) {
+                    if (failed_ || produced_size_ != expected_size_ || crc32_ != expected_crc32_)
+                        throw std::runtime_error("Zip entry data is corrupted.");
+                    return traits_type::eof();
+                }
+                produced_size_ += produced;
+                crc32_ = crc32(crc32_, reinterpret_cast<const Bytef*>(out_buffer_.data()), static_cast<uInt>(produced));
+                setg(out_buffer_.data(), out_buffer_.data(), out_buffer_.data() + produced);
+                return traits_type::to_int_type(*gptr());
+            }
+
+        private:
+            std::unique_ptr<std::ifstream> ifs_;
+            uint64_t remaining_input_;
+            uint64_t expected_size_;
+            uLong expected_crc32_;
+            uint64_t produced_size_ = 0;
+            uLong crc32_ = 0;
+            bool deflated_;
+            bool finished_ = false;
+            bool failed_ = false;
+            bool inflate_initialized_ = false;
+            z_stream z_{};
+            std::vector<char> in_buffer_;
+            std::vector<char> out_buffer_;
+
+            /// zip ファイルから、このファイルのデータを buffer に最大 buffer.size() バイト読み込みます。
+            size_t readInput(std::vector<char>& buffer) {
+                const auto size = static_cast<size_t>(std::min<uint64_t>(remaining_input_, buffer.size()));
+                if (size == 0)
+                    return 0;
+                ifs_->read(buffer.data(), static_cast<std::streamsize>(size));
+                const auto read_size = static_cast<size_t>(ifs_->gcount());
+                remaining_input_ = read_size == size ? remaining_input_ - size : 0;
+                return read_size;
+            }
+
+            size_t readNext() {
+                return readInput(out_buffer_);
+            }
+
+            size_t inflateNext() {
+                while (!finished_) {
+                    if (z_.avail_in == 0) {
+                        const auto read_size = readInput(in_buffer_);
+                        z_.next_in = reinterpret_cast<Bytef*>(in_buffer_.data());
+                        z_.avail_in = static_cast<uInt>(read_size);
+                    }
+                    z_.next_out = reinterpret_cast<Bytef*>(out_buffer_.data());
+                    z_.avail_out = static_cast<uInt>(out_buffer_.size());
+                    const auto result = inflate(&z_, Z_NO_FLUSH);
+                    if (result == Z_STREAM_END) {
+                        finished_ = true;
+                    } else if (result != Z_OK && result != Z_BUF_ERROR) {
+                        // 壊れたデータです。
+                        finished_ = failed_ = true;
+                    }
+                    const auto produced = out_buffer_.size() - z_.avail_out;
+                    if (produced > 0)
+                        return produced;
+                    if (!finished_ && z_.avail_in == 0 && remaining_input_ == 0) {
+                        // Deflate データの終わりに達する前に入力が途切れました。
+                        finished_ = failed_ = true;
+                    }
+                }
+                return 0;
+            }
+        };
+
+        /// EntryStreamBuf を所有する istream です。
+        class EntryStream : public std::istream {
+        public:
+            EntryStream(std::unique_ptr<std::ifstream> ifs, uint64_t data_offset, const ZipArchive::Entry& entry) :
+                std::istream(nullptr),
+                buf_(std::move(ifs), data_offset, entry) {
+                rdbuf(&buf_);
+            }
+
+        private:
+            EntryStreamBuf buf_;
+        };
+
+        /// 開いた zip の索引を、zip ファイルのパスごとに共有します。
+        std::mutex open_archives_mutex;
+        std::map<std::string, std::weak_ptr<const ZipArchive>> open_archives;
+
+        std::string toLowerAscii(std::string str) {
+            std::transform(str.begin(), str.end(), str.begin(), [](char c) {
+                return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+            });
+            return str;
+        }
+    }
+
+    ZipArchive::ZipArchive(std::string path) :
+        path_(std::move(path)) {
+    }
+
+    std::shared_ptr<const ZipArchive> ZipArchive::open(const std::string& zip_path) {
+        std::error_code error;
+        const auto key = fs::absolute(fs::u8path(zip_path), error).lexically_normal().u8string();
+        if (error)
+            return nullptr;
+
+        std::lock_guard<std::mutex> lock(open_archives_mutex);
+        const auto found = open_archives.find(key);
+        if (found != open_archives.end()) {
+            if (auto archive = found->second.lock())
+                return archive;
+        }
+
+        auto archive = std::shared_ptr<ZipArchive>(new ZipArchive(zip_path));
+        if (!archive->readCentralDirectory())
+            return nullptr;
+        open_archives[key] = archive;
+        return archive;
+    }
+
+    bool ZipArchive::splitPath(const std::string& path, std::string& out_zip_path, std::string& out_entry_path) {
+        auto normalized = path;
+        std::replace(normalized.begin(), normalized.end(), '\\', '/');
+        const auto lower = toLowerAscii(normalized);
+        static const std::string zip_extension = ".zip/";
+        for (auto pos = lower.find(zip_extension); pos != std::string::npos; pos = lower.find(zip_extension, pos + 1)) {
+            const auto zip_path_length = pos + zip_extension.size() - 1;
+            std::error_code error;
+            if (!fs::is_regular_file(fs::u8path(path.substr(0, zip_path_length)), error))
+                continue;
+            out_zip_path = path.substr(0, zip_path_length);
+            out_entry_path = normalized.substr(zip_path_length + 1);
+            return true;
+        }
+        return false;
+    }
+
+    const std::string& ZipArchive::getPath() const {
+        return path_;
+    }
+
+    const std::vector<ZipArchive::Entry>& ZipArchive::getEntries() const {
+        return entries_;
+    }
+
+    const ZipArchive::Entry* ZipArchive::findEntry(const std::string& entry_path) const {
+        auto normalized = entry_path;
+        std::replace(normalized.begin(), normalized.end(), '\\', '/');
+        const auto found = entry_indices_.find(normalized);
+        if (found == entry_indices_.end())
+            return nullptr;
+        return &entries_[found->second];
+    }
+
+    std::unique_ptr<std::istream> ZipArchive::openEntry(const std::string& entry_path) const {
+        const auto entry = findEntry(entry_path);
+        if (entry == nullptr)
+            return nullptr;
+        if (entry->compression_method != compression_stored && entry->compression_method != compression_deflated)
+            return nullptr;
+
+        auto ifs = std::make_unique<std::ifstream>(fs::u8path(path_), std::ios::binary);
+        if (!*ifs)
+            return nullptr;
+
+        // データはローカルファイルヘッダーの後ろにあります。ヘッダーの可変長部分は中央ディレクトリと異なることがあるため読み直します。
+        std::vector<unsigned char> header(local_file_header_size);
+        if (!readAt(*ifs, entry->local_header_offset, header) || readU32(header.data()) != local_file_header_signature)
+            return nullptr;
+        const auto data_offset = entry->local_header_offset + local_file_header_size +
+                                 readU16(header.data() + 26) + readU16(header.data() + 28);
+        return std::make_unique<EntryStream>(std::move(ifs), data_offset, *entry);
+    }
+
+    bool ZipArchive::extractEntry(const std::string& entry_path, const std::string& destination_path) const {
+        const auto stream = openEntry(entry_path);
+        if (stream == nullptr)
+            return false;
+
+        const auto destination = fs::u8path(destination_path);
+        if (destination.has_parent_path())
+            fs::create_directories(destination.parent_path());
+        std::ofstream ofs(destination, std::ios::binary);
+        if (!ofs)
+            return false;
+        std::vector<char> buffer(stream_buffer_size);
+        while (stream->read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || stream->gcount() > 0) {
+            ofs.write(buffer.data(), stream->gcount());
+        }
+        ofs.close();
+        if (stream->bad() || !ofs) {
+            // 途中までのファイルを残すと、展開済みとみなされて使われ続けるため削除します。
+            std::error_code ignored;
+            fs::remove(destination, ignored);
+            return false;
+        }
+        return true;
+    }
+
+    bool ZipArchive::readCentralDirectory() {
+        std::ifstream ifs(fs::u8path(path_), std::ios::binary);
+        if (!ifs)
+            return false;
+        ifs.seekg(0, std::ios::end);
+        const auto file_size = static_cast<uint64_t>(ifs.tellg());
+        if (file_size < end_of_central_directory_size)
+            return false;
+
+        // 中央ディレクトリの終端レコードは、最大 65535 バイトのコメントの前にあるため、末尾から逆向きに探します。
+        std::vector<unsigned char> tail(static_cast<size_t>(
+                std::min<uint64_t>(file_size, end_of_central_directory_size + max_comment_size)));
+        const auto tail_offset = file_size - tail.size();
+        if (!readAt(ifs, tail_offset, tail))
+            return false;
+        size_t eocd_pos = tail.size() - end_of_central_directory_size + 1;
+        while (eocd_pos-- > 0) {
+            if (readU32(tail.data() + eocd_pos) == end_of_central_directory_signature)
+                break;
+        }
+        if (eocd_pos == static_cast<size_t>(-1))
+            return false;
+
+        const auto eocd = tail.data() + eocd_pos;
+        uint64_t entry_count = readU16(eocd + 10);
+        uint64_t central_directory_size = readU32(eocd + 12);
+        uint64_t central_directory_offset = readU32(eocd + 16);
+
+        // 値が入りきらないときは Zip64 の終端レコードを読みます。
+        if (entry_count == 0xFFFF || central_directory_size == 0xFFFFFFFF || central_directory_offset == 0xFFFFFFFF) {
+            const auto eocd_offset = tail_offset + eocd_pos;
+            if (eocd_offset < zip64_end_of_central_directory_locator_size)
+                return false;
+            std::vector<unsigned char> locator(zip64_end_of_central_directory_locator_size);
+            if (!readAt(ifs, eocd_offset - locator.size(), locator) ||
+                readU32(locator.data()) != zip64_end_of_central_directory_locator_signature)
+                return false;
+            std::vector<unsigned char> zip64_eocd(zip64_end_of_central_directory_size);
+            if (!readAt(ifs, readU64(locator.data() + 8), zip64_eocd) ||
+                readU32(zip64_eocd.data()) != zip64_end_of_central_directory_signature)
+                return false;
+            entry_count = readU64(zip64_eocd.data() + 32);
+            central_directory_size = readU64(zip64_eocd.data() + 40);
+            central_directory_offset = readU64(zip64_eocd.data() + 48);
+        }
+        if (central_directory_offset + central_directory_size > file_size)
+            return false;
+
+        std::vector<unsigned char> central_directory(static_cast<size_t>(central_directory_size));
+        if (!readAt(ifs, central_directory_offset, central_directory))
+            return false;
+
+        entries_.reserve(static_cast<size_t>(std::min<uint64_t>(entry_count, central_directory.size() / central_directory_header_size)));
+        size_t pos = 0;
+        for (uint64_t i = 0; i < entry_count; ++i) {
+            if (pos + central_directory_header_size > central_directory.size())
+                return false;
+            const auto header = central_directory.data() + pos;
+            if (readU32(header) != central_directory_header_signature)
+                return false;
+            const auto name_length = readU16(header + 28);
+            const auto extra_length = readU16(header + 30);
+            const auto comment_length = readU16(header + 32);
+            const auto next_pos = pos + central_directory_header_size + name_length + extra_length + comment_length;
+            if (next_pos > central_directory.size())
+                return false;
+
+            Entry entry;
+            entry.path.assign(reinterpret_cast<const char*>(header + central_directory_header_size), name_length);
+            std::replace(entry.path.begin(), entry.path.end(), '\\', '/');
+            entry.compression_method = readU16(header + 10);
+            entry.crc32 = readU32(header + 16);
+            entry.compressed_size = readU32(header + 20);
+            entry.uncompressed_size = readU32(header + 24);
+            entry.local_header_offset = readU32(header + 42);
+
+            // 4GB を超える値は Zip64 拡張フィールドに、0xFFFFFFFF になっている項目の順に入っています。
+            auto extra = header + central_directory_header_size + name_length;
+            const auto extra_end = extra + extra_length;
+            while (extra + 4 <= extra_end) {
+                const auto id = readU16(extra);
+                const auto size = readU16(extra + 2);
+                auto field = extra + 4;
+                const auto field_end = std::min(field + size, extra_end);
+                if (id == zip64_extra_field_id) {
+                    for (auto value : {&entry.uncompressed_size, &entry.compressed_size, &entry.local_header_offset}) {
+                        if (*value != 0xFFFFFFFF || field + 8 > field_end)
+                            continue;
+                        *value = readU64(field);
+                        field += 8;
+                    }
+                }
+                extra += 4 + size;
+            }
+
+            pos = next_pos;
+            // フォルダは索引に含めません。
+            if (entry.path.empty() || entry.path.back() == '/')
+                continue;
+            entry_indices_.emplace(entry.path, entries_.size());
+            entries_.push_back(std::move(entry));
+        }
+        return true;
+    }
+}
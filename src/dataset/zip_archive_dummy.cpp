@@ -0,0 +1,44 @@
+#include <plateau/dataset/zip_archive.h>
+
+namespace plateau::dataset {
+    /**
+     * zip の展開に使う zlib はモバイル向けにはビルドしないので、CMakeによって zip_archive.cpp が zip_archive_dummy.cpp に置き換えられます。
+     * zip ファイルは開けないものとして扱います。
+     */
+
+    ZipArchive::ZipArchive(std::string path) :
+        path_(std::move(path)) {
+    }
+
+    std::shared_ptr<const ZipArchive> ZipArchive::open(const std::string& zip_path) {
+        return nullptr;
+    }
+
+    bool ZipArchive::splitPath(const std::string& path, std::string& out_zip_path, std::string& out_entry_path) {
+        return false;
+    }
+
+    const std::string& ZipArchive::getPath() const {
+        return path_;
+    }
+
+    const std::vector<ZipArchive::Entry>& ZipArchive::getEntries() const {
+        return entries_;
+    }
+
+    const ZipArchive::Entry* ZipArchive::findEntry(const std::string& entry_path) const {
+        return nullptr;
+    }
+
+    std::unique_ptr<std::istream> ZipArchive::openEntry(const std::string& entry_path) const {
+        return nullptr;
+    }
+
+    bool ZipArchive::extractEntry(const std::string& entry_path, const std::string& destination_path) const {
+        return false;
+    }
+
+    bool ZipArchive::readCentralDirectory() {
+        return false;
+    }
+}
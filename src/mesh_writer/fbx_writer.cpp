@@ -3,6 +3,7 @@
 #include <cassert>
 
 #include <plateau/mesh_writer/fbx_writer.h>
+#include <plateau/mesh_writer/texture_copier.h>
 
 #include <fbxsdk.h>
 #include <set>
@@ -15,11 +16,10 @@ namespace {
         auto t_path = src_path.filename();
         auto dst_path = fs::u8path(fbx_path).parent_path();
         dst_path /= src_path.parent_path().filename();
-        create_directories(dst_path);
         dst_path /= t_path;
 
-        constexpr auto copy_options = fs::copy_options::skip_existing;
-        copy(src_path, dst_path, copy_options);
+        // 複数の書き出しが並列に同じテクスチャをコピーしても衝突しないよう、TextureCopier を通します。
+        plateau::meshWriter::TextureCopier::copy(src_path, dst_path);
     }
 }
 
@@ -92,8 +92,13 @@ namespace plateau::meshWriter {
             parent_fbx_node->AddChild(fbx_node);
 
             const auto mesh = node.getMesh();
-            if (mesh != nullptr)
-                addMesh(*mesh, fbx_scene, fbx_node);
+            if (mesh != nullptr) {
+                if (node.isInstanced()) {
+                    addInstances(node, *mesh, fbx_scene, fbx_node);
+                } else {
+                    addMesh(*mesh, fbx_scene, fbx_node);
+                }
+            }
 
             for (size_t i = 0; i < node.getChildCount(); ++i) {
                 const auto& child_node = node.getChildAt(i);
@@ -101,11 +106,37 @@ namespace plateau::meshWriter {
             }
         }
 
-        void addMesh(const polygonMesh::Mesh& mesh, FbxScene* fbx_scene, FbxNode* fbx_node) {
+        /**
+         * インスタンスごとに平行移動した子ノードを作り、1つの FbxMesh を共有させます。
+         */
+        void addInstances(const polygonMesh::Node& node, const polygonMesh::Mesh& mesh, FbxScene* fbx_scene, FbxNode* fbx_node) {
+            FbxNode* prototype_fbx_node = nullptr;
+            FbxMesh* fbx_mesh = nullptr;
+            for (const auto& instance : node.getInstances()) {
+                const auto instance_fbx_node = FbxNode::Create(fbx_scene, instance.name.c_str());
+                fbx_node->AddChild(instance_fbx_node);
+                instance_fbx_node->LclTranslation.Set(
+                        FbxDouble3(instance.translation.x, instance.translation.y, instance.translation.z));
+
+                if (prototype_fbx_node == nullptr) {
+                    fbx_mesh = addMesh(mesh, fbx_scene, instance_fbx_node);
+                    prototype_fbx_node = instance_fbx_node;
+                    continue;
+                }
+                // マテリアルの番号が FbxMesh のポリゴンと対応するよう、同じ順で追加します。
+                for (int i = 0; i < prototype_fbx_node->GetMaterialCount(); ++i) {
+                    instance_fbx_node->AddMaterial(prototype_fbx_node->GetMaterial(i));
+                }
+                if (fbx_mesh != nullptr)
+                    instance_fbx_node->SetNodeAttribute(fbx_mesh);
+            }
+        }
+
+        FbxMesh* addMesh(const polygonMesh::Mesh& mesh, FbxScene* fbx_scene, FbxNode* fbx_node) {
             const auto fbx_mesh = FbxMesh::Create(fbx_scene, "");
 
             // Create control points.
-            unsigned VertCount(mesh.getVertices().size());
+            unsigned VertCount(mesh.getVertexCount());
             fbx_mesh->InitControlPoints(VertCount);
             FbxVector4* ControlPoints = fbx_mesh->GetControlPoints();
 
@@ -130,7 +161,7 @@ namespace plateau::meshWriter {
             Layer->SetUVs(UVDiffuseLayer, FbxLayerElement::eTextureDiffuse);
 
             for (unsigned VertexIdx = 0; VertexIdx < VertCount; ++VertexIdx) {
-                const auto& vertex = mesh.getVertices()[VertexIdx];
+                const auto vertex = mesh.getVertexAt(VertexIdx);
                 const auto& uv = mesh.getUV1()[VertexIdx];
                 ControlPoints[VertexIdx] = FbxVector4(vertex.x, vertex.y, vertex.z);
                 UVDiffuseLayer->GetDirectArray().Add(FbxVector2(uv.x, uv.y));
@@ -187,6 +218,7 @@ namespace plateau::meshWriter {
 
                 fbx_node->SetNodeAttribute(fbx_mesh);
             }
+            return fbx_mesh;
         }
 
     private:
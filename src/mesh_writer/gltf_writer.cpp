@@ -3,6 +3,8 @@
 #include <algorithm>
 #include <iomanip>
 #include <filesystem>
+#include <optional>
+#include <unordered_map>
 
 #include <citygml/citygml.h>
 #include <citygml/citymodel.h>
@@ -11,10 +13,13 @@
 #include <citygml/texture.h>
 
 #include <plateau/mesh_writer/gltf_writer.h>
+#include <plateau/mesh_writer/texture_copier.h>
+#include <plateau/polygon_mesh/mesh_optimizer.h>
 
 #include <cassert>
 #include <codecvt>
 #include <fstream>
+#include <set>
 
 #include <GLTFSDK/GLBResourceWriter.h>
 #include <GLTFSDK/IStreamWriter.h>
@@ -22,6 +27,8 @@
 #include <GLTFSDK/GLTF.h>
 #include <GLTFSDK/BufferBuilder.h>
 
+#include "../../3rdparty/json/single_include/nlohmann/json.hpp"
+
 
 namespace fs = std::filesystem;
 namespace gltf = Microsoft::glTF;
@@ -62,20 +69,59 @@ namespace {
         fs::path m_pathBase;
     };
 
-    void copyTexture(const std::string& gltf_path, const std::string& texture_url, plateau::meshWriter::GltfWriteOptions options) {
+    void copyTexture(const std::string& gltf_path, const std::string& texture_url, const plateau::meshWriter::GltfWriteOptions& options) {
         auto src_path = fs::u8path(texture_url);
         auto  t_path = fs::u8path(texture_url).filename();
         auto dst_path = fs::u8path(gltf_path).parent_path();
         if (!options.texture_directory_path.empty()) {
             dst_path /= fs::u8path(options.texture_directory_path);
-            create_directories(dst_path);
-            dst_path /= t_path;
-        } else {
-            dst_path /= t_path;
         }
+        dst_path /= t_path;
+
+        // 複数の書き出しが並列に同じテクスチャをコピーしても衝突しないよう、TextureCopier を通します。
+        plateau::meshWriter::TextureCopier::copy(src_path, dst_path);
+    }
+
+    /**
+     * 地物インデックスに対応する gml:id を返します。
+     * 最小地物として登録されていなければ主要地物の gml:id を返し、それもなければ nullptr を返します。
+     */
+    const std::string* findGmlId(const plateau::polygonMesh::CityObjectList& city_object_list,
+                                 const plateau::polygonMesh::CityObjectIndex& index) {
+        try {
+            return &city_object_list.getAtomicGmlID(index);
+        } catch (const std::out_of_range&) {
+        }
+        try {
+            return &city_object_list.getPrimaryGmlID(index.primary_index);
+        } catch (const std::out_of_range&) {
+        }
+        return nullptr;
+    }
+
+    /// EXT_structural_metadata のプロパティIDに使えない文字を '_' に置き換えます。
+    std::string toPropertyId(const std::string& key) {
+        std::string id;
+        for (const auto c : key) {
+            const bool is_valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+            id += is_valid ? c : '_';
+        }
+        if (id.empty() || (id[0] >= '0' && id[0] <= '9'))
+            id = "_" + id;
+        return id;
+    }
 
-        constexpr auto copy_options = fs::copy_options::skip_existing;
-        copy(src_path, dst_path, copy_options);
+    /**
+     * EXT_structural_metadata のプロパティテーブルが参照するバッファビューは、開始位置を8バイト境界に揃える必要があります。
+     * バッファの末尾が揃っていなければ、詰め物のバッファビューを挟んでから data のバッファビューを追加します。
+     */
+    template<typename T>
+    std::string addPropertyBufferView(const std::vector<T>& data, gltf::BufferBuilder& bufferBuilder) {
+        constexpr size_t alignment = 8;
+        const auto misalignment = bufferBuilder.GetCurrentBuffer().byteLength % alignment;
+        if (misalignment != 0)
+            bufferBuilder.AddBufferView(std::vector<uint8_t>(alignment - misalignment, 0));
+        return bufferBuilder.AddBufferView(data).id;
     }
 }
 
@@ -88,8 +134,52 @@ namespace plateau::meshWriter {
 
         void precessNodeRecursive(const plateau::polygonMesh::Node& node, Microsoft::glTF::Document& document, Microsoft::glTF::BufferBuilder& bufferBuilder);
         std::string writeMaterialReference(std::string texUrl, Microsoft::glTF::Document& document);
-        void writeNode(Microsoft::glTF::Document& document);
+        std::string writeNode(Microsoft::glTF::Document& document);
+        std::string addPositions(const float* position_data, size_t vertex_count, bool quantize, Microsoft::glTF::BufferBuilder& bufferBuilder);
+        std::string addTexCoords(const std::vector<float>& texcoords, Microsoft::glTF::BufferBuilder& bufferBuilder);
         void writeMesh(std::string accessorIdPositions, std::string accessorIdIndices, std::string accessorIdTexCoords, Microsoft::glTF::BufferBuilder& bufferBuilder);
+        void writeMergedModel(const plateau::polygonMesh::Model& model, Microsoft::glTF::Document& document, Microsoft::glTF::BufferBuilder& bufferBuilder);
+        void writeMergedNode(const plateau::polygonMesh::Node& root_node, Microsoft::glTF::Document& document, Microsoft::glTF::BufferBuilder& bufferBuilder);
+        void collectMeshesRecursive(const plateau::polygonMesh::Node& node);
+        void appendMergedMesh(const plateau::polygonMesh::Mesh& mesh, const TVec3d& translation, const std::string* instance_name);
+        void writeInstancing(Microsoft::glTF::Document& document);
+        void writePropertyTable(const citygml::CityModel* city_model, Microsoft::glTF::BufferBuilder& bufferBuilder);
+        void writeStructuralMetadata(Microsoft::glTF::Document& document);
+
+        /**
+         * write_feature_metadata で、ルートノード1つ分を結合した頂点と、テクスチャごとの Indices です。
+         * 地物IDは Model 全体で共通で、プロパティテーブルの行に対応します。
+         */
+        struct MergedModel {
+            std::vector<float> positions;
+            std::vector<float> texcoords;
+            std::vector<float> feature_ids;
+            std::map<std::string, std::vector<unsigned>> texture_to_indices;
+            /// 地物IDに対応する gml:id です。
+            std::vector<const std::string*> gml_ids;
+            std::unordered_map<std::string, unsigned> gml_id_to_feature_id;
+        };
+
+        /// 表の列1つ分の、プロパティIDとバッファビューIDです。
+        struct PropertyColumn {
+            std::string property_id;
+            std::string name;
+            std::string values_buffer_view_id;
+            std::string offsets_buffer_view_id;
+        };
+
+        MergedModel merged_;
+        std::vector<PropertyColumn> property_columns_;
+
+        /// EXT_mesh_gpu_instancing を付けるノードのIDと、インスタンスの移動量のアクセサIDです。
+        std::vector<std::pair<std::string, std::string>> instanced_nodes_;
+
+        /// 量子化した座標を int16 で表すときの絶対値の最大です。
+        static constexpr long quantized_position_max = 32767;
+        /// 量子化した座標を元に戻すための、次に書き込むノードの移動と拡大縮小です。
+        std::optional<Microsoft::glTF::Vector3> node_translation_;
+        std::optional<Microsoft::glTF::Vector3> node_scale_;
+        bool uses_quantization_ = false;
 
         Microsoft::glTF::Scene scene_;
         Microsoft::glTF::Mesh mesh_;
@@ -101,22 +191,22 @@ namespace plateau::meshWriter {
         GltfWriteOptions options_;
     };
 
-    GltfWriter::GltfWriter() : impl(new Impl) {
+    GltfWriter::GltfWriter() {
     }
 
     GltfWriter::~GltfWriter() {
     }
 
-    bool GltfWriter::write(const std::string& gltf_file_path, const plateau::polygonMesh::Model& model, GltfWriteOptions options) {
+    bool GltfWriter::write(const std::string& gltf_file_path, const plateau::polygonMesh::Model& model, GltfWriteOptions options) const {
+        return write(gltf_file_path, model, std::move(options), nullptr);
+    }
+
+    bool GltfWriter::write(const std::string& gltf_file_path, const plateau::polygonMesh::Model& model, GltfWriteOptions options,
+                           const citygml::CityModel* city_model) const {
 
-        impl->required_materials_.clear();
-        impl->node_name_ = "";
-        impl->image_id_num_ = 0;
-        impl->texture_id_num_ = 0;
-        impl->scene_.nodes.clear();
-        impl->mesh_.primitives.clear();
-        impl->material_ids_.clear();
-        impl->options_ = options;
+        // 書き出しの途中の状態は呼び出しごとに持つため、同じ GltfWriter から同時に書き出せます。
+        Impl impl;
+        impl.options_ = options;
 
         std::filesystem::path path = std::filesystem::u8path(gltf_file_path);
         if (path.is_relative()) {
@@ -162,19 +252,36 @@ namespace plateau::meshWriter {
         material.metallicRoughness.baseColorFactor = gltf::Color4(0.5f, 0.5f, 0.5f, 1.0f);
         material.metallicRoughness.metallicFactor = 0.0f;
         material.metallicRoughness.roughnessFactor = 1.0f;
-        impl->default_material_id_ = document.materials.Append(material, gltf::AppendIdPolicy::GenerateOnEmpty).id;
+        impl.default_material_id_ = document.materials.Append(material, gltf::AppendIdPolicy::GenerateOnEmpty).id;
 
-        for (int i = 0; i < model.getRootNodeCount(); i++) {
-            auto& root_node = model.getRootNodeAt(i);
-            impl->precessNodeRecursive(root_node, document, bufferBuilder);
+        if (options.write_feature_metadata) {
+            impl.writeMergedModel(model, document, bufferBuilder);
+            impl.writePropertyTable(city_model, bufferBuilder);
+        } else {
+            for (int i = 0; i < model.getRootNodeCount(); i++) {
+                auto& root_node = model.getRootNodeAt(i);
+                impl.precessNodeRecursive(root_node, document, bufferBuilder);
+            }
         }
 
-        document.SetDefaultScene(std::move(impl->scene_), gltf::AppendIdPolicy::GenerateOnEmpty);
+        document.SetDefaultScene(std::move(impl.scene_), gltf::AppendIdPolicy::GenerateOnEmpty);
         bufferBuilder.Output(document);
+        if (options.write_feature_metadata) {
+            impl.writeStructuralMetadata(document);
+        }
+        impl.writeInstancing(document);
+        if (impl.uses_quantization_) {
+            document.extensionsUsed.insert("KHR_mesh_quantization");
+            document.extensionsRequired.insert("KHR_mesh_quantization");
+        }
         std::string manifest;
 
         try {
-            manifest = Serialize(document, gltf::SerializeFlags::Pretty);
+            // GLB は配信サイズを抑えるため、改行やインデントのない JSON にします。
+            const auto serialize_flags = options.mesh_file_format == GltfFileFormat::GLB
+                                         ? gltf::SerializeFlags::None
+                                         : gltf::SerializeFlags::Pretty;
+            manifest = Serialize(document, serialize_flags);
         }
         catch (const gltf::GLTFException& ex) {
             std::stringstream ss;
@@ -194,7 +301,7 @@ namespace plateau::meshWriter {
         }
 
         // テクスチャファイルコピー
-        for (const auto& [_, texture_url] : impl->required_materials_) {
+        for (const auto& [_, texture_url] : impl.required_materials_) {
             copyTexture(fs::absolute(path).u8string(), texture_url, options);
         }
 
@@ -207,7 +314,6 @@ namespace plateau::meshWriter {
 
         auto mesh = node.getMesh();
         if (mesh != nullptr) {
-            const auto& vertices = mesh->getVertices();
             const auto& all_indices = mesh->getIndices();
             const auto& uvs = mesh->getUV1();
 
@@ -215,21 +321,25 @@ namespace plateau::meshWriter {
             if (!sub_meshes.empty()) {
 
                 //position
+                // 頂点を float で保持しているメッシュは、変換せずにそのまま書き込みます。
                 std::vector<float> positions;
-                for (TVec3d vertex : vertices) {
-                    positions.push_back((float)vertex.x);
-                    positions.push_back((float)vertex.y);
-                    positions.push_back((float)vertex.z);
-                }
-                bufferBuilder.AddBufferView(gltf::BufferViewTarget::ARRAY_BUFFER);
-                std::vector<float> minValues(3U, std::numeric_limits<float>::max());
-                std::vector<float> maxValues(3U, std::numeric_limits<float>::lowest());
-                const size_t positionCount = positions.size();
-                for (size_t i = 0U, j = 0U; i < positionCount; ++i, j = (i % 3U)) {
-                    minValues[j] = std::min(positions[i], minValues[j]);
-                    maxValues[j] = std::max(positions[i], maxValues[j]);
+                const float* position_data;
+                const size_t vertex_count = mesh->getVertexCount();
+                if (mesh->hasFloatVertices()) {
+                    static_assert(sizeof(TVec3f) == sizeof(float) * 3);
+                    position_data = reinterpret_cast<const float*>(mesh->getFloatVertices().data());
+                } else {
+                    positions.reserve(vertex_count * 3);
+                    for (const auto& vertex : mesh->getVertices()) {
+                        positions.push_back((float)vertex.x);
+                        positions.push_back((float)vertex.y);
+                        positions.push_back((float)vertex.z);
+                    }
+                    position_data = positions.data();
                 }
-                auto accessorIdPositions = bufferBuilder.AddAccessor(positions, { gltf::TYPE_VEC3, gltf::COMPONENT_FLOAT, false, minValues, maxValues }).id;
+                // インスタンスの移動量はノードの拡大縮小の影響を受けるため、インスタンスを持つノードは量子化しません。
+                auto accessorIdPositions = addPositions(position_data, vertex_count,
+                                                        options_.quantize_vertices && !node.isInstanced(), bufferBuilder);
 
                 //uv
                 std::string accessorIdTexCoords = "";
@@ -239,18 +349,24 @@ namespace plateau::meshWriter {
                         texcoords.push_back((float)uv.x);
                         texcoords.push_back((float)1.0 - (float)uv.y);
                     }
-                    bufferBuilder.AddBufferView(gltf::BufferViewTarget::ARRAY_BUFFER);
-                    accessorIdTexCoords = bufferBuilder.AddAccessor(texcoords, { gltf::TYPE_VEC2, gltf::COMPONENT_FLOAT }).id;
+                    accessorIdTexCoords = addTexCoords(texcoords, bufferBuilder);
                 }
 
                 bufferBuilder.AddBufferView(gltf::BufferViewTarget::ELEMENT_ARRAY_BUFFER);
+                // 頂点数が少ないメッシュは 16bit の Indices で出力し、サイズを半分にします。
+                const bool use_16bit_indices = plateau::polygonMesh::MeshOptimizer::fitsIn16BitIndices(*mesh);
                 for (auto& sub_mesh : sub_meshes) {
                     //index
                     auto st = sub_mesh.getStartIndex();
                     auto ed = sub_mesh.getEndIndex();
-                    std::vector<int> indices(all_indices.begin() + st, all_indices.begin() + ed + 1);
-
-                    auto& accessorIdIndices = bufferBuilder.AddAccessor(indices, { gltf::TYPE_SCALAR, gltf::COMPONENT_UNSIGNED_INT }).id;
+                    std::string accessorIdIndices;
+                    if (use_16bit_indices) {
+                        std::vector<uint16_t> indices(all_indices.begin() + st, all_indices.begin() + ed + 1);
+                        accessorIdIndices = bufferBuilder.AddAccessor(indices, { gltf::TYPE_SCALAR, gltf::COMPONENT_UNSIGNED_SHORT }).id;
+                    } else {
+                        std::vector<unsigned> indices(all_indices.begin() + st, all_indices.begin() + ed + 1);
+                        accessorIdIndices = bufferBuilder.AddAccessor(indices, { gltf::TYPE_SCALAR, gltf::COMPONENT_UNSIGNED_INT }).id;
+                    }
 
                     //texture
                     auto& texUrl = sub_mesh.getTexturePath();
@@ -262,7 +378,20 @@ namespace plateau::meshWriter {
                         writeMesh(accessorIdPositions, accessorIdIndices, "", bufferBuilder);
                     }
                 }
-                writeNode(document);
+                const auto nodeId = writeNode(document);
+
+                if (node.isInstanced()) {
+                    std::vector<float> translations;
+                    for (const auto& instance : node.getInstances()) {
+                        translations.push_back((float)instance.translation.x);
+                        translations.push_back((float)instance.translation.y);
+                        translations.push_back((float)instance.translation.z);
+                    }
+                    // インスタンスごとの属性は頂点属性ではないため、ターゲットのないバッファビューに書き込みます。
+                    bufferBuilder.AddBufferView();
+                    const auto accessorIdTranslations = bufferBuilder.AddAccessor(translations, { gltf::TYPE_VEC3, gltf::COMPONENT_FLOAT }).id;
+                    instanced_nodes_.emplace_back(nodeId, accessorIdTranslations);
+                }
             }
         }
 
@@ -281,14 +410,99 @@ namespace plateau::meshWriter {
         mesh_.primitives.push_back(meshPrimitive);
     }
 
-    void GltfWriter::Impl::writeNode(gltf::Document& document) {
+    std::string GltfWriter::Impl::addPositions(const float* position_data, size_t vertex_count, bool quantize, gltf::BufferBuilder& bufferBuilder) {
+        std::vector<float> minValues(3U, std::numeric_limits<float>::max());
+        std::vector<float> maxValues(3U, std::numeric_limits<float>::lowest());
+        const size_t positionCount = vertex_count * 3;
+        for (size_t i = 0U, j = 0U; i < positionCount; ++i, j = (i % 3U)) {
+            minValues[j] = std::min(position_data[i], minValues[j]);
+            maxValues[j] = std::max(position_data[i], maxValues[j]);
+        }
+
+        bufferBuilder.AddBufferView(gltf::BufferViewTarget::ARRAY_BUFFER);
+        if (!quantize) {
+            node_translation_.reset();
+            node_scale_.reset();
+            return bufferBuilder.AddAccessor(position_data, vertex_count, { gltf::TYPE_VEC3, gltf::COMPONENT_FLOAT, false, minValues, maxValues }).id;
+        }
+
+        // KHR_mesh_quantization : 座標を範囲の中心からの int16 で表し、ノードの移動と拡大縮小で元の座標に戻します。
+        float center[3], scale[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            center[axis] = (minValues[axis] + maxValues[axis]) * 0.5f;
+            const auto half_extent = (maxValues[axis] - minValues[axis]) * 0.5f;
+            scale[axis] = half_extent > 0 ? half_extent / quantized_position_max : 1.0f;
+        }
+        // 頂点属性の各要素は4バイト境界に揃える必要があるため、1頂点を4つの int16 (最後は詰め物) で書き込みます。
+        std::vector<int16_t> quantized(vertex_count * 4, 0);
+        std::vector<float> quantizedMin(3U, static_cast<float>(quantized_position_max));
+        std::vector<float> quantizedMax(3U, -static_cast<float>(quantized_position_max));
+        for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+            for (int axis = 0; axis < 3; ++axis) {
+                const auto value = std::lround((position_data[vertex * 3 + axis] - center[axis]) / scale[axis]);
+                const auto clamped = static_cast<int16_t>(std::clamp<long>(value, -quantized_position_max, quantized_position_max));
+                quantized[vertex * 4 + axis] = clamped;
+                quantizedMin[axis] = std::min(quantizedMin[axis], static_cast<float>(clamped));
+                quantizedMax[axis] = std::max(quantizedMax[axis], static_cast<float>(clamped));
+            }
+        }
+        node_translation_ = gltf::Vector3(center[0], center[1], center[2]);
+        node_scale_ = gltf::Vector3(scale[0], scale[1], scale[2]);
+        uses_quantization_ = true;
+
+        const gltf::AccessorDesc desc(gltf::TYPE_VEC3, gltf::COMPONENT_SHORT, false, quantizedMin, quantizedMax);
+        std::string accessorId;
+        bufferBuilder.AddAccessors(quantized.data(), vertex_count, sizeof(int16_t) * 4, &desc, 1, &accessorId);
+        return accessorId;
+    }
+
+    std::string GltfWriter::Impl::addTexCoords(const std::vector<float>& texcoords, gltf::BufferBuilder& bufferBuilder) {
+        bufferBuilder.AddBufferView(gltf::BufferViewTarget::ARRAY_BUFFER);
+        const bool is_in_unit_range = std::all_of(texcoords.begin(), texcoords.end(), [](float value) {
+            return value >= 0.0f && value <= 1.0f;
+        });
+        if (!options_.quantize_vertices || !is_in_unit_range) {
+            return bufferBuilder.AddAccessor(texcoords, { gltf::TYPE_VEC2, gltf::COMPONENT_FLOAT }).id;
+        }
+
+        // KHR_mesh_quantization : 0〜1 に収まる UV は正規化した uint16 で書き込みます。
+        std::vector<uint16_t> quantized;
+        quantized.reserve(texcoords.size());
+        for (const auto value : texcoords) {
+            quantized.push_back(static_cast<uint16_t>(std::lround(value * std::numeric_limits<uint16_t>::max())));
+        }
+        uses_quantization_ = true;
+        return bufferBuilder.AddAccessor(quantized, { gltf::TYPE_VEC2, gltf::COMPONENT_UNSIGNED_SHORT, true }).id;
+    }
+
+    std::string GltfWriter::Impl::writeNode(gltf::Document& document) {
         auto meshId = document.meshes.Append(mesh_, gltf::AppendIdPolicy::GenerateOnEmpty).id;
         gltf::Node node;
         node.meshId = meshId;
         node.name = node_name_;
+        if (node_translation_ && node_scale_) {
+            node.translation = *node_translation_;
+            node.scale = *node_scale_;
+        }
         auto nodeId = document.nodes.Append(node, gltf::AppendIdPolicy::GenerateOnEmpty).id;
         scene_.nodes.push_back(nodeId);
         mesh_.primitives.clear();
+        return nodeId;
+    }
+
+    void GltfWriter::Impl::writeInstancing(gltf::Document& document) {
+        if (instanced_nodes_.empty())
+            return;
+
+        // アクセサのインデックスは Output 後に確定するため、拡張はここで付けます。
+        for (const auto& [nodeId, accessorIdTranslations] : instanced_nodes_) {
+            nlohmann::json instancing;
+            instancing["attributes"]["TRANSLATION"] = document.accessors.GetIndex(accessorIdTranslations);
+            auto node = document.nodes.Get(nodeId);
+            node.extensions["EXT_mesh_gpu_instancing"] = instancing.dump();
+            document.nodes.Replace(node);
+        }
+        document.extensionsUsed.insert("EXT_mesh_gpu_instancing");
     }
 
     std::string GltfWriter::Impl::writeMaterialReference(std::string texture_url, gltf::Document& document) {
@@ -326,4 +540,218 @@ namespace plateau::meshWriter {
         }
         return material_ids_[material_name];
     }
+
+    void GltfWriter::Impl::collectMeshesRecursive(const plateau::polygonMesh::Node& node) {
+        const auto mesh = node.getMesh();
+        if (mesh != nullptr && !mesh->getSubMeshes().empty()) {
+            if (node.isInstanced()) {
+                // 1つの primitive にまとめるため、インスタンスは頂点を移動して展開します。
+                for (const auto& instance : node.getInstances()) {
+                    appendMergedMesh(*mesh, instance.translation, &instance.name);
+                }
+            } else {
+                appendMergedMesh(*mesh, TVec3d(0, 0, 0), nullptr);
+            }
+        }
+
+        for (size_t i = 0; i < node.getChildCount(); i++) {
+            collectMeshesRecursive(node.getChildAt(i));
+        }
+    }
+
+    void GltfWriter::Impl::appendMergedMesh(const plateau::polygonMesh::Mesh& mesh, const TVec3d& translation,
+                                            const std::string* instance_name) {
+        const auto base_index = static_cast<unsigned>(merged_.positions.size() / 3);
+        const auto vertex_count = mesh.getVertexCount();
+        const auto tx = (float)translation.x;
+        const auto ty = (float)translation.y;
+        const auto tz = (float)translation.z;
+        if (mesh.hasFloatVertices()) {
+            for (const auto& vertex : mesh.getFloatVertices()) {
+                merged_.positions.insert(merged_.positions.end(), { vertex.x + tx, vertex.y + ty, vertex.z + tz });
+            }
+        } else {
+            for (const auto& vertex : mesh.getVertices()) {
+                merged_.positions.insert(merged_.positions.end(), {
+                    (float)(vertex.x + translation.x), (float)(vertex.y + translation.y), (float)(vertex.z + translation.z) });
+            }
+        }
+
+        const auto& uvs = mesh.getUV1();
+        for (size_t i = 0; i < vertex_count; ++i) {
+            const auto uv = i < uvs.size() ? uvs.at(i) : TVec2f(0, 0);
+            merged_.texcoords.insert(merged_.texcoords.end(), { uv.x, 1.0f - uv.y });
+        }
+
+        // 地物インデックスを、Model 全体で gml:id ごとに一意な地物IDに置き換えます。
+        // インスタンスのメッシュは元になった1つの地物のものなので、インスタンスの名前を gml:id とします。
+        const auto& uv4 = mesh.getUV4();
+        std::map<plateau::polygonMesh::CityObjectIndex, unsigned> index_to_feature_id;
+        for (size_t i = 0; i < vertex_count; ++i) {
+            const auto city_object_index = i < uv4.size()
+                                           ? plateau::polygonMesh::CityObjectIndex::fromUV(uv4.at(i))
+                                           : plateau::polygonMesh::CityObjectIndex(-1, -1);
+            auto found = index_to_feature_id.find(city_object_index);
+            if (found == index_to_feature_id.end()) {
+                static const std::string unknown_gml_id;
+                const auto gml_id = instance_name != nullptr
+                                    ? instance_name
+                                    : findGmlId(mesh.getCityObjectList(), city_object_index);
+                const auto& key = gml_id == nullptr ? unknown_gml_id : *gml_id;
+                auto [feature, inserted] = merged_.gml_id_to_feature_id.try_emplace(
+                        key, static_cast<unsigned>(merged_.gml_ids.size()));
+                if (inserted)
+                    merged_.gml_ids.push_back(&feature->first);
+                found = index_to_feature_id.emplace(city_object_index, feature->second).first;
+            }
+            merged_.feature_ids.push_back(static_cast<float>(found->second));
+        }
+
+        const auto& all_indices = mesh.getIndices();
+        for (const auto& sub_mesh : mesh.getSubMeshes()) {
+            auto& indices = merged_.texture_to_indices[sub_mesh.getTexturePath()];
+            for (auto i = sub_mesh.getStartIndex(); i <= sub_mesh.getEndIndex(); ++i) {
+                indices.push_back(base_index + all_indices.at(i));
+            }
+        }
+    }
+
+    void GltfWriter::Impl::writeMergedModel(const plateau::polygonMesh::Model& model, gltf::Document& document, gltf::BufferBuilder& bufferBuilder) {
+        // LODごとのルートノードを1つにまとめると、同じ地物の複数のLODが重なって表示されるため、ルートノードごとに結合します。
+        for (size_t i = 0; i < model.getRootNodeCount(); i++) {
+            writeMergedNode(model.getRootNodeAt(i), document, bufferBuilder);
+        }
+    }
+
+    void GltfWriter::Impl::writeMergedNode(const plateau::polygonMesh::Node& root_node, gltf::Document& document, gltf::BufferBuilder& bufferBuilder) {
+        merged_.positions.clear();
+        merged_.texcoords.clear();
+        merged_.feature_ids.clear();
+        merged_.texture_to_indices.clear();
+        collectMeshesRecursive(root_node);
+        const size_t vertex_count = merged_.positions.size() / 3;
+        if (vertex_count == 0)
+            return;
+
+        const auto accessorIdPositions = addPositions(merged_.positions.data(), vertex_count, options_.quantize_vertices, bufferBuilder);
+        const auto accessorIdTexCoords = addTexCoords(merged_.texcoords, bufferBuilder);
+
+        // 頂点属性は4バイト境界に揃える必要があるため、地物IDは float で書き込みます。
+        bufferBuilder.AddBufferView(gltf::BufferViewTarget::ARRAY_BUFFER);
+        const auto accessorIdFeatureIds = bufferBuilder.AddAccessor(merged_.feature_ids, { gltf::TYPE_SCALAR, gltf::COMPONENT_FLOAT }).id;
+
+        // featureCount はこのノードに含まれる地物の数です。
+        std::vector<bool> feature_exists(merged_.gml_ids.size(), false);
+        for (const auto feature_id : merged_.feature_ids) {
+            feature_exists[static_cast<size_t>(feature_id)] = true;
+        }
+        const auto feature_count = std::count(feature_exists.begin(), feature_exists.end(), true);
+
+        nlohmann::json mesh_features;
+        mesh_features["featureIds"] = nlohmann::json::array({ {
+            { "featureCount", feature_count },
+            { "attribute", 0 },
+            { "propertyTable", 0 }
+        } });
+        const auto mesh_features_json = mesh_features.dump();
+
+        bufferBuilder.AddBufferView(gltf::BufferViewTarget::ELEMENT_ARRAY_BUFFER);
+        const bool use_16bit_indices = vertex_count < 0xFFFF;
+        for (const auto& [texUrl, all_indices] : merged_.texture_to_indices) {
+            std::string accessorIdIndices;
+            if (use_16bit_indices) {
+                std::vector<uint16_t> indices(all_indices.begin(), all_indices.end());
+                accessorIdIndices = bufferBuilder.AddAccessor(indices, { gltf::TYPE_SCALAR, gltf::COMPONENT_UNSIGNED_SHORT }).id;
+            } else {
+                accessorIdIndices = bufferBuilder.AddAccessor(all_indices, { gltf::TYPE_SCALAR, gltf::COMPONENT_UNSIGNED_INT }).id;
+            }
+
+            current_material_id_ = texUrl.empty() ? default_material_id_ : writeMaterialReference(texUrl, document);
+            writeMesh(accessorIdPositions, accessorIdIndices, texUrl.empty() ? "" : accessorIdTexCoords, bufferBuilder);
+            auto& primitive = mesh_.primitives.back();
+            primitive.attributes["_FEATURE_ID_0"] = accessorIdFeatureIds;
+            primitive.extensions["EXT_mesh_features"] = mesh_features_json;
+        }
+
+        node_name_ = root_node.getName();
+        writeNode(document);
+    }
+
+    void GltfWriter::Impl::writePropertyTable(const citygml::CityModel* city_model, gltf::BufferBuilder& bufferBuilder) {
+        if (merged_.gml_ids.empty())
+            return;
+
+        // STRING 型の列は、UTF-8 の文字列を連結したバッファと、各文字列の開始位置のバッファで表します。
+        const auto add_column = [&](const std::string& property_id, const std::string& name, const auto& get_value) {
+            std::vector<uint8_t> values;
+            std::vector<uint32_t> offsets;
+            for (size_t feature_id = 0; feature_id < merged_.gml_ids.size(); ++feature_id) {
+                offsets.push_back(static_cast<uint32_t>(values.size()));
+                const auto value = get_value(*merged_.gml_ids[feature_id]);
+                values.insert(values.end(), value.begin(), value.end());
+            }
+            offsets.push_back(static_cast<uint32_t>(values.size()));
+            // 長さ0のバッファビューは glTF で許されないため、すべて空文字列の列でも1バイト確保します。
+            if (values.empty())
+                values.push_back(0);
+            // 続く stringOffsets が8バイト境界から始まるよう、文字列の後ろを0で埋めます。文字列の範囲は stringOffsets で決まるため影響しません。
+            values.resize((values.size() + 7) / 8 * 8, 0);
+
+            PropertyColumn column;
+            column.property_id = property_id;
+            column.name = name;
+            column.values_buffer_view_id = addPropertyBufferView(values, bufferBuilder);
+            column.offsets_buffer_view_id = addPropertyBufferView(offsets, bufferBuilder);
+            property_columns_.push_back(column);
+        };
+
+        add_column("gml_id", "gml_id", [](const std::string& gml_id) { return gml_id; });
+        if (city_model == nullptr)
+            return;
+
+        std::set<std::string> used_property_ids = { "gml_id" };
+        for (const auto& key : options_.feature_attribute_keys) {
+            auto property_id = toPropertyId(key);
+            while (!used_property_ids.insert(property_id).second) {
+                property_id += "_";
+            }
+            add_column(property_id, key, [&](const std::string& gml_id) -> std::string {
+                const auto city_object = gml_id.empty() ? nullptr : city_model->getCityObjectById(gml_id);
+                if (city_object == nullptr)
+                    return "";
+                const auto& attributes = city_object->getAttributes();
+                const auto found = attributes.find(key);
+                return found == attributes.end() ? "" : found->second.asString();
+            });
+        }
+    }
+
+    void GltfWriter::Impl::writeStructuralMetadata(gltf::Document& document) {
+        if (property_columns_.empty())
+            return;
+
+        nlohmann::json class_properties;
+        nlohmann::json table_properties;
+        for (const auto& column : property_columns_) {
+            class_properties[column.property_id] = { { "name", column.name }, { "type", "STRING" } };
+            table_properties[column.property_id] = {
+                { "values", document.bufferViews.GetIndex(column.values_buffer_view_id) },
+                { "stringOffsets", document.bufferViews.GetIndex(column.offsets_buffer_view_id) },
+                { "stringOffsetType", "UINT32" }
+            };
+        }
+
+        nlohmann::json structural_metadata;
+        structural_metadata["schema"]["id"] = "plateau";
+        structural_metadata["schema"]["classes"]["CityObject"]["properties"] = class_properties;
+        structural_metadata["propertyTables"] = nlohmann::json::array({ {
+            { "class", "CityObject" },
+            { "count", merged_.gml_ids.size() },
+            { "properties", table_properties }
+        } });
+
+        document.extensions["EXT_structural_metadata"] = structural_metadata.dump();
+        document.extensionsUsed.insert("EXT_mesh_features");
+        document.extensionsUsed.insert("EXT_structural_metadata");
+    }
 }
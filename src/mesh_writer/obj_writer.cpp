@@ -1,56 +1,125 @@
 ﻿#include <stdexcept>
 #include <vector>
 #include <algorithm>
-#include <iomanip>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
 #include <filesystem>
+#include <map>
+#include <sstream>
+#include <string_view>
 
 #include <citygml/citymodel.h>
 
 #include <plateau/mesh_writer/obj_writer.h>
+#include <plateau/mesh_writer/texture_copier.h>
 #include <cassert>
 #include <fstream>
 
+#include "../util/parallel_for.h"
+
 namespace fs = std::filesystem;
 using namespace citygml;
 
 namespace {
-    void startMeshGroup(std::ofstream& obj_ofs, const std::string& name) {
-        obj_ofs << "g " << name << std::endl;
-    }
+    /**
+     * OBJ の文字列をメモリ上に溜めてからまとめてファイルに書き込むバッファです。
+     * 1行ごとに ostringstream を作ったり std::endl でフラッシュしたりすると、
+     * 頂点数の多いメッシュでは書式化が I/O より遅くなるため、数値は std::to_chars で直接書き込みます。
+     */
+    class OutputBuffer {
+    public:
+        explicit OutputBuffer(std::ofstream& ofs) :
+            ofs_(ofs) {
+            buffer_.reserve(flush_threshold + 1024);
+        }
 
-    void applyMaterial(std::ofstream& obj_ofs, const std::string& name) {
-        obj_ofs << "usemtl " << name << std::endl;
-    }
+        OutputBuffer& operator<<(std::string_view str) {
+            buffer_.append(str);
+            return *this;
+        }
 
-    void applyDefaultMaterial(std::ofstream& obj_ofs) {
-        applyMaterial(obj_ofs, "Default-Material");
-    }
+        OutputBuffer& operator<<(char c) {
+            buffer_.push_back(c);
+            return *this;
+        }
 
-    std::string generateVertex(const TVec3d& vertex) {
-        std::ostringstream oss;
-        oss << "v " << vertex.x << " " << vertex.y << " " << vertex.z << std::endl;
-        return oss.str();
-    }
+        OutputBuffer& operator<<(unsigned value) {
+            char chars[16];
+            const auto result = std::to_chars(chars, chars + sizeof(chars), value);
+            buffer_.append(chars, result.ptr);
+            return *this;
+        }
 
-    std::string generateFace(unsigned i0, unsigned i1, unsigned i2) {
-        std::ostringstream oss;
-        oss << "f " << i0 << " " << i1 << " " << i2 << std::endl;
-        return oss.str();
-    }
+        /**
+         * std::ostream の既定の書式 (有効数字6桁で、桁が大きいか小さいときは指数表記) で書き込みます。
+         * 頂点座標はこの書式で書き込みます。
+         */
+        OutputBuffer& writeDefaultFormat(double value) {
+            char chars[32];
+            const auto length = std::snprintf(chars, sizeof(chars), "%g", value);
+            buffer_.append(chars, static_cast<size_t>(std::max(length, 0)));
+            return *this;
+        }
 
-    std::string generateFaceWithUV(unsigned i0, unsigned i1, unsigned i2, unsigned u0, unsigned u1, unsigned u2) {
-        std::ostringstream oss;
-        oss << "f ";
-        oss << i0 << "/" << u0 << " ";
-        oss << i1 << "/" << u1 << " ";
-        oss << i2 << "/" << u2 << " " << std::endl;
-        return oss.str();
-    }
+        /**
+         * std::fixed と std::setprecision(6) で書き込んだときと同じ形式で書き込みます。UV はこの書式で書き込みます。
+         * 丸めに浮動小数点の乗算を使うため、ちょうど中間の値ではまれに最後の桁が1異なります。
+         */
+        OutputBuffer& operator<<(double value) {
+            // 整数部が uint64_t に収まらない値や inf, nan はまれなので printf に任せます。
+            if (!std::isfinite(value) || std::fabs(value) >= max_fast_value) {
+                char chars[512];
+                const auto length = std::snprintf(chars, sizeof(chars), "%.6f", value);
+                buffer_.append(chars, static_cast<size_t>(std::max(length, 0)));
+                return *this;
+            }
+
+            // 小数点以下6桁で丸めた値を整数として扱い、整数部と小数部を別々に書き込みます。
+            if (std::signbit(value)) {
+                buffer_.push_back('-');
+                value = -value;
+            }
+            const auto scaled = static_cast<uint64_t>(std::llround(value * fraction_scale));
+            char chars[32];
+            auto result = std::to_chars(chars, chars + sizeof(chars), scaled / fraction_scale);
+            buffer_.append(chars, result.ptr);
+            buffer_.push_back('.');
+            auto fraction = scaled % fraction_scale;
+            char fraction_chars[fraction_digits];
+            for (int i = fraction_digits - 1; i >= 0; --i) {
+                fraction_chars[i] = static_cast<char>('0' + fraction % 10);
+                fraction /= 10;
+            }
+            buffer_.append(fraction_chars, fraction_digits);
+            return *this;
+        }
+
+        /// バッファが一定量を超えたらファイルに書き込みます。
+        void flushIfFull() {
+            if (buffer_.size() >= flush_threshold)
+                flush();
+        }
+
+        void flush() {
+            ofs_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+            buffer_.clear();
+        }
+
+    private:
+        static constexpr size_t flush_threshold = 4 * 1024 * 1024;
+        static constexpr int fraction_digits = 6;
+        static constexpr uint64_t fraction_scale = 1000000;
+        static constexpr double max_fast_value = 1.0e12;
+
+        std::ofstream& ofs_;
+        std::string buffer_;
+    };
 
     std::string generateDefaultMtl() {
         std::ostringstream oss;
-        oss << "newmtl Default-Material" << std::endl;
-        oss << "Kd 0.5 0.5 0.5" << std::endl << std::endl;
+        oss << "newmtl Default-Material\n";
+        oss << "Kd 0.5 0.5 0.5\n\n";
         return oss.str();
     }
 
@@ -60,8 +129,8 @@ namespace {
         std::replace(t_path.begin(), t_path.end(), '\\', '/');
 
         std::ostringstream oss;
-        oss << "newmtl " << name << std::endl;
-        oss << "map_Kd ./" << t_path << std::endl;
+        oss << "newmtl " << name << '\n';
+        oss << "map_Kd ./" << t_path << '\n';
         return oss.str();
     }
 
@@ -70,175 +139,155 @@ namespace {
         auto t_path = src_path.filename();
         auto dst_path = fs::u8path(obj_path).parent_path();
         dst_path /= src_path.parent_path().filename();
-        create_directories(dst_path);
         dst_path /= t_path;
 
-        constexpr auto copy_options = fs::copy_options::skip_existing;
-        copy(src_path, dst_path, copy_options);
+        // 複数の書き出しが並列に同じテクスチャをコピーしても衝突しないよう、TextureCopier を通します。
+        plateau::meshWriter::TextureCopier::copy(src_path, dst_path);
     }
-}
 
-namespace plateau::meshWriter {
-    bool ObjWriter::write(const std::string& obj_file_path, const plateau::polygonMesh::Model& model) {
-        // 内部状態初期化
-        required_materials_.clear();
-
-        std::filesystem::path path = std::filesystem::u8path(obj_file_path);
-        if (path.is_relative()) {
-            auto current_path = std::filesystem::current_path();
-            current_path /= path;
-            current_path.swap(path);
+    /**
+     * ルートノード1つ分の OBJ ファイルを書き出します。
+     * ファイルごとに頂点番号のオフセットと参照するマテリアルを持つため、複数のファイルを並列に書き出せます。
+     */
+    class ObjFileWriter {
+    public:
+        explicit ObjFileWriter(std::ofstream& ofs) :
+            out_(ofs), v_offset_(0), uv_offset_(0) {
         }
 
-        for (size_t i = 0; i < model.getRootNodeCount(); ++i) {
-            // 内部状態初期化
-            v_offset_ = 0;
-            uv_offset_ = 0;
-
-            auto& root_node = model.getRootNodeAt(i);
-
-            // ファイル名設定
-            std::stringstream oss;
-            oss << "_" << root_node.getName() << ".obj";
-            const auto filename_without_ext = fs::u8path(obj_file_path).filename().replace_extension("").u8string();
-            const auto& file_path =
-                fs::u8path(obj_file_path)
-                .parent_path()
-                .append(filename_without_ext + oss.str())
-                .u8string();
-
-            writeObj(file_path, root_node);
-
-            writeMtl(file_path);
+        void write(const std::string& mtl_file_name, const plateau::polygonMesh::Node& node) {
+            // MTL参照
+            out_ << "mtllib " << mtl_file_name << '\n';
+            writeCityObjectRecursive(node);
+            out_.flush();
         }
 
-        // テクスチャファイルコピー
-        for (const auto& [_, texture_url] : required_materials_) {
-            copyTexture(fs::absolute(path).u8string(), texture_url);
+        const std::map<std::string, std::string>& getRequiredMaterials() const {
+            return required_materials_;
         }
 
-        return true;
-    }
+    private:
+        void writeCityObjectRecursive(const plateau::polygonMesh::Node& node) {
+            writeCityObject(node);
 
-    void ObjWriter::writeObj(const std::string& obj_file_path, const plateau::polygonMesh::Node& node) {
-        auto ofs = std::ofstream(fs::u8path(obj_file_path));
-        if (!ofs.is_open()) {
-            throw std::runtime_error("Failed to open stream of obj path : " + obj_file_path);
+            for (size_t i = 0; i < node.getChildCount(); i++) {
+                writeCityObjectRecursive(node.getChildAt(i));
+            }
         }
-        ofs << std::fixed << std::setprecision(6);
-
-        // MTL参照
-        const auto mtl_file_name = fs::u8path(obj_file_path).filename().replace_extension(".mtl").string();
-        ofs << "mtllib " << mtl_file_name << std::endl;
-
-        writeCityObjectRecursive(ofs, node);
-    }
 
-    void ObjWriter::writeCityObjectRecursive(std::ofstream& ofs, const plateau::polygonMesh::Node& node) {
-        writeCityObject(ofs, node);
+        void writeCityObject(const plateau::polygonMesh::Node& node) {
+            const auto mesh = node.getMesh();
+            if (mesh == nullptr)
+                return;
 
-        for (size_t i = 0; i < node.getChildCount(); i++) {
-            writeCityObjectRecursive(ofs, node.getChildAt(i));
+            // OBJ にはインスタンスの記法がないため、インスタンスごとにグループを展開します。
+            if (node.isInstanced()) {
+                for (const auto& instance : node.getInstances()) {
+                    writeMeshGroup(instance.name, *mesh, instance.translation);
+                }
+            } else {
+                writeMeshGroup(node.getName(), *mesh, TVec3d(0, 0, 0));
+            }
         }
-    }
 
-    void ObjWriter::writeCityObject(std::ofstream& ofs, const plateau::polygonMesh::Node& node) {
+        void writeMeshGroup(const std::string& group_name, const plateau::polygonMesh::Mesh& mesh, const TVec3d& translation) {
+            const auto& sub_meshes = mesh.getSubMeshes();
+            if (sub_meshes.empty())
+                return;
 
-        const auto& node_name = node.getName();
+            out_ << "g " << group_name << '\n';
 
-        const auto mesh = node.getMesh();
-        if (mesh != nullptr) {
-            const auto& sub_meshes = mesh->getSubMeshes();
-            if (!sub_meshes.empty()) {
-                std::stringstream ss;
-                ss << node_name;
-                startMeshGroup(ofs, ss.str());
+            const auto& all_indices = mesh.getIndices();
+            const auto& uvs = mesh.getUV1();
 
-                const auto& vertices = mesh->getVertices();
-                const auto& all_indices = mesh->getIndices();
-                const auto& uvs = mesh->getUV1();
+            assert(all_indices.size() % 3 == 0);
 
-                assert(all_indices.size() % 3 == 0);
+            writeVertices(mesh, translation);
+            writeUVs(uvs);
 
-                writeVertices(ofs, vertices);
-
-                if (!uvs.empty()) {
-                    std::vector<TVec2f> texcoords; // TODO texcoords、使われていないのでは？
-                    for (const auto& uv : uvs) {
-                        auto t = uv;
-                        t.y = 1.0f - uv.y;
-                        texcoords.push_back(t);
-                    }
-                    writeUVs(ofs, uvs);
-                }
+            for (auto& sub_mesh : sub_meshes) {
+                const auto st = sub_mesh.getStartIndex();
+                const auto ed = sub_mesh.getEndIndex();
+                assert((ed + 1 - st) % 3 == 0);
 
-                for (auto& sub_mesh : sub_meshes) {
-                    auto st = sub_mesh.getStartIndex();
-                    auto ed = sub_mesh.getEndIndex();
-                    std::vector<unsigned int> indices(all_indices.begin() + (long long)st, all_indices.begin() + (long long)ed + 1);
-                    assert(indices.size() % 3 == 0);
+                auto texUrl = sub_mesh.getTexturePath();
+                std::replace(texUrl.begin(), texUrl.end(), '\\', '/');
+                writeMaterialReference(texUrl);
 
-                    auto texUrl = sub_mesh.getTexturePath();
-                    std::replace(texUrl.begin(), texUrl.end(), '\\', '/');
-                    writeMaterialReference(ofs, texUrl);
-
-                    // UV番号を明記する記法と省略する記法が混在すると Blender にインポートしたときにUVがずれるので
-                    // テクスチャがなくともUVは記載します。
-                    writeIndicesWithUV(ofs, indices);
-                }
-                v_offset_ += vertices.size();
-                uv_offset_ += uvs.size();
+                // UV番号を明記する記法と省略する記法が混在すると Blender にインポートしたときにUVがずれるので
+                // テクスチャがなくともUVは記載します。
+                writeIndicesWithUV(all_indices, st, ed);
             }
+            v_offset_ += mesh.getVertexCount();
+            uv_offset_ += uvs.size();
         }
-    }
 
-    void ObjWriter::writeVertices(std::ofstream& ofs, const std::vector<TVec3d>& vertices) {
-        for (const auto& vertex : vertices) {
-            ofs << generateVertex(vertex);
+        void writeVertices(const plateau::polygonMesh::Mesh& mesh, const TVec3d& translation) {
+            const auto vertex_count = mesh.getVertexCount();
+            for (size_t i = 0; i < vertex_count; ++i) {
+                const auto vertex = mesh.getVertexAt(i) + translation;
+                out_ << "v ";
+                out_.writeDefaultFormat(vertex.x) << ' ';
+                out_.writeDefaultFormat(vertex.y) << ' ';
+                out_.writeDefaultFormat(vertex.z) << '\n';
+                out_.flushIfFull();
+            }
         }
-    }
 
-    void ObjWriter::writeUVs(std::ofstream& ofs, const std::vector<TVec2f>& uvs) {
-        for (const auto& uv : uvs) {
-            ofs << "vt " << uv.x << " " << uv.y << std::endl;
+        void writeUVs(const std::vector<TVec2f>& uvs) {
+            for (const auto& uv : uvs) {
+                out_ << "vt " << (double)uv.x << ' ' << (double)uv.y << '\n';
+                out_.flushIfFull();
+            }
         }
-    }
 
-    void ObjWriter::writeIndicesWithUV(std::ofstream& ofs, const std::vector<unsigned int>& indices) const {
-        unsigned face[3] = {};
-        unsigned uv_face[3] = {};
-        for (unsigned i = 0; i < indices.size(); i++) {
-            face[i % 3] = indices[i] + v_offset_ + 1;
-            uv_face[i % 3] = indices[i] + uv_offset_ + 1;
+        void writeIndicesWithUV(const std::vector<unsigned>& indices, size_t start, size_t end) {
+            for (size_t i = start; i + 2 <= end; i += 3) {
+                out_ << "f ";
+                for (size_t j = 0; j < 3; ++j) {
+                    out_ << indices[i + j] + v_offset_ + 1 << '/' << indices[i + j] + uv_offset_ + 1 << ' ';
+                }
+                out_ << '\n';
+                out_.flushIfFull();
+            }
+        }
 
-            if (i % 3 < 2) {
-                continue;
+        void writeMaterialReference(const std::string& texUrl) {
+            if (texUrl.empty()) {
+                out_ << "usemtl Default-Material\n";
+                return;
             }
 
-            ofs << generateFaceWithUV(
-                    face[0], face[1], face[2],
-                    uv_face[0], uv_face[1], uv_face[2]);
-        }
-    }
+            // マテリアル名はテクスチャファイル名(拡張子抜き)
+            const auto material_name = fs::u8path(texUrl).filename().replace_extension().u8string();
 
-    void ObjWriter::writeMaterialReference(std::ofstream& ofs, const std::string& texUrl) {
-        if (texUrl.empty()) {
-            applyDefaultMaterial(ofs);
-            return;
-        }
+            out_ << "usemtl " << material_name << '\n';
 
-        // マテリアル名はテクスチャファイル名(拡張子抜き)
-        const auto material_name = fs::u8path(texUrl).filename().replace_extension().u8string();
+            const bool material_exists = required_materials_.find(material_name) != required_materials_.end();
+            if (!material_exists) {
+                required_materials_[material_name] = texUrl;
+            }
+        }
 
-        applyMaterial(ofs, material_name);
+        OutputBuffer out_;
+        unsigned v_offset_, uv_offset_;
+        std::map<std::string, std::string> required_materials_;
+    };
 
-        const bool material_exists = required_materials_.find(material_name) != required_materials_.end();
-        if (!material_exists) {
-            required_materials_[material_name] = texUrl;
+    void writeObj(const std::string& obj_file_path, const plateau::polygonMesh::Node& node,
+                  std::map<std::string, std::string>& out_required_materials) {
+        auto ofs = std::ofstream(fs::u8path(obj_file_path));
+        if (!ofs.is_open()) {
+            throw std::runtime_error("Failed to open stream of obj path : " + obj_file_path);
         }
+
+        const auto mtl_file_name = fs::u8path(obj_file_path).filename().replace_extension(".mtl").string();
+        auto writer = ObjFileWriter(ofs);
+        writer.write(mtl_file_name, node);
+        out_required_materials = writer.getRequiredMaterials();
     }
 
-    void ObjWriter::writeMtl(const std::string& obj_file_path) {
+    void writeMtl(const std::string& obj_file_path, const std::map<std::string, std::string>& required_materials) {
         const auto mtl_file_path = fs::u8path(obj_file_path).replace_extension(".mtl");
         auto mtl_ofs = std::ofstream(mtl_file_path);
         if (!mtl_ofs.is_open()) {
@@ -246,8 +295,52 @@ namespace plateau::meshWriter {
         }
 
         mtl_ofs << generateDefaultMtl();
-        for (auto& [material_name, texture_url] : required_materials_) {
+        for (auto& [material_name, texture_url] : required_materials) {
             mtl_ofs << generateMtl(material_name, texture_url);
         }
     }
 }
+
+namespace plateau::meshWriter {
+    bool ObjWriter::write(const std::string& obj_file_path, const plateau::polygonMesh::Model& model) const {
+        std::filesystem::path path = std::filesystem::u8path(obj_file_path);
+        if (path.is_relative()) {
+            auto current_path = std::filesystem::current_path();
+            current_path /= path;
+            current_path.swap(path);
+        }
+
+        // ルートノードごとのファイルは互いに独立しているため、並列に書き出します。
+        const auto root_node_count = model.getRootNodeCount();
+        std::vector<std::map<std::string, std::string>> required_materials_per_file(root_node_count);
+        plateau::util::parallelFor(root_node_count, [&](size_t i) {
+            auto& root_node = model.getRootNodeAt(i);
+
+            // ファイル名設定
+            std::stringstream oss;
+            oss << "_" << root_node.getName() << ".obj";
+            const auto filename_without_ext = fs::u8path(obj_file_path).filename().replace_extension("").u8string();
+            const auto& file_path =
+                fs::u8path(obj_file_path)
+                .parent_path()
+                .append(filename_without_ext + oss.str())
+                .u8string();
+
+            writeObj(file_path, root_node, required_materials_per_file[i]);
+
+            writeMtl(file_path, required_materials_per_file[i]);
+        });
+
+        std::map<std::string, std::string> required_materials;
+        for (const auto& required_materials_of_file : required_materials_per_file) {
+            required_materials.insert(required_materials_of_file.begin(), required_materials_of_file.end());
+        }
+
+        // テクスチャファイルコピー
+        for (const auto& [_, texture_url] : required_materials) {
+            copyTexture(fs::absolute(path).u8string(), texture_url);
+        }
+
+        return true;
+    }
+}
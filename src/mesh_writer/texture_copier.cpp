@@ -0,0 +1,53 @@
+#include <plateau/mesh_writer/texture_copier.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace plateau::meshWriter {
+    namespace {
+        /// 出力先のパスのハッシュで選ぶロックの数です。同じ出力先へのコピーは必ず同じロックで直列化されます。
+        constexpr size_t lock_stripe_count = 64;
+
+        std::mutex& lockFor(const fs::path& dst_path) {
+            static std::array<std::mutex, lock_stripe_count> locks;
+            return locks[fs::hash_value(dst_path) % lock_stripe_count];
+        }
+
+        /// 同じ出力先へ同時にコピーする別のプロセスとも衝突しない、一時ファイルのパスを返します。
+        fs::path temporaryPathOf(const fs::path& dst_path) {
+            static std::atomic<uint64_t> next_serial(0);
+            std::stringstream ss;
+            ss << ".tmp" << std::hash<std::thread::id>()(std::this_thread::get_id()) << "_" << next_serial.fetch_add(1);
+            auto temp_path = dst_path;
+            temp_path += fs::u8path(ss.str());
+            return temp_path;
+        }
+    }
+
+    void TextureCopier::copy(const fs::path& src_path, const fs::path& dst_path) {
+        const auto absolute_dst_path = fs::absolute(dst_path).lexically_normal();
+        std::lock_guard<std::mutex> lock(lockFor(absolute_dst_path));
+        if (fs::exists(absolute_dst_path))
+            return;
+
+        if (absolute_dst_path.has_parent_path())
+            fs::create_directories(absolute_dst_path.parent_path());
+
+        const auto temp_path = temporaryPathOf(absolute_dst_path);
+        fs::copy_file(src_path, temp_path, fs::copy_options::overwrite_existing);
+        std::error_code error;
+        fs::rename(temp_path, absolute_dst_path, error);
+        if (error) {
+            // 別のプロセスが先に同じファイルを書き込んだ場合は、それを使います。
+            fs::remove(temp_path);
+            if (!fs::exists(absolute_dst_path))
+                throw fs::filesystem_error("Failed to copy texture", src_path, absolute_dst_path, error);
+        }
+    }
+}
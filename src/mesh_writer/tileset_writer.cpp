@@ -0,0 +1,350 @@
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <thread>
+
+#include <citygml/citygml.h>
+#include <citygml/citymodel.h>
+
+#include <plateau/mesh_writer/tileset_writer.h>
+#include <plateau/mesh_writer/gltf_writer.h>
+#include <plateau/polygon_mesh/mesh_optimizer.h>
+#include <plateau/polygon_mesh/polygon_mesh_utils.h>
+#include <plateau/dataset/gml_file.h>
+#include <plateau/dataset/gml_filter.h>
+#include <plateau/geometry/geo_reference.h>
+#include "../polygon_mesh/area_mesh_factory.h"
+#include "../util/parallel_for.h"
+#include "../../3rdparty/json/single_include/nlohmann/json.hpp"
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+using namespace plateau::polygonMesh;
+
+namespace {
+    /// タイル座標 (x: 西, y: 南, z: 上) での軸平行な範囲です。
+    struct Box {
+        TVec3d min = TVec3d(std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+        TVec3d max = TVec3d(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest());
+
+        bool isEmpty() const {
+            return min.x > max.x;
+        }
+
+        void add(const TVec3d& point) {
+            min = TVec3d(std::min(min.x, point.x), std::min(min.y, point.y), std::min(min.z, point.z));
+            max = TVec3d(std::max(max.x, point.x), std::max(max.y, point.y), std::max(max.z, point.z));
+        }
+
+        void add(const Box& other) {
+            if (other.isEmpty())
+                return;
+            add(other.min);
+            add(other.max);
+        }
+
+        double diagonal() const {
+            return isEmpty() ? 0.0 : (max - min).length();
+        }
+
+        /// 3D Tiles の boundingVolume.box (中心と3つの半軸) に変換します。
+        json toJson() const {
+            const auto center = (min + max) * 0.5;
+            const auto half = (max - min) * 0.5;
+            return json::array({ center.x, center.y, center.z,
+                                 half.x, 0.0, 0.0,
+                                 0.0, half.y, 0.0,
+                                 0.0, 0.0, half.z });
+        }
+    };
+
+    struct Tile {
+        std::string content_uri;
+        Box box;
+        double geometric_error = 0.0;
+        std::vector<Tile> children;
+    };
+
+    /**
+     * WUN 座標系の頂点を、glTF の Y-up を 3D Tiles の Z-up に変換した後のタイル座標に変換します。
+     * glTF の (x, y, z) は 3D Tiles では (x, -z, y) として扱われます。
+     */
+    TVec3d toTileSpace(const TVec3d& wun) {
+        return TVec3d(wun.x, -wun.z, wun.y);
+    }
+
+    void addNodeToBox(const Node& node, Box& box) {
+        const auto mesh = node.getMesh();
+        if (mesh != nullptr) {
+            for (const auto& vertex : mesh->getVertices()) {
+                box.add(toTileSpace(vertex));
+            }
+        }
+        for (size_t i = 0; i < node.getChildCount(); ++i) {
+            addNodeToBox(node.getChildAt(i), box);
+        }
+    }
+
+    Box boxOf(const Model& model) {
+        Box box;
+        for (size_t i = 0; i < model.getRootNodeCount(); ++i) {
+            addNodeToBox(model.getRootNodeAt(i), box);
+        }
+        return box;
+    }
+
+    /// lod_mask のうち max_lod 以下で最大の LOD を返します。該当する LOD がなければ -1 を返します。
+    int getTopLod(unsigned lod_mask, unsigned max_lod) {
+        for (int lod = static_cast<int>(max_lod); lod >= 0; --lod) {
+            if ((lod_mask & (1u << lod)) != 0)
+                return lod;
+        }
+        return -1;
+    }
+
+    /// classification のうち、pred を満たす地物だけを残した分類を返します。
+    template<typename Pred>
+    AreaClassification filterEntries(const AreaClassification& classification, Pred pred) {
+        AreaClassification filtered;
+        filtered.grid_names = classification.grid_names;
+        for (const auto& entry : classification.entries) {
+            if (pred(entry))
+                filtered.entries.push_back(entry);
+        }
+        return filtered;
+    }
+
+    /// gridMerge の結果を、"LOD(番号)" という名前のノードの子として model に追加します。
+    void addMergedMeshes(Model& model, unsigned lod, const AreaClassification& classification, GridMergeResult& merged) {
+        Node* lod_node = nullptr;
+        for (auto& [group_id, mesh] : merged) {
+            if (mesh->getVertices().empty())
+                continue;
+            if (lod_node == nullptr)
+                lod_node = &model.addEmptyNode("LOD" + std::to_string(lod));
+            lod_node->addChildNode(Node(AreaMeshFactory::getGroupName(classification, group_id), std::move(mesh)));
+        }
+    }
+
+    /// タイルの Model を GLB で書き出し、そのタイルを返します。
+    Tile writeTileContent(Model& model, const fs::path& tiles_directory, const std::string& file_name,
+                          const MeshExtractOptions& extract_options) {
+        if (extract_options.enable_mesh_optimization)
+            MeshOptimizer::optimize(model);
+
+        plateau::meshWriter::GltfWriteOptions gltf_options;
+        gltf_options.mesh_file_format = plateau::meshWriter::GltfFileFormat::GLB;
+        gltf_options.texture_directory_path = "textures";
+        plateau::meshWriter::GltfWriter().write((tiles_directory / fs::u8path(file_name)).u8string(), model, gltf_options);
+
+        Tile tile;
+        tile.content_uri = "tiles/" + file_name;
+        tile.box = boxOf(model);
+        return tile;
+    }
+
+    /**
+     * 1つの GMLファイルを読み込み、粗いタイルとグリッドごとの詳細なタイルを書き出します。
+     * CityModel はこの関数を抜けると解放されます。
+     * max_merge_threads はグループごとのメッシュ結合に使うスレッド数の上限です。
+     */
+    std::optional<Tile> writeGmlTiles(const std::string& gml_path, const fs::path& tiles_directory,
+                                      const MeshExtractOptions& extract_options,
+                                      const plateau::meshWriter::TilesetWriteOptions& options,
+                                      unsigned max_merge_threads) {
+        citygml::ParserParams params;
+        // 遅延テッセレーションでは、抽出するポリゴンだけを抽出時に三角形に分割します。
+        params.tesselate = !extract_options.enable_lazy_tessellation;
+        params.keepVertices = true;
+        // 抽出しない LOD の形状はパースする前に取り除きます。
+        const auto city_model = plateau::dataset::GmlFilter::load(
+                gml_path, params, plateau::dataset::GmlFilterParams::fromExtractOptions(extract_options));
+        if (city_model == nullptr)
+            return std::nullopt;
+
+        const plateau::geometry::GeoReference geo_reference(
+                extract_options.coordinate_zone_id, extract_options.reference_point,
+                extract_options.unit_scale, extract_options.mesh_axes);
+        const auto classification = AreaMeshFactory::classify(*city_model, extract_options);
+        const auto stem = fs::u8path(gml_path).filename().replace_extension().u8string();
+        const auto coarse_max_lod = std::min(options.coarse_max_lod, extract_options.max_lod);
+
+        const auto top_lod_of = [&](const AreaClassification::Entry& entry) {
+            const auto top_lod = getTopLod(entry.lod_mask, extract_options.max_lod);
+            return top_lod < static_cast<int>(extract_options.min_lod) ? -1 : top_lod;
+        };
+        bool has_fine_lod = false;
+        for (const auto& entry : classification.entries) {
+            has_fine_lod |= top_lod_of(entry) > static_cast<int>(coarse_max_lod);
+        }
+
+        // 粗いタイルでは、各地物を coarse_max_lod 以下で持つ最大の LOD で表します。
+        Model coarse_model;
+        // 詳細なタイルでは、各地物を持つ最大の LOD で表します。グリッド番号ごとに1つのタイルにします。
+        std::map<unsigned, Model> grid_models;
+        constexpr unsigned lod_count_in_group = PolygonMeshUtils::max_lod_in_specification_ + 1;
+        for (unsigned lod = extract_options.min_lod; lod <= extract_options.max_lod; ++lod) {
+            if (lod <= coarse_max_lod) {
+                const auto coarse = filterEntries(classification, [&](const AreaClassification::Entry& entry) {
+                    const auto top_lod = top_lod_of(entry);
+                    return top_lod >= 0 && std::min(top_lod, static_cast<int>(coarse_max_lod)) == static_cast<int>(lod);
+                });
+                if (!coarse.entries.empty()) {
+                    auto merged = AreaMeshFactory::gridMerge(coarse, extract_options, lod, geo_reference, max_merge_threads);
+                    addMergedMeshes(coarse_model, lod, coarse, merged);
+                }
+            }
+
+            if (!has_fine_lod)
+                continue;
+            const auto fine = filterEntries(classification, [&](const AreaClassification::Entry& entry) {
+                return top_lod_of(entry) == static_cast<int>(lod);
+            });
+            if (fine.entries.empty())
+                continue;
+            auto merged = AreaMeshFactory::gridMerge(fine, extract_options, lod, geo_reference, max_merge_threads);
+            std::map<unsigned, GridMergeResult> merged_per_grid;
+            for (auto& [group_id, mesh] : merged) {
+                merged_per_grid[group_id / lod_count_in_group].emplace(group_id, std::move(mesh));
+            }
+            for (auto& [grid_id, grid_merged] : merged_per_grid) {
+                addMergedMeshes(grid_models[grid_id], lod, fine, grid_merged);
+            }
+        }
+        if (coarse_model.getRootNodeCount() == 0 && grid_models.empty())
+            return std::nullopt;
+
+        auto gml_tile = coarse_model.getRootNodeCount() == 0
+                        ? Tile()
+                        : writeTileContent(coarse_model, tiles_directory, stem + ".glb", extract_options);
+        for (auto& [grid_id, grid_model] : grid_models) {
+            if (grid_model.getRootNodeCount() == 0)
+                continue;
+            const auto grid_name = grid_id < classification.grid_names.size()
+                                   ? classification.grid_names.at(grid_id)
+                                   : std::to_string(grid_id);
+            auto grid_tile = writeTileContent(grid_model, tiles_directory, stem + "_" + grid_name + ".glb", extract_options);
+            gml_tile.box.add(grid_tile.box);
+            gml_tile.geometric_error = std::max(gml_tile.geometric_error, grid_tile.box.diagonal());
+            gml_tile.children.push_back(std::move(grid_tile));
+        }
+        return gml_tile;
+    }
+
+    json toJson(const Tile& tile) {
+        json tile_json;
+        tile_json["boundingVolume"]["box"] = tile.box.toJson();
+        tile_json["geometricError"] = tile.geometric_error;
+        tile_json["refine"] = "REPLACE";
+        if (!tile.content_uri.empty())
+            tile_json["content"]["uri"] = tile.content_uri;
+        if (!tile.children.empty()) {
+            auto children = json::array();
+            for (const auto& child : tile.children) {
+                children.push_back(toJson(child));
+            }
+            tile_json["children"] = children;
+        }
+        return tile_json;
+    }
+
+    /**
+     * タイル座標 (西, 南, 上) から、基準点を原点とする地心直交座標 (ECEF) への変換行列を列優先で返します。
+     * 楕円体は GRS80 とします。
+     */
+    json tileToEcefTransform(const plateau::geometry::GeoCoordinate& origin) {
+        constexpr double pi = 3.14159265358979323846;
+        constexpr double semi_major_axis = 6378137.0;
+        constexpr double flattening = 1.0 / 298.257222101;
+        constexpr double eccentricity_sq = flattening * (2.0 - flattening);
+        const auto lat = origin.latitude * pi / 180.0;
+        const auto lon = origin.longitude * pi / 180.0;
+        const auto prime_vertical_radius = semi_major_axis / std::sqrt(1.0 - eccentricity_sq * std::sin(lat) * std::sin(lat));
+
+        const TVec3d east(-std::sin(lon), std::cos(lon), 0);
+        const TVec3d north(-std::sin(lat) * std::cos(lon), -std::sin(lat) * std::sin(lon), std::cos(lat));
+        const TVec3d up(std::cos(lat) * std::cos(lon), std::cos(lat) * std::sin(lon), std::sin(lat));
+        const TVec3d position(
+                (prime_vertical_radius + origin.height) * std::cos(lat) * std::cos(lon),
+                (prime_vertical_radius + origin.height) * std::cos(lat) * std::sin(lon),
+                (prime_vertical_radius * (1.0 - eccentricity_sq) + origin.height) * std::sin(lat));
+        return json::array({ -east.x, -east.y, -east.z, 0.0,
+                             -north.x, -north.y, -north.z, 0.0,
+                             up.x, up.y, up.z, 0.0,
+                             position.x, position.y, position.z, 1.0 });
+    }
+}
+
+namespace plateau::meshWriter {
+    bool TilesetWriter::write(const std::string& output_directory, const std::vector<std::string>& gml_paths,
+                              const MeshExtractOptions& extract_options, const TilesetWriteOptions& options) {
+        auto tile_extract_options = extract_options;
+        tile_extract_options.mesh_axes = geometry::CoordinateSystem::WUN;
+        tile_extract_options.mesh_granularity = MeshGranularity::PerCityModelArea;
+
+        const auto output_path = fs::u8path(output_directory);
+        const auto tiles_directory = output_path / "tiles";
+        fs::create_directories(tiles_directory);
+
+        // GMLファイルの並列処理の中でグループごとの結合も並列にすると、スレッド数が両者の積になります。
+        // そのため、ハードウェアのスレッド数を同時に処理する GMLファイルで分け合います。
+        const auto hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+        const auto file_threads = static_cast<unsigned>(std::min<size_t>(
+                options.max_parallel_files != 0 ? options.max_parallel_files : hardware_threads,
+                std::max<size_t>(gml_paths.size(), 1)));
+        const auto merge_threads = std::max(hardware_threads / file_threads, 1u);
+
+        // GMLファイルごとに読み込み・結合・書き出しを行い、タイルの情報だけを残します。
+        std::vector<std::optional<Tile>> gml_tiles(gml_paths.size());
+        util::parallelFor(gml_paths.size(), [&](size_t i) {
+            try {
+                gml_tiles[i] = writeGmlTiles(gml_paths[i], tiles_directory, tile_extract_options, options, merge_threads);
+            } catch (...) {
+                // 読み込めなかった GMLファイルはスキップし、他のファイルの処理を続けます。
+                gml_tiles[i] = std::nullopt;
+            }
+        }, file_threads);
+
+        // GMLファイルのタイルを2次メッシュごとにまとめます。
+        std::map<std::string, Tile> second_mesh_tiles;
+        for (size_t i = 0; i < gml_paths.size(); ++i) {
+            if (!gml_tiles[i])
+                continue;
+            const dataset::GmlFile gml_file(gml_paths[i]);
+            const auto key = gml_file.isValid()
+                             ? gml_file.getMeshCode().asSecond().get()
+                             : fs::u8path(gml_paths[i]).filename().replace_extension().u8string();
+            auto& second_mesh_tile = second_mesh_tiles[key];
+            second_mesh_tile.box.add(gml_tiles[i]->box);
+            second_mesh_tile.children.push_back(std::move(*gml_tiles[i]));
+        }
+        if (second_mesh_tiles.empty())
+            return false;
+
+        Tile root;
+        for (auto& [key, second_mesh_tile] : second_mesh_tiles) {
+            second_mesh_tile.geometric_error = second_mesh_tile.box.diagonal();
+            root.box.add(second_mesh_tile.box);
+            root.children.push_back(std::move(second_mesh_tile));
+        }
+        root.geometric_error = root.box.diagonal();
+
+        const geometry::GeoReference geo_reference(
+                tile_extract_options.coordinate_zone_id, tile_extract_options.reference_point,
+                tile_extract_options.unit_scale, tile_extract_options.mesh_axes);
+        auto root_json = toJson(root);
+        root_json["transform"] = tileToEcefTransform(geo_reference.unproject(TVec3d(0, 0, 0)));
+
+        json tileset;
+        tileset["asset"]["version"] = "1.0";
+        tileset["geometricError"] = root.geometric_error;
+        tileset["root"] = root_json;
+        std::ofstream ofs(output_path / "tileset.json");
+        ofs << tileset.dump(2);
+        return true;
+    }
+}
@@ -3,26 +3,31 @@
 #include <plateau/polygon_mesh/primary_city_object_types.h>
 #include <plateau/polygon_mesh/mesh_factory.h>
 #include <plateau/polygon_mesh/polygon_mesh_utils.h>
+#include <plateau/dataset/mesh_code.h>
+#include "../util/parallel_for.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <citygml/geometry.h>
+#include <citygml/polygon.h>
+#include <citygml/linearring.h>
 
 namespace {
     using namespace plateau;
     using namespace polygonMesh;
 
     /**
-    * グリッド番号と、そのグリッドに属する CityObject のリストを対応付ける辞書です。
+    * グループ番号と、そのグループに属する主要地物のリストを対応付ける辞書です。
     */
-    using GridIDToObjectsMap = std::map<unsigned, std::list<const citygml::CityObject*>>;
-    using GroupIDToObjectsMap = GridIDToObjectsMap;
+    using GroupIDToObjectsMap = std::map<unsigned, std::list<const AreaClassification::Entry*>>;
 
     /**
-     * cityModelのEnvelope(範囲)を指定のグリッド数(x,y)で分割したとき、
+     * 範囲 (lower, upper) を指定のグリッド数(x,y)で分割したとき、
      * positionは何番目のグリッドに属するかを計算します。
      */
-    int getGridId(const citygml::Envelope& city_envelope, const TVec3d& position,
+    int getGridId(const TVec3d& lower, const TVec3d& upper, const TVec3d& position,
         const int grid_num_x, const int grid_num_y) {
 
-        const auto lower = city_envelope.getLowerBound();
-        const auto upper = city_envelope.getUpperBound();
         int grid_x = static_cast<int>((position.x - lower.x) * grid_num_x / (upper.x - lower.x));
         int grid_y = static_cast<int>((position.y - lower.y) * grid_num_y / (upper.y - lower.y));
         if (grid_x < 0) grid_x = 0;
@@ -33,36 +38,209 @@ namespace {
         return grid_id;
     }
 
+    struct PrimaryObjectInModel {
+        const citygml::CityModel* city_model;
+        const citygml::CityObject* primary_object;
+    };
+
+    /// 分割前のグリッド1つ分の範囲と、そこに属する主要地物です。
+    struct GridCell {
+        std::string name;
+        TVec3d lower;
+        TVec3d upper;
+        std::vector<const PrimaryObjectInModel*> objects;
+    };
+
+    /**
+     * position を含む3次メッシュを grid_count × grid_count に分割したとき、position が属するグリッドを返します。
+     * グリッドの名前は "(3次メッシュコード)_(行)_(列)" であり、GMLファイルによらず位置だけで決まります。
+     */
+    GridCell getMeshCodeGridCell(const TVec3d& position, const int grid_count) {
+        const auto mesh_code = dataset::MeshCode::getThirdMesh(geometry::GeoCoordinate(position.x, position.y, position.z));
+        const auto extent = mesh_code.getExtent();
+        const auto to_cell = [grid_count](double value, double min, double max) {
+            const auto cell = static_cast<int>(std::floor((value - min) * grid_count / (max - min)));
+            return std::clamp(cell, 0, grid_count - 1);
+        };
+        const auto row = to_cell(position.x, extent.min.latitude, extent.max.latitude);
+        const auto col = to_cell(position.y, extent.min.longitude, extent.max.longitude);
+        const auto lat_size = (extent.max.latitude - extent.min.latitude) / grid_count;
+        const auto lon_size = (extent.max.longitude - extent.min.longitude) / grid_count;
+
+        GridCell cell;
+        cell.name = mesh_code.get() + "_" + std::to_string(row) + "_" + std::to_string(col);
+        cell.lower = TVec3d(extent.min.latitude + lat_size * row, extent.min.longitude + lon_size * col, extent.min.height);
+        cell.upper = TVec3d(cell.lower.x + lat_size, cell.lower.y + lon_size, extent.max.height);
+        return cell;
+    }
+
+    /// ring の頂点のうち、先頭と同じ座標で輪を閉じる末尾の頂点を除いた数を返します。
+    size_t openRingSize(const std::vector<TVec3d>& vertices) {
+        auto size = vertices.size();
+        if (size > 1 && vertices.front() == vertices.back())
+            --size;
+        return size;
+    }
+
     /**
-     * key が グリッド番号であり、 value は　CityObjectのvector であるmapを初期化します。
+     * polygon を三角形に分割したときの三角形の数を返します。
+     * テッセレーションされていない (遅延テッセレーションの) ポリゴンは、外周と穴の頂点数から見積もります。
+     * 頂点数 n の外周を分割すると n-2 個、穴は1つにつき頂点数 + 2 個の三角形が増えます。
      */
-    GridIDToObjectsMap initGridIDToObjectsMap(const int grid_num_x, const int grid_num_y) {
-        const int grid_num = grid_num_x * grid_num_y;
-        auto grid_id_to_objects_map = GridIDToObjectsMap();
-        for (int i = 0; i < grid_num; i++) {
-            grid_id_to_objects_map.emplace(i, std::list<const citygml::CityObject*>());
+    size_t estimateTriangleCount(const citygml::Polygon& polygon) {
+        if (!polygon.getIndices().empty())
+            return polygon.getIndices().size() / 3;
+
+        const auto exterior_size = openRingSize(PolygonMeshUtils::getPolygonVertices(polygon));
+        if (exterior_size < 3)
+            return 0;
+        auto count = exterior_size - 2;
+        for (const auto& interior_ring : polygon.interiorRings()) {
+            const auto interior_size = openRingSize(interior_ring->getVertices());
+            if (interior_size >= 3)
+                count += interior_size + 2;
         }
-        return grid_id_to_objects_map;
+        return count;
     }
 
+    void countTrianglesInGeometry(const citygml::Geometry& geometry, std::vector<size_t>& counts) {
+        const auto lod = geometry.getLOD();
+        if (lod < counts.size()) {
+            for (unsigned i = 0; i < geometry.getPolygonsCount(); ++i) {
+                counts[lod] += estimateTriangleCount(*geometry.getPolygon(i));
+            }
+        }
+        for (unsigned i = 0; i < geometry.getGeometriesCount(); ++i) {
+            countTrianglesInGeometry(geometry.getGeometry(i), counts);
+        }
+    }
+
+    void countTrianglesRecursive(const citygml::CityObject& city_object, std::vector<size_t>& counts) {
+        for (unsigned i = 0; i < city_object.getChildCityObjectsCount(); ++i) {
+            countTrianglesRecursive(city_object.getChildCityObject(i), counts);
+        }
+        for (unsigned i = 0; i < city_object.getGeometriesCount(); ++i) {
+            countTrianglesInGeometry(city_object.getGeometry(i), counts);
+        }
+    }
 
     /**
-     * city_objects の各CityObjectが位置の上でどのグリッドに属するかを求め、gridIdToObjsMapに追加することでグリッド分けします。
-     * また ImportID を割り振ります。
-     * extentの範囲外のものは除外します（除外する設定の場合）。
+     * 主要地物 (子を含む) の三角形の数を LOD ごとに数え、最も多い LOD の数を返します。
+     * グリッド分けは全 LOD で共有するため、最も重い LOD を基準に分割します。
      */
-    GridIDToObjectsMap classifyCityObjectsToGrid(const citygml::ConstCityObjects& city_objects, const citygml::Envelope& city_envelope,
-                                           const MeshExtractOptions& options) {
-        auto grid_id_to_objects_map = initGridIDToObjectsMap(options.grid_count_of_side, options.grid_count_of_side);
-        for (const auto co : city_objects) {
-            // 範囲外、または位置不明ならスキップします（スキップする設定の場合）。
-            if (options.exclude_city_object_outside_extent && !options.extent.contains(*co))
+    size_t countTrianglesOfDensestLod(const citygml::CityObject& primary_object) {
+        std::vector<size_t> counts(PolygonMeshUtils::max_lod_in_specification_ + 1, 0);
+        countTrianglesRecursive(primary_object, counts);
+        return *std::max_element(counts.begin(), counts.end());
+    }
+
+    /// 適応的な分割で得られる、最終的なグリッドです。
+    struct AdaptiveLeaf {
+        std::string path;
+        size_t triangle_count;
+        std::vector<const PrimaryObjectInModel*> objects;
+    };
+
+    struct WeightedObject {
+        const PrimaryObjectInModel* object;
+        TVec3d position;
+        size_t triangle_count;
+    };
+
+    constexpr unsigned max_adaptive_depth = 10;
+
+    /**
+     * 三角形の数が budget を超える範囲を4分割する操作を再帰的に行い、葉を out_leaves に追加します。
+     * 葉の path は4分木をたどる象限番号 (0〜3) の列です。
+     * 分割後に辺を共有する兄弟の葉の合計が budget 以下であれば、それらを1つの葉にまとめます。
+     */
+    void subdivideAdaptively(const std::vector<WeightedObject>& objects, const TVec3d& lower, const TVec3d& upper,
+                             const std::string& path, unsigned depth, size_t budget,
+                             std::vector<AdaptiveLeaf>& out_leaves) {
+        size_t triangle_count = 0;
+        for (const auto& object : objects) {
+            triangle_count += object.triangle_count;
+        }
+        if (triangle_count <= budget || objects.size() <= 1 || depth >= max_adaptive_depth) {
+            AdaptiveLeaf leaf{ path, triangle_count, {} };
+            for (const auto& object : objects) {
+                leaf.objects.push_back(object.object);
+            }
+            out_leaves.push_back(std::move(leaf));
+            return;
+        }
+
+        // 緯度と経度の中央で4つの象限に分けます。
+        const auto middle = (lower + upper) * 0.5;
+        std::vector<WeightedObject> quadrants[4];
+        for (const auto& object : objects) {
+            const int quadrant = (object.position.x >= middle.x ? 2 : 0) + (object.position.y >= middle.y ? 1 : 0);
+            quadrants[quadrant].push_back(object);
+        }
+
+        std::vector<AdaptiveLeaf> child_leaves;
+        for (int quadrant = 0; quadrant < 4; ++quadrant) {
+            if (quadrants[quadrant].empty())
+                continue;
+            const auto child_lower = TVec3d(quadrant >= 2 ? middle.x : lower.x, quadrant % 2 == 1 ? middle.y : lower.y, lower.z);
+            const auto child_upper = TVec3d(quadrant >= 2 ? upper.x : middle.x, quadrant % 2 == 1 ? upper.y : middle.y, upper.z);
+            subdivideAdaptively(quadrants[quadrant], child_lower, child_upper, path + std::to_string(quadrant), depth + 1,
+                                budget, child_leaves);
+        }
+
+        // それ以上分割されなかった兄弟のうち、辺を共有するものを budget の範囲で2つずつまとめます。
+        // 象限 1 と 2、 0 と 3 は対角に位置し、まとめると離れた範囲が1つのグリッドになるため対象外です。
+        constexpr int edge_sharing_pairs[][2] = { { 0, 1 }, { 2, 3 }, { 0, 2 }, { 1, 3 } };
+        int direct_leaf_of_quadrant[4] = { -1, -1, -1, -1 };
+        for (size_t i = 0; i < child_leaves.size(); ++i) {
+            const auto& leaf_path = child_leaves[i].path;
+            if (leaf_path.size() == path.size() + 1)
+                direct_leaf_of_quadrant[leaf_path.back() - '0'] = static_cast<int>(i);
+        }
+        std::vector<std::string> merged_quadrants(child_leaves.size());
+        std::vector<bool> is_absorbed(child_leaves.size(), false);
+        for (const auto& [first_quadrant, second_quadrant] : edge_sharing_pairs) {
+            const auto first = direct_leaf_of_quadrant[first_quadrant];
+            const auto second = direct_leaf_of_quadrant[second_quadrant];
+            if (first < 0 || second < 0 || !merged_quadrants[first].empty() || !merged_quadrants[second].empty())
+                continue;
+            auto& first_leaf = child_leaves[first];
+            auto& second_leaf = child_leaves[second];
+            if (first_leaf.triangle_count + second_leaf.triangle_count > budget)
+                continue;
+            first_leaf.triangle_count += second_leaf.triangle_count;
+            first_leaf.objects.insert(first_leaf.objects.end(), second_leaf.objects.begin(), second_leaf.objects.end());
+            merged_quadrants[first] = std::to_string(first_quadrant) + std::to_string(second_quadrant);
+            merged_quadrants[second] = merged_quadrants[first];
+            is_absorbed[second] = true;
+        }
+        for (size_t i = 0; i < child_leaves.size(); ++i) {
+            if (is_absorbed[i])
                 continue;
+            if (!merged_quadrants[i].empty())
+                child_leaves[i].path = path + "m" + merged_quadrants[i];
+            out_leaves.push_back(std::move(child_leaves[i]));
+        }
+    }
 
-            const int grid_id = getGridId(city_envelope, PolygonMeshUtils::cityObjPos(*co), options.grid_count_of_side, options.grid_count_of_side);
-            grid_id_to_objects_map.at(grid_id).push_back(co);
+    /**
+     * 各 city_model の主要地物を集めます。
+     * extentの範囲外のものは除外します（除外する設定の場合）。
+     */
+    std::vector<PrimaryObjectInModel> collectPrimaryObjects(const std::vector<const citygml::CityModel*>& city_models,
+                                                            const MeshExtractOptions& options) {
+        std::vector<PrimaryObjectInModel> result;
+        for (const auto city_model : city_models) {
+            const auto& primary_objects = city_model->getAllCityObjectsOfType(
+                    PrimaryCityObjectTypes::getPrimaryTypeMask() & options.city_object_type_mask);
+            for (const auto primary_object : primary_objects) {
+                // 範囲外、または位置不明ならスキップします（スキップする設定の場合）。
+                if (options.exclude_city_object_outside_extent && !options.extent.contains(*primary_object))
+                    continue;
+                result.push_back({ city_model, primary_object });
+            }
         }
-        return grid_id_to_objects_map;
+        return result;
     }
 }
 
@@ -72,12 +250,110 @@ namespace plateau::polygonMesh {
     GridMergeResult
         AreaMeshFactory::gridMerge(const CityModel& city_model, const MeshExtractOptions& options, unsigned lod,
                               const geometry::GeoReference& geo_reference) {
-        // city_model に含まれる 主要地物 をグリッドに分類します。
-        const auto& all_primary_city_objects =
-            city_model.getAllCityObjectsOfType(PrimaryCityObjectTypes::getPrimaryTypeMask());
-        const auto& city_envelope = city_model.getEnvelope();
-        auto grid_id_to_primary_objects_map = classifyCityObjectsToGrid(all_primary_city_objects, city_envelope, options);
-        
+        return gridMerge(classify(city_model, options), options, lod, geo_reference);
+    }
+
+    AreaClassification AreaMeshFactory::classify(const CityModel& city_model, const MeshExtractOptions& options) {
+        return classify(std::vector<const CityModel*>{ &city_model }, options);
+    }
+
+    AreaClassification AreaMeshFactory::classify(const std::vector<const CityModel*>& city_models,
+                                                 const MeshExtractOptions& options) {
+        const auto primary_objects = collectPrimaryObjects(city_models, options);
+        AreaClassification classification;
+
+        // 主要地物をグリッドに分類します。
+        auto grid_id_to_cell = std::map<unsigned, GridCell>();
+        if (options.align_grid_to_mesh_code) {
+            // 3次メッシュに揃えたグリッドに分類し、グリッド名の順にグリッド番号を振ります。
+            auto grid_name_to_cell = std::map<std::string, GridCell>();
+            for (const auto& object : primary_objects) {
+                const auto position = PolygonMeshUtils::cityObjPos(*object.primary_object);
+                auto cell = getMeshCodeGridCell(position, options.grid_count_of_side);
+                grid_name_to_cell.try_emplace(cell.name, cell).first->second.objects.push_back(&object);
+            }
+            for (auto& [grid_name, cell] : grid_name_to_cell) {
+                grid_id_to_cell.emplace(static_cast<unsigned>(grid_id_to_cell.size()), std::move(cell));
+            }
+        } else {
+            // すべての city_model を合わせた範囲をグリッド状に分割して分類します。
+            TVec3d lower(std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+            TVec3d upper(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest());
+            for (const auto city_model : city_models) {
+                const auto& envelope = city_model->getEnvelope();
+                lower = TVec3d(std::min(lower.x, envelope.getLowerBound().x), std::min(lower.y, envelope.getLowerBound().y),
+                               std::min(lower.z, envelope.getLowerBound().z));
+                upper = TVec3d(std::max(upper.x, envelope.getUpperBound().x), std::max(upper.y, envelope.getUpperBound().y),
+                               std::max(upper.z, envelope.getUpperBound().z));
+            }
+            const auto grid_count = options.grid_count_of_side;
+            const auto cell_size_x = (upper.x - lower.x) / grid_count;
+            const auto cell_size_y = (upper.y - lower.y) / grid_count;
+            for (const auto& object : primary_objects) {
+                const auto grid_id = static_cast<unsigned>(getGridId(
+                    lower, upper, PolygonMeshUtils::cityObjPos(*object.primary_object), grid_count, grid_count));
+                auto [found, inserted] = grid_id_to_cell.try_emplace(grid_id);
+                auto& cell = found->second;
+                if (inserted) {
+                    const auto grid_x = static_cast<int>(grid_id) % grid_count;
+                    const auto grid_y = static_cast<int>(grid_id) / grid_count;
+                    cell.name = std::to_string(grid_id);
+                    cell.lower = TVec3d(lower.x + cell_size_x * grid_x, lower.y + cell_size_y * grid_y, lower.z);
+                    cell.upper = TVec3d(cell.lower.x + cell_size_x, cell.lower.y + cell_size_y, upper.z);
+                }
+                cell.objects.push_back(&object);
+            }
+        }
+
+        // 適応的な分割が有効なら、三角形の数が予算を超えるグリッドを4分木で分割し、疎な兄弟をまとめます。
+        auto grid_id_to_objects = std::map<unsigned, std::vector<const PrimaryObjectInModel*>>();
+        if (options.enable_adaptive_grid) {
+            for (const auto& [root_grid_id, cell] : grid_id_to_cell) {
+                std::vector<WeightedObject> weighted_objects;
+                for (const auto object : cell.objects) {
+                    weighted_objects.push_back({ object, PolygonMeshUtils::cityObjPos(*object->primary_object),
+                                                 countTrianglesOfDensestLod(*object->primary_object) });
+                }
+                std::vector<AdaptiveLeaf> leaves;
+                subdivideAdaptively(weighted_objects, cell.lower, cell.upper, "", 0,
+                                    std::max<size_t>(options.adaptive_grid_triangle_budget, 1), leaves);
+                for (auto& leaf : leaves) {
+                    const auto grid_id = static_cast<unsigned>(classification.grid_names.size());
+                    classification.grid_names.push_back(leaf.path.empty() ? cell.name : cell.name + "_q" + leaf.path);
+                    grid_id_to_objects.emplace(grid_id, std::move(leaf.objects));
+                }
+            }
+        } else {
+            for (auto& [grid_id, cell] : grid_id_to_cell) {
+                if (options.align_grid_to_mesh_code)
+                    classification.grid_names.push_back(cell.name);
+                grid_id_to_objects.emplace(grid_id, std::move(cell.objects));
+            }
+        }
+
+        // 各主要地物が持つ LOD を調べます。
+        for (const auto& [grid_id, objects_in_grid] : grid_id_to_objects) {
+            for (const auto object : objects_in_grid) {
+                classification.entries.push_back({ object->city_model, object->primary_object, grid_id,
+                                                   PolygonMeshUtils::getLodMask(*object->primary_object) });
+            }
+        }
+        return classification;
+    }
+
+    std::string AreaMeshFactory::getGroupName(const AreaClassification& classification, unsigned group_id) {
+        if (classification.grid_names.empty())
+            return "group" + std::to_string(group_id);
+        const auto lod_pattern_count = PolygonMeshUtils::max_lod_in_specification_ + 1;
+        const auto grid_id = group_id / lod_pattern_count;
+        const auto max_lod_in_group = group_id % lod_pattern_count;
+        return "group_" + classification.grid_names.at(grid_id) + "_lod" + std::to_string(max_lod_in_group);
+    }
+
+    GridMergeResult
+        AreaMeshFactory::gridMerge(const AreaClassification& classification,
+                                   const MeshExtractOptions& options, unsigned lod,
+                                   const geometry::GeoReference& geo_reference, unsigned max_threads) {
         // グリッドをさらに分割してグループにします。
         // グループの分割基準:
         // 仕様上存在しうる最大LODをm として、各オブジェクトを次のグループに分けます。
@@ -93,48 +369,50 @@ namespace plateau::polygonMesh {
         // そのようにグループ分けする利点は、
         // 「高いLODを表示したが、低いLODにしか対応していない箇所が穴になってしまう」という状況で、穴をちょうど埋める範囲の低LODグループが存在することです。
         auto group_id_to_primary_objects_map = GroupIDToObjectsMap();
-        for (const auto& [grid_id, primary_objects_in_grid] : grid_id_to_primary_objects_map) {
-            for (const auto& primary_object : primary_objects_in_grid) {
-                // この CityObject について、最大でどのLODまで存在するか確認します。
-                unsigned max_lod_in_obj = PolygonMeshUtils::max_lod_in_specification_;
-                for (unsigned target_lod = lod + 1; target_lod <= PolygonMeshUtils::max_lod_in_specification_; ++target_lod) {
-                    bool target_lod_exists =
-                        PolygonMeshUtils::findFirstPolygon(primary_object, target_lod) != nullptr;
-                    if (!target_lod_exists) {
-                        max_lod_in_obj = target_lod - 1;
-                        break;
-                    }
-                }
-                // グループに追加します。
-                unsigned group_id = grid_id * (PolygonMeshUtils::max_lod_in_specification_ + 1) + max_lod_in_obj;
-                if (group_id_to_primary_objects_map.find(group_id) == group_id_to_primary_objects_map.end())
-                    group_id_to_primary_objects_map[group_id] = std::list<const CityObject*>();
-
-                group_id_to_primary_objects_map.at(group_id).push_back(primary_object);
+        for (const auto& entry : classification.entries) {
+            // この CityObject について、 lod より上で連続して存在する最大の LOD を求めます。
+            unsigned max_lod_in_obj = lod;
+            while (max_lod_in_obj < PolygonMeshUtils::max_lod_in_specification_ &&
+                   (entry.lod_mask & (1u << (max_lod_in_obj + 1))) != 0) {
+                ++max_lod_in_obj;
             }
+            // グループに追加します。
+            unsigned group_id = entry.grid_id * (PolygonMeshUtils::max_lod_in_specification_ + 1) + max_lod_in_obj;
+            group_id_to_primary_objects_map[group_id].push_back(&entry);
         }
 
         // グループごとにメッシュを結合します。
-        auto merged_meshes = GridMergeResult();
-        // グループごとのループ
-        for (const auto& [group_id, primary_objects] : group_id_to_primary_objects_map) {
+        // グループ間で共有する状態はないため、並列で生成します。
+        std::vector<const GroupIDToObjectsMap::value_type*> groups;
+        for (const auto& group : group_id_to_primary_objects_map) {
+            groups.push_back(&group);
+        }
+        std::vector<std::unique_ptr<Mesh>> meshes(groups.size());
+        util::parallelFor(groups.size(), [&](size_t i) {
             // 1グループのメッシュ生成
             MeshFactory mesh_factory(nullptr, options, geo_reference);
 
             // グループ内の各主要地物のループ
-            for (const auto& primary_object : primary_objects) {
+            for (const auto entry : groups[i]->second) {
+                const auto& primary_object = entry->primary_object;
+                const auto& gml_path = entry->city_model->getGmlPath();
                 if (MeshExtractor::shouldContainPrimaryMesh(lod, *primary_object)) {
-                    mesh_factory.addPolygonsInPrimaryCityObject(*primary_object, lod, city_model.getGmlPath());
+                    mesh_factory.addPolygonsInPrimaryCityObject(*primary_object, lod, gml_path);
                 }
 
                 if (lod >= 2) {
                     // 主要地物の子である各最小地物をメッシュに加えます。
-                    auto atomic_objects = PolygonMeshUtils::getChildCityObjectsRecursive(*primary_object);
-                    mesh_factory.addPolygonsInAtomicCityObjects(*primary_object, atomic_objects, lod, city_model.getGmlPath());
+                    auto atomic_objects = PolygonMeshUtils::getChildCityObjectsRecursive(*primary_object, options.city_object_type_mask);
+                    mesh_factory.addPolygonsInAtomicCityObjects(*primary_object, atomic_objects, lod, gml_path);
                 }
                 mesh_factory.incrementPrimaryIndex();
             }
-            merged_meshes.emplace(group_id, mesh_factory.releaseMesh());
+            meshes[i] = mesh_factory.releaseMesh();
+        }, max_threads);
+
+        auto merged_meshes = GridMergeResult();
+        for (size_t i = 0; i < groups.size(); ++i) {
+            merged_meshes.emplace(groups[i]->first, std::move(meshes[i]));
         }
         return merged_meshes;
     }
@@ -5,11 +5,36 @@
 #include <plateau/polygon_mesh/mesh_extractor.h>
 #include <plateau/polygon_mesh/mesh.h>
 #include <plateau/polygon_mesh/mesh_extract_options.h>
+#include <string>
+#include <vector>
 
 namespace plateau::polygonMesh {
     /// グループIDと、その結合後Meshのmapです。
     using GridMergeResult = std::map<unsigned, std::unique_ptr<Mesh>>;
 
+    /**
+     * 主要地物をグリッドに分類し、各主要地物が持つ LOD を調べた結果です。
+     * LOD によらない情報なので、 city_model ごとに1度だけ求めて全 LOD の gridMerge で共有します。
+     */
+    struct AreaClassification {
+        struct Entry {
+            const citygml::CityModel* city_model;
+            const citygml::CityObject* primary_object;
+            unsigned grid_id;
+            /// i ビット目が立っていれば、その主要地物 (子を含む) は LOD i のポリゴンを持ちます。
+            unsigned lod_mask;
+        };
+
+        /// グリッド番号の昇順、同じグリッド内では city_model 内の順に並びます。
+        std::vector<Entry> entries;
+
+        /**
+         * グリッド番号ごとのグリッド名です。
+         * MeshExtractOptions::align_grid_to_mesh_code が true のときのみ、 "(3次メッシュコード)_(行)_(列)" の形式で入ります。
+         */
+        std::vector<std::string> grid_names;
+    };
+
     /**
      * cityModel をグリッド状に分割し、各地物オブジェクトをグリッドに分類します。
      * グリッドをさらにグループ分けし、
@@ -24,5 +49,31 @@ namespace plateau::polygonMesh {
         static GridMergeResult
         gridMerge(const citygml::CityModel& city_model, const MeshExtractOptions& options, unsigned lod,
                   const plateau::geometry::GeoReference& geo_reference);
+
+        /**
+         * classify で求めた分類を使って gridMerge を行います。
+         * 複数の LOD を抽出するときは、分類を使い回すことで地物の走査を1度で済ませられます。
+         * グループごとのメッシュの生成は並列で行います。
+         * max_threads はそのスレッド数の上限で、0 のときはハードウェアのスレッド数とします。
+         */
+        static GridMergeResult
+        gridMerge(const AreaClassification& classification, const MeshExtractOptions& options, unsigned lod,
+                  const plateau::geometry::GeoReference& geo_reference, unsigned max_threads = 0);
+
+        /// city_model の主要地物をグリッドに分類し、各主要地物が持つ LOD を調べます。
+        static AreaClassification classify(const citygml::CityModel& city_model, const MeshExtractOptions& options);
+
+        /**
+         * 複数の city_model の主要地物をまとめてグリッドに分類します。
+         * 同じグリッドに属する主要地物は、GMLファイルが異なっても1つのグループになります。
+         */
+        static AreaClassification classify(const std::vector<const citygml::CityModel*>& city_models,
+                                           const MeshExtractOptions& options);
+
+        /**
+         * gridMerge の結果のグループ番号から、ノード名を返します。
+         * 地域メッシュに揃えたグリッドでは、隣接するGMLファイルの同じ位置のグリッドが同じ名前になります。
+         */
+        static std::string getGroupName(const AreaClassification& classification, unsigned group_id);
     };
 }
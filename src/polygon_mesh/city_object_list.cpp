@@ -1,18 +1,53 @@
 #include <plateau/polygon_mesh/node.h>
 #include "plateau/polygon_mesh/city_object_list.h"
+#include <algorithm>
+#include <stdexcept>
 #include <string>
 
 namespace plateau::polygonMesh {
+    const std::string& GmlIdArena::intern(std::string_view str) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto found = index_.find(str);
+        if (found != index_.end())
+            return *found->second;
+        // std::deque は末尾への追加で既存の要素を移動しないため、文字列のアドレスは変わりません。
+        const auto& stored = strings_.emplace_back(str);
+        index_.emplace(stored, &stored);
+        return stored;
+    }
+
+    size_t GmlIdArena::size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return strings_.size();
+    }
+
+    CityObjectList::CityObjectList(std::shared_ptr<GmlIdArena> arena)
+        : arena_(std::move(arena)) {
+    }
+
+    std::vector<CityObjectList::Entry>::const_iterator CityObjectList::find(const CityObjectIndex& key) const {
+        const auto found = std::lower_bound(
+            entries_.begin(), entries_.end(), key,
+            [](const Entry& entry, const CityObjectIndex& k) { return entry.first < k; });
+        if (found == entries_.end() || !(found->first == key))
+            return entries_.end();
+        return found;
+    }
+
     const std::string& CityObjectList::getAtomicGmlID(const CityObjectIndex& city_object_index) const {
-        return city_object_index_to_gml_id_.at(city_object_index);
+        const auto found = find(city_object_index);
+        if (found == entries_.end())
+            throw std::out_of_range("city_object_index is not found in CityObjectList.");
+        return *found->second;
     }
 
     const std::string& CityObjectList::getPrimaryGmlID(const int index) const {
-        return city_object_index_to_gml_id_.at({ index, CityObjectIndex::invalidIndex() });
+        return getAtomicGmlID({ index, CityObjectIndex::invalidIndex() });
     }
 
     void CityObjectList::getAllKeys(std::vector<CityObjectIndex>& keys) const {
-        for (const auto& [key, _] : city_object_index_to_gml_id_) {
+        keys.reserve(keys.size() + entries_.size());
+        for (const auto& [key, _] : entries_) {
             keys.push_back(key);
         }
     }
@@ -23,15 +58,63 @@ namespace plateau::polygonMesh {
         return result;
     }
 
-    CityObjectIndex CityObjectList::getCityObjectIndex(const std::string& gml_id) const {
-        for (const auto& [key, value] : city_object_index_to_gml_id_) {
-            if (value == gml_id)
-                return key;
+    CityObjectIndex CityObjectList::getCityObjectIndex(std::string_view gml_id) const {
+        const auto found = gml_id_to_index_.find(gml_id);
+        if (found == gml_id_to_index_.end())
+            return { -1, -1 };
+        return found->second;
+    }
+
+    void CityObjectList::getCityObjectIndices(const std::vector<std::string_view>& gml_ids,
+                                              std::vector<CityObjectIndex>& out_indices) const {
+        out_indices.reserve(out_indices.size() + gml_ids.size());
+        for (const auto gml_id : gml_ids) {
+            out_indices.push_back(getCityObjectIndex(gml_id));
         }
-        return { -1, -1 };
     }
 
     void CityObjectList::add(const CityObjectIndex& key, const std::string& value) {
-        city_object_index_to_gml_id_[key] = value;
+        if (arena_ == nullptr)
+            arena_ = std::make_shared<GmlIdArena>();
+        const auto& gml_id = arena_->intern(value);
+
+        // 地物インデックスは昇順に追加されることが多いため、末尾への追加を先に判定します。
+        auto position = entries_.end();
+        if (!entries_.empty() && !(entries_.back().first < key)) {
+            position = std::lower_bound(
+                entries_.begin(), entries_.end(), key,
+                [](const Entry& entry, const CityObjectIndex& k) { return entry.first < k; });
+        }
+
+        if (position != entries_.end() && position->first == key) {
+            const auto& old_gml_id = *position->second;
+            position->second = &gml_id;
+            if (&old_gml_id == &gml_id)
+                return;
+            // 書き換え前の gml:id の逆引きがこのキーを指していれば、同じ gml:id を持つ別のキーを探し直します。
+            const auto reverse = gml_id_to_index_.find(old_gml_id);
+            if (reverse != gml_id_to_index_.end() && reverse->second == key) {
+                gml_id_to_index_.erase(reverse);
+                for (const auto& [other_key, other_gml_id] : entries_) {
+                    if (other_gml_id == &old_gml_id) {
+                        gml_id_to_index_.emplace(old_gml_id, other_key);
+                        break;
+                    }
+                }
+            }
+        } else {
+            entries_.emplace(position, key, &gml_id);
+        }
+        updateReverseIndex(gml_id, key);
+    }
+
+    void CityObjectList::updateReverseIndex(const std::string& gml_id, const CityObjectIndex& key) {
+        const auto [found, inserted] = gml_id_to_index_.emplace(gml_id, key);
+        if (!inserted && key < found->second)
+            found->second = key;
+    }
+
+    size_t CityObjectList::size() const {
+        return entries_.size();
     }
 }
@@ -7,19 +7,43 @@ namespace plateau::polygonMesh {
     using namespace citygml;
 
     Mesh::Mesh()
-        : uv1_(UV())
+        : has_float_vertices_(false)
+        , uv1_(UV())
         , uv4_(UV()) {
     }
 
     Mesh::Mesh(std::vector<TVec3d>&& vertices, std::vector<unsigned>&& indices, UV&& uv_1,
                std::vector<SubMesh>&& sub_meshes, CityObjectList&& city_object_list)
         : vertices_(std::move(vertices))
+        , has_float_vertices_(false)
         , indices_(std::move(indices))
         , uv1_(std::move(uv_1))
         , sub_meshes_(std::move(sub_meshes))
         , city_object_list_(std::move(city_object_list)) {
     }
 
+    Mesh::Mesh(std::vector<TVec3d>&& vertices, std::vector<unsigned>&& indices, UV&& uv_1, UV&& uv_4,
+               std::vector<SubMesh>&& sub_meshes, CityObjectList&& city_object_list)
+        : vertices_(std::move(vertices))
+        , has_float_vertices_(false)
+        , indices_(std::move(indices))
+        , uv1_(std::move(uv_1))
+        , uv4_(std::move(uv_4))
+        , sub_meshes_(std::move(sub_meshes))
+        , city_object_list_(std::move(city_object_list)) {
+    }
+
+    Mesh::Mesh(std::vector<TVec3f>&& float_vertices, std::vector<unsigned>&& indices, UV&& uv_1, UV&& uv_4,
+               std::vector<SubMesh>&& sub_meshes, CityObjectList&& city_object_list)
+        : float_vertices_(std::move(float_vertices))
+        , has_float_vertices_(true)
+        , indices_(std::move(indices))
+        , uv1_(std::move(uv_1))
+        , uv4_(std::move(uv_4))
+        , sub_meshes_(std::move(sub_meshes))
+        , city_object_list_(std::move(city_object_list)) {
+    }
+
     std::vector<TVec3d>& Mesh::getVertices() {
         return vertices_;
     }
@@ -28,6 +52,39 @@ namespace plateau::polygonMesh {
         return vertices_;
     }
 
+    const std::vector<TVec3f>& Mesh::getFloatVertices() const {
+        return float_vertices_;
+    }
+
+    bool Mesh::hasFloatVertices() const {
+        return has_float_vertices_;
+    }
+
+    size_t Mesh::getVertexCount() const {
+        return has_float_vertices_ ? float_vertices_.size() : vertices_.size();
+    }
+
+    TVec3d Mesh::getVertexAt(size_t index) const {
+        if (has_float_vertices_) {
+            const auto& vertex = float_vertices_.at(index);
+            return { vertex.x, vertex.y, vertex.z };
+        }
+        return vertices_.at(index);
+    }
+
+    void Mesh::convertVerticesToFloat() {
+        if (has_float_vertices_)
+            return;
+        float_vertices_.reserve(vertices_.size());
+        for (const auto& vertex : vertices_) {
+            float_vertices_.emplace_back(
+                static_cast<float>(vertex.x), static_cast<float>(vertex.y), static_cast<float>(vertex.z));
+        }
+        // double版のメモリを解放します。
+        std::vector<TVec3d>().swap(vertices_);
+        has_float_vertices_ = true;
+    }
+
     const std::vector<unsigned>& Mesh::getIndices() const {
         return indices_;
     }
@@ -53,7 +110,10 @@ namespace plateau::polygonMesh {
     }
 
     void Mesh::reserve(long long vertex_count) {
-        vertices_.reserve(vertex_count);
+        if (has_float_vertices_)
+            float_vertices_.reserve(vertex_count);
+        else
+            vertices_.reserve(vertex_count);
         indices_.reserve(vertex_count);
         uv1_.reserve(vertex_count);
         uv4_.reserve(vertex_count);
@@ -66,6 +126,24 @@ namespace plateau::polygonMesh {
         }
     }
 
+    void Mesh::addVerticesList(const Mesh& other_mesh) {
+        if (!has_float_vertices_ && !other_mesh.has_float_vertices_) {
+            addVerticesList(other_mesh.vertices_);
+            return;
+        }
+
+        // どちらかが float であれば float に揃えます。
+        convertVerticesToFloat();
+        if (other_mesh.has_float_vertices_) {
+            float_vertices_.insert(float_vertices_.end(), other_mesh.float_vertices_.begin(), other_mesh.float_vertices_.end());
+        } else {
+            for (const auto& vertex : other_mesh.vertices_) {
+                float_vertices_.emplace_back(
+                    static_cast<float>(vertex.x), static_cast<float>(vertex.y), static_cast<float>(vertex.z));
+            }
+        }
+    }
+
     /**
      * Indices を追加します。
      * メッシュのマージ処理の流れについて
@@ -171,7 +249,7 @@ namespace plateau::polygonMesh {
 
     void Mesh::debugString(std::stringstream& ss, int indent) const {
         for (int i = 0; i < indent; i++) ss << "    ";
-        ss << "Mesh: ( " << vertices_.size() << " vertices, " << indices_.size() << " indices )" << std::endl;
+        ss << "Mesh: ( " << getVertexCount() << " vertices, " << indices_.size() << " indices )" << std::endl;
         for (const auto& sub_mesh : sub_meshes_) {
             sub_mesh.debugString(ss, indent + 1);
         }
@@ -4,26 +4,90 @@
 #include "area_mesh_factory.h"
 #include "citygml/cityobject.h"
 #include <plateau/polygon_mesh/mesh_factory.h>
+#include <plateau/polygon_mesh/mesh_optimizer.h>
+#include <plateau/polygon_mesh/mesh_simplifier.h>
+#include <plateau/polygon_mesh/mesh_instancer.h>
 #include <plateau/polygon_mesh/polygon_mesh_utils.h>
 #include <plateau/texture/texture_packer.h>
+#include "../util/parallel_for.h"
 
 namespace {
     using namespace plateau;
     using namespace polygonMesh;
     using namespace texture;
 
+    void convertVerticesToFloatRecursive(Node& node) {
+        if (node.getMesh() != nullptr) {
+            node.getMesh()->convertVerticesToFloat();
+        }
+        for (unsigned i = 0; i < node.getChildCount(); ++i) {
+            convertVerticesToFloatRecursive(node.getChildAt(i));
+        }
+    }
+
     bool shouldSkipCityObj(const citygml::CityObject& city_obj, const MeshExtractOptions& options) {
         return options.exclude_city_object_outside_extent && !options.extent.contains(city_obj);
     }
 
+    /// 抽出する主要地物と、それを含む CityModel の組です。
+    using PrimaryCityObject = std::pair<const citygml::CityModel*, const citygml::CityObject*>;
+
+    /// city_models の主要地物のうち、抽出するものを順に返します。
+    std::vector<PrimaryCityObject> findPrimaryCityObjects(
+            const std::vector<const citygml::CityModel*>& city_models, const MeshExtractOptions& options) {
+        std::vector<PrimaryCityObject> result;
+        for (const auto city_model : city_models) {
+            const auto& primary_city_objects = city_model->getAllCityObjectsOfType(
+                    PrimaryCityObjectTypes::getPrimaryTypeMask() & options.city_object_type_mask);
+            for (const auto primary_city_object : primary_city_objects) {
+                // 範囲外ならスキップします。
+                if (shouldSkipCityObj(*primary_city_object, options))
+                    continue;
+                result.emplace_back(city_model, primary_city_object);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * 各主要地物から create_node でノードを作り、主要地物の順に lod_node に追加します。
+     * 遅延テッセレーションでは主要地物ごとの処理が重くなるため、ノードを複数のスレッドで並列に作ります。
+     */
+    template<typename CreateNode>
+    void addPrimaryNodes(Node& lod_node, const std::vector<PrimaryCityObject>& primary_city_objects,
+                         const MeshExtractOptions& options, CreateNode&& create_node) {
+        if (!options.enable_lazy_tessellation) {
+            for (const auto& primary_city_object : primary_city_objects) {
+                lod_node.addChildNode(create_node(primary_city_object));
+            }
+            return;
+        }
+        std::vector<std::unique_ptr<Node>> nodes(primary_city_objects.size());
+        util::parallelFor(primary_city_objects.size(), [&](size_t i) {
+            nodes[i] = std::make_unique<Node>(create_node(primary_city_objects[i]));
+        });
+        for (auto& node : nodes) {
+            lod_node.addChildNode(std::move(*node));
+        }
+    }
+
     void extractInner(
-        Model& out_model, const citygml::CityModel& city_model,
+        Model& out_model, const std::vector<const citygml::CityModel*>& city_models,
         const MeshExtractOptions& options) {
 
         if (options.max_lod < options.min_lod) throw std::logic_error("Invalid LOD range.");
 
         const auto geo_reference = geometry::GeoReference(options.coordinate_zone_id, options.reference_point, options.unit_scale, options.mesh_axes);
 
+        // 地域単位のグリッド分けは LOD によらないため、全 LOD で1度の分類を共有します。
+        const auto area_classification = options.mesh_granularity == MeshGranularity::PerCityModelArea
+                                          ? AreaMeshFactory::classify(city_models, options)
+                                          : AreaClassification();
+
+        const auto primary_city_objects = options.mesh_granularity == MeshGranularity::PerCityModelArea
+                                          ? std::vector<PrimaryCityObject>()
+                                          : findPrimaryCityObjects(city_models, options);
+
         // rootNode として LODノード を作ります。
         for (unsigned lod = options.min_lod; lod <= options.max_lod; lod++) {
             auto lod_node = Node("LOD" + std::to_string(lod));
@@ -36,10 +100,10 @@ namespace {
                 // model -> LODノード -> グループごとのノード
 
                 // 3D都市モデルをグループに分け、グループごとにメッシュをマージします。
-                auto result = AreaMeshFactory::gridMerge(city_model, options, lod, geo_reference);
+                auto result = AreaMeshFactory::gridMerge(area_classification, options, lod, geo_reference);
                 // グループごとのノードを追加します。
                 for (auto& [group_id, mesh] : result) {
-                    auto node = Node("group" + std::to_string(group_id), std::move(mesh));
+                    auto node = Node(AreaMeshFactory::getGroupName(area_classification, group_id), std::move(mesh));
                     lod_node.addChildNode(std::move(node));
                 }
             }
@@ -49,44 +113,36 @@ namespace {
                 // 次のような階層構造を作ります：
                 // model -> LODノード -> 主要地物ごとのノード
 
-                auto& all_primary_city_objects_in_model =
-                    city_model.getAllCityObjectsOfType(PrimaryCityObjectTypes::getPrimaryTypeMask());
-
                 // 主要地物ごとにメッシュを結合します。
-                for (auto primary_object : all_primary_city_objects_in_model) {
-                    // 範囲外ならスキップします。
-                    if (shouldSkipCityObj(*primary_object, options))
-                        continue;
+                addPrimaryNodes(lod_node, primary_city_objects, options, [&](const PrimaryCityObject& primary) {
+                    const auto& city_model = *primary.first;
+                    const auto primary_object = primary.second;
 
                     // 主要地物のメッシュを作ります。
                     MeshFactory mesh_factory(nullptr, options, geo_reference);
-                    
+
                     if (MeshExtractor::shouldContainPrimaryMesh(lod, *primary_object)) {
                         mesh_factory.addPolygonsInPrimaryCityObject(*primary_object, lod, city_model.getGmlPath());
                     }
 
                     if (lod >= 2) {
                         // 主要地物の子である各最小地物をメッシュに加えます。
-                        auto atomic_objects = PolygonMeshUtils::getChildCityObjectsRecursive(*primary_object);
+                        auto atomic_objects = PolygonMeshUtils::getChildCityObjectsRecursive(*primary_object, options.city_object_type_mask);
                         mesh_factory.addPolygonsInAtomicCityObjects(*primary_object, atomic_objects, lod, city_model.getGmlPath());
                     }
 
-                    // 主要地物ごとのノードを追加します。
-                    lod_node.addChildNode(Node(primary_object->getId(), mesh_factory.releaseMesh()));
-                    mesh_factory.incrementPrimaryIndex();
-                }
+                    // 主要地物ごとのノードを作ります。
+                    return Node(primary_object->getId(), mesh_factory.releaseMesh());
+                });
             }
             break;
             case MeshGranularity::PerAtomicFeatureObject:
             {
                 // 次のような階層構造を作ります：
                 // model -> LODノード -> 主要地物ごとのノード -> その子の最小地物ごとのノード
-                auto& primary_city_objects = city_model.getAllCityObjectsOfType(
-                        PrimaryCityObjectTypes::getPrimaryTypeMask());
-                for (auto primary_city_object : primary_city_objects) {
-                    // 範囲外ならスキップします。
-                    if (shouldSkipCityObj(*primary_city_object, options))
-                        continue;
+                addPrimaryNodes(lod_node, primary_city_objects, options, [&](const PrimaryCityObject& primary) {
+                    const auto& city_model = *primary.first;
+                    const auto primary_city_object = primary.second;
 
                     // 主要地物のノードを作成します。
                     std::unique_ptr<Mesh> primary_mesh;
@@ -98,7 +154,7 @@ namespace {
                     auto primary_node = Node(primary_city_object->getId(), std::move(primary_mesh));
 
                     // 最小地物ごとにノードを作成
-                    auto atomic_objects = PolygonMeshUtils::getChildCityObjectsRecursive(*primary_city_object);
+                    auto atomic_objects = PolygonMeshUtils::getChildCityObjectsRecursive(*primary_city_object, options.city_object_type_mask);
                     for (auto atomic_object : atomic_objects) {
                         MeshFactory atomic_mesh_factory(nullptr, options, geo_reference);
                         atomic_mesh_factory.addPolygonsInAtomicCityObject(
@@ -107,9 +163,8 @@ namespace {
                         auto atomic_node = Node(atomic_object->getId(), atomic_mesh_factory.releaseMesh());
                         primary_node.addChildNode(std::move(atomic_node));
                     }
-                    lod_node.addChildNode(std::move(primary_node));
-                    primary_mesh_factory.incrementPrimaryIndex();
-                }
+                    return primary_node;
+                });
             }
             break;
             default:
@@ -125,6 +180,29 @@ namespace {
             TexturePacker packer(options.texture_packing_resolution, options.texture_packing_resolution);
             packer.process(out_model);
         }
+
+        if (options.enable_instancing) {
+            MeshInstancer::instantiate(out_model);
+        }
+
+        if (options.generate_proxy_lod) {
+            const auto lod_node_count = out_model.getRootNodeCount();
+            for (size_t i = 0; i < lod_node_count; ++i) {
+                const auto& lod_node = out_model.getRootNodeAt(i);
+                out_model.addNode(MeshSimplifier::createProxyLodNode(
+                    lod_node, lod_node.getName() + "_proxy", options.proxy_lod_target_ratio));
+            }
+        }
+
+        if (options.enable_mesh_optimization) {
+            MeshOptimizer::optimize(out_model);
+        }
+
+        if (options.store_vertices_as_float) {
+            for (size_t i = 0; i < out_model.getRootNodeCount(); ++i) {
+                convertVerticesToFloatRecursive(out_model.getRootNodeAt(i));
+            }
+        }
     }
 }
 
@@ -138,7 +216,19 @@ namespace plateau::polygonMesh {
 
     void MeshExtractor::extract(Model& out_model, const citygml::CityModel& city_model,
                                 const MeshExtractOptions& options) {
-        extractInner(out_model, city_model, options);
+        extractInner(out_model, { &city_model }, options);
+    }
+
+    std::shared_ptr<Model> MeshExtractor::extract(const std::vector<const citygml::CityModel*>& city_models,
+                                                  const MeshExtractOptions& options) {
+        auto result = std::make_shared<Model>();
+        extract(*result, city_models, options);
+        return result;
+    }
+
+    void MeshExtractor::extract(Model& out_model, const std::vector<const citygml::CityModel*>& city_models,
+                                const MeshExtractOptions& options) {
+        extractInner(out_model, city_models, options);
     }
 
     bool MeshExtractor::shouldContainPrimaryMesh(unsigned lod, const citygml::CityObject& primary_obj) {
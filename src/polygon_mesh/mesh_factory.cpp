@@ -8,6 +8,8 @@
 #include <filesystem>
 
 #include "plateau/polygon_mesh/mesh_merger.h"
+#include "plateau/polygon_mesh/polygon_mesh_utils.h"
+#include "polygon_tessellator.h"
 
 
 
@@ -21,43 +23,127 @@ namespace plateau::polygonMesh {
             return !(other_poly.getVertices().empty() || other_poly.getIndices().empty());
         }
 
+        /// 遅延テッセレーションの対象として、外周の頂点を3つ以上持つかどうかを返します。
+        bool hasExteriorRing(const Polygon& polygon) {
+            const auto exterior_ring = polygon.exteriorRing();
+            return exterior_ring != nullptr && exterior_ring->getVertices().size() >= 3;
+        }
+
+        /// ring の頂点のうち、先頭と同じ座標で輪を閉じる末尾の頂点を除いた数を返します。
+        size_t openRingSize(const LinearRing& ring) {
+            const auto& vertices = ring.getVertices();
+            auto size = vertices.size();
+            if (size > 1 && vertices.front() == vertices.back())
+                --size;
+            return size;
+        }
+
+        /**
+         * テッセレーションされていない polygon の外周と穴を PolygonTessellator で三角形に分割します。
+         * 頂点は平面直角座標に変換したうえで分割し、結果を引数で out と名の付くものに格納します。
+         * テクスチャ座標は、テクスチャが各輪に対応付けたものを頂点と同じ順に並べます。
+         */
+        void tessellatePolygon(
+            const Polygon& polygon, const GeoReference& geo_reference,
+            std::vector<TVec3d>& out_vertices, std::vector<unsigned>& out_indices, std::vector<TVec2f>& out_uv_1) {
+
+            std::vector<std::shared_ptr<const LinearRing>> rings;
+            rings.push_back(polygon.exteriorRing());
+            for (const auto& interior_ring : polygon.interiorRings()) {
+                rings.push_back(interior_ring);
+            }
+
+            auto texture_target = polygon.getTextureTargetDefinitionForTheme("rgbTexture", true);
+            if (texture_target == nullptr) {
+                // rgbTextureのthemeが存在しない場合
+                auto themes = polygon.getAllTextureThemes(true);
+                if (!themes.empty())
+                    texture_target = polygon.getTextureTargetDefinitionForTheme(themes.at(0), true);
+            }
+
+            std::vector<std::vector<TVec3d>> projected_rings;
+            projected_rings.reserve(rings.size());
+            for (const auto& ring : rings) {
+                const auto ring_size = openRingSize(*ring);
+                auto& projected_ring = projected_rings.emplace_back();
+                projected_ring.reserve(ring_size);
+                for (size_t i = 0; i < ring_size; ++i) {
+                    projected_ring.push_back(geo_reference.projectWithoutAxisConvert(ring->getVertices()[i]));
+                }
+                out_vertices.insert(out_vertices.end(), projected_ring.begin(), projected_ring.end());
+
+                if (texture_target == nullptr)
+                    continue;
+                // 輪に対応するテクスチャ座標がなければ 0 で埋めます。
+                std::vector<TVec2f> ring_uv;
+                for (unsigned i = 0; i < texture_target->getTextureCoordinatesCount(); ++i) {
+                    const auto texture_coordinates = texture_target->getTextureCoordinates(i);
+                    if (texture_coordinates != nullptr && texture_coordinates->targets(*ring)) {
+                        ring_uv = texture_coordinates->getCoords();
+                        break;
+                    }
+                }
+                ring_uv.resize(ring_size, TVec2f(0, 0));
+                out_uv_1.insert(out_uv_1.end(), ring_uv.begin(), ring_uv.end());
+            }
+
+            out_indices = PolygonTessellator::tessellate(projected_rings);
+            // 向きが反転したポリゴンは、libcitygml のテッセレーションと同様に三角形を裏返します。
+            if (polygon.negNormal()) {
+                for (size_t i = 0; i + 2 < out_indices.size(); i += 3) {
+                    std::swap(out_indices[i + 1], out_indices[i + 2]);
+                }
+            }
+        }
+
         /**
          * Plateau の Polygon を Mesh情報 に変換します。
          * Mesh構築に必要な情報を Polygon から コピーします。すなわち:
          * Vertices を極座標から平面直角座標に変換したうえでコピーします。座標軸は 入力も出力も ENU です。
          * Indices, UV1 をコピーします。SubMeshを生成します。
          * 引数の gml_path は、テクスチャパスを相対から絶対に変換するときの基準パスです。
+         * lazy_tessellation が true で polygon が外周を持つときは、Indices をコピーする代わりに外周と穴を三角形に分割します。
          * 結果は引数で out と名の付くものに格納されます。
          */
         void cityGmlPolygonToMesh(
             const Polygon& polygon, const std::string& gml_path,
-            const GeoReference& geo_reference, Mesh& out_mesh) {
-
-            // マージ対象の情報を取得します。ここでの頂点は極座標です。
-            const auto& vertices_lat_lon = polygon.getVertices();
-            const auto& in_indices = polygon.getIndices();
-            auto in_uv_1 = polygon.getTexCoordsForTheme("rgbTexture", true);
-            // rgbTextureのthemeが存在しない場合
-            if (in_uv_1.empty()) {
-                auto themes = polygon.getAllTextureThemes(true);
-                if (!themes.empty())
-                    in_uv_1 = polygon.getTexCoordsForTheme(themes.at(0), true);
+            const GeoReference& geo_reference, const bool lazy_tessellation, Mesh& out_mesh) {
+
+            auto& out_vertices = out_mesh.getVertices();
+            const bool tessellate = lazy_tessellation && hasExteriorRing(polygon);
+            std::vector<unsigned> tessellated_indices;
+            std::vector<TVec2f> in_uv_1;
+            if (tessellate) {
+                tessellatePolygon(polygon, geo_reference, out_vertices, tessellated_indices, in_uv_1);
+            } else {
+                // マージ対象の情報を取得します。ここでの頂点は極座標です。
+                const auto& vertices_lat_lon = polygon.getVertices();
+                in_uv_1 = polygon.getTexCoordsForTheme("rgbTexture", true);
+                // rgbTextureのthemeが存在しない場合
+                if (in_uv_1.empty()) {
+                    auto themes = polygon.getAllTextureThemes(true);
+                    if (!themes.empty())
+                        in_uv_1 = polygon.getTexCoordsForTheme(themes.at(0), true);
+                }
+
+                if (vertices_lat_lon.empty() || polygon.getIndices().empty())
+                    return;
+
+                // 極座標から平面直角座標へ変換します。
+                out_vertices.reserve(vertices_lat_lon.size());
+                for (const auto& lat_lon : vertices_lat_lon) {
+                    auto xyz = geo_reference.projectWithoutAxisConvert(lat_lon);
+                    out_vertices.push_back(xyz);
+                }
+                assert(out_vertices.size() == vertices_lat_lon.size());
             }
+            const auto& in_indices = tessellate ? tessellated_indices : polygon.getIndices();
 
             assert(in_indices.size() % 3 == 0);
 
-            if (vertices_lat_lon.empty() || in_indices.empty())
+            if (out_vertices.empty() || in_indices.empty())
                 return;
 
-            // 極座標から平面直角座標へ変換します。
-            auto& out_vertices = out_mesh.getVertices();
-            out_vertices.reserve(vertices_lat_lon.size());
-            for (const auto& lat_lon : vertices_lat_lon) {
-                auto xyz = geo_reference.projectWithoutAxisConvert(lat_lon);
-                out_vertices.push_back(xyz);
-            }
-            assert(out_vertices.size() == vertices_lat_lon.size());
-
             // Indicesをコピーします。
             out_mesh.addIndicesList(in_indices, false, false);
 
@@ -65,7 +151,7 @@ namespace plateau::polygonMesh {
             assert(out_mesh.getIndices().size() % 3 == 0);
 
             // UV1をコピーし、頂点数に足りない分を 0 で埋めます。
-            out_mesh.addUV1(in_uv_1, vertices_lat_lon.size());
+            out_mesh.addUV1(in_uv_1, out_vertices.size());
 
             // テクスチャパスを取得し SubMesh を作ります。
             auto texture = polygon.getTextureFor("rgbTexture");
@@ -119,7 +205,7 @@ namespace plateau::polygonMesh {
             for (unsigned int i = 0; i < polygon_count; i++) {
                 const auto& poly = geom.getPolygon(i);
                 polygons.push_back(poly.get());
-                out_vertices_count += static_cast<long long>(poly->getVertices().size());
+                out_vertices_count += static_cast<long long>(PolygonMeshUtils::getPolygonVertices(*poly).size());
             }
         }
 
@@ -139,7 +225,9 @@ namespace plateau::polygonMesh {
             for (unsigned int i = 0; i < polygon_count; i++) {
                 const auto& polygon = geom.getPolygon(i);
                 bool is_in_extent = false;
-                for (const auto& vertex : polygon->getVertices()) {
+                // テッセレーションしていないポリゴンは外周の頂点で判定します。
+                const auto& vertices = PolygonMeshUtils::getPolygonVertices(*polygon);
+                for (const auto& vertex : vertices) {
                     if (extent.contains(vertex)) {
                         is_in_extent = true;
                         break;
@@ -150,7 +238,7 @@ namespace plateau::polygonMesh {
                     continue;
 
                 polygons.push_back(polygon.get());
-                out_vertices_count += static_cast<long long>(polygon->getVertices().size());
+                out_vertices_count += static_cast<long long>(vertices.size());
             }
         }
     }
@@ -183,11 +271,12 @@ namespace plateau::polygonMesh {
     }
 
     void MeshFactory::addPolygon(const Polygon& polygon, const std::string& gml_path) const {
-        if (!isValidPolygon(polygon))
+        const bool lazy_tessellation = options_.enable_lazy_tessellation && hasExteriorRing(polygon);
+        if (!lazy_tessellation && !isValidPolygon(polygon))
             return;
 
         Mesh mesh;
-        cityGmlPolygonToMesh(polygon, gml_path, geo_reference_, mesh);
+        cityGmlPolygonToMesh(polygon, gml_path, geo_reference_, lazy_tessellation, mesh);
 
         const auto from_axis = geometry::CoordinateSystem::ENU;
         const auto to_axis = options_.mesh_axes;
@@ -230,9 +319,12 @@ namespace plateau::polygonMesh {
 
         findAllPolygons(city_object, lod, polygons, vertex_count, extent);
         mesh_->reserve(vertex_count);
+        const auto vertex_count_before = mesh_->getVertexCount();
         for (const auto polygon : polygons) {
             addPolygon(*polygon, gml_path);
         }
+        // 遅延テッセレーションでは穴の頂点も加わるため、UV4 は実際に追加された頂点の数だけ設定します。
+        vertex_count = static_cast<long long>(mesh_->getVertexCount() - vertex_count_before);
 
         const auto& gml_id = city_object.getId();
 
@@ -281,9 +373,11 @@ namespace plateau::polygonMesh {
         std::list<const Polygon*> polygons;
         findAllPolygons(city_object, lod, polygons, vertex_count, extent);
         mesh_->reserve(vertex_count);
+        const auto vertex_count_before = mesh_->getVertexCount();
         for (const auto polygon : polygons) {
             addPolygon(*polygon, gml_path);
         }
+        vertex_count = static_cast<long long>(mesh_->getVertexCount() - vertex_count_before);
 
         mesh_->addUV4WithSameVal(city_object_index.toUV(), vertex_count);
         mesh_->city_object_list_.add(city_object_index, city_object.getId());
@@ -313,9 +407,11 @@ namespace plateau::polygonMesh {
             std::list<const Polygon*> polygons;
             findAllPolygons(*city_object, lod, polygons, vertex_count, extent);
             mesh_->reserve(vertex_count);
+            const auto vertex_count_before = mesh_->getVertexCount();
             for (const auto polygon : polygons) {
                 addPolygon(*polygon, gml_path);
             }
+            vertex_count = static_cast<long long>(mesh_->getVertexCount() - vertex_count_before);
 
             if (vertex_count > 0)
                 mesh_->addUV4WithSameVal(available_city_object_index.toUV(), vertex_count);
@@ -0,0 +1,169 @@
+#include <plateau/polygon_mesh/mesh_instancer.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+
+namespace plateau::polygonMesh {
+    namespace {
+        /// メッシュの形状を、範囲の最小点を原点とした量子化座標で表したものです。
+        struct Shape {
+            const Mesh* mesh;
+            TVec3d origin;
+            std::vector<int64_t> positions;
+            uint64_t hash;
+        };
+
+        class Fnv1a {
+        public:
+            void add(const void* data, size_t size) {
+                const auto* bytes = static_cast<const unsigned char*>(data);
+                for (size_t i = 0; i < size; ++i) {
+                    hash_ ^= bytes[i];
+                    hash_ *= 1099511628211ull;
+                }
+            }
+
+            template<typename T>
+            void addArray(const std::vector<T>& array) {
+                add(array.data(), array.size() * sizeof(T));
+            }
+
+            uint64_t get() const {
+                return hash_;
+            }
+
+        private:
+            uint64_t hash_ = 14695981039346656037ull;
+        };
+
+        Shape createShape(const Mesh& mesh, double tolerance) {
+            Shape shape{ &mesh, TVec3d(0, 0, 0), {}, 0 };
+            const auto& vertices = mesh.getVertices();
+            TVec3d min(std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+            for (const auto& vertex : vertices) {
+                min = TVec3d(std::min(min.x, vertex.x), std::min(min.y, vertex.y), std::min(min.z, vertex.z));
+            }
+            shape.origin = min;
+
+            shape.positions.reserve(vertices.size() * 3);
+            for (const auto& vertex : vertices) {
+                const auto relative = vertex - min;
+                shape.positions.push_back(std::llround(relative.x / tolerance));
+                shape.positions.push_back(std::llround(relative.y / tolerance));
+                shape.positions.push_back(std::llround(relative.z / tolerance));
+            }
+
+            Fnv1a hash;
+            hash.addArray(shape.positions);
+            hash.addArray(mesh.getIndices());
+            hash.addArray(mesh.getUV1());
+            for (const auto& sub_mesh : mesh.getSubMeshes()) {
+                const uint64_t range[2] = { sub_mesh.getStartIndex(), sub_mesh.getEndIndex() };
+                hash.add(range, sizeof(range));
+                const auto texture_hash = std::hash<std::string>()(sub_mesh.getTexturePath());
+                hash.add(&texture_hash, sizeof(texture_hash));
+            }
+            shape.hash = hash.get();
+            return shape;
+        }
+
+        bool isSameShape(const Shape& a, const Shape& b) {
+            const auto& mesh_a = *a.mesh;
+            const auto& mesh_b = *b.mesh;
+            if (a.positions != b.positions || mesh_a.getIndices() != mesh_b.getIndices())
+                return false;
+            const auto& uv_a = mesh_a.getUV1();
+            const auto& uv_b = mesh_b.getUV1();
+            if (uv_a.size() != uv_b.size() ||
+                (!uv_a.empty() && std::memcmp(uv_a.data(), uv_b.data(), uv_a.size() * sizeof(TVec2f)) != 0))
+                return false;
+            const auto& sub_meshes_a = mesh_a.getSubMeshes();
+            const auto& sub_meshes_b = mesh_b.getSubMeshes();
+            if (sub_meshes_a.size() != sub_meshes_b.size())
+                return false;
+            for (size_t i = 0; i < sub_meshes_a.size(); ++i) {
+                const auto& sub_a = sub_meshes_a[i];
+                const auto& sub_b = sub_meshes_b[i];
+                if (sub_a.getStartIndex() != sub_b.getStartIndex() || sub_a.getEndIndex() != sub_b.getEndIndex() ||
+                    sub_a.getTexturePath() != sub_b.getTexturePath() || sub_a.getMaterial() != sub_b.getMaterial())
+                    return false;
+            }
+            return true;
+        }
+
+        /// インスタンス化の対象となるメッシュを持つノードを集めます。
+        void collectNodesRecursive(Node& node, std::vector<Node*>& out_nodes) {
+            // float の頂点しか持たないメッシュと、既にインスタンスを持つノードは対象外とします。
+            const auto mesh = node.getMesh();
+            if (node.polygonExists() && !node.isInstanced() && !mesh->hasFloatVertices())
+                out_nodes.push_back(&node);
+            for (size_t i = 0; i < node.getChildCount(); ++i) {
+                collectNodesRecursive(node.getChildAt(i), out_nodes);
+            }
+        }
+    }
+
+    size_t MeshInstancer::instantiate(Model& model, double tolerance) {
+        size_t removed_mesh_count = 0;
+        for (size_t i = 0; i < model.getRootNodeCount(); ++i) {
+            removed_mesh_count += instantiateInRoot(model.getRootNodeAt(i), tolerance);
+        }
+
+        if (removed_mesh_count > 0)
+            model.eraseEmptyNodes();
+        return removed_mesh_count;
+    }
+
+    size_t MeshInstancer::instantiateInRoot(Node& root_node, double tolerance) {
+        std::vector<Node*> nodes;
+        collectNodesRecursive(root_node, nodes);
+
+        std::vector<Shape> shapes;
+        shapes.reserve(nodes.size());
+        for (const auto node : nodes) {
+            shapes.push_back(createShape(*node->getMesh(), tolerance));
+        }
+
+        // ハッシュで候補を絞り、形状を比較してグループに分けます。グループは最初に見つかった順に並びます。
+        std::vector<std::vector<size_t>> groups;
+        std::unordered_map<uint64_t, std::vector<size_t>> hash_to_groups;
+        for (size_t i = 0; i < shapes.size(); ++i) {
+            auto& candidates = hash_to_groups[shapes[i].hash];
+            bool found = false;
+            for (const auto group_index : candidates) {
+                if (isSameShape(shapes[groups[group_index].front()], shapes[i])) {
+                    groups[group_index].push_back(i);
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                candidates.push_back(groups.size());
+                groups.push_back({ i });
+            }
+        }
+
+        size_t removed_mesh_count = 0;
+        for (const auto& group : groups) {
+            if (group.size() < 2)
+                continue;
+            auto& prototype = *nodes[group.front()];
+            auto& prototype_mesh = *prototype.getMesh();
+            const auto prototype_origin = shapes[group.front()].origin;
+            for (auto& vertex : prototype_mesh.vertices_) {
+                vertex = vertex - prototype_origin;
+            }
+            for (const auto index : group) {
+                prototype.addInstance(nodes[index]->getName(), shapes[index].origin);
+            }
+            for (size_t i = 1; i < group.size(); ++i) {
+                nodes[group[i]]->setMesh(nullptr);
+                ++removed_mesh_count;
+            }
+        }
+        return removed_mesh_count;
+    }
+}
@@ -7,17 +7,17 @@ namespace plateau::polygonMesh {
 
     namespace {
         bool isValidMesh(const Mesh& mesh) {
-            return !(mesh.getVertices().empty() || mesh.getIndices().empty());
+            return !(mesh.getVertexCount() == 0 || mesh.getIndices().empty());
         }
 
         /**
          * @brief SubMesh以外の形状情報をマージします。
          */
         void mergeShape(Mesh& mesh, const Mesh& other_mesh, const bool invert_mesh_front_back) {
-            const auto vertex_count = mesh.getVertices().size();
-            const auto other_vertex_count = other_mesh.getVertices().size();
+            const auto vertex_count = mesh.getVertexCount();
+            const auto other_vertex_count = other_mesh.getVertexCount();
 
-            mesh.addVerticesList(other_mesh.getVertices());
+            mesh.addVerticesList(other_mesh);
             mesh.addIndicesList(other_mesh.getIndices(), static_cast<unsigned>(vertex_count), invert_mesh_front_back);
             mesh.addUV1(other_mesh.getUV1(), static_cast<unsigned>(other_vertex_count));
             mesh.addUV4(other_mesh.getUV4(), static_cast<unsigned>(other_vertex_count));
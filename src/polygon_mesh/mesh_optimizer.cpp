@@ -0,0 +1,363 @@
+#include <plateau/polygon_mesh/mesh_optimizer.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace plateau::polygonMesh {
+    namespace {
+        /// UV1, UV4 の要素数が頂点数と一致しているか (または空か) を判定します。
+        bool hasConsistentAttributes(const Mesh& mesh) {
+            const auto vertex_count = mesh.getVertexCount();
+            if (mesh.getIndices().size() % 3 != 0)
+                return false;
+            if (!mesh.getUV1().empty() && mesh.getUV1().size() != vertex_count)
+                return false;
+            if (!mesh.getUV4().empty() && mesh.getUV4().size() != vertex_count)
+                return false;
+            return std::all_of(mesh.getIndices().begin(), mesh.getIndices().end(),
+                               [vertex_count](unsigned index) { return index < vertex_count; });
+        }
+
+        template<typename T>
+        std::vector<T> gather(const std::vector<T>& src, const std::vector<unsigned>& new_to_old) {
+            if (src.empty())
+                return {};
+            std::vector<T> result;
+            result.reserve(new_to_old.size());
+            for (const auto old_index : new_to_old) {
+                result.push_back(src[old_index]);
+            }
+            return result;
+        }
+
+        uint32_t floatBits(float value) {
+            // -0.0 と 0.0 を同一視します。
+            value += 0.0f;
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        struct WeldKey {
+            int64_t position[3];
+            int32_t normal[3];
+            uint32_t uv1[2];
+            uint32_t uv4[2];
+            int64_t sub_mesh;
+
+            bool operator==(const WeldKey& other) const {
+                return std::memcmp(this, &other, sizeof(WeldKey)) == 0;
+            }
+        };
+
+        struct WeldKeyHash {
+            size_t operator()(const WeldKey& key) const {
+                // FNV-1a
+                const auto* bytes = reinterpret_cast<const unsigned char*>(&key);
+                uint64_t hash = 14695981039346656037ull;
+                for (size_t i = 0; i < sizeof(WeldKey); ++i) {
+                    hash ^= bytes[i];
+                    hash *= 1099511628211ull;
+                }
+                return static_cast<size_t>(hash);
+            }
+        };
+
+        /**
+         * Forsyth のアルゴリズム (Linear-Speed Vertex Cache Optimisation) で使う定数と評価関数です。
+         * https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+         */
+        namespace forsyth {
+            constexpr int cache_size = 32;
+            constexpr float cache_decay_power = 1.5f;
+            constexpr float last_tri_score = 0.75f;
+            constexpr float valence_boost_scale = 2.0f;
+            constexpr float valence_boost_power = 0.5f;
+
+            float vertexScore(int cache_position, unsigned remaining_triangles) {
+                if (remaining_triangles == 0)
+                    return -1.0f;
+
+                float score = 0.0f;
+                if (cache_position >= 0) {
+                    if (cache_position < 3) {
+                        // 直前の三角形の頂点は、どの順番で使っても同じなので固定のスコアとします。
+                        score = last_tri_score;
+                    } else {
+                        const float scaler = 1.0f / (cache_size - 3);
+                        score = std::pow(1.0f - static_cast<float>(cache_position - 3) * scaler, cache_decay_power);
+                    }
+                }
+                // 残りの三角形が少ない頂点を優先して片付けます。
+                score += valence_boost_scale * std::pow(static_cast<float>(remaining_triangles), -valence_boost_power);
+                return score;
+            }
+        }
+
+        /**
+         * indices の [first, last) の範囲の三角形を、頂点キャッシュ効率の良い順に並べ替えます。
+         * local_ids は頂点数の大きさを持ち、すべて -1 で初期化されている必要があります。関数の終了時に -1 に戻します。
+         */
+        void reorderTrianglesInRange(std::vector<unsigned>& indices, size_t first, size_t last, std::vector<int>& local_ids) {
+            const auto triangle_count = (last - first) / 3;
+            if (triangle_count <= 1)
+                return;
+
+            // 範囲内の頂点にローカルな番号を振ります。
+            std::vector<unsigned> local_to_global;
+            std::vector<unsigned> local_indices(last - first);
+            for (size_t i = first; i < last; ++i) {
+                auto& local_id = local_ids[indices[i]];
+                if (local_id < 0) {
+                    local_id = static_cast<int>(local_to_global.size());
+                    local_to_global.push_back(indices[i]);
+                }
+                local_indices[i - first] = static_cast<unsigned>(local_id);
+            }
+            const auto vertex_count = local_to_global.size();
+
+            // 頂点 → 三角形 の隣接リストを作ります。
+            std::vector<unsigned> remaining(vertex_count, 0);
+            for (const auto local_index : local_indices) {
+                ++remaining[local_index];
+            }
+            std::vector<size_t> adjacency_offsets(vertex_count + 1, 0);
+            for (size_t v = 0; v < vertex_count; ++v) {
+                adjacency_offsets[v + 1] = adjacency_offsets[v] + remaining[v];
+            }
+            std::vector<unsigned> adjacency(local_indices.size());
+            {
+                auto fill_positions = adjacency_offsets;
+                for (size_t t = 0; t < triangle_count; ++t) {
+                    for (int k = 0; k < 3; ++k) {
+                        adjacency[fill_positions[local_indices[t * 3 + k]]++] = static_cast<unsigned>(t);
+                    }
+                }
+            }
+
+            std::vector<int> cache_positions(vertex_count, -1);
+            std::vector<float> vertex_scores(vertex_count);
+            for (size_t v = 0; v < vertex_count; ++v) {
+                vertex_scores[v] = forsyth::vertexScore(-1, remaining[v]);
+            }
+            std::vector<float> triangle_scores(triangle_count);
+            std::vector<bool> triangle_added(triangle_count, false);
+            for (size_t t = 0; t < triangle_count; ++t) {
+                triangle_scores[t] = vertex_scores[local_indices[t * 3]] + vertex_scores[local_indices[t * 3 + 1]] +
+                                     vertex_scores[local_indices[t * 3 + 2]];
+            }
+
+            auto best_triangle = static_cast<long long>(
+                std::max_element(triangle_scores.begin(), triangle_scores.end()) - triangle_scores.begin());
+            size_t next_unadded = 0;
+            std::vector<unsigned> cache;
+            std::vector<unsigned> new_cache;
+            std::vector<unsigned> reordered;
+            reordered.reserve(local_indices.size());
+
+            for (size_t n = 0; n < triangle_count; ++n) {
+                if (best_triangle < 0) {
+                    // キャッシュ内に候補がなければ、未追加の三角形を先頭から探します。
+                    while (triangle_added[next_unadded]) ++next_unadded;
+                    best_triangle = static_cast<long long>(next_unadded);
+                }
+                const auto tri = static_cast<size_t>(best_triangle);
+                triangle_added[tri] = true;
+
+                // 三角形を出力し、各頂点の未処理の隣接三角形から取り除きます。
+                new_cache.clear();
+                for (int k = 0; k < 3; ++k) {
+                    const auto v = local_indices[tri * 3 + k];
+                    reordered.push_back(local_to_global[v]);
+                    new_cache.push_back(v);
+
+                    const auto begin = adjacency.begin() + static_cast<long long>(adjacency_offsets[v]);
+                    const auto end = begin + remaining[v];
+                    const auto found = std::find(begin, end, static_cast<unsigned>(tri));
+                    std::iter_swap(found, end - 1);
+                    --remaining[v];
+                }
+
+                // LRU キャッシュを更新します。
+                for (const auto v : cache) {
+                    if (std::find(new_cache.begin(), new_cache.end(), v) == new_cache.end())
+                        new_cache.push_back(v);
+                }
+                for (size_t i = 0; i < new_cache.size(); ++i) {
+                    const auto v = new_cache[i];
+                    cache_positions[v] = i < static_cast<size_t>(forsyth::cache_size) ? static_cast<int>(i) : -1;
+                    vertex_scores[v] = forsyth::vertexScore(cache_positions[v], remaining[v]);
+                }
+
+                // スコアが変わった頂点に隣接する三角形のスコアを更新し、次の三角形を選びます。
+                best_triangle = -1;
+                float best_score = -1.0f;
+                for (const auto v : new_cache) {
+                    const auto begin = adjacency_offsets[v];
+                    for (size_t a = begin; a < begin + remaining[v]; ++a) {
+                        const auto t = adjacency[a];
+                        const auto score = vertex_scores[local_indices[t * 3]] + vertex_scores[local_indices[t * 3 + 1]] +
+                                           vertex_scores[local_indices[t * 3 + 2]];
+                        triangle_scores[t] = score;
+                        if (score > best_score) {
+                            best_score = score;
+                            best_triangle = t;
+                        }
+                    }
+                }
+                if (new_cache.size() > static_cast<size_t>(forsyth::cache_size))
+                    new_cache.resize(forsyth::cache_size);
+                cache.swap(new_cache);
+            }
+
+            std::copy(reordered.begin(), reordered.end(), indices.begin() + static_cast<long long>(first));
+            for (const auto global_id : local_to_global) {
+                local_ids[global_id] = -1;
+            }
+        }
+    }
+
+    void MeshOptimizer::optimize(Mesh& mesh, double weld_tolerance) {
+        if (!hasConsistentAttributes(mesh))
+            return;
+        weldVertices(mesh, weld_tolerance);
+        optimizeVertexCache(mesh);
+        optimizeVertexFetch(mesh);
+    }
+
+    void MeshOptimizer::optimize(Model& model, double weld_tolerance) {
+        std::vector<Node*> nodes;
+        for (size_t i = 0; i < model.getRootNodeCount(); ++i) {
+            nodes.push_back(&model.getRootNodeAt(i));
+        }
+        while (!nodes.empty()) {
+            auto& node = *nodes.back();
+            nodes.pop_back();
+            if (node.getMesh() != nullptr)
+                optimize(*node.getMesh(), weld_tolerance);
+            for (unsigned i = 0; i < node.getChildCount(); ++i) {
+                nodes.push_back(&node.getChildAt(i));
+            }
+        }
+    }
+
+    void MeshOptimizer::weldVertices(Mesh& mesh, double weld_tolerance) {
+        const auto vertex_count = mesh.getVertexCount();
+        if (vertex_count == 0 || !hasConsistentAttributes(mesh))
+            return;
+        if (weld_tolerance <= 0)
+            weld_tolerance = default_weld_tolerance;
+
+        // 頂点ごとに、最初に参照する三角形の法線と SubMesh を記録します。
+        // これらをキーに含めることで、異なる面やテクスチャの頂点が溶接されるのを防ぎます。
+        std::vector<TVec3d> normals(vertex_count, TVec3d(0, 0, 0));
+        std::vector<int64_t> sub_mesh_ids(vertex_count, -1);
+        const auto& indices = mesh.indices_;
+        const auto& sub_meshes = mesh.getSubMeshes();
+        for (size_t s = 0; s < sub_meshes.size(); ++s) {
+            const auto end = std::min(sub_meshes[s].getEndIndex() + 1, indices.size());
+            for (size_t i = sub_meshes[s].getStartIndex(); i + 2 < end; i += 3) {
+                const auto v0 = mesh.getVertexAt(indices[i]);
+                const auto v1 = mesh.getVertexAt(indices[i + 1]);
+                const auto v2 = mesh.getVertexAt(indices[i + 2]);
+                auto normal = (v1 - v0).cross(v2 - v0);
+                const auto length = normal.length();
+                if (length > 0)
+                    normal = normal / length;
+                for (size_t k = 0; k < 3; ++k) {
+                    const auto v = indices[i + k];
+                    if (sub_mesh_ids[v] >= 0)
+                        continue;
+                    sub_mesh_ids[v] = static_cast<int64_t>(s);
+                    normals[v] = normal;
+                }
+            }
+        }
+
+        std::unordered_map<WeldKey, unsigned, WeldKeyHash> key_to_new_index;
+        key_to_new_index.reserve(vertex_count);
+        std::vector<unsigned> old_to_new(vertex_count);
+        std::vector<unsigned> new_to_old;
+        new_to_old.reserve(vertex_count);
+        constexpr double normal_quantization = 64.0;
+        for (size_t v = 0; v < vertex_count; ++v) {
+            WeldKey key;
+            std::memset(&key, 0, sizeof(WeldKey));
+            const auto position = mesh.getVertexAt(v);
+            key.position[0] = std::llround(position.x / weld_tolerance);
+            key.position[1] = std::llround(position.y / weld_tolerance);
+            key.position[2] = std::llround(position.z / weld_tolerance);
+            key.normal[0] = static_cast<int32_t>(std::lround(normals[v].x * normal_quantization));
+            key.normal[1] = static_cast<int32_t>(std::lround(normals[v].y * normal_quantization));
+            key.normal[2] = static_cast<int32_t>(std::lround(normals[v].z * normal_quantization));
+            if (!mesh.uv1_.empty()) {
+                key.uv1[0] = floatBits(mesh.uv1_[v].x);
+                key.uv1[1] = floatBits(mesh.uv1_[v].y);
+            }
+            if (!mesh.uv4_.empty()) {
+                key.uv4[0] = floatBits(mesh.uv4_[v].x);
+                key.uv4[1] = floatBits(mesh.uv4_[v].y);
+            }
+            key.sub_mesh = sub_mesh_ids[v];
+
+            const auto [found, inserted] = key_to_new_index.emplace(key, static_cast<unsigned>(new_to_old.size()));
+            if (inserted)
+                new_to_old.push_back(static_cast<unsigned>(v));
+            old_to_new[v] = found->second;
+        }
+
+        if (new_to_old.size() == vertex_count)
+            return;
+
+        for (auto& index : mesh.indices_) {
+            index = old_to_new[index];
+        }
+        mesh.vertices_ = gather(mesh.vertices_, new_to_old);
+        mesh.float_vertices_ = gather(mesh.float_vertices_, new_to_old);
+        mesh.uv1_ = gather(mesh.uv1_, new_to_old);
+        mesh.uv4_ = gather(mesh.uv4_, new_to_old);
+    }
+
+    void MeshOptimizer::optimizeVertexCache(Mesh& mesh) {
+        if (!hasConsistentAttributes(mesh))
+            return;
+        auto& indices = mesh.indices_;
+        std::vector<int> local_ids(mesh.getVertexCount(), -1);
+        for (const auto& sub_mesh : mesh.getSubMeshes()) {
+            const auto first = sub_mesh.getStartIndex();
+            const auto last = sub_mesh.getEndIndex() + 1;
+            if (first % 3 != 0 || last % 3 != 0 || last > indices.size())
+                continue;
+            reorderTrianglesInRange(indices, first, last, local_ids);
+        }
+    }
+
+    void MeshOptimizer::optimizeVertexFetch(Mesh& mesh) {
+        if (!hasConsistentAttributes(mesh))
+            return;
+        constexpr auto not_assigned = std::numeric_limits<unsigned>::max();
+        std::vector<unsigned> old_to_new(mesh.getVertexCount(), not_assigned);
+        std::vector<unsigned> new_to_old;
+        new_to_old.reserve(mesh.getVertexCount());
+        for (auto& index : mesh.indices_) {
+            auto& new_index = old_to_new[index];
+            if (new_index == not_assigned) {
+                new_index = static_cast<unsigned>(new_to_old.size());
+                new_to_old.push_back(index);
+            }
+            index = new_index;
+        }
+        mesh.vertices_ = gather(mesh.vertices_, new_to_old);
+        mesh.float_vertices_ = gather(mesh.float_vertices_, new_to_old);
+        mesh.uv1_ = gather(mesh.uv1_, new_to_old);
+        mesh.uv4_ = gather(mesh.uv4_, new_to_old);
+    }
+
+    bool MeshOptimizer::fitsIn16BitIndices(const Mesh& mesh) {
+        // 65535 はプリミティブリスタートに使われることがあるため除外します。
+        return mesh.getVertexCount() < 0xFFFF;
+    }
+}
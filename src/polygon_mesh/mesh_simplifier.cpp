@@ -0,0 +1,536 @@
+#include <plateau/polygon_mesh/mesh_simplifier.h>
+#include <plateau/polygon_mesh/mesh_optimizer.h>
+#include "../util/parallel_for.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+namespace plateau::polygonMesh {
+    namespace {
+        /// 対称な 4x4 行列で表される二次誤差です。上三角の10要素を保持します。
+        struct Quadric {
+            // xx, xy, xz, xw, yy, yz, yw, zz, zw, ww
+            std::array<double, 10> m = {};
+
+            static Quadric fromPlane(const TVec3d& normal, double d, double weight) {
+                const auto a = normal.x;
+                const auto b = normal.y;
+                const auto c = normal.z;
+                Quadric q;
+                q.m = { a * a, a * b, a * c, a * d, b * b, b * c, b * d, c * c, c * d, d * d };
+                for (auto& value : q.m) {
+                    value *= weight;
+                }
+                return q;
+            }
+
+            void add(const Quadric& other) {
+                for (size_t i = 0; i < m.size(); ++i) {
+                    m[i] += other.m[i];
+                }
+            }
+
+            /// 位置 p における誤差 (面からの距離の2乗の重み付き和) を返します。
+            double evaluate(const TVec3d& p) const {
+                const auto x = p.x;
+                const auto y = p.y;
+                const auto z = p.z;
+                return m[0] * x * x + 2 * m[1] * x * y + 2 * m[2] * x * z + 2 * m[3] * x
+                       + m[4] * y * y + 2 * m[5] * y * z + 2 * m[6] * y
+                       + m[7] * z * z + 2 * m[8] * z
+                       + m[9];
+            }
+        };
+
+        /// 位置と属性がすべて一致する頂点を同一とみなすためのキーです。
+        struct VertexKey {
+            std::array<int64_t, 3> position;
+            std::array<uint32_t, 4> uv;
+            int64_t sub_mesh;
+
+            bool operator==(const VertexKey& other) const {
+                return position == other.position && uv == other.uv && sub_mesh == other.sub_mesh;
+            }
+        };
+
+        struct VertexKeyHash {
+            size_t operator()(const VertexKey& key) const {
+                size_t hash = std::hash<int64_t>()(key.sub_mesh);
+                const auto combine = [&hash](size_t value) {
+                    hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+                };
+                for (const auto value : key.position) combine(std::hash<int64_t>()(value));
+                for (const auto value : key.uv) combine(std::hash<uint32_t>()(value));
+                return hash;
+            }
+        };
+
+        struct PositionHash {
+            size_t operator()(const std::array<int64_t, 3>& position) const {
+                return std::hash<int64_t>()(position[0]) * 73856093u
+                       ^ std::hash<int64_t>()(position[1]) * 19349663u
+                       ^ std::hash<int64_t>()(position[2]) * 83492791u;
+            }
+        };
+
+        uint32_t floatBits(float value) {
+            value += 0.0f;
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        template<typename T>
+        std::vector<T> gather(const std::vector<T>& src, const std::vector<unsigned>& new_to_old) {
+            if (src.empty())
+                return {};
+            std::vector<T> result;
+            result.reserve(new_to_old.size());
+            for (const auto old_index : new_to_old) {
+                result.push_back(src[old_index]);
+            }
+            return result;
+        }
+
+        /// 頂点 from を頂点 to に寄せる縮約の候補です。
+        struct Collapse {
+            double cost;
+            unsigned from;
+            unsigned to;
+            unsigned from_version;
+            unsigned to_version;
+
+            bool operator>(const Collapse& other) const {
+                return cost > other.cost;
+            }
+        };
+
+        /**
+         * 1つのメッシュの縮約処理です。
+         * 位置と属性が同じ頂点を1つにまとめたうえで (内部頂点)、内部頂点どうしをつなぐ辺を誤差の小さい順に縮約します。
+         */
+        class SimplifyContext {
+        public:
+            SimplifyContext(const Mesh& mesh, const std::vector<unsigned>& triangle_sub_mesh)
+                : mesh_(mesh), triangle_sub_mesh_(triangle_sub_mesh) {
+                buildInternalVertices();
+                buildTriangles();
+                lockSeamAndBorderVertices();
+                computeQuadrics();
+            }
+
+            void run(size_t target_triangle_count, double max_error) {
+                std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>> heap;
+                for (unsigned v = 0; v < positions_.size(); ++v) {
+                    pushCollapses(v, heap);
+                }
+
+                const auto max_cost = max_error * max_error;
+                while (live_triangle_count_ > target_triangle_count && !heap.empty()) {
+                    const auto collapse = heap.top();
+                    heap.pop();
+                    if (collapse.cost > max_cost)
+                        break;
+                    if (removed_[collapse.from] || removed_[collapse.to] ||
+                        versions_[collapse.from] != collapse.from_version ||
+                        versions_[collapse.to] != collapse.to_version)
+                        continue;
+                    if (!canCollapse(collapse.from, collapse.to))
+                        continue;
+                    applyCollapse(collapse.from, collapse.to);
+                    pushCollapses(collapse.to, heap);
+                }
+            }
+
+            /**
+             * 縮約の結果を、SubMesh ごとに並べた Indices として出力します。
+             * out_new_to_old には、出力の頂点番号ごとに元のメッシュの頂点番号が入ります。
+             */
+            void buildResult(const std::vector<SubMesh>& sub_meshes, std::vector<unsigned>& out_indices,
+                             std::vector<unsigned>& out_new_to_old, std::vector<SubMesh>& out_sub_meshes) const {
+                std::vector<unsigned> new_index_of(positions_.size(), std::numeric_limits<unsigned>::max());
+                for (const auto& sub_mesh : sub_meshes) {
+                    const auto start = out_indices.size();
+                    const auto first_triangle = sub_mesh.getStartIndex() / 3;
+                    const auto last_triangle = (sub_mesh.getEndIndex() + 1) / 3;
+                    for (auto t = first_triangle; t < last_triangle; ++t) {
+                        if (triangle_removed_[t])
+                            continue;
+                        for (const auto v : triangles_[t]) {
+                            auto& new_index = new_index_of[v];
+                            if (new_index == std::numeric_limits<unsigned>::max()) {
+                                new_index = static_cast<unsigned>(out_new_to_old.size());
+                                out_new_to_old.push_back(representatives_[v]);
+                            }
+                            out_indices.push_back(new_index);
+                        }
+                    }
+                    if (out_indices.size() > start) {
+                        out_sub_meshes.emplace_back(start, out_indices.size() - 1,
+                                                    sub_mesh.getTexturePath(), sub_mesh.getMaterial());
+                    }
+                }
+            }
+
+        private:
+            void buildInternalVertices() {
+                const auto vertex_count = mesh_.getVertexCount();
+                const auto& indices = mesh_.getIndices();
+                std::vector<int64_t> vertex_sub_mesh(vertex_count, -1);
+                for (size_t i = 0; i < indices.size(); ++i) {
+                    auto& sub_mesh = vertex_sub_mesh[indices[i]];
+                    if (sub_mesh < 0)
+                        sub_mesh = triangle_sub_mesh_[i / 3];
+                }
+
+                const auto& uv1 = mesh_.getUV1();
+                const auto& uv4 = mesh_.getUV4();
+                std::unordered_map<VertexKey, unsigned, VertexKeyHash> key_to_internal;
+                key_to_internal.reserve(vertex_count);
+                to_internal_.resize(vertex_count);
+                for (size_t v = 0; v < vertex_count; ++v) {
+                    const auto position = mesh_.getVertexAt(v);
+                    VertexKey key = {};
+                    key.position = quantize(position);
+                    if (!uv1.empty()) {
+                        key.uv[0] = floatBits(uv1[v].x);
+                        key.uv[1] = floatBits(uv1[v].y);
+                    }
+                    if (!uv4.empty()) {
+                        key.uv[2] = floatBits(uv4[v].x);
+                        key.uv[3] = floatBits(uv4[v].y);
+                    }
+                    key.sub_mesh = vertex_sub_mesh[v];
+                    const auto [found, inserted] = key_to_internal.emplace(key, static_cast<unsigned>(positions_.size()));
+                    if (inserted) {
+                        positions_.push_back(position);
+                        representatives_.push_back(static_cast<unsigned>(v));
+                        sub_mesh_of_.push_back(vertex_sub_mesh[v]);
+                    }
+                    to_internal_[v] = found->second;
+                }
+                removed_.assign(positions_.size(), false);
+                locked_.assign(positions_.size(), false);
+                versions_.assign(positions_.size(), 0);
+                vertex_triangles_.resize(positions_.size());
+            }
+
+            void buildTriangles() {
+                const auto& indices = mesh_.getIndices();
+                const auto triangle_count = indices.size() / 3;
+                triangles_.resize(triangle_count);
+                triangle_removed_.assign(triangle_count, false);
+                live_triangle_count_ = 0;
+                for (unsigned t = 0; t < triangle_count; ++t) {
+                    auto& triangle = triangles_[t];
+                    for (int k = 0; k < 3; ++k) {
+                        triangle[k] = to_internal_[indices[t * 3 + k]];
+                    }
+                    // 溶接で潰れた三角形は取り除きます。
+                    if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[2] == triangle[0]) {
+                        triangle_removed_[t] = true;
+                        continue;
+                    }
+                    for (const auto v : triangle) {
+                        vertex_triangles_[v].push_back(t);
+                    }
+                    ++live_triangle_count_;
+                }
+            }
+
+            void lockSeamAndBorderVertices() {
+                // 同じ位置に属性の異なる頂点があれば、そこは SubMesh, UV1, UV4 の境目なので固定します。
+                std::unordered_map<std::array<int64_t, 3>, unsigned, PositionHash> position_counts;
+                for (const auto& position : positions_) {
+                    ++position_counts[quantize(position)];
+                }
+                for (unsigned v = 0; v < positions_.size(); ++v) {
+                    if (position_counts[quantize(positions_[v])] > 1)
+                        locked_[v] = true;
+                }
+
+                // 1つの三角形にしか使われない辺 (縁) と、3つ以上の三角形に使われる辺の頂点を固定します。
+                // 複数の SubMesh から参照される頂点も固定します。
+                std::unordered_map<uint64_t, unsigned> edge_counts;
+                for (unsigned t = 0; t < triangles_.size(); ++t) {
+                    if (triangle_removed_[t])
+                        continue;
+                    for (int k = 0; k < 3; ++k) {
+                        ++edge_counts[edgeKey(triangles_[t][k], triangles_[t][(k + 1) % 3])];
+                        if (sub_mesh_of_[triangles_[t][k]] != static_cast<int64_t>(triangle_sub_mesh_[t]))
+                            locked_[triangles_[t][k]] = true;
+                    }
+                }
+                for (const auto& [key, count] : edge_counts) {
+                    if (count == 2)
+                        continue;
+                    locked_[static_cast<unsigned>(key >> 32)] = true;
+                    locked_[static_cast<unsigned>(key & 0xFFFFFFFFu)] = true;
+                }
+            }
+
+            void computeQuadrics() {
+                quadrics_.assign(positions_.size(), Quadric());
+                for (unsigned t = 0; t < triangles_.size(); ++t) {
+                    if (triangle_removed_[t])
+                        continue;
+                    const auto& triangle = triangles_[t];
+                    const auto& p0 = positions_[triangle[0]];
+                    auto normal = (positions_[triangle[1]] - p0).cross(positions_[triangle[2]] - p0);
+                    const auto double_area = normal.length();
+                    if (double_area <= 0)
+                        continue;
+                    normal = normal / double_area;
+                    const auto d = -normal.dot(p0);
+                    const auto quadric = Quadric::fromPlane(normal, d, double_area * 0.5);
+                    for (const auto v : triangle) {
+                        quadrics_[v].add(quadric);
+                    }
+                }
+            }
+
+            template<typename Heap>
+            void pushCollapses(unsigned v, Heap& heap) {
+                collectNeighbors(v, neighbors_);
+                for (const auto neighbor : neighbors_) {
+                    if (!locked_[v])
+                        heap.push(makeCollapse(v, neighbor));
+                    if (!locked_[neighbor])
+                        heap.push(makeCollapse(neighbor, v));
+                }
+            }
+
+            Collapse makeCollapse(unsigned from, unsigned to) const {
+                auto quadric = quadrics_[from];
+                quadric.add(quadrics_[to]);
+                return { quadric.evaluate(positions_[to]), from, to, versions_[from], versions_[to] };
+            }
+
+            void collectNeighbors(unsigned v, std::vector<unsigned>& out_neighbors) const {
+                out_neighbors.clear();
+                for (const auto t : vertex_triangles_[v]) {
+                    if (triangle_removed_[t])
+                        continue;
+                    for (const auto other : triangles_[t]) {
+                        if (other != v)
+                            out_neighbors.push_back(other);
+                    }
+                }
+                std::sort(out_neighbors.begin(), out_neighbors.end());
+                out_neighbors.erase(std::unique(out_neighbors.begin(), out_neighbors.end()), out_neighbors.end());
+            }
+
+            bool canCollapse(unsigned from, unsigned to) {
+                size_t shared_triangle_count = 0;
+                for (const auto t : vertex_triangles_[from]) {
+                    if (triangle_removed_[t])
+                        continue;
+                    const auto& triangle = triangles_[t];
+                    if (std::find(triangle.begin(), triangle.end(), to) != triangle.end()) {
+                        ++shared_triangle_count;
+                        continue;
+                    }
+
+                    // 縮約によって面が裏返ったり潰れたりしないかを確認します。
+                    std::array<TVec3d, 3> before;
+                    std::array<TVec3d, 3> after;
+                    for (int k = 0; k < 3; ++k) {
+                        before[k] = positions_[triangle[k]];
+                        after[k] = triangle[k] == from ? positions_[to] : before[k];
+                    }
+                    const auto normal_before = (before[1] - before[0]).cross(before[2] - before[0]);
+                    const auto normal_after = (after[1] - after[0]).cross(after[2] - after[0]);
+                    const auto length_after = normal_after.length();
+                    if (length_after <= std::numeric_limits<double>::epsilon())
+                        return false;
+                    if (normal_before.dot(normal_after) <= 0)
+                        return false;
+                }
+                if (shared_triangle_count == 0)
+                    return false;
+
+                // from と to の両方に隣接する頂点が、共有する三角形の頂点以外にあれば、縮約すると非多様体になります。
+                collectNeighbors(from, neighbors_);
+                collectNeighbors(to, other_neighbors_);
+                std::vector<unsigned> common;
+                std::set_intersection(neighbors_.begin(), neighbors_.end(),
+                                      other_neighbors_.begin(), other_neighbors_.end(),
+                                      std::back_inserter(common));
+                return common.size() <= shared_triangle_count;
+            }
+
+            void applyCollapse(unsigned from, unsigned to) {
+                for (const auto t : vertex_triangles_[from]) {
+                    if (triangle_removed_[t])
+                        continue;
+                    auto& triangle = triangles_[t];
+                    if (std::find(triangle.begin(), triangle.end(), to) != triangle.end()) {
+                        triangle_removed_[t] = true;
+                        --live_triangle_count_;
+                        continue;
+                    }
+                    std::replace(triangle.begin(), triangle.end(), from, to);
+                    vertex_triangles_[to].push_back(t);
+                }
+                auto& to_triangles = vertex_triangles_[to];
+                to_triangles.erase(std::remove_if(to_triangles.begin(), to_triangles.end(),
+                                                  [this](unsigned t) { return triangle_removed_[t]; }),
+                                   to_triangles.end());
+                vertex_triangles_[from].clear();
+                vertex_triangles_[from].shrink_to_fit();
+
+                quadrics_[to].add(quadrics_[from]);
+                removed_[from] = true;
+                ++versions_[to];
+            }
+
+            static std::array<int64_t, 3> quantize(const TVec3d& position) {
+                constexpr auto tolerance = MeshOptimizer::default_weld_tolerance;
+                return { std::llround(position.x / tolerance),
+                         std::llround(position.y / tolerance),
+                         std::llround(position.z / tolerance) };
+            }
+
+            static uint64_t edgeKey(unsigned a, unsigned b) {
+                if (a > b) std::swap(a, b);
+                return (static_cast<uint64_t>(a) << 32) | b;
+            }
+
+            const Mesh& mesh_;
+            const std::vector<unsigned>& triangle_sub_mesh_;
+
+            // 内部頂点ごとの情報
+            std::vector<TVec3d> positions_;
+            std::vector<unsigned> representatives_;
+            std::vector<int64_t> sub_mesh_of_;
+            std::vector<Quadric> quadrics_;
+            std::vector<bool> removed_;
+            std::vector<bool> locked_;
+            std::vector<unsigned> versions_;
+            std::vector<std::vector<unsigned>> vertex_triangles_;
+
+            std::vector<unsigned> to_internal_;
+            std::vector<std::array<unsigned, 3>> triangles_;
+            std::vector<bool> triangle_removed_;
+            size_t live_triangle_count_ = 0;
+
+            std::vector<unsigned> neighbors_;
+            std::vector<unsigned> other_neighbors_;
+        };
+
+        bool hasConsistentAttributes(const Mesh& mesh) {
+            const auto vertex_count = mesh.getVertexCount();
+            if (mesh.getIndices().size() % 3 != 0)
+                return false;
+            if (!mesh.getUV1().empty() && mesh.getUV1().size() != vertex_count)
+                return false;
+            if (!mesh.getUV4().empty() && mesh.getUV4().size() != vertex_count)
+                return false;
+            return std::all_of(mesh.getIndices().begin(), mesh.getIndices().end(),
+                               [vertex_count](unsigned index) { return index < vertex_count; });
+        }
+
+        /**
+         * 三角形ごとに所属する SubMesh の番号を求めます。
+         * SubMesh の範囲が三角形の境目に揃っていない、またはどの SubMesh にも属さない三角形があるときは false を返します。
+         */
+        bool computeTriangleSubMeshes(const Mesh& mesh, std::vector<unsigned>& out_triangle_sub_mesh) {
+            const auto triangle_count = mesh.getIndices().size() / 3;
+            constexpr auto unassigned = std::numeric_limits<unsigned>::max();
+            out_triangle_sub_mesh.assign(triangle_count, unassigned);
+            const auto& sub_meshes = mesh.getSubMeshes();
+            for (unsigned s = 0; s < sub_meshes.size(); ++s) {
+                const auto first = sub_meshes[s].getStartIndex();
+                const auto last = sub_meshes[s].getEndIndex() + 1;
+                if (first % 3 != 0 || last % 3 != 0 || last > triangle_count * 3)
+                    return false;
+                for (auto t = first / 3; t < last / 3; ++t) {
+                    out_triangle_sub_mesh[t] = s;
+                }
+            }
+            return std::find(out_triangle_sub_mesh.begin(), out_triangle_sub_mesh.end(), unassigned) ==
+                   out_triangle_sub_mesh.end();
+        }
+
+        void collectMeshesRecursive(Node& node, std::vector<Mesh*>& out_meshes) {
+            if (node.getMesh() != nullptr)
+                out_meshes.push_back(node.getMesh());
+            for (unsigned i = 0; i < node.getChildCount(); ++i) {
+                collectMeshesRecursive(node.getChildAt(i), out_meshes);
+            }
+        }
+
+        Node copyNodeRecursive(const Node& source, const std::string& name, std::vector<Mesh*>& out_meshes) {
+            std::unique_ptr<Mesh> mesh;
+            if (source.getMesh() != nullptr) {
+                mesh = std::make_unique<Mesh>(*source.getMesh());
+                out_meshes.push_back(mesh.get());
+            }
+            auto node = Node(name, std::move(mesh));
+            for (const auto& instance : source.getInstances()) {
+                node.addInstance(instance.name, instance.translation);
+            }
+            for (unsigned i = 0; i < source.getChildCount(); ++i) {
+                const auto& child = source.getChildAt(i);
+                node.addChildNode(copyNodeRecursive(child, child.getName(), out_meshes));
+            }
+            return node;
+        }
+
+        void simplifyInParallel(const std::vector<Mesh*>& meshes, float target_ratio, double max_error) {
+            util::parallelFor(meshes.size(), [&meshes, target_ratio, max_error](size_t i) {
+                MeshSimplifier::simplify(*meshes[i], target_ratio, max_error);
+            });
+        }
+    }
+
+    void MeshSimplifier::simplify(Mesh& mesh, float target_ratio, double max_error) {
+        if (mesh.getIndices().size() < 6 || !hasConsistentAttributes(mesh))
+            return;
+        const auto triangle_count = mesh.getIndices().size() / 3;
+        const auto target_triangle_count = static_cast<size_t>(
+            static_cast<double>(triangle_count) * std::clamp(target_ratio, 0.0f, 1.0f));
+        if (target_triangle_count >= triangle_count)
+            return;
+
+        std::vector<unsigned> triangle_sub_mesh;
+        if (!computeTriangleSubMeshes(mesh, triangle_sub_mesh))
+            return;
+
+        SimplifyContext context(mesh, triangle_sub_mesh);
+        context.run(target_triangle_count, max_error);
+
+        std::vector<unsigned> indices;
+        std::vector<unsigned> new_to_old;
+        std::vector<SubMesh> sub_meshes;
+        context.buildResult(mesh.getSubMeshes(), indices, new_to_old, sub_meshes);
+        mesh.vertices_ = gather(mesh.vertices_, new_to_old);
+        mesh.float_vertices_ = gather(mesh.float_vertices_, new_to_old);
+        mesh.uv1_ = gather(mesh.uv1_, new_to_old);
+        mesh.uv4_ = gather(mesh.uv4_, new_to_old);
+        mesh.indices_ = std::move(indices);
+        mesh.sub_meshes_ = std::move(sub_meshes);
+    }
+
+    void MeshSimplifier::simplify(Model& model, float target_ratio, double max_error) {
+        std::vector<Mesh*> meshes;
+        for (size_t i = 0; i < model.getRootNodeCount(); ++i) {
+            collectMeshesRecursive(model.getRootNodeAt(i), meshes);
+        }
+        simplifyInParallel(meshes, target_ratio, max_error);
+    }
+
+    Node MeshSimplifier::createProxyLodNode(const Node& source, const std::string& name,
+                                            float target_ratio, double max_error) {
+        std::vector<Mesh*> meshes;
+        auto node = copyNodeRecursive(source, name, meshes);
+        simplifyInParallel(meshes, target_ratio, max_error);
+        return node;
+    }
+}
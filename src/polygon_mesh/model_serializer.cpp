@@ -0,0 +1,675 @@
+#include <plateau/polygon_mesh/model_serializer.h>
+#include <citygml/material.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace plateau::polygonMesh {
+    namespace fs = std::filesystem;
+
+    namespace {
+        constexpr char file_magic[8] = { 'P', 'L', 'T', 'M', 'O', 'D', 'E', 'L' };
+        constexpr uint32_t endian_marker = 0x01020304;
+        constexpr uint64_t data_alignment = 16;
+
+        struct SectionDesc {
+            uint64_t offset;
+            uint64_t count;
+        };
+
+        struct FileHeader {
+            char magic[8];
+            uint32_t version;
+            uint32_t endian_marker;
+            uint64_t file_size;
+            uint64_t root_node_count;
+            SectionDesc nodes;
+            SectionDesc meshes;
+            SectionDesc sub_meshes;
+            SectionDesc materials;
+            SectionDesc city_objects;
+            SectionDesc string_offsets;
+            SectionDesc string_data;
+            SectionDesc instances;
+        };
+
+        struct NodeRecord {
+            uint32_t name;
+            int32_t mesh_index;
+            uint32_t first_child;
+            uint32_t child_count;
+            uint32_t first_instance;
+            uint32_t instance_count;
+        };
+
+        struct InstanceRecord {
+            double translation[3];
+            uint32_t name;
+            uint32_t reserved;
+        };
+
+        struct MeshRecord {
+            SectionDesc vertices;
+            SectionDesc float_vertices;
+            SectionDesc indices;
+            SectionDesc uv1;
+            SectionDesc uv4;
+            uint32_t first_sub_mesh;
+            uint32_t sub_mesh_count;
+            uint32_t first_city_object;
+            uint32_t city_object_count;
+        };
+
+        struct SubMeshRecord {
+            uint64_t start_index;
+            uint64_t end_index;
+            uint32_t texture_path;
+            int32_t material_index;
+        };
+
+        struct MaterialRecord {
+            uint32_t id;
+            uint32_t is_smooth;
+            float diffuse[3];
+            float emissive[3];
+            float specular[3];
+            float ambient_intensity;
+            float shininess;
+            float transparency;
+        };
+
+        struct CityObjectRecord {
+            int32_t primary_index;
+            int32_t atomic_index;
+            uint32_t gml_id;
+            uint32_t reserved;
+        };
+
+        // 頂点データは memcpy でそのまま書き込むため、型のサイズが想定どおりであることを確認します。
+        static_assert(sizeof(TVec3d) == sizeof(double) * 3);
+        static_assert(sizeof(TVec3f) == sizeof(float) * 3);
+        static_assert(sizeof(TVec2f) == sizeof(float) * 2);
+        static_assert(sizeof(FileHeader) == 160);
+        static_assert(sizeof(MeshRecord) == 96);
+
+        uint64_t align(uint64_t offset) {
+            return (offset + data_alignment - 1) / data_alignment * data_alignment;
+        }
+
+        /// libcitygml の Material はコンストラクタが protected のため、復元用に派生クラスを用意します。
+        class DeserializedMaterial : public citygml::Material {
+        public:
+            explicit DeserializedMaterial(const std::string& id) :
+                citygml::Material(id) {
+            }
+        };
+
+        class StringTable {
+        public:
+            uint32_t add(const std::string& str) {
+                const auto found = ids_.find(str);
+                if (found != ids_.end())
+                    return found->second;
+                const auto id = static_cast<uint32_t>(strings_.size());
+                strings_.push_back(str);
+                ids_.emplace(str, id);
+                return id;
+            }
+
+            const std::vector<std::string>& getStrings() const {
+                return strings_;
+            }
+
+        private:
+            std::vector<std::string> strings_;
+            std::unordered_map<std::string, uint32_t> ids_;
+        };
+
+        /// Model を走査して、書き込むレコードを集めます。
+        class ModelCollector {
+        public:
+            explicit ModelCollector(const Model& model) {
+                // 子ノードが Node表の中で連続するよう、幅優先で走査します。
+                std::vector<const Node*> order;
+                for (size_t i = 0; i < model.getRootNodeCount(); ++i) {
+                    order.push_back(&model.getRootNodeAt(i));
+                }
+                for (size_t i = 0; i < order.size(); ++i) {
+                    const auto& node = *order[i];
+                    NodeRecord record{};
+                    record.name = strings.add(node.getName());
+                    record.mesh_index = -1;
+                    record.first_child = static_cast<uint32_t>(order.size());
+                    record.child_count = static_cast<uint32_t>(node.getChildCount());
+                    for (unsigned c = 0; c < node.getChildCount(); ++c) {
+                        order.push_back(&node.getChildAt(c));
+                    }
+                    if (node.getMesh() != nullptr) {
+                        record.mesh_index = static_cast<int32_t>(meshes.size());
+                        addMesh(*node.getMesh());
+                    }
+                    record.first_instance = static_cast<uint32_t>(instances.size());
+                    record.instance_count = static_cast<uint32_t>(node.getInstances().size());
+                    for (const auto& instance : node.getInstances()) {
+                        InstanceRecord instance_record{};
+                        instance_record.translation[0] = instance.translation.x;
+                        instance_record.translation[1] = instance.translation.y;
+                        instance_record.translation[2] = instance.translation.z;
+                        instance_record.name = strings.add(instance.name);
+                        instances.push_back(instance_record);
+                    }
+                    nodes.push_back(record);
+                }
+            }
+
+            StringTable strings;
+            std::vector<NodeRecord> nodes;
+            std::vector<const Mesh*> meshes;
+            std::vector<MeshRecord> mesh_records;
+            std::vector<SubMeshRecord> sub_meshes;
+            std::vector<MaterialRecord> materials;
+            std::vector<CityObjectRecord> city_objects;
+            std::vector<InstanceRecord> instances;
+
+        private:
+            void addMesh(const Mesh& mesh) {
+                MeshRecord record{};
+                record.first_sub_mesh = static_cast<uint32_t>(sub_meshes.size());
+                record.sub_mesh_count = static_cast<uint32_t>(mesh.getSubMeshes().size());
+                for (const auto& sub_mesh : mesh.getSubMeshes()) {
+                    SubMeshRecord sub_mesh_record{};
+                    sub_mesh_record.start_index = sub_mesh.getStartIndex();
+                    sub_mesh_record.end_index = sub_mesh.getEndIndex();
+                    sub_mesh_record.texture_path = strings.add(sub_mesh.getTexturePath());
+                    sub_mesh_record.material_index = addMaterial(sub_mesh.getMaterial());
+                    sub_meshes.push_back(sub_mesh_record);
+                }
+
+                const auto& city_object_list = mesh.getCityObjectList();
+                std::vector<CityObjectIndex> keys;
+                city_object_list.getAllKeys(keys);
+                record.first_city_object = static_cast<uint32_t>(city_objects.size());
+                record.city_object_count = static_cast<uint32_t>(keys.size());
+                for (const auto& key : keys) {
+                    CityObjectRecord city_object_record{};
+                    city_object_record.primary_index = key.primary_index;
+                    city_object_record.atomic_index = key.atomic_index;
+                    city_object_record.gml_id = strings.add(city_object_list.getAtomicGmlID(key));
+                    city_objects.push_back(city_object_record);
+                }
+
+                record.vertices.count = mesh.getVertices().size();
+                record.float_vertices.count = mesh.getFloatVertices().size();
+                record.indices.count = mesh.getIndices().size();
+                record.uv1.count = mesh.getUV1().size();
+                record.uv4.count = mesh.getUV4().size();
+                meshes.push_back(&mesh);
+                mesh_records.push_back(record);
+            }
+
+            int32_t addMaterial(const std::shared_ptr<const citygml::Material>& material) {
+                if (material == nullptr)
+                    return -1;
+                const auto found = material_ids_.find(material.get());
+                if (found != material_ids_.end())
+                    return found->second;
+
+                MaterialRecord record{};
+                record.id = strings.add(material->getId());
+                record.is_smooth = material->isSmooth() ? 1 : 0;
+                const auto diffuse = material->getDiffuse();
+                const auto emissive = material->getEmissive();
+                const auto specular = material->getSpecular();
+                const auto copy_vec3 = [](const TVec3f& src, float* dst) {
+                    dst[0] = src.x;
+                    dst[1] = src.y;
+                    dst[2] = src.z;
+                };
+                copy_vec3(diffuse, record.diffuse);
+                copy_vec3(emissive, record.emissive);
+                copy_vec3(specular, record.specular);
+                record.ambient_intensity = material->getAmbientIntensity();
+                record.shininess = material->getShininess();
+                record.transparency = material->getTransparency();
+
+                const auto id = static_cast<int32_t>(materials.size());
+                materials.push_back(record);
+                material_ids_.emplace(material.get(), id);
+                return id;
+            }
+
+            std::unordered_map<const citygml::Material*, int32_t> material_ids_;
+        };
+
+        class BinaryWriter {
+        public:
+            explicit BinaryWriter(std::ostream& out) :
+                out_(out), pos_(0) {
+            }
+
+            void write(const void* data, size_t size) {
+                if (size == 0)
+                    return;
+                out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+                pos_ += size;
+            }
+
+            template<typename T>
+            void writeArray(const std::vector<T>& array) {
+                write(array.data(), array.size() * sizeof(T));
+            }
+
+            /// 指定位置までゼロで埋めます。
+            void padTo(uint64_t offset) {
+                static const char zeros[data_alignment] = {};
+                while (pos_ < offset) {
+                    const auto size = std::min<uint64_t>(offset - pos_, data_alignment);
+                    write(zeros, static_cast<size_t>(size));
+                }
+            }
+
+        private:
+            std::ostream& out_;
+            uint64_t pos_;
+        };
+
+        /// ヘッダを検証して返します。
+        FileHeader readHeader(const uint8_t* data, size_t size) {
+            if (data == nullptr || size < sizeof(FileHeader))
+                throw std::runtime_error("ModelSerializer : data is too small.");
+            FileHeader header{};
+            std::memcpy(&header, data, sizeof(FileHeader));
+            if (std::memcmp(header.magic, file_magic, sizeof(file_magic)) != 0)
+                throw std::runtime_error("ModelSerializer : invalid magic number.");
+            if (header.endian_marker != endian_marker)
+                throw std::runtime_error("ModelSerializer : endianness mismatch.");
+            if (header.version != ModelSerializer::format_version)
+                throw std::runtime_error("ModelSerializer : unsupported format version " + std::to_string(header.version));
+            if (header.file_size > size)
+                throw std::runtime_error("ModelSerializer : data is truncated.");
+            return header;
+        }
+
+        /// 範囲 [offset, offset + count * element_size) がデータ内に収まることを確認します。
+        void checkRange(const SectionDesc& section, size_t element_size, size_t size) {
+            if (section.offset > size || section.count > (size - section.offset) / element_size)
+                throw std::runtime_error("ModelSerializer : section is out of range.");
+        }
+
+        template<typename T>
+        T readRecord(const uint8_t* data, const SectionDesc& section, size_t index) {
+            if (index >= section.count)
+                throw std::runtime_error("ModelSerializer : record index is out of range.");
+            T record;
+            std::memcpy(&record, data + section.offset + index * sizeof(T), sizeof(T));
+            return record;
+        }
+
+        template<typename T>
+        std::vector<T> readArray(const uint8_t* data, const SectionDesc& section, size_t size) {
+            checkRange(section, sizeof(T), size);
+            std::vector<T> result(static_cast<size_t>(section.count));
+            if (section.count > 0)
+                std::memcpy(result.data(), data + section.offset, result.size() * sizeof(T));
+            return result;
+        }
+
+        /// ヘッダの各表がデータ内に収まっているか検証します。
+        void checkSections(const FileHeader& header, size_t size) {
+            checkRange(header.nodes, sizeof(NodeRecord), size);
+            checkRange(header.meshes, sizeof(MeshRecord), size);
+            checkRange(header.sub_meshes, sizeof(SubMeshRecord), size);
+            checkRange(header.materials, sizeof(MaterialRecord), size);
+            checkRange(header.city_objects, sizeof(CityObjectRecord), size);
+            checkRange(header.string_offsets, sizeof(uint64_t), size);
+            checkRange(header.string_data, 1, size);
+            checkRange(header.instances, sizeof(InstanceRecord), size);
+            if (header.string_offsets.count == 0 || header.root_node_count > header.nodes.count)
+                throw std::runtime_error("ModelSerializer : invalid header.");
+        }
+
+        std::string_view readString(const uint8_t* data, const FileHeader& header, uint32_t index) {
+            if (index + 1ull >= header.string_offsets.count)
+                throw std::runtime_error("ModelSerializer : string index is out of range.");
+            const auto begin = readRecord<uint64_t>(data, header.string_offsets, index);
+            const auto end = readRecord<uint64_t>(data, header.string_offsets, index + 1);
+            if (begin > end || end > header.string_data.count)
+                throw std::runtime_error("ModelSerializer : string is out of range.");
+            return {
+                reinterpret_cast<const char*>(data + header.string_data.offset + begin),
+                static_cast<size_t>(end - begin)
+            };
+        }
+
+        class ModelBuilder {
+        public:
+            ModelBuilder(const uint8_t* data, size_t size) :
+                data_(data), size_(size), header_(readHeader(data, size)) {
+                checkSections(header_, size_);
+                for (size_t i = 0; i < header_.materials.count; ++i) {
+                    materials_.push_back(readMaterial(readRecord<MaterialRecord>(data_, header_.materials, i)));
+                }
+            }
+
+            void build(Model& out_model) {
+                for (size_t i = 0; i < header_.root_node_count; ++i) {
+                    out_model.addNode(buildNode(static_cast<uint32_t>(i)));
+                }
+            }
+
+        private:
+            Node buildNode(uint32_t index) {
+                const auto record = readRecord<NodeRecord>(data_, header_.nodes, index);
+                std::unique_ptr<Mesh> mesh;
+                if (record.mesh_index >= 0) {
+                    mesh = buildMesh(static_cast<size_t>(record.mesh_index));
+                }
+                auto node = Node(std::string(readString(data_, header_, record.name)), std::move(mesh));
+                // 幅優先で並んでいるため、子は必ず親より後ろにあります。これにより循環参照を防ぎます。
+                if (record.child_count > 0 && record.first_child <= index)
+                    throw std::runtime_error("ModelSerializer : invalid node hierarchy.");
+                for (uint32_t i = 0; i < record.instance_count; ++i) {
+                    const auto instance = readRecord<InstanceRecord>(data_, header_.instances, record.first_instance + static_cast<size_t>(i));
+                    node.addInstance(std::string(readString(data_, header_, instance.name)),
+                                     TVec3d(instance.translation[0], instance.translation[1], instance.translation[2]));
+                }
+                for (uint32_t c = 0; c < record.child_count; ++c) {
+                    node.addChildNode(buildNode(record.first_child + c));
+                }
+                return node;
+            }
+
+            std::unique_ptr<Mesh> buildMesh(size_t index) {
+                const auto record = readRecord<MeshRecord>(data_, header_.meshes, index);
+
+                std::vector<SubMesh> sub_meshes;
+                sub_meshes.reserve(record.sub_mesh_count);
+                for (uint32_t i = 0; i < record.sub_mesh_count; ++i) {
+                    const auto sub_mesh = readRecord<SubMeshRecord>(data_, header_.sub_meshes, record.first_sub_mesh + static_cast<size_t>(i));
+                    std::shared_ptr<const citygml::Material> material;
+                    if (sub_mesh.material_index >= 0) {
+                        material = materials_.at(sub_mesh.material_index);
+                    }
+                    sub_meshes.emplace_back(static_cast<size_t>(sub_mesh.start_index), static_cast<size_t>(sub_mesh.end_index),
+                                            std::string(readString(data_, header_, sub_mesh.texture_path)), material);
+                }
+
+                CityObjectList city_object_list;
+                for (uint32_t i = 0; i < record.city_object_count; ++i) {
+                    const auto city_object = readRecord<CityObjectRecord>(data_, header_.city_objects, record.first_city_object + static_cast<size_t>(i));
+                    city_object_list.add({ city_object.primary_index, city_object.atomic_index },
+                                         std::string(readString(data_, header_, city_object.gml_id)));
+                }
+
+                if (record.float_vertices.count > 0) {
+                    return std::make_unique<Mesh>(
+                        readArray<TVec3f>(data_, record.float_vertices, size_),
+                        readArray<unsigned>(data_, record.indices, size_),
+                        readArray<TVec2f>(data_, record.uv1, size_),
+                        readArray<TVec2f>(data_, record.uv4, size_),
+                        std::move(sub_meshes),
+                        std::move(city_object_list));
+                }
+                return std::make_unique<Mesh>(
+                    readArray<TVec3d>(data_, record.vertices, size_),
+                    readArray<unsigned>(data_, record.indices, size_),
+                    readArray<TVec2f>(data_, record.uv1, size_),
+                    readArray<TVec2f>(data_, record.uv4, size_),
+                    std::move(sub_meshes),
+                    std::move(city_object_list));
+            }
+
+            std::shared_ptr<const citygml::Material> readMaterial(const MaterialRecord& record) {
+                auto material = std::make_shared<DeserializedMaterial>(std::string(readString(data_, header_, record.id)));
+                material->setDiffuse(TVec3f(record.diffuse[0], record.diffuse[1], record.diffuse[2]));
+                material->setEmissive(TVec3f(record.emissive[0], record.emissive[1], record.emissive[2]));
+                material->setSpecular(TVec3f(record.specular[0], record.specular[1], record.specular[2]));
+                material->setAmbientIntensity(record.ambient_intensity);
+                material->setShininess(record.shininess);
+                material->setTransparency(record.transparency);
+                material->setIsSmooth(record.is_smooth != 0);
+                return material;
+            }
+
+            const uint8_t* data_;
+            size_t size_;
+            FileHeader header_;
+            std::vector<std::shared_ptr<const citygml::Material>> materials_;
+        };
+    }
+
+    void ModelSerializer::write(const Model& model, std::ostream& out) {
+        const auto collected = ModelCollector(model);
+        const auto& strings = collected.strings.getStrings();
+
+        // 各表の配置を決めます。
+        FileHeader header{};
+        std::memcpy(header.magic, file_magic, sizeof(file_magic));
+        header.version = format_version;
+        header.endian_marker = endian_marker;
+        header.root_node_count = model.getRootNodeCount();
+
+        uint64_t offset = sizeof(FileHeader);
+        const auto place = [&offset](SectionDesc& section, uint64_t count, uint64_t element_size) {
+            offset = align(offset);
+            section.offset = offset;
+            section.count = count;
+            offset += count * element_size;
+        };
+        place(header.nodes, collected.nodes.size(), sizeof(NodeRecord));
+        place(header.meshes, collected.mesh_records.size(), sizeof(MeshRecord));
+        place(header.sub_meshes, collected.sub_meshes.size(), sizeof(SubMeshRecord));
+        place(header.materials, collected.materials.size(), sizeof(MaterialRecord));
+        place(header.city_objects, collected.city_objects.size(), sizeof(CityObjectRecord));
+
+        std::vector<uint64_t> string_offsets;
+        string_offsets.reserve(strings.size() + 1);
+        uint64_t string_data_size = 0;
+        for (const auto& str : strings) {
+            string_offsets.push_back(string_data_size);
+            string_data_size += str.size();
+        }
+        string_offsets.push_back(string_data_size);
+        place(header.string_offsets, string_offsets.size(), sizeof(uint64_t));
+        place(header.string_data, string_data_size, 1);
+        place(header.instances, collected.instances.size(), sizeof(InstanceRecord));
+
+        auto mesh_records = collected.mesh_records;
+        for (auto& record : mesh_records) {
+            place(record.vertices, record.vertices.count, sizeof(TVec3d));
+            place(record.float_vertices, record.float_vertices.count, sizeof(TVec3f));
+            place(record.indices, record.indices.count, sizeof(unsigned));
+            place(record.uv1, record.uv1.count, sizeof(TVec2f));
+            place(record.uv4, record.uv4.count, sizeof(TVec2f));
+        }
+        header.file_size = align(offset);
+
+        // 書き込みます。
+        auto writer = BinaryWriter(out);
+        writer.write(&header, sizeof(FileHeader));
+        writer.padTo(header.nodes.offset);
+        writer.writeArray(collected.nodes);
+        writer.padTo(header.meshes.offset);
+        writer.writeArray(mesh_records);
+        writer.padTo(header.sub_meshes.offset);
+        writer.writeArray(collected.sub_meshes);
+        writer.padTo(header.materials.offset);
+        writer.writeArray(collected.materials);
+        writer.padTo(header.city_objects.offset);
+        writer.writeArray(collected.city_objects);
+        writer.padTo(header.string_offsets.offset);
+        writer.writeArray(string_offsets);
+        writer.padTo(header.string_data.offset);
+        for (const auto& str : strings) {
+            writer.write(str.data(), str.size());
+        }
+        writer.padTo(header.instances.offset);
+        writer.writeArray(collected.instances);
+        for (size_t i = 0; i < mesh_records.size(); ++i) {
+            const auto& mesh = *collected.meshes[i];
+            const auto& record = mesh_records[i];
+            writer.padTo(record.vertices.offset);
+            writer.writeArray(mesh.getVertices());
+            writer.padTo(record.float_vertices.offset);
+            writer.writeArray(mesh.getFloatVertices());
+            writer.padTo(record.indices.offset);
+            writer.writeArray(mesh.getIndices());
+            writer.padTo(record.uv1.offset);
+            writer.writeArray(mesh.getUV1());
+            writer.padTo(record.uv4.offset);
+            writer.writeArray(mesh.getUV4());
+        }
+        writer.padTo(header.file_size);
+    }
+
+    void ModelSerializer::write(const Model& model, const std::string& file_path) {
+        auto ofs = std::ofstream(fs::u8path(file_path), std::ios::binary);
+        if (!ofs)
+            throw std::runtime_error("ModelSerializer : failed to open file : " + file_path);
+        write(model, ofs);
+        if (!ofs)
+            throw std::runtime_error("ModelSerializer : failed to write file : " + file_path);
+    }
+
+    std::shared_ptr<Model> ModelSerializer::read(const std::string& file_path) {
+        auto model = Model::createModel();
+        read(*model, file_path);
+        return model;
+    }
+
+    std::shared_ptr<Model> ModelSerializer::read(const void* data, size_t size) {
+        auto model = Model::createModel();
+        read(*model, data, size);
+        return model;
+    }
+
+    void ModelSerializer::read(Model& out_model, const void* data, size_t size) {
+        auto builder = ModelBuilder(static_cast<const uint8_t*>(data), size);
+        builder.build(out_model);
+    }
+
+    void ModelSerializer::read(Model& out_model, const std::string& file_path) {
+        auto ifs = std::ifstream(fs::u8path(file_path), std::ios::binary | std::ios::ate);
+        if (!ifs)
+            throw std::runtime_error("ModelSerializer : failed to open file : " + file_path);
+        const auto size = static_cast<size_t>(ifs.tellg());
+        ifs.seekg(0);
+        std::vector<uint8_t> buffer(size);
+        ifs.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(size));
+        if (!ifs)
+            throw std::runtime_error("ModelSerializer : failed to read file : " + file_path);
+        read(out_model, buffer.data(), buffer.size());
+    }
+
+    SerializedModelView::SerializedModelView(const void* data, size_t size) :
+        data_(static_cast<const uint8_t*>(data)),
+        size_(size) {
+        const auto header = readHeader(data_, size_);
+        checkSections(header, size_);
+        for (size_t i = 0; i < header.meshes.count; ++i) {
+            const auto record = readRecord<MeshRecord>(data_, header.meshes, i);
+            checkRange(record.vertices, sizeof(TVec3d), size_);
+            checkRange(record.float_vertices, sizeof(TVec3f), size_);
+            checkRange(record.indices, sizeof(unsigned), size_);
+            checkRange(record.uv1, sizeof(TVec2f), size_);
+            checkRange(record.uv4, sizeof(TVec2f), size_);
+        }
+    }
+
+    namespace {
+        FileHeader headerOf(const uint8_t* data) {
+            FileHeader header{};
+            std::memcpy(&header, data, sizeof(FileHeader));
+            return header;
+        }
+    }
+
+    size_t SerializedModelView::getRootNodeCount() const {
+        return static_cast<size_t>(headerOf(data_).root_node_count);
+    }
+
+    size_t SerializedModelView::getNodeCount() const {
+        return static_cast<size_t>(headerOf(data_).nodes.count);
+    }
+
+    std::string_view SerializedModelView::getNodeName(size_t node_index) const {
+        const auto header = headerOf(data_);
+        return readString(data_, header, readRecord<NodeRecord>(data_, header.nodes, node_index).name);
+    }
+
+    int SerializedModelView::getNodeMeshIndex(size_t node_index) const {
+        return readRecord<NodeRecord>(data_, headerOf(data_).nodes, node_index).mesh_index;
+    }
+
+    size_t SerializedModelView::getNodeFirstChild(size_t node_index) const {
+        return readRecord<NodeRecord>(data_, headerOf(data_).nodes, node_index).first_child;
+    }
+
+    size_t SerializedModelView::getNodeChildCount(size_t node_index) const {
+        return readRecord<NodeRecord>(data_, headerOf(data_).nodes, node_index).child_count;
+    }
+
+    size_t SerializedModelView::getNodeInstanceCount(size_t node_index) const {
+        return readRecord<NodeRecord>(data_, headerOf(data_).nodes, node_index).instance_count;
+    }
+
+    namespace {
+        InstanceRecord readInstance(const uint8_t* data, const FileHeader& header, size_t node_index, size_t instance_index) {
+            const auto node = readRecord<NodeRecord>(data, header.nodes, node_index);
+            if (instance_index >= node.instance_count)
+                throw std::out_of_range("SerializedModelView : instance index is out of range.");
+            return readRecord<InstanceRecord>(data, header.instances, node.first_instance + instance_index);
+        }
+    }
+
+    std::string_view SerializedModelView::getNodeInstanceName(size_t node_index, size_t instance_index) const {
+        const auto header = headerOf(data_);
+        return readString(data_, header, readInstance(data_, header, node_index, instance_index).name);
+    }
+
+    TVec3d SerializedModelView::getNodeInstanceTranslation(size_t node_index, size_t instance_index) const {
+        const auto instance = readInstance(data_, headerOf(data_), node_index, instance_index);
+        return TVec3d(instance.translation[0], instance.translation[1], instance.translation[2]);
+    }
+
+    size_t SerializedModelView::getMeshCount() const {
+        return static_cast<size_t>(headerOf(data_).meshes.count);
+    }
+
+    SerializedModelView::MeshStreams SerializedModelView::getMeshStreams(size_t mesh_index) const {
+        const auto record = readRecord<MeshRecord>(data_, headerOf(data_).meshes, mesh_index);
+        return {
+            reinterpret_cast<const TVec3d*>(data_ + record.vertices.offset), static_cast<size_t>(record.vertices.count),
+            reinterpret_cast<const TVec3f*>(data_ + record.float_vertices.offset), static_cast<size_t>(record.float_vertices.count),
+            reinterpret_cast<const unsigned*>(data_ + record.indices.offset), static_cast<size_t>(record.indices.count),
+            reinterpret_cast<const TVec2f*>(data_ + record.uv1.offset), static_cast<size_t>(record.uv1.count),
+            reinterpret_cast<const TVec2f*>(data_ + record.uv4.offset), static_cast<size_t>(record.uv4.count)
+        };
+    }
+
+    size_t SerializedModelView::getSubMeshCount(size_t mesh_index) const {
+        return readRecord<MeshRecord>(data_, headerOf(data_).meshes, mesh_index).sub_mesh_count;
+    }
+
+    void SerializedModelView::getSubMeshRange(size_t mesh_index, size_t sub_mesh_index, size_t& out_start, size_t& out_end) const {
+        const auto header = headerOf(data_);
+        const auto mesh = readRecord<MeshRecord>(data_, header.meshes, mesh_index);
+        if (sub_mesh_index >= mesh.sub_mesh_count)
+            throw std::out_of_range("SerializedModelView : sub mesh index is out of range.");
+        const auto sub_mesh = readRecord<SubMeshRecord>(data_, header.sub_meshes, mesh.first_sub_mesh + sub_mesh_index);
+        out_start = static_cast<size_t>(sub_mesh.start_index);
+        out_end = static_cast<size_t>(sub_mesh.end_index);
+    }
+
+    std::string_view SerializedModelView::getSubMeshTexturePath(size_t mesh_index, size_t sub_mesh_index) const {
+        const auto header = headerOf(data_);
+        const auto mesh = readRecord<MeshRecord>(data_, header.meshes, mesh_index);
+        if (sub_mesh_index >= mesh.sub_mesh_count)
+            throw std::out_of_range("SerializedModelView : sub mesh index is out of range.");
+        const auto sub_mesh = readRecord<SubMeshRecord>(data_, header.sub_meshes, mesh.first_sub_mesh + sub_mesh_index);
+        return readString(data_, header, sub_mesh.texture_path);
+    }
+}
@@ -58,16 +58,32 @@ namespace plateau::polygonMesh {
     bool Node::polygonExists() const {
         if (mesh_ == nullptr)
             return false;
-        if (mesh_->getVertices().empty())
+        if (mesh_->getVertexCount() == 0)
             return false;
         if (mesh_->getIndices().empty())
             return false;
         return true;
     }
 
+    void Node::addInstance(std::string name, const TVec3d& translation) {
+        instances_.push_back({ std::move(name), translation });
+    }
+
+    const std::vector<NodeInstance>& Node::getInstances() const {
+        return instances_;
+    }
+
+    bool Node::isInstanced() const {
+        return !instances_.empty();
+    }
+
     void Node::debugString(std::stringstream& ss, int indent) const {
         for (int i = 0; i < indent; i++) ss << "    ";
         ss << "Node: " << name_ << std::endl;
+        if (!instances_.empty()) {
+            for (int i = 0; i < indent + 1; i++) ss << "    ";
+            ss << "Instances: " << instances_.size() << std::endl;
+        }
         if (mesh_ != nullptr) {
             mesh_->debugString(ss, indent + 1);
         } else {
@@ -2,17 +2,22 @@
 #include "plateau/polygon_mesh/mesh.h"
 #include "plateau/geometry/geo_reference.h"
 #include "citygml/citymodel.h"
+#include "citygml/polygon.h"
 
 namespace plateau::polygonMesh {
     using namespace citygml;
 
     namespace {
-        void childCityObjectsRecursive(const CityObject& city_obj, std::list<const CityObject*>& child_objs) {
+        void childCityObjectsRecursive(const CityObject& city_obj, std::list<const CityObject*>& child_objs,
+                                       CityObject::CityObjectsType type_mask) {
+            // マスクに含まれない型の都市オブジェクトは、その子も含めて除外します。
+            if ((city_obj.getType() & type_mask) == static_cast<CityObject::CityObjectsType>(0))
+                return;
             child_objs.push_back(&city_obj);
             unsigned int num_child = city_obj.getChildCityObjectsCount();
             for (unsigned int i = 0; i < num_child; i++) {
                 auto& child = city_obj.getChildCityObject(i);
-                childCityObjectsRecursive(child, child_objs);
+                childCityObjectsRecursive(child, child_objs, type_mask);
             }
         }
 
@@ -22,7 +27,7 @@ namespace plateau::polygonMesh {
             unsigned int num_poly = geometry.getPolygonsCount();
             for (unsigned int i = 0; i < num_poly; i++) {
                 auto poly = geometry.getPolygon(i);
-                if (!poly->getVertices().empty()) return poly.get();
+                if (!PolygonMeshUtils::getPolygonVertices(*poly).empty()) return poly.get();
             }
             // 子の Geometry について再帰
             unsigned int num_geom = geometry.getGeometriesCount();
@@ -46,7 +51,7 @@ namespace plateau::polygonMesh {
             for (int lod = 0; lod <= max_lod_in_specification_; lod++) {
                 auto poly = findFirstPolygon(&city_obj, lod);
                 if (poly) {
-                    return poly->getVertices().at(0);
+                    return getPolygonVertices(*poly).at(0);
                 }
             }
         }
@@ -54,6 +59,17 @@ namespace plateau::polygonMesh {
         throw std::invalid_argument("Could not find position of CityObject.");
     }
 
+    const std::vector<TVec3d>& PolygonMeshUtils::getPolygonVertices(const Polygon& polygon) {
+        const auto& vertices = polygon.getVertices();
+        if (!vertices.empty())
+            return vertices;
+        const auto exterior_ring = polygon.exteriorRing();
+        if (exterior_ring != nullptr)
+            return exterior_ring->getVertices();
+        static const std::vector<TVec3d> empty;
+        return empty;
+    }
+
     TVec3d PolygonMeshUtils::getCenterPoint(const CityModel& city_model, int coordinate_zone_id) {
         auto& envelope = city_model.getEnvelope();
         if (!envelope.validBounds()) {
@@ -67,12 +83,13 @@ namespace plateau::polygonMesh {
      * city_obj の子を再帰的に検索して返します。
      * ただし引数のcityObj自身は含めません。
      */
-    std::list<const CityObject*> PolygonMeshUtils::getChildCityObjectsRecursive(const CityObject& city_obj) {
+    std::list<const CityObject*> PolygonMeshUtils::getChildCityObjectsRecursive(
+            const CityObject& city_obj, CityObject::CityObjectsType type_mask) {
         auto children = std::list<const CityObject*>();
         unsigned int num_child = city_obj.getChildCityObjectsCount();
         for (unsigned int i = 0; i < num_child; i++) {
             auto& child = city_obj.getChildCityObject(i);
-            childCityObjectsRecursive(child, children);
+            childCityObjectsRecursive(child, children, type_mask);
         }
         return children;
     }
@@ -92,4 +109,24 @@ namespace plateau::polygonMesh {
         }
         return nullptr;
     }
+
+    unsigned PolygonMeshUtils::getLodMask(const CityObject& city_obj) {
+        unsigned mask = 0;
+        // 子の CityObject について再帰
+        unsigned int num_obj = city_obj.getChildCityObjectsCount();
+        for (unsigned int i = 0; i < num_obj; i++) {
+            mask |= getLodMask(city_obj.getChildCityObject(i));
+        }
+        // 子の Geometry について、そのLODのポリゴンがあるか調べます。
+        unsigned int num_geom = city_obj.getGeometriesCount();
+        for (unsigned int i = 0; i < num_geom; i++) {
+            const auto& geometry = city_obj.getGeometry(i);
+            const auto lod = geometry.getLOD();
+            if (lod > max_lod_in_specification_ || (mask & (1u << lod)) != 0)
+                continue;
+            if (findFirstPolygonInGeometry(geometry, lod) != nullptr)
+                mask |= 1u << lod;
+        }
+        return mask;
+    }
 }
@@ -0,0 +1,333 @@
+#include "polygon_tessellator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace plateau::polygonMesh {
+    namespace {
+        /// 平面に投影した頂点を、輪をつなぐ双方向リストの要素として保持します。
+        struct Vertex {
+            /// rings を連結したときの頂点番号です。
+            unsigned index;
+            double x;
+            double y;
+            size_t prev;
+            size_t next;
+        };
+
+        /**
+         * 頂点のリストを保持し、耳刈り取り法で三角形に分割します。
+         * 頂点の追加で再確保が起きても参照が壊れないよう、リストのつながりは vertices_ の添字で表します。
+         */
+        class EarClipper {
+        public:
+            explicit EarClipper(std::vector<unsigned>& out_indices) :
+                out_indices_(out_indices) {
+            }
+
+            /// 輪を、counter_clockwise が true なら反時計回り、false なら時計回りになる向きで追加し、その先頭の添字を返します。
+            size_t addRing(const std::vector<std::pair<double, double>>& points, unsigned first_index, bool counter_clockwise) {
+                const bool reverse = (signedArea(points) > 0) != counter_clockwise;
+                const auto count = points.size();
+                const auto first = vertices_.size();
+                for (size_t k = 0; k < count; ++k) {
+                    const auto i = reverse ? count - 1 - k : k;
+                    const auto self = vertices_.size();
+                    vertices_.push_back({first_index + static_cast<unsigned>(i), points[i].first, points[i].second,
+                                         k == 0 ? first + count - 1 : self - 1,
+                                         k + 1 == count ? first : self + 1});
+                }
+                return first;
+            }
+
+            /// 時計回りの穴の輪を外周とつなぎます。穴は最も左の頂点の x が小さい順につなぐ必要があります。
+            void eliminateHoles(size_t outer, std::vector<size_t> holes) {
+                for (auto& hole : holes) {
+                    hole = leftmost(hole);
+                }
+                std::sort(holes.begin(), holes.end(), [this](size_t lhs, size_t rhs) {
+                    return v(lhs).x < v(rhs).x;
+                });
+                for (const auto hole : holes) {
+                    const auto bridge = findHoleBridge(hole, outer);
+                    if (bridge == npos)
+                        continue;
+                    splitPolygon(bridge, hole);
+                }
+            }
+
+            /// start を含む輪を三角形に分割します。
+            void clip(size_t start) {
+                clip(start, 0);
+            }
+
+        private:
+            static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+            std::vector<Vertex> vertices_;
+            std::vector<unsigned>& out_indices_;
+
+            Vertex& v(size_t i) {
+                return vertices_[i];
+            }
+
+            static double signedArea(const std::vector<std::pair<double, double>>& points) {
+                double sum = 0;
+                for (size_t i = 0, j = points.size() - 1; i < points.size(); j = i++) {
+                    sum += points[j].first * points[i].second - points[i].first * points[j].second;
+                }
+                return sum;
+            }
+
+            /// p, q, r の順に左に曲がるとき正、右に曲がるとき負を返します。
+            double area(size_t p, size_t q, size_t r) {
+                return (v(q).x - v(p).x) * (v(r).y - v(p).y) - (v(q).y - v(p).y) * (v(r).x - v(p).x);
+            }
+
+            bool equals(size_t p, size_t q) {
+                return v(p).x == v(q).x && v(p).y == v(q).y;
+            }
+
+            static bool pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy,
+                                        double px, double py) {
+                const auto d1 = (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+                const auto d2 = (cx - bx) * (py - by) - (cy - by) * (px - bx);
+                const auto d3 = (ax - cx) * (py - cy) - (ay - cy) * (px - cx);
+                const bool has_negative = d1 < 0 || d2 < 0 || d3 < 0;
+                const bool has_positive = d1 > 0 || d2 > 0 || d3 > 0;
+                return !(has_negative && has_positive);
+            }
+
+            /// a から b への対角線が、a の付近で輪の内側を通るかどうかを返します。
+            bool locallyInside(size_t a, size_t b) {
+                const auto prev = v(a).prev;
+                const auto next = v(a).next;
+                if (area(prev, a, next) >= 0)
+                    return area(a, next, b) >= 0 && area(a, b, prev) >= 0;
+                return area(a, next, b) >= 0 || area(a, b, prev) >= 0;
+            }
+
+            size_t leftmost(size_t start) {
+                auto result = start;
+                auto p = start;
+                do {
+                    if (v(p).x < v(result).x || (v(p).x == v(result).x && v(p).y < v(result).y))
+                        result = p;
+                    p = v(p).next;
+                } while (p != start);
+                return result;
+            }
+
+            void remove(size_t p) {
+                v(v(p).prev).next = v(p).next;
+                v(v(p).next).prev = v(p).prev;
+            }
+
+            /**
+             * 穴の最も左の頂点 hole から左に伸ばした半直線が最初に交わる外周の辺を求め、
+             * その付近で hole から見通せる外周の頂点を返します。
+             */
+            size_t findHoleBridge(size_t hole, size_t outer) {
+                const auto hx = v(hole).x;
+                const auto hy = v(hole).y;
+                auto qx = -std::numeric_limits<double>::infinity();
+                auto m = npos;
+                auto p = outer;
+                do {
+                    const auto next = v(p).next;
+                    const auto py = v(p).y;
+                    const auto ny = v(next).y;
+                    if (py != ny && ((hy <= py && hy >= ny) || (hy >= py && hy <= ny))) {
+                        const auto x = v(p).x + (hy - py) * (v(next).x - v(p).x) / (ny - py);
+                        if (x <= hx && x > qx) {
+                            qx = x;
+                            m = v(p).x < v(next).x ? p : next;
+                            if (x == hx)
+                                return m;
+                        }
+                    }
+                    p = next;
+                } while (p != outer);
+                if (m == npos)
+                    return npos;
+
+                // 半直線との交点と m を結ぶ三角形の中に外周の頂点があれば、半直線との角度が最も小さいものを選びます。
+                const auto stop = m;
+                const auto mx = v(m).x;
+                const auto my = v(m).y;
+                auto tan_min = std::numeric_limits<double>::infinity();
+                p = m;
+                do {
+                    if (hx >= v(p).x && v(p).x >= mx && hx != v(p).x &&
+                        pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, v(p).x, v(p).y)) {
+                        const auto tan = std::abs(hy - v(p).y) / (hx - v(p).x);
+                        if (locallyInside(p, hole) && (tan < tan_min || (tan == tan_min && v(p).x > v(m).x))) {
+                            m = p;
+                            tan_min = tan;
+                        }
+                    }
+                    p = v(p).next;
+                } while (p != stop);
+                return m;
+            }
+
+            /// a と b を対角線でつなぎます。a と b を複製し、a → b → (b の輪) → b の複製 → a の複製 → (a の輪) の順にします。
+            void splitPolygon(size_t a, size_t b) {
+                const auto a_copy = v(a);
+                const auto b_copy = v(b);
+                const auto a2 = vertices_.size();
+                vertices_.push_back(a_copy);
+                const auto b2 = vertices_.size();
+                vertices_.push_back(b_copy);
+                const auto an = v(a).next;
+                const auto bp = v(b).prev;
+
+                v(a).next = b;
+                v(b).prev = a;
+                v(a2).next = an;
+                v(an).prev = a2;
+                v(b2).next = a2;
+                v(a2).prev = b2;
+                v(bp).next = b2;
+                v(b2).prev = bp;
+            }
+
+            /// 重複する頂点と、同一直線上にある頂点を取り除きます。
+            size_t filterPoints(size_t start) {
+                auto p = start;
+                auto end = start;
+                bool again;
+                do {
+                    again = false;
+                    const auto next = v(p).next;
+                    if (next != v(p).prev && (equals(p, next) || area(v(p).prev, p, next) == 0)) {
+                        remove(p);
+                        p = end = v(p).prev;
+                        if (p == v(p).next)
+                            break;
+                        again = true;
+                    } else {
+                        p = next;
+                    }
+                } while (again || p != end);
+                return end;
+            }
+
+            bool isEar(size_t ear) {
+                const auto a = v(ear).prev;
+                const auto c = v(ear).next;
+                if (area(a, ear, c) <= 0)
+                    return false;
+
+                // 三角形の中に、へこんだ頂点があれば耳ではありません。
+                auto p = v(c).next;
+                while (p != a) {
+                    if (!equals(p, a) && !equals(p, ear) && !equals(p, c) &&
+                        pointInTriangle(v(a).x, v(a).y, v(ear).x, v(ear).y, v(c).x, v(c).y, v(p).x, v(p).y) &&
+                        area(v(p).prev, p, v(p).next) <= 0)
+                        return false;
+                    p = v(p).next;
+                }
+                return true;
+            }
+
+            /**
+             * 耳を順に切り取ります。耳が見つからなくなったら、pass 1 では不要な頂点を取り除いて続け、
+             * pass 2 では自己交差などで耳がない場合でも終わるよう、凸な頂点を耳とみなして切り取ります。
+             */
+            void clip(size_t ear, int pass) {
+                auto stop = ear;
+                while (v(ear).prev != v(ear).next) {
+                    const auto prev = v(ear).prev;
+                    const auto next = v(ear).next;
+                    const bool clip_anyway = pass == 2 && area(prev, ear, next) > 0;
+                    if (clip_anyway || isEar(ear)) {
+                        out_indices_.push_back(v(prev).index);
+                        out_indices_.push_back(v(ear).index);
+                        out_indices_.push_back(v(next).index);
+                        remove(ear);
+                        ear = v(next).next;
+                        stop = ear;
+                        continue;
+                    }
+                    ear = next;
+                    if (ear != stop)
+                        continue;
+
+                    // pass 2 で凸な頂点がなくなった残りは面積を持たないため捨てます。
+                    if (pass < 2)
+                        clip(filterPoints(ear), pass + 1);
+                    return;
+                }
+            }
+        };
+
+        /// 面積ベクトル (Newell 法) を求めます。向きは頂点が反時計回りに見える側です。
+        TVec3d newellNormal(const std::vector<TVec3d>& ring) {
+            double nx = 0, ny = 0, nz = 0;
+            for (size_t i = 0; i < ring.size(); ++i) {
+                const auto& current = ring[i];
+                const auto& next = ring[(i + 1) % ring.size()];
+                nx += (current.y - next.y) * (current.z + next.z);
+                ny += (current.z - next.z) * (current.x + next.x);
+                nz += (current.x - next.x) * (current.y + next.y);
+            }
+            return TVec3d(nx, ny, nz);
+        }
+    }
+
+    std::vector<unsigned> PolygonTessellator::tessellate(const std::vector<std::vector<TVec3d>>& rings) {
+        std::vector<unsigned> indices;
+        if (rings.empty() || rings.front().size() < 3)
+            return indices;
+
+        // 法線の成分が最も大きい軸を落として平面に投影します。法線が負の向きのときは2軸を入れ替え、外周が反時計回りに見えるようにします。
+        const auto normal = newellNormal(rings.front());
+        const double abs_normal[] = {std::abs(normal.x), std::abs(normal.y), std::abs(normal.z)};
+        const auto drop_axis = static_cast<int>(std::max_element(abs_normal, abs_normal + 3) - abs_normal);
+        if (abs_normal[drop_axis] == 0)
+            return indices;
+        const double normal_sign = drop_axis == 0 ? normal.x : drop_axis == 1 ? normal.y : normal.z;
+        const auto project = [drop_axis, normal_sign](const TVec3d& p) {
+            double u, w;
+            switch (drop_axis) {
+                case 0: u = p.y; w = p.z; break;
+                case 1: u = p.z; w = p.x; break;
+                default: u = p.x; w = p.y; break;
+            }
+            return normal_sign > 0 ? std::make_pair(u, w) : std::make_pair(w, u);
+        };
+
+        size_t vertex_count = 0;
+        for (const auto& ring : rings) {
+            vertex_count += ring.size();
+        }
+        indices.reserve(std::max(vertex_count, static_cast<size_t>(3)) * 3);
+
+        EarClipper clipper(indices);
+        size_t outer = 0;
+        std::vector<size_t> holes;
+        unsigned first_index = 0;
+        for (size_t r = 0; r < rings.size(); ++r) {
+            const auto& ring = rings[r];
+            if (r == 0 || ring.size() >= 3) {
+                std::vector<std::pair<double, double>> points;
+                points.reserve(ring.size());
+                for (const auto& p : ring) {
+                    points.push_back(project(p));
+                }
+                const auto first = clipper.addRing(points, first_index, r == 0);
+                if (r == 0)
+                    outer = first;
+                else
+                    holes.push_back(first);
+            }
+            first_index += static_cast<unsigned>(ring.size());
+        }
+
+        clipper.eliminateHoles(outer, holes);
+        clipper.clip(outer);
+        return indices;
+    }
+}
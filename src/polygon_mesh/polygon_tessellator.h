@@ -0,0 +1,25 @@
+#pragma once
+
+#include <citygml/vecs.hpp>
+#include <libplateau_api.h>
+#include <vector>
+
+namespace plateau::polygonMesh {
+    /**
+     * 穴のある平面ポリゴンを、耳刈り取り法 (ear clipping) で三角形に分割します。
+     *
+     * libcitygml のテッセレーションはパース時にすべてのポリゴンに対して行われますが、
+     * こちらは MeshFactory が抽出するポリゴンだけに対して、抽出時に行うためのものです。
+     * 穴は外周と橋渡しの辺でつないで1つの輪にしてから分割するため、新しい頂点は追加しません。
+     */
+    class LIBPLATEAU_EXPORT PolygonTessellator {
+    public:
+        /**
+         * rings の先頭を外周、残りを穴として三角形に分割し、頂点番号を3つずつ並べて返します。
+         * 頂点番号は rings の頂点を先頭から順に連結したときの番号です。
+         * 三角形は、外周の頂点の並びから求めた法線の側から見て反時計回りになります。
+         * 外周の面積が 0 のときなど、分割できないときは空を返します。
+         */
+        static std::vector<unsigned> tessellate(const std::vector<std::vector<TVec3d>>& rings);
+    };
+}
@@ -0,0 +1,53 @@
+#include <plateau/polygon_mesh/streaming_mesh_extractor.h>
+#include <plateau/polygon_mesh/mesh_extractor.h>
+#include <plateau/dataset/gml_filter.h>
+#include <plateau/dataset/gml_partitioner.h>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace plateau::polygonMesh {
+    namespace fs = std::filesystem;
+    using namespace plateau::dataset;
+
+    bool StreamingMeshExtractor::extract(const std::string& gml_path, const MeshExtractOptions& options,
+                                         const NodeSink& sink, const size_t batch_bytes) {
+        if (options.mesh_granularity == MeshGranularity::PerCityModelArea)
+            throw std::invalid_argument("StreamingMeshExtractor does not support PerCityModelArea.");
+
+        GmlTopLevelLayout layout;
+        {
+            std::ifstream ifs(fs::u8path(gml_path), std::ios::binary);
+            if (!ifs)
+                return false;
+            layout = GmlPartitioner::scan(ifs);
+        }
+        if (!layout.isValid())
+            return false;
+
+        citygml::ParserParams parser_params;
+        // 遅延テッセレーションでは、抽出するポリゴンだけを抽出時に三角形に分割します。
+        parser_params.tesselate = !options.enable_lazy_tessellation;
+        parser_params.keepVertices = true;
+        const auto filter_params = GmlFilterParams::fromExtractOptions(options);
+
+        for (const auto& members : GmlPartitioner::batch(layout, batch_bytes)) {
+            Model model;
+            {
+                const auto city_model = GmlPartitioner::loadPart(gml_path, layout, members, parser_params, filter_params);
+                if (city_model == nullptr)
+                    return false;
+                MeshExtractor::extract(model, *city_model, options);
+                // ノードを sink に渡す前に CityModel を解放します。
+            }
+            for (size_t i = 0; i < model.getRootNodeCount(); ++i) {
+                auto& lod_node = model.getRootNodeAt(i);
+                for (unsigned j = 0; j < lod_node.getChildCount(); ++j) {
+                    sink(lod_node.getName(), std::move(lod_node.getChildAt(j)));
+                }
+            }
+        }
+        return true;
+    }
+}
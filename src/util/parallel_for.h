@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace plateau::util {
+    /**
+     * [0, count) の各インデックスについて func(index) を複数のスレッドで並列に実行します。
+     * インデックスはスレッド間で動的に割り振られるため、処理時間にばらつきがあっても負荷が偏りにくくなっています。
+     * func が例外を投げた場合、残りの処理を打ち切り、最初の例外を呼び出し元で再送出します。
+     * max_threads が 0 のときはハードウェアのスレッド数を上限とします。
+     */
+    template<typename Func>
+    void parallelFor(size_t count, Func&& func, unsigned max_threads = 0) {
+        size_t thread_count = max_threads != 0 ? max_threads : std::thread::hardware_concurrency();
+        thread_count = std::min(std::max(thread_count, static_cast<size_t>(1)), count);
+        if (thread_count <= 1) {
+            for (size_t i = 0; i < count; ++i) {
+                func(i);
+            }
+            return;
+        }
+
+        std::atomic<size_t> next_index(0);
+        std::exception_ptr first_exception;
+        std::mutex exception_mutex;
+        const auto worker = [&]() {
+            while (true) {
+                const auto index = next_index.fetch_add(1);
+                if (index >= count)
+                    return;
+                try {
+                    func(index);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(exception_mutex);
+                    if (!first_exception)
+                        first_exception = std::current_exception();
+                    next_index.store(count);
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count - 1);
+        for (size_t i = 0; i + 1 < thread_count; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        if (first_exception)
+            std::rethrow_exception(first_exception);
+    }
+}
@@ -0,0 +1,57 @@
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <plateau/polygon_mesh/city_object_list.h>
+
+using namespace plateau::polygonMesh;
+
+TEST(CityObjectListTest, lookup_works_in_both_directions) { // NOLINT
+    CityObjectList list;
+    list.add({ 1, -1 }, "bldg_b");
+    list.add({ 0, -1 }, "bldg_a");
+    list.add({ 0, 0 }, "wall_a");
+    list.add({ 1, 0 }, "wall_b");
+
+    ASSERT_EQ(list.size(), 4);
+    ASSERT_EQ(list.getPrimaryGmlID(0), "bldg_a");
+    ASSERT_EQ(list.getAtomicGmlID({ 1, 0 }), "wall_b");
+    ASSERT_THROW(list.getAtomicGmlID({ 2, 0 }), std::out_of_range);
+
+    const auto index = list.getCityObjectIndex("wall_a");
+    ASSERT_EQ(index.primary_index, 0);
+    ASSERT_EQ(index.atomic_index, 0);
+    const auto not_found = list.getCityObjectIndex("unknown");
+    ASSERT_EQ(not_found.primary_index, -1);
+    ASSERT_EQ(not_found.atomic_index, -1);
+
+    // キーは地物インデックスの昇順で返ります。
+    std::vector<CityObjectIndex> keys;
+    list.getAllKeys(keys);
+    ASSERT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+}
+
+TEST(CityObjectListTest, overwritten_value_is_removed_from_reverse_lookup) { // NOLINT
+    CityObjectList list;
+    list.add({ 0, 0 }, "old_id");
+    list.add({ 0, 0 }, "new_id");
+
+    ASSERT_EQ(list.size(), 1);
+    ASSERT_EQ(list.getCityObjectIndex("old_id").primary_index, -1);
+    ASSERT_EQ(list.getCityObjectIndex("new_id").primary_index, 0);
+}
+
+TEST(CityObjectListTest, copied_list_shares_arena) { // NOLINT
+    const auto arena = std::make_shared<GmlIdArena>();
+    CityObjectList list(arena);
+    list.add({ 0, 0 }, "wall");
+    const auto copied = list;
+    list.add({ 0, 1 }, "wall");
+
+    ASSERT_EQ(arena->size(), 1);
+    ASSERT_EQ(&copied.getAtomicGmlID({ 0, 0 }), &list.getAtomicGmlID({ 0, 1 }));
+
+    std::vector<CityObjectIndex> indices;
+    list.getCityObjectIndices({ "wall", "none" }, indices);
+    ASSERT_EQ(indices.size(), 2);
+    ASSERT_EQ(indices[0].atomic_index, 0);
+    ASSERT_EQ(indices[1].atomic_index, -1);
+}
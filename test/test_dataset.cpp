@@ -1,10 +1,15 @@
+#include <condition_variable>
 #include <filesystem>
+#include <mutex>
+#include <thread>
 #include <gtest/gtest.h>
 
 #include <citygml/citygml.h>
 
 #include <plateau/dataset/dataset_source.h>
+#include <plateau/dataset/gml_filter.h>
 #include <plateau/dataset/i_dataset_accessor.h>
+#include "../src/dataset/local_dataset_accessor.h"
 
 using namespace citygml;
 using namespace plateau::dataset;
@@ -207,3 +212,141 @@ TEST_F(DatasetTest, get_max_lod_local){
     auto gml = gml_files->at(0);
     ASSERT_EQ(gml.getMaxLod(), 2);
 }
+
+TEST_F(DatasetTest, watch_local_applies_added_and_removed_gml_files) { // NOLINT
+    // 一時フォルダにコピーしたデータを監視し、GMLファイルの追加と削除が反映されるかテストします。
+    const auto temp_test_dir = fs::u8path(u8"../テスト用一時ディレクトリ_watch");
+    fs::remove_all(temp_test_dir);
+    fs::create_directories(temp_test_dir);
+    fs::copy(fs::u8path(source_path_) / "udx", temp_test_dir / "udx", fs::copy_options::recursive);
+    const auto accessor = LocalDatasetAccessor::find(temp_test_dir.u8string());
+    const auto initial_count = accessor->getGmlFileCount(PredefinedCityModelPackage::Building);
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::pair<LocalDatasetChange, std::string>> changes;
+    ASSERT_TRUE(accessor->startWatching([&](LocalDatasetChange change, const GmlFile& gml_file) {
+        std::lock_guard<std::mutex> lock(mutex);
+        changes.emplace_back(change, gml_file.getMeshCode().get());
+        changed.notify_all();
+    }, std::chrono::milliseconds(100)));
+    const auto wait_for_changes = [&](size_t count) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return changed.wait_for(lock, std::chrono::seconds(10), [&] { return changes.size() >= count; });
+    };
+
+    // 書き込み途中のファイルが通知されないよう、udx の外で作ってから移動します。
+    const auto bldg_dir = temp_test_dir / "udx" / "bldg";
+    const auto added_path = bldg_dir / "53392643_bldg_6697_op2.gml";
+    fs::copy_file(bldg_dir / "53392642_bldg_6697_op2.gml", temp_test_dir / "53392643_bldg_6697_op2.gml");
+    fs::rename(temp_test_dir / "53392643_bldg_6697_op2.gml", added_path);
+    ASSERT_TRUE(wait_for_changes(1));
+    ASSERT_EQ(changes[0].first, LocalDatasetChange::Added);
+    ASSERT_EQ(changes[0].second, "53392643");
+    ASSERT_EQ(accessor->getGmlFileCount(PredefinedCityModelPackage::Building), initial_count + 1);
+    ASSERT_EQ(accessor->getMeshCodes().count(MeshCode("53392643")), 1);
+
+    fs::remove(added_path);
+    ASSERT_TRUE(wait_for_changes(2));
+    ASSERT_EQ(changes[1].first, LocalDatasetChange::Removed);
+    ASSERT_EQ(changes[1].second, "53392643");
+    ASSERT_EQ(accessor->getGmlFileCount(PredefinedCityModelPackage::Building), initial_count);
+    ASSERT_EQ(accessor->getMeshCodes().count(MeshCode("53392643")), 0);
+
+    accessor->stopWatching();
+    fs::remove_all(temp_test_dir);
+}
+
+TEST_F(DatasetTest, watch_local_keeps_only_shallowest_gml_files_like_find) { // NOLINT
+    const auto temp_test_dir = fs::u8path(u8"../テスト用一時ディレクトリ_watch_depth");
+    fs::remove_all(temp_test_dir);
+    fs::create_directories(temp_test_dir);
+    fs::copy(fs::u8path(source_path_) / "udx", temp_test_dir / "udx", fs::copy_options::recursive);
+    const auto accessor = LocalDatasetAccessor::find(temp_test_dir.u8string());
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::pair<LocalDatasetChange, std::string>> changes;
+    ASSERT_TRUE(accessor->startWatching([&](LocalDatasetChange change, const GmlFile& gml_file) {
+        std::lock_guard<std::mutex> lock(mutex);
+        changes.emplace_back(change, gml_file.getMeshCode().get());
+        changed.notify_all();
+    }, std::chrono::milliseconds(100)));
+    const auto wait_for_changes = [&](size_t count) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return changed.wait_for(lock, std::chrono::seconds(10), [&] { return changes.size() >= count; });
+    };
+    // 書き込み途中のファイルが通知されないよう、udx の外で作ってから移動します。
+    const auto tran_dir = temp_test_dir / "udx" / "tran";
+    const auto add_gml = [&](const fs::path& path) {
+        const auto temp_path = temp_test_dir / path.filename();
+        fs::copy_file(fs::u8path(source_path_) / "udx" / "tran" / "533925_tran_6697_op.gml", temp_path);
+        fs::rename(temp_path, path);
+    };
+
+    // 既存のファイルより深い階層のファイルは、find と同じく対象外です。
+    fs::create_directories(tran_dir / "sub");
+    add_gml(tran_dir / "sub" / "533926_tran_6697_op.gml");
+    add_gml(temp_test_dir / "udx" / "bldg" / "53392643_bldg_6697_op2.gml");
+    ASSERT_TRUE(wait_for_changes(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    ASSERT_EQ(changes.size(), 1u);
+    ASSERT_EQ(changes[0].second, "53392643");
+    ASSERT_EQ(accessor->getMeshCodes().count(MeshCode("533926")), 0);
+
+    // 最も浅いファイルがなくなると、次に浅い階層のファイルが対象になります。
+    fs::remove(tran_dir / "533925_tran_6697_op.gml");
+    ASSERT_TRUE(wait_for_changes(3));
+    ASSERT_EQ(changes[1].first, LocalDatasetChange::Removed);
+    ASSERT_EQ(changes[1].second, "533925");
+    ASSERT_EQ(changes[2].first, LocalDatasetChange::Added);
+    ASSERT_EQ(changes[2].second, "533926");
+    ASSERT_EQ(accessor->getGmlFileCount(PredefinedCityModelPackage::Road), 1);
+
+    // より浅い階層にファイルが追加されると、それまでのファイルは対象外になります。
+    add_gml(tran_dir / "533927_tran_6697_op.gml");
+    ASSERT_TRUE(wait_for_changes(5));
+    ASSERT_EQ(changes[3].first, LocalDatasetChange::Removed);
+    ASSERT_EQ(changes[3].second, "533926");
+    ASSERT_EQ(changes[4].first, LocalDatasetChange::Added);
+    ASSERT_EQ(changes[4].second, "533927");
+    ASSERT_EQ(accessor->getGmlFileCount(PredefinedCityModelPackage::Road), 1);
+    ASSERT_EQ(accessor->getGmlFile(PredefinedCityModelPackage::Road, 0).getMeshCode().get(), "533927");
+
+    accessor->stopWatching();
+    fs::remove_all(temp_test_dir);
+}
+
+TEST_F(DatasetTest, temporary_files_of_gml_filter_are_not_found_nor_watched) { // NOLINT
+    const auto temp_test_dir = fs::u8path(u8"../テスト用一時ディレクトリ_watch_filter");
+    fs::remove_all(temp_test_dir);
+    fs::create_directories(temp_test_dir);
+    fs::copy(fs::u8path(source_path_) / "udx", temp_test_dir / "udx", fs::copy_options::recursive);
+    const auto gml_path = temp_test_dir / "udx" / "bldg" / "53392642_bldg_6697_op2.gml";
+
+    // 読み込み中に異常終了して一時ファイルが残っても、GMLファイルとしては扱いません。
+    const auto initial_count =
+            LocalDatasetAccessor::find(temp_test_dir.u8string())->getGmlFileCount(PredefinedCityModelPackage::Building);
+    fs::copy_file(gml_path, fs::u8path(gml_path.u8string() + ".filtered_1_0_0.tmp"));
+    const auto accessor = LocalDatasetAccessor::find(temp_test_dir.u8string());
+    ASSERT_EQ(accessor->getGmlFileCount(PredefinedCityModelPackage::Building), initial_count);
+
+    std::mutex mutex;
+    std::vector<std::pair<LocalDatasetChange, std::string>> changes;
+    ASSERT_TRUE(accessor->startWatching([&](LocalDatasetChange change, const GmlFile& gml_file) {
+        std::lock_guard<std::mutex> lock(mutex);
+        changes.emplace_back(change, gml_file.getPath());
+    }, std::chrono::milliseconds(100)));
+
+    // GMLファイルと同じフォルダに一時ファイルを作って読み込みますが、その追加と削除は通知されません。
+    ParserParams params;
+    ASSERT_NE(GmlFilter::load(gml_path.u8string(), params, GmlFilterParams::geometryOnly()), nullptr);
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ASSERT_TRUE(changes.empty()) << changes[0].second;
+    }
+
+    accessor->stopWatching();
+    fs::remove_all(temp_test_dir);
+}
@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
 #include <plateau/dataset/dataset_source.h>
+#include <chrono>
+#include <condition_variable>
 #include <filesystem>
 #include <memory>
+#include <mutex>
 
 #include "plateau/network/client.h"
 
@@ -29,5 +32,44 @@ namespace plateau::dataset {
         ASSERT_EQ(mesh_code_str, "533926");
         auto gml_files = accessor->getGmlFiles(PredefinedCityModelPackage::Building);
         ASSERT_EQ(gml_files->at(0).getMeshCode().get(), "53392642");
+        ASSERT_FALSE(accessor->startWatching([](LocalDatasetChange, const GmlFile&) {}));
+        ASSERT_FALSE(accessor->isWatching());
+    }
+
+    TEST_F(DatasetSourceTest, accessor_of_local_source_can_watch_and_returns_mesh_codes_as_copy) { // NOLINT
+        const auto temp_test_dir = fs::u8path(u8"../テスト用一時ディレクトリ_source_watch");
+        fs::remove_all(temp_test_dir);
+        fs::create_directories(temp_test_dir);
+        fs::copy(fs::u8path(u8"../data/日本語パステスト/udx"), temp_test_dir / "udx", fs::copy_options::recursive);
+        const auto source = DatasetSource::createLocal(temp_test_dir.u8string());
+        const auto accessor = source.getAccessor();
+
+        std::mutex mutex;
+        std::condition_variable changed;
+        int change_count = 0;
+        ASSERT_TRUE(accessor->startWatching([&](LocalDatasetChange, const GmlFile&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++change_count;
+            changed.notify_all();
+        }, std::chrono::milliseconds(100)));
+        ASSERT_TRUE(accessor->isWatching());
+        const auto mesh_codes_before = accessor->getMeshCodes();
+
+        // 書き込み途中のファイルが通知されないよう、udx の外で作ってから移動します。
+        const auto bldg_dir = temp_test_dir / "udx" / "bldg";
+        fs::copy_file(bldg_dir / "53392642_bldg_6697_op2.gml", temp_test_dir / "53392643_bldg_6697_op2.gml");
+        fs::rename(temp_test_dir / "53392643_bldg_6697_op2.gml", bldg_dir / "53392643_bldg_6697_op2.gml");
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ASSERT_TRUE(changed.wait_for(lock, std::chrono::seconds(10), [&] { return change_count >= 1; }));
+        }
+
+        // 先に取得したメッシュコードは監視スレッドの変更を受けません。
+        ASSERT_EQ(mesh_codes_before.count(MeshCode("53392643")), 0);
+        ASSERT_EQ(accessor->getMeshCodes().count(MeshCode("53392643")), 1);
+
+        accessor->stopWatching();
+        ASSERT_FALSE(accessor->isWatching());
+        fs::remove_all(temp_test_dir);
     }
 }
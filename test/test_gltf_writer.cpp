@@ -1,12 +1,22 @@
+#include <atomic>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <iterator>
+#include <set>
+#include <thread>
 #include <gtest/gtest.h>
 
 #include <citygml/citygml.h>
 #include <citygml/citymodel.h>
 
 #include <plateau/polygon_mesh/mesh_extractor.h>
+#include <plateau/polygon_mesh/mesh_instancer.h>
 #include <plateau/mesh_writer/gltf_writer.h>
+#include "test_mesh_helper.h"
+
+#include "../3rdparty/json/single_include/nlohmann/json.hpp"
 
 using namespace citygml;
 namespace fs = std::filesystem;
@@ -38,6 +48,8 @@ namespace plateau::meshWriter {
                 *city_model_, mesh_extract_options_);
 
         static void assertFileExists(const fs::path& file_path);
+        /// GLTF 形式で書き出したファイルの JSON を読み込みます。
+        static nlohmann::json readGltfJson(const fs::path& gltf_path);
         bool exportGltf(GltfFileFormat file_format, const fs::path& output_dir, const fs::path& output_gltf_path,
                         const fs::path& output_texture_dir);
     };
@@ -87,12 +99,271 @@ namespace plateau::meshWriter {
         assertFileExists(expected_output_glb);
     }
 
+    TEST_F(GltfWriterTest, glb_with_feature_metadata_is_written_with_merged_primitives) { // NOLINT
+        auto extract_options = mesh_extract_options_;
+        extract_options.mesh_granularity = plateau::polygonMesh::MeshGranularity::PerAtomicFeatureObject;
+        const auto atomic_model = plateau::polygonMesh::MeshExtractor::extract(*city_model_, extract_options);
+
+        auto output_dir = fs::u8path(u8"./tempTestDestDir");
+        fs::create_directories(output_dir);
+        auto expected_output_glb = fs::path(output_dir).append(basename_ + ".glb");
+
+        GltfWriteOptions gltf_options;
+        gltf_options.mesh_file_format = GltfFileFormat::GLB;
+        gltf_options.write_feature_metadata = true;
+        gltf_options.feature_attribute_keys = { "bldg:measuredHeight" };
+        auto result = GltfWriter().write(expected_output_glb.u8string(), *atomic_model, gltf_options, city_model_.get());
+
+        ASSERT_TRUE(result);
+        assertFileExists(expected_output_glb);
+    }
+
+    TEST_F(GltfWriterTest, feature_metadata_is_written_per_root_node) { // NOLINT
+        auto extract_options = mesh_extract_options_;
+        extract_options.mesh_granularity = plateau::polygonMesh::MeshGranularity::PerAtomicFeatureObject;
+        const auto atomic_model = plateau::polygonMesh::MeshExtractor::extract(*city_model_, extract_options);
+
+        auto output_dir = fs::u8path(u8"./tempTestDestDir");
+        fs::create_directories(output_dir);
+        auto output_gltf = fs::path(output_dir).append(basename_ + ".gltf");
+
+        GltfWriteOptions gltf_options;
+        gltf_options.mesh_file_format = GltfFileFormat::GLTF;
+        gltf_options.write_feature_metadata = true;
+        gltf_options.feature_attribute_keys = { "bldg:measuredHeight" };
+        ASSERT_TRUE(GltfWriter().write(output_gltf.u8string(), *atomic_model, gltf_options, city_model_.get()));
+
+        const auto gltf = readGltfJson(output_gltf);
+        const auto& extensions_used = gltf.at("extensionsUsed");
+        ASSERT_NE(std::find(extensions_used.begin(), extensions_used.end(), "EXT_mesh_features"), extensions_used.end());
+        ASSERT_NE(std::find(extensions_used.begin(), extensions_used.end(), "EXT_structural_metadata"), extensions_used.end());
+
+        // LODごとのルートノードは、それぞれ1つのノードに結合されます。
+        std::vector<std::string> root_names;
+        std::set<std::string> gml_ids;
+        std::function<bool(const plateau::polygonMesh::Node&)> collect_gml_ids =
+                [&](const plateau::polygonMesh::Node& node) {
+            bool has_mesh = false;
+            const auto mesh = node.getMesh();
+            if (mesh != nullptr && !mesh->getSubMeshes().empty()) {
+                has_mesh = true;
+                const auto& city_object_list = mesh->getCityObjectList();
+                for (const auto& uv : mesh->getUV4()) {
+                    const auto index = plateau::polygonMesh::CityObjectIndex::fromUV(uv);
+                    // 最小地物、主要地物の順に gml:id を探し、どちらもなければ空文字列の地物とします。
+                    std::string gml_id;
+                    try {
+                        gml_id = city_object_list.getAtomicGmlID(index);
+                    } catch (const std::out_of_range&) {
+                        try {
+                            gml_id = city_object_list.getPrimaryGmlID(index.primary_index);
+                        } catch (const std::out_of_range&) {
+                        }
+                    }
+                    gml_ids.insert(gml_id);
+                }
+            }
+            for (size_t i = 0; i < node.getChildCount(); ++i) {
+                has_mesh |= collect_gml_ids(node.getChildAt(i));
+            }
+            return has_mesh;
+        };
+        for (size_t i = 0; i < atomic_model->getRootNodeCount(); ++i) {
+            const auto& root_node = atomic_model->getRootNodeAt(i);
+            if (collect_gml_ids(root_node))
+                root_names.push_back(root_node.getName());
+        }
+        ASSERT_GT(root_names.size(), 1u);
+        const auto& nodes = gltf.at("nodes");
+        ASSERT_EQ(nodes.size(), root_names.size());
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            ASSERT_EQ(nodes.at(i).at("name").get<std::string>(), root_names.at(i));
+        }
+
+        for (const auto& mesh : gltf.at("meshes")) {
+            for (const auto& primitive : mesh.at("primitives")) {
+                ASSERT_TRUE(primitive.at("attributes").contains("_FEATURE_ID_0"));
+                const auto& feature_ids = primitive.at("extensions").at("EXT_mesh_features").at("featureIds");
+                ASSERT_EQ(feature_ids.size(), 1u);
+                ASSERT_EQ(feature_ids.at(0).at("propertyTable").get<int>(), 0);
+            }
+        }
+
+        const auto& property_tables = gltf.at("extensions").at("EXT_structural_metadata").at("propertyTables");
+        ASSERT_EQ(property_tables.size(), 1u);
+        ASSERT_EQ(property_tables.at(0).at("count").get<size_t>(), gml_ids.size());
+        ASSERT_TRUE(property_tables.at(0).at("properties").contains("gml_id"));
+        ASSERT_TRUE(property_tables.at(0).at("properties").contains("bldg_measuredHeight"));
+
+        // プロパティテーブルが参照するバッファビューは8バイト境界から始まります。
+        const auto& buffer_views = gltf.at("bufferViews");
+        for (const auto& property : property_tables.at(0).at("properties")) {
+            for (const auto key : { "values", "stringOffsets" }) {
+                const auto& buffer_view = buffer_views.at(property.at(key).get<size_t>());
+                ASSERT_EQ(buffer_view.value("byteOffset", size_t(0)) % 8, 0u);
+            }
+        }
+
+        // 境界を揃えても、各文字列はバッファビューの位置から読み出せます。
+        std::ifstream bin_stream(output_dir / gltf.at("buffers").at(0).at("uri").get<std::string>(), std::ios::binary);
+        const std::string bin((std::istreambuf_iterator<char>(bin_stream)), std::istreambuf_iterator<char>());
+        const auto& gml_id_property = property_tables.at(0).at("properties").at("gml_id");
+        const auto& values_view = buffer_views.at(gml_id_property.at("values").get<size_t>());
+        const auto& offsets_view = buffer_views.at(gml_id_property.at("stringOffsets").get<size_t>());
+        std::vector<uint32_t> offsets(offsets_view.at("byteLength").get<size_t>() / sizeof(uint32_t));
+        std::memcpy(offsets.data(), bin.data() + offsets_view.value("byteOffset", size_t(0)), offsets.size() * sizeof(uint32_t));
+        ASSERT_EQ(offsets.size(), gml_ids.size() + 1);
+        for (size_t i = 0; i < gml_ids.size(); ++i) {
+            const auto gml_id = bin.substr(values_view.value("byteOffset", size_t(0)) + offsets[i], offsets[i + 1] - offsets[i]);
+            ASSERT_EQ(gml_ids.count(gml_id), 1u);
+        }
+    }
+
+    TEST_F(GltfWriterTest, quantized_glb_is_smaller_than_float_glb) { // NOLINT
+        auto output_dir = fs::u8path(u8"./tempTestDestDir");
+        fs::create_directories(output_dir);
+        auto float_glb = fs::path(output_dir).append(basename_ + "_float.glb");
+        auto quantized_glb = fs::path(output_dir).append(basename_ + "_quantized.glb");
+
+        GltfWriteOptions gltf_options;
+        gltf_options.mesh_file_format = GltfFileFormat::GLB;
+        ASSERT_TRUE(GltfWriter().write(float_glb.u8string(), *model_, gltf_options));
+        gltf_options.quantize_vertices = true;
+        ASSERT_TRUE(GltfWriter().write(quantized_glb.u8string(), *model_, gltf_options));
+
+        ASSERT_LT(fs::file_size(quantized_glb), fs::file_size(float_glb));
+    }
+
+    TEST_F(GltfWriterTest, quantized_accessors_are_declared_with_khr_mesh_quantization) { // NOLINT
+        auto output_dir = fs::u8path(u8"./tempTestDestDir");
+        fs::create_directories(output_dir);
+        auto output_gltf = fs::path(output_dir).append(basename_ + "_quantized.gltf");
+
+        GltfWriteOptions gltf_options;
+        gltf_options.mesh_file_format = GltfFileFormat::GLTF;
+        gltf_options.quantize_vertices = true;
+        ASSERT_TRUE(GltfWriter().write(output_gltf.u8string(), *model_, gltf_options));
+
+        const auto gltf = readGltfJson(output_gltf);
+        for (const auto key : { "extensionsUsed", "extensionsRequired" }) {
+            const auto& extensions = gltf.at(key);
+            ASSERT_NE(std::find(extensions.begin(), extensions.end(), "KHR_mesh_quantization"), extensions.end());
+        }
+
+        const auto& accessors = gltf.at("accessors");
+        ASSERT_GT(gltf.at("meshes").size(), 0u);
+        for (const auto& mesh : gltf.at("meshes")) {
+            for (const auto& primitive : mesh.at("primitives")) {
+                // 座標は正規化しない int16 (SHORT) です。
+                const auto& position = accessors.at(primitive.at("attributes").at("POSITION").get<size_t>());
+                ASSERT_EQ(position.at("componentType").get<int>(), 5122);
+                ASSERT_FALSE(position.value("normalized", false));
+                // 0〜1 に収まる UV は正規化した uint16 (UNSIGNED_SHORT)、収まらない UV は float のままです。
+                if (!primitive.at("attributes").contains("TEXCOORD_0"))
+                    continue;
+                const auto& texcoord = accessors.at(primitive.at("attributes").at("TEXCOORD_0").get<size_t>());
+                const auto component_type = texcoord.at("componentType").get<int>();
+                if (component_type == 5123) {
+                    ASSERT_TRUE(texcoord.value("normalized", false));
+                } else {
+                    ASSERT_EQ(component_type, 5126);
+                }
+            }
+        }
+        // 量子化した座標はノードの移動と拡大縮小で元に戻します。
+        for (const auto& node : gltf.at("nodes")) {
+            ASSERT_TRUE(node.contains("translation"));
+            ASSERT_TRUE(node.contains("scale"));
+        }
+    }
+
+    TEST_F(GltfWriterTest, instanced_node_is_written_with_ext_mesh_gpu_instancing) { // NOLINT
+        auto model = plateau::polygonMesh::Model::createModel();
+        auto& root = model->addEmptyNode("root");
+        root.addChildNode(plateau::polygonMesh::Node("lamp_1", plateau::polygonMesh::test::createSquare(TVec3d(10, 20, 0), 1)));
+        root.addChildNode(plateau::polygonMesh::Node("lamp_2", plateau::polygonMesh::test::createSquare(TVec3d(-5, 3, 2), 1)));
+        ASSERT_EQ(plateau::polygonMesh::MeshInstancer::instantiate(*model), 1u);
+
+        auto output_dir = fs::u8path(u8"./tempTestDestDir");
+        fs::create_directories(output_dir);
+        auto output_gltf = fs::path(output_dir).append("instanced.gltf");
+        GltfWriteOptions gltf_options;
+        gltf_options.mesh_file_format = GltfFileFormat::GLTF;
+        gltf_options.quantize_vertices = true;
+        ASSERT_TRUE(GltfWriter().write(output_gltf.u8string(), *model, gltf_options));
+
+        const auto gltf = readGltfJson(output_gltf);
+        const auto& extensions_used = gltf.at("extensionsUsed");
+        ASSERT_NE(std::find(extensions_used.begin(), extensions_used.end(), "EXT_mesh_gpu_instancing"), extensions_used.end());
+
+        const auto& nodes = gltf.at("nodes");
+        ASSERT_EQ(nodes.size(), 1u);
+        const auto& node = nodes.at(0);
+        ASSERT_EQ(node.at("name").get<std::string>(), "lamp_1");
+        // インスタンスを持つノードは量子化しません。
+        ASSERT_FALSE(node.contains("scale"));
+
+        const auto& accessors = gltf.at("accessors");
+        const auto translation_index = node.at("extensions").at("EXT_mesh_gpu_instancing")
+                .at("attributes").at("TRANSLATION").get<size_t>();
+        const auto& translation = accessors.at(translation_index);
+        ASSERT_EQ(translation.at("count").get<size_t>(), 2u);
+        ASSERT_EQ(translation.at("type").get<std::string>(), "VEC3");
+        ASSERT_EQ(translation.at("componentType").get<int>(), 5126);
+
+        const auto mesh_index = node.at("mesh").get<size_t>();
+        const auto& primitive = gltf.at("meshes").at(mesh_index).at("primitives").at(0);
+        const auto& position = accessors.at(primitive.at("attributes").at("POSITION").get<size_t>());
+        ASSERT_EQ(position.at("componentType").get<int>(), 5126);
+    }
+
+    TEST_F(GltfWriterTest, one_writer_can_write_files_concurrently) { // NOLINT
+        const auto output_dir = fs::u8path(u8"./tempTestDestDir/concurrent");
+        fs::create_directories(output_dir);
+        GltfWriteOptions gltf_options;
+        gltf_options.mesh_file_format = GltfFileFormat::GLB;
+        // すべてのファイルが同じテクスチャを同じフォルダにコピーします。
+        gltf_options.texture_directory_path = "textures";
+
+        const GltfWriter writer;
+        constexpr int file_count = 8;
+        std::vector<std::thread> threads;
+        std::atomic<int> success_count(0);
+        for (int i = 0; i < file_count; ++i) {
+            threads.emplace_back([&, i]() {
+                const auto path = (output_dir / fs::u8path("tile_" + std::to_string(i) + ".glb")).u8string();
+                if (writer.write(path, *model_, gltf_options))
+                    ++success_count;
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        ASSERT_EQ(success_count.load(), file_count);
+        for (int i = 0; i < file_count; ++i) {
+            assertFileExists(output_dir / fs::u8path("tile_" + std::to_string(i) + ".glb"));
+        }
+        // 一時ファイルが残っていないことを確認します。
+        const auto texture_dir = output_dir / "textures";
+        if (!fs::exists(texture_dir))
+            return;
+        for (const auto& entry : fs::directory_iterator(texture_dir)) {
+            ASSERT_EQ(entry.path().u8string().find(".tmp"), std::string::npos);
+        }
+    }
+
     void GltfWriterTest::assertFileExists(const fs::path& file_path) {
         std::ifstream ifs(file_path);
         ASSERT_TRUE(ifs.is_open());
         ifs.close();
     }
 
+    nlohmann::json GltfWriterTest::readGltfJson(const fs::path& gltf_path) {
+        std::ifstream ifs(gltf_path);
+        return nlohmann::json::parse(ifs);
+    }
+
     bool GltfWriterTest::exportGltf(GltfFileFormat file_format, const fs::path& output_dir,
                                     const fs::path& output_gltf_path, const fs::path& texture_dir) {
         fs::create_directories(output_dir);
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include <plateau/dataset/gml_filter.h>
+#include <citygml/citymodel.h>
+#include <fstream>
+#include <sstream>
+
+namespace plateau::dataset {
+    class GmlFilterTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            params_.tesselate = true;
+        }
+
+        const std::string gml_path_ = u8"../data/日本語パステスト/udx/bldg/53392642_bldg_6697_op2.gml";
+        citygml::ParserParams params_;
+    };
+
+    namespace {
+        std::string filterString(const std::string& content, const GmlFilterParams& params) {
+            std::istringstream in(content);
+            std::ostringstream out;
+            GmlFilter::filter(in, out, params);
+            return out.str();
+        }
+
+        /// 座標 pos_list を外周とするポリゴンを、形状プロパティ property で包んだ文字列を返します。
+        std::string polygonIn(const std::string& property, const std::string& pos_list) {
+            return "<bldg:" + property + "><gml:MultiSurface><gml:surfaceMember><gml:Polygon><gml:exterior><gml:LinearRing>"
+                   "<gml:posList>" + pos_list + "</gml:posList></gml:LinearRing></gml:exterior></gml:Polygon>"
+                   "</gml:surfaceMember></gml:MultiSurface></bldg:" + property + ">";
+        }
+
+        size_t countOf(const std::string& str, const std::string& pattern) {
+            size_t count = 0;
+            for (auto pos = str.find(pattern); pos != std::string::npos; pos = str.find(pattern, pos + 1)) {
+                ++count;
+            }
+            return count;
+        }
+    }
+
+    TEST_F(GmlFilterTest, lod_mask_of_sets_bits_in_range) { // NOLINT
+        ASSERT_EQ(GmlFilterParams::lodMaskOf(1, 2), 0b110u);
+        ASSERT_EQ(GmlFilterParams::lodMaskOf(0, 0), 0b1u);
+    }
+
+    TEST_F(GmlFilterTest, removes_geometry_of_lods_not_in_mask) { // NOLINT
+        GmlFilterParams params;
+        params.lod_mask = GmlFilterParams::lodMaskOf(1, 1);
+        const auto filtered = filterString(
+                "<bldg:Building><bldg:lod1Solid><gml:Solid>a</gml:Solid></bldg:lod1Solid>"
+                "<bldg:lod2Solid><gml:Solid attr=\"x>y\">b</gml:Solid></bldg:lod2Solid>"
+                "<bldg:lod2MultiSurface/><!-- <bldg:lod2Solid> --></bldg:Building>", params);
+        ASSERT_EQ(filtered,
+                  "<bldg:Building><bldg:lod1Solid><gml:Solid>a</gml:Solid></bldg:lod1Solid>"
+                  "<!-- <bldg:lod2Solid> --></bldg:Building>");
+    }
+
+    TEST_F(GmlFilterTest, filter_with_default_params_keeps_file_unchanged) { // NOLINT
+        std::ifstream ifs(gml_path_, std::ios::binary);
+        std::stringstream original;
+        original << ifs.rdbuf();
+        ASSERT_EQ(filterString(original.str(), GmlFilterParams()), original.str());
+    }
+
+    TEST_F(GmlFilterTest, load_skips_geometry_of_lods_not_in_mask) { // NOLINT
+        GmlFilterParams filter_params;
+        filter_params.lod_mask = GmlFilterParams::lodMaskOf(0, 1);
+        const auto city_model = GmlFilter::load(gml_path_, params_, filter_params);
+        ASSERT_NE(city_model, nullptr);
+        const auto& buildings = city_model->getAllCityObjectsOfType(citygml::CityObject::CityObjectsType::COT_Building);
+        ASSERT_FALSE(buildings.empty());
+        for (const auto building : buildings) {
+            for (unsigned i = 0; i < building->getGeometriesCount(); ++i) {
+                ASSERT_LE(building->getGeometry(i).getLOD(), 1u);
+            }
+        }
+    }
+
+    TEST_F(GmlFilterTest, removes_city_object_members_outside_extent) { // NOLINT
+        GmlFilterParams params;
+        params.exclude_city_object_outside_extent = true;
+        params.extent = geometry::Extent(geometry::GeoCoordinate(0, 0, 0), geometry::GeoCoordinate(10, 10, 10));
+        const auto inside = "<core:cityObjectMember><bldg:Building>" + polygonIn("lod1Solid", "1 2 3 1 3 3 2 3 3") +
+                            "<a>in</a></bldg:Building></core:cityObjectMember>";
+        const auto filtered = filterString(
+                "<core:CityModel>" + inside +
+                "<core:cityObjectMember><bldg:Building>" + polygonIn("lod1Solid", "50 2 3 50 3 3 51 3 3") +
+                "<a>out</a></bldg:Building></core:cityObjectMember>"
+                "<core:cityObjectMember><bldg:Building/></core:cityObjectMember>"
+                "</core:CityModel>", params);
+        ASSERT_EQ(filtered, "<core:CityModel>" + inside + "</core:CityModel>");
+    }
+
+    TEST_F(GmlFilterTest, position_of_city_object_member_is_decided_like_city_obj_pos) { // NOLINT
+        GmlFilterParams params;
+        params.exclude_city_object_outside_extent = true;
+        params.extent = geometry::Extent(geometry::GeoCoordinate(0, 0, 0), geometry::GeoCoordinate(10, 10, 10));
+        const auto member = [](const std::string& content) {
+            return "<core:cityObjectMember><bldg:Building>" + content + "</bldg:Building></core:cityObjectMember>";
+        };
+        const auto wall = [](const std::string& content) {
+            return "<bldg:boundedBy><bldg:WallSurface>" + content + "</bldg:WallSurface></bldg:boundedBy>";
+        };
+        const auto envelope = [](const std::string& lower, const std::string& upper) {
+            return "<gml:boundedBy><gml:Envelope><gml:lowerCorner>" + lower + "</gml:lowerCorner><gml:upperCorner>" +
+                   upper + "</gml:upperCorner></gml:Envelope></gml:boundedBy>";
+        };
+        // 最も低い LOD のポリゴンの頂点で判定します。
+        const auto lowest_lod_inside = member(polygonIn("lod2MultiSurface", "50 2 3") + polygonIn("lod1Solid", "1 2 3"));
+        const auto lowest_lod_outside = member(polygonIn("lod2MultiSurface", "1 2 3") + polygonIn("lod1Solid", "50 2 3"));
+        // 主要地物自身の Envelope があれば、ポリゴンより優先してその中心で判定します。
+        const auto envelope_inside = member(envelope("0 0 0", "4 4 4") + polygonIn("lod0RoofEdge", "50 2 3"));
+        // 同じ LOD では、子の都市オブジェクトのポリゴンを自身のポリゴンより優先します。
+        const auto child_outside = member(polygonIn("lod2MultiSurface", "1 2 3") + wall(polygonIn("lod2MultiSurface", "50 2 3")));
+        // 子の都市オブジェクトの Envelope は使いません。
+        const auto child_envelope = member(wall(envelope("1 1 1", "2 2 2") + polygonIn("lod2MultiSurface", "50 2 3")));
+        // インスタンス化された形状しかなければ、位置が不明なため取り除きます。
+        const auto implicit_only = member(polygonIn("lod1ImplicitRepresentation", "1 2 3"));
+
+        const auto filtered = filterString(
+                "<core:CityModel>" + lowest_lod_inside + lowest_lod_outside + envelope_inside + child_outside +
+                child_envelope + implicit_only + "</core:CityModel>", params);
+        ASSERT_EQ(filtered, "<core:CityModel>" + lowest_lod_inside + envelope_inside + "</core:CityModel>");
+    }
+
+    TEST_F(GmlFilterTest, keeps_only_city_object_members_inside_extent_of_file) { // NOLINT
+        std::ifstream ifs(gml_path_, std::ios::binary);
+        std::stringstream original;
+        original << ifs.rdbuf();
+        GmlFilterParams params;
+        params.exclude_city_object_outside_extent = true;
+        params.extent = geometry::Extent(geometry::GeoCoordinate(35.539, 139.77, -9999),
+                                         geometry::GeoCoordinate(35.545, 139.78, 9999));
+        const auto filtered = filterString(original.str(), params);
+        ASSERT_EQ(countOf(original.str(), "<core:cityObjectMember>"), 8u);
+        ASSERT_EQ(countOf(filtered, "<core:cityObjectMember>"), 6u);
+        ASSERT_EQ(countOf(filtered, "</core:cityObjectMember>"), 6u);
+    }
+
+    TEST_F(GmlFilterTest, removes_city_objects_of_types_not_in_mask_with_their_property) { // NOLINT
+        using CityObjectsType = citygml::CityObject::CityObjectsType;
+        GmlFilterParams params;
+        params.city_object_type_mask = ~(CityObjectsType::COT_Room | CityObjectsType::COT_BuildingFurniture);
+        const auto filtered = filterString(
+                "<core:CityModel><core:cityObjectMember><bldg:Building>"
+                "<bldg:interiorRoom><bldg:Room><bldg:lod4Solid/></bldg:Room></bldg:interiorRoom>"
+                "<bldg:interiorFurniture><bldg:BuildingFurniture/></bldg:interiorFurniture>"
+                "<bldg:lod1Solid/></bldg:Building></core:cityObjectMember></core:CityModel>", params);
+        ASSERT_EQ(filtered,
+                  "<core:CityModel><core:cityObjectMember><bldg:Building>"
+                  "<bldg:lod1Solid/></bldg:Building></core:cityObjectMember></core:CityModel>");
+    }
+
+    TEST_F(GmlFilterTest, geometry_only_removes_attributes_and_appearance_but_keeps_geometry) { // NOLINT
+        std::ifstream ifs(gml_path_, std::ios::binary);
+        std::stringstream original;
+        original << ifs.rdbuf();
+        const auto filtered = filterString(original.str(), GmlFilterParams::geometryOnly());
+        ASSERT_EQ(countOf(filtered, "<gen:"), 0u);
+        ASSERT_EQ(countOf(filtered, "<uro:extendedAttribute"), 0u);
+        ASSERT_EQ(countOf(filtered, "<bldg:address"), 0u);
+        ASSERT_EQ(countOf(filtered, "<app:"), 0u);
+        ASSERT_EQ(countOf(filtered, "<gml:posList"), countOf(original.str(), "<gml:posList"));
+    }
+}
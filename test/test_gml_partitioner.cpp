@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <plateau/dataset/gml_partitioner.h>
+#include <citygml/citymodel.h>
+#include <citygml/geometry.h>
+#include <citygml/polygon.h>
+#include <fstream>
+#include <functional>
+#include <sstream>
+
+namespace plateau::dataset {
+    class GmlPartitionerTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            params_.tesselate = true;
+        }
+
+        const std::string gml_path_ = u8"../data/日本語パステスト/udx/bldg/53392642_bldg_6697_op2.gml";
+        citygml::ParserParams params_;
+
+        /// city_model のうち、テクスチャが割り当てられたポリゴンの数を返します。
+        static size_t countTexturedPolygons(const citygml::CityModel& city_model);
+    };
+
+    TEST_F(GmlPartitionerTest, scan_finds_top_level_city_object_members) { // NOLINT
+        std::istringstream in(
+                "<?xml version=\"1.0\"?>\n<core:CityModel a=\"1\">"
+                "<gml:boundedBy><gml:Envelope/></gml:boundedBy>"
+                "<core:cityObjectMember><bldg:Building><core:cityObjectMember/></bldg:Building></core:cityObjectMember>"
+                "<core:cityObjectMember/>"
+                "<app:appearanceMember>x</app:appearanceMember>"
+                "</core:CityModel>");
+        const auto layout = GmlPartitioner::scan(in);
+        const auto& content = in.str();
+        ASSERT_TRUE(layout.isValid());
+        ASSERT_EQ(content.substr(layout.root_content_begin, 14), "<gml:boundedBy");
+        ASSERT_EQ(content.substr(layout.root_end_begin), "</core:CityModel>");
+        ASSERT_EQ(layout.city_object_members.size(), 2u);
+        ASSERT_EQ(layout.shared_elements.size(), 2u);
+        const auto& first_member = layout.city_object_members[0];
+        ASSERT_EQ(content.substr(first_member.begin, first_member.end - first_member.begin),
+                  "<core:cityObjectMember><bldg:Building><core:cityObjectMember/></bldg:Building></core:cityObjectMember>");
+    }
+
+    TEST_F(GmlPartitionerTest, partition_keeps_all_members_in_order) { // NOLINT
+        std::ifstream ifs(gml_path_, std::ios::binary);
+        const auto layout = GmlPartitioner::scan(ifs);
+        ASSERT_EQ(layout.city_object_members.size(), 8u);
+        const auto partitions = GmlPartitioner::partition(layout, 3);
+        ASSERT_EQ(partitions.size(), 3u);
+        size_t index = 0;
+        for (const auto& partition : partitions) {
+            ASSERT_FALSE(partition.empty());
+            for (const auto& member : partition) {
+                ASSERT_EQ(member.begin, layout.city_object_members[index++].begin);
+            }
+        }
+        ASSERT_EQ(index, layout.city_object_members.size());
+    }
+
+    TEST_F(GmlPartitionerTest, load_parallel_returns_all_buildings) { // NOLINT
+        const auto whole = GmlFilter::load(gml_path_, params_, GmlFilterParams());
+        ASSERT_NE(whole, nullptr);
+        const auto building_type = citygml::CityObject::CityObjectsType::COT_Building;
+
+        const auto parts = GmlPartitioner::loadParallel(gml_path_, params_, GmlFilterParams(), 3);
+        ASSERT_EQ(parts.size(), 3u);
+        size_t building_count = 0;
+        for (const auto& part : parts) {
+            building_count += part->getAllCityObjectsOfType(building_type).size();
+        }
+        ASSERT_EQ(building_count, whole->getAllCityObjectsOfType(building_type).size());
+    }
+
+    TEST_F(GmlPartitionerTest, load_parallel_keeps_textures_of_each_part) { // NOLINT
+        // 各部分のアピアランスは、その部分のポリゴンを対象とするものだけになりますが、テクスチャの割り当ては変わりません。
+        const auto whole = GmlFilter::load(gml_path_, params_, GmlFilterParams());
+        ASSERT_NE(whole, nullptr);
+        const auto whole_count = countTexturedPolygons(*whole);
+        ASSERT_GT(whole_count, 0u);
+
+        const auto parts = GmlPartitioner::loadParallel(gml_path_, params_, GmlFilterParams(), 3);
+        ASSERT_EQ(parts.size(), 3u);
+        size_t parts_count = 0;
+        for (const auto& part : parts) {
+            parts_count += countTexturedPolygons(*part);
+        }
+        ASSERT_EQ(parts_count, whole_count);
+    }
+
+    size_t GmlPartitionerTest::countTexturedPolygons(const citygml::CityModel& city_model) {
+        size_t count = 0;
+        std::function<void(const citygml::Geometry&)> count_in_geometry = [&](const citygml::Geometry& geometry) {
+            for (unsigned i = 0; i < geometry.getPolygonsCount(); ++i) {
+                if (geometry.getPolygon(i)->getTextureFor("rgbTexture") != nullptr)
+                    ++count;
+            }
+            for (unsigned i = 0; i < geometry.getGeometriesCount(); ++i) {
+                count_in_geometry(geometry.getGeometry(i));
+            }
+        };
+        for (const auto city_object : city_model.getAllCityObjectsOfType(citygml::CityObject::CityObjectsType::COT_All)) {
+            for (unsigned i = 0; i < city_object->getGeometriesCount(); ++i) {
+                count_in_geometry(city_object->getGeometry(i));
+            }
+        }
+        return count;
+    }
+}
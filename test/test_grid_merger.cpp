@@ -1,6 +1,7 @@
 #include "gtest/gtest.h"
 #include "citygml/citygml.h"
 #include "../src/polygon_mesh/area_mesh_factory.h"
+#include <algorithm>
 
 using namespace citygml;
 using namespace plateau::polygonMesh;
@@ -41,3 +42,105 @@ TEST_F(GridMergerTest, gridMerge_uv_size_matches_num_of_vertices) { // NOLINT
         ASSERT_EQ(size_of_uv4, num_of_vertices);
     }
 }
+
+TEST_F(GridMergerTest, gridMerge_with_shared_classification_returns_same_groups) { // NOLINT
+    const auto classification = AreaMeshFactory::classify(*city_model_, mesh_extract_options_);
+    for (unsigned lod = 0; lod <= 2; ++lod) {
+        auto expected = AreaMeshFactory::gridMerge(*city_model_, mesh_extract_options_, lod, geo_reference_);
+        auto actual = AreaMeshFactory::gridMerge(classification, mesh_extract_options_, lod, geo_reference_);
+        ASSERT_EQ(expected.size(), actual.size());
+        for (const auto& [id, mesh] : expected) {
+            ASSERT_EQ(mesh->getVertices().size(), actual.at(id)->getVertices().size());
+            ASSERT_EQ(mesh->getIndices(), actual.at(id)->getIndices());
+        }
+    }
+}
+
+TEST_F(GridMergerTest, grid_aligned_to_mesh_code_is_named_by_third_mesh) { // NOLINT
+    auto options = mesh_extract_options_;
+    options.align_grid_to_mesh_code = true;
+    const auto classification = AreaMeshFactory::classify(*city_model_, options);
+    ASSERT_FALSE(classification.grid_names.empty());
+    for (const auto& grid_name : classification.grid_names) {
+        // GMLファイルは 3次メッシュ 53392642 の範囲です。
+        ASSERT_EQ(grid_name.substr(0, 8), "53392642");
+    }
+
+    const auto result = AreaMeshFactory::gridMerge(classification, options, 0, geo_reference_);
+    for (const auto& [group_id, mesh] : result) {
+        ASSERT_EQ(AreaMeshFactory::getGroupName(classification, group_id).rfind("group_53392642_", 0), 0);
+    }
+}
+
+TEST_F(GridMergerTest, same_grid_of_multiple_city_models_is_merged_into_one_group) { // NOLINT
+    auto options = mesh_extract_options_;
+    options.align_grid_to_mesh_code = true;
+    const auto single = AreaMeshFactory::classify(*city_model_, options);
+    const auto multiple = AreaMeshFactory::classify(
+            std::vector<const CityModel*>{ city_model_.get(), city_model_.get() }, options);
+
+    ASSERT_EQ(single.grid_names, multiple.grid_names);
+    ASSERT_EQ(single.entries.size() * 2, multiple.entries.size());
+}
+
+TEST_F(GridMergerTest, adaptive_grid_splits_cells_over_triangle_budget) { // NOLINT
+    auto options = mesh_extract_options_;
+    options.grid_count_of_side = 1;
+    const auto uniform = AreaMeshFactory::classify(*city_model_, options);
+
+    options.enable_adaptive_grid = true;
+    options.adaptive_grid_triangle_budget = 1;
+    const auto adaptive = AreaMeshFactory::classify(*city_model_, options);
+
+    // 予算が極端に小さいため、1つだったグリッドが4分木で分割されます。
+    ASSERT_EQ(uniform.entries.size(), adaptive.entries.size());
+    ASSERT_GT(adaptive.grid_names.size(), 1);
+    for (const auto& grid_name : adaptive.grid_names) {
+        ASSERT_EQ(grid_name.rfind("0_q", 0), 0);
+    }
+
+    const auto result = AreaMeshFactory::gridMerge(adaptive, options, 0, geo_reference_);
+    for (const auto& [group_id, mesh] : result) {
+        ASSERT_EQ(AreaMeshFactory::getGroupName(adaptive, group_id).rfind("group_0_q", 0), 0);
+    }
+}
+
+TEST_F(GridMergerTest, adaptive_grid_splits_untessellated_city_model) { // NOLINT
+    // 遅延テッセレーションでは、ポリゴンが三角形に分割されないまま読み込まれます。
+    ParserParams params;
+    params.tesselate = false;
+    const auto untessellated_model = load(gml_path_, params);
+
+    auto options = mesh_extract_options_;
+    options.grid_count_of_side = 1;
+    options.enable_adaptive_grid = true;
+    options.adaptive_grid_triangle_budget = 1;
+    const auto tessellated = AreaMeshFactory::classify(*city_model_, options);
+    const auto untessellated = AreaMeshFactory::classify(*untessellated_model, options);
+
+    // 三角形の数を外周と穴の頂点数から見積もるため、テッセレーションの有無によらず同じように分割されます。
+    ASSERT_GT(untessellated.grid_names.size(), 1);
+    ASSERT_EQ(tessellated.grid_names, untessellated.grid_names);
+}
+
+TEST_F(GridMergerTest, adaptive_grid_merges_only_edge_sharing_siblings) { // NOLINT
+    auto options = mesh_extract_options_;
+    options.grid_count_of_side = 1;
+    options.enable_adaptive_grid = true;
+
+    // まとめたグリッドの名前は "m" の後にまとめた象限番号が続きます。
+    // 象限 0 と 3、 1 と 2 は対角に位置するため、どの予算でもまとめられません。
+    const std::vector<std::string> edge_sharing_pairs = { "01", "23", "02", "13" };
+    for (const size_t budget : { 10, 100, 1000, 10000 }) {
+        options.adaptive_grid_triangle_budget = budget;
+        const auto classification = AreaMeshFactory::classify(*city_model_, options);
+        for (const auto& grid_name : classification.grid_names) {
+            const auto merged_at = grid_name.rfind('m');
+            if (merged_at == std::string::npos)
+                continue;
+            const auto merged_quadrants = grid_name.substr(merged_at + 1);
+            ASSERT_NE(std::find(edge_sharing_pairs.begin(), edge_sharing_pairs.end(), merged_quadrants),
+                      edge_sharing_pairs.end()) << grid_name;
+        }
+    }
+}
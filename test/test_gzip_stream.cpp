@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <plateau/dataset/gzip_stream.h>
+#include <plateau/dataset/gml_filter.h>
+#include <plateau/dataset/gml_file.h>
+#include <plateau/dataset/lod_searcher.h>
+#include <plateau/dataset/dataset_source.h>
+#include <citygml/citymodel.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace plateau::dataset {
+    namespace fs = std::filesystem;
+
+    class GzipStreamTest : public ::testing::Test {
+    protected:
+        static std::string readAll(std::istream& stream) {
+            std::ostringstream buffer;
+            buffer << stream.rdbuf();
+            return buffer.str();
+        }
+
+        // gzip_dataset の GMLファイルは、udx/bldg の GMLファイルを gzip で圧縮したものです。
+        const std::string gzip_dataset_path_ = u8"../data/日本語パステスト/gzip_dataset";
+        const std::string gz_path_ = gzip_dataset_path_ + u8"/udx/bldg/53392642_bldg_6697_op2.gml.gz";
+        const std::string gml_path_ = u8"../data/日本語パステスト/udx/bldg/53392642_bldg_6697_op2.gml";
+    };
+
+    TEST_F(GzipStreamTest, open_inflates_same_content_as_original_file) { // NOLINT
+        const auto stream = GzipStream::open(gz_path_);
+        ASSERT_NE(stream, nullptr);
+        std::ifstream original(fs::u8path(gml_path_), std::ios::binary);
+        ASSERT_EQ(readAll(*stream), readAll(original));
+    }
+
+    TEST_F(GzipStreamTest, open_file_reads_plain_file_as_is) { // NOLINT
+        const auto stream = GzipStream::openFile(gml_path_);
+        ASSERT_NE(stream, nullptr);
+        std::ifstream original(fs::u8path(gml_path_), std::ios::binary);
+        ASSERT_EQ(readAll(*stream), readAll(original));
+        ASSERT_EQ(GzipStream::openFile(gml_path_ + ".not_exist"), nullptr);
+    }
+
+    TEST_F(GzipStreamTest, is_gml_path_accepts_gzipped_gml) { // NOLINT
+        ASSERT_TRUE(GzipStream::isGmlPath(gml_path_));
+        ASSERT_TRUE(GzipStream::isGmlPath(gz_path_));
+        ASSERT_TRUE(GzipStream::isGmlPath("53392642_bldg_6697_op2.GML.GZ"));
+        ASSERT_FALSE(GzipStream::isGmlPath("codelists.xml.gz"));
+    }
+
+    TEST_F(GzipStreamTest, searches_lods_and_paths_in_gzipped_gml) { // NOLINT
+        ASSERT_EQ(LodSearcher::searchLodsInFile(fs::u8path(gz_path_)).getMax(), 2);
+        const auto gz_file = GmlFile(gz_path_);
+        const auto gml_file = GmlFile(gml_path_);
+        ASSERT_EQ(gz_file.getMeshCode().get(), "53392642");
+        ASSERT_EQ(gz_file.searchAllCodelistPathsInGML(), gml_file.searchAllCodelistPathsInGML());
+        ASSERT_EQ(gz_file.searchAllImagePathsInGML(), gml_file.searchAllImagePathsInGML());
+    }
+
+    TEST_F(GzipStreamTest, local_accessor_finds_gzipped_gml) { // NOLINT
+        const auto accessor = DatasetSource::createLocal(gzip_dataset_path_).getAccessor();
+        const auto gml_files = accessor->getGmlFiles(PredefinedCityModelPackage::Building);
+        ASSERT_EQ(gml_files->size(), 1);
+        ASSERT_EQ(gml_files->at(0).getMeshCode().get(), "53392642");
+    }
+
+    TEST_F(GzipStreamTest, load_parses_gzipped_gml) { // NOLINT
+        // コードリストを読み込めるよう、一時フォルダに GMLファイルとコードリストを配置します。
+        const auto temp_test_dir = fs::u8path(u8"../テスト用一時ディレクトリ_gzip");
+        fs::remove_all(temp_test_dir);
+        fs::copy(fs::u8path(gzip_dataset_path_), temp_test_dir, fs::copy_options::recursive);
+        fs::copy(fs::u8path(u8"../data/日本語パステスト/codelists"), temp_test_dir / "codelists");
+        const auto temp_gz_path = (temp_test_dir / "udx/bldg/53392642_bldg_6697_op2.gml.gz").u8string();
+
+        citygml::ParserParams params;
+        const auto gz_city_model = GmlFilter::load(temp_gz_path, params, GmlFilterParams());
+        const auto city_model = GmlFilter::load(gml_path_, params, GmlFilterParams());
+        ASSERT_NE(gz_city_model, nullptr);
+        ASSERT_EQ(gz_city_model->getAllCityObjectsOfType(citygml::CityObject::CityObjectsType::COT_Building).size(),
+                  city_model->getAllCityObjectsOfType(citygml::CityObject::CityObjectsType::COT_Building).size());
+        fs::remove_all(temp_test_dir);
+    }
+}
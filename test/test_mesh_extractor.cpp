@@ -7,6 +7,7 @@
 #include "../src/c_wrapper/citygml_c.cpp"
 #include "../src/polygon_mesh/area_mesh_factory.h"
 #include <plateau/polygon_mesh/mesh_extractor.h>
+#include <plateau/polygon_mesh/streaming_mesh_extractor.h>
 
 using namespace citygml;
 using namespace plateau::geometry;
@@ -31,6 +32,12 @@ namespace plateau::polygonMesh {
         void testExtractFromCWrapper() const;
         bool haveVertexRecursive(const Node& node) const;
 
+        /// テッセレーションせずに gml_path_ をパースします。
+        std::shared_ptr<const CityModel> loadUntessellated() const;
+
+        /// mesh の三角形の面積の合計を返します。
+        static double calcTriangleArea(const Mesh& mesh);
+
         /**
          * MeshGranularity と LOD の全組み合わせをテストします。
          * @param check_func
@@ -165,6 +172,26 @@ namespace plateau::polygonMesh {
         );
     }
 
+    TEST_F(MeshExtractorTest, when_store_vertices_as_float_then_vertices_are_same_as_double_version) { // NOLINT
+        auto options = mesh_extract_options_;
+        const auto double_model = MeshExtractor::extract(*city_model_, options);
+        options.store_vertices_as_float = true;
+        const auto float_model = MeshExtractor::extract(*city_model_, options);
+
+        const auto& double_mesh = *double_model->getRootNodeAt(0).getChildAt(0).getMesh();
+        const auto& float_mesh = *float_model->getRootNodeAt(0).getChildAt(0).getMesh();
+        ASSERT_FALSE(double_mesh.hasFloatVertices());
+        ASSERT_TRUE(float_mesh.hasFloatVertices());
+        ASSERT_TRUE(float_mesh.getVertices().empty());
+        ASSERT_EQ(double_mesh.getVertexCount(), float_mesh.getVertexCount());
+        for (size_t i = 0; i < double_mesh.getVertexCount(); ++i) {
+            const auto& expected = double_mesh.getVertices().at(i);
+            const auto actual = float_mesh.getVertexAt(i);
+            ASSERT_NEAR(expected.x, actual.x, 0.01);
+            ASSERT_NEAR(expected.y, actual.y, 0.01);
+            ASSERT_NEAR(expected.z, actual.z, 0.01);
+        }
+    }
 
     void MeshExtractorTest::testExtractFromCWrapper() const {
 
@@ -184,7 +211,7 @@ namespace plateau::polygonMesh {
 
     bool MeshExtractorTest::haveVertexRecursive(const Node& node) const {
         const auto& mesh = node.getMesh();
-        if (mesh != nullptr && !(mesh->getVertices().empty())) {
+        if (mesh != nullptr && mesh->getVertexCount() > 0) {
             return true;
         }
         auto num_child = node.getChildCount();
@@ -196,6 +223,106 @@ namespace plateau::polygonMesh {
         return false;
     }
 
+    TEST_F(MeshExtractorTest, streaming_extract_emits_same_nodes_as_extract) { // NOLINT
+        auto options = mesh_extract_options_;
+        options.mesh_granularity = MeshGranularity::PerPrimaryFeatureObject;
+        const auto model = MeshExtractor::extract(*city_model_, options);
+        std::vector<std::string> expected_names;
+        for (size_t i = 0; i < model->getRootNodeCount(); ++i) {
+            const auto& lod_node = model->getRootNodeAt(i);
+            for (unsigned j = 0; j < lod_node.getChildCount(); ++j) {
+                expected_names.push_back(lod_node.getName() + "/" + lod_node.getChildAt(j).getName());
+            }
+        }
+
+        // 小さな組に分けて、複数回のパースを経由させます。
+        std::vector<std::string> streamed_names;
+        const bool succeeded = StreamingMeshExtractor::extract(
+                gml_path_, options,
+                [&streamed_names](const std::string& lod_node_name, Node&& node) {
+                    streamed_names.push_back(lod_node_name + "/" + node.getName());
+                }, 64 * 1024);
+        ASSERT_TRUE(succeeded);
+        ASSERT_EQ(streamed_names, expected_names);
+    }
+
+    TEST_F(MeshExtractorTest, lazy_tessellation_extracts_same_meshes_from_untessellated_city_model) { // NOLINT
+        const auto untessellated_city_model = loadUntessellated();
+        for (const auto granularity : {MeshGranularity::PerCityModelArea, MeshGranularity::PerPrimaryFeatureObject}) {
+            auto options = mesh_extract_options_;
+            options.mesh_granularity = granularity;
+            const auto model = MeshExtractor::extract(*city_model_, options);
+            options.enable_lazy_tessellation = true;
+            const auto lazy_model = MeshExtractor::extract(*untessellated_city_model, options);
+
+            const auto& lod_node = model->getRootNodeAt(0);
+            const auto& lazy_lod_node = lazy_model->getRootNodeAt(0);
+            ASSERT_EQ(lazy_lod_node.getName(), lod_node.getName());
+            ASSERT_EQ(lazy_lod_node.getChildCount(), lod_node.getChildCount());
+            ASSERT_GT(lod_node.getChildCount(), 0u);
+            for (unsigned i = 0; i < lazy_lod_node.getChildCount(); ++i) {
+                const auto& node = lod_node.getChildAt(i);
+                const auto& lazy_node = lazy_lod_node.getChildAt(i);
+                ASSERT_EQ(lazy_node.getName(), node.getName());
+                ASSERT_EQ(lazy_node.getMesh() == nullptr, node.getMesh() == nullptr);
+                if (node.getMesh() == nullptr)
+                    continue;
+                const auto& mesh = *node.getMesh();
+                const auto& lazy_mesh = *lazy_node.getMesh();
+                // テッセレーションの方法は異なっても、三角形の数と総面積は一致するはずです。
+                ASSERT_EQ(lazy_mesh.getIndices().size(), mesh.getIndices().size()) << node.getName();
+                const auto area = calcTriangleArea(mesh);
+                ASSERT_GT(area, 0.0);
+                ASSERT_NEAR(calcTriangleArea(lazy_mesh), area, area * 1e-6) << node.getName();
+                ASSERT_EQ(lazy_mesh.getUV1().size(), lazy_mesh.getVertexCount());
+                ASSERT_EQ(lazy_mesh.getUV4().size(), lazy_mesh.getVertexCount());
+            }
+        }
+    }
+
+    TEST_F(MeshExtractorTest, lazy_tessellation_keeps_polygons_inside_extent) { // NOLINT
+        auto options = mesh_extract_options_;
+        options.mesh_granularity = MeshGranularity::PerPrimaryFeatureObject;
+        options.exclude_city_object_outside_extent = true;
+        options.exclude_polygons_outside_extent = true;
+        options.extent = Extent::all();
+        const auto model = MeshExtractor::extract(*city_model_, options);
+        options.enable_lazy_tessellation = true;
+        const auto lazy_model = MeshExtractor::extract(*loadUntessellated(), options);
+
+        const auto& lod_node = model->getRootNodeAt(0);
+        const auto& lazy_lod_node = lazy_model->getRootNodeAt(0);
+        ASSERT_GT(lod_node.getChildCount(), 0u);
+        ASSERT_EQ(lazy_lod_node.getChildCount(), lod_node.getChildCount());
+        ASSERT_TRUE(haveVertexRecursive(lazy_lod_node));
+    }
+
+    TEST_F(MeshExtractorTest, streaming_extract_rejects_per_city_model_area) { // NOLINT
+        ASSERT_THROW(StreamingMeshExtractor::extract(gml_path_, mesh_extract_options_,
+                                                     [](const std::string&, Node&&) {}),
+                     std::invalid_argument);
+    }
+
+    std::shared_ptr<const CityModel> MeshExtractorTest::loadUntessellated() const {
+        ParserParams params;
+        params.tesselate = false;
+        params.keepVertices = true;
+        return load(gml_path_, params);
+    }
+
+    double MeshExtractorTest::calcTriangleArea(const Mesh& mesh) {
+        const auto& vertices = mesh.getVertices();
+        const auto& indices = mesh.getIndices();
+        double area = 0;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            const auto& p0 = vertices.at(indices.at(i));
+            const auto ab = vertices.at(indices.at(i + 1)) - p0;
+            const auto ac = vertices.at(indices.at(i + 2)) - p0;
+            area += ab.cross(ac).length() / 2;
+        }
+        return area;
+    }
+
     void MeshExtractorTest::foreachMeshGranularityAndLOD(MeshExtractOptions options,
                                                          std::function<void(Node&, unsigned)> check_func) {
         const std::vector<MeshGranularity> test_pattern_granularity = {MeshGranularity::PerCityModelArea,
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <plateau/polygon_mesh/mesh.h>
+
+/**
+ * テストで使うメッシュを手作業で組み立てるための共通パーツです。
+ */
+namespace plateau::polygonMesh::test {
+
+    /**
+     * vertices と indices からメッシュを作ります。
+     * UV1 と UV4 はすべて (0, 0) とし、地物情報は持ちません。
+     * sub_meshes を省略すると、全体をテクスチャのない1つの SubMesh とします。
+     */
+    inline Mesh createMesh(std::vector<TVec3d> vertices, std::vector<unsigned> indices,
+                           std::vector<SubMesh> sub_meshes = {}) {
+        if (sub_meshes.empty())
+            sub_meshes.emplace_back(0, indices.size() - 1, "", nullptr);
+        const auto vertex_count = vertices.size();
+        return Mesh(std::move(vertices), std::move(indices), UV(vertex_count, TVec2f(0, 0)),
+                    UV(vertex_count, TVec2f(0, 0)), std::move(sub_meshes), CityObjectList());
+    }
+
+    /// offset を最小点とする、z=0 の平面上の大きさ size の正方形 (三角形2つ) のメッシュを作ります。
+    inline std::unique_ptr<Mesh> createSquare(const TVec3d& offset, double size) {
+        return std::make_unique<Mesh>(createMesh(
+                { offset + TVec3d(0, 0, 0), offset + TVec3d(size, 0, 0),
+                  offset + TVec3d(size, size, 0), offset + TVec3d(0, size, 0) },
+                { 0, 1, 2, 0, 2, 3 }));
+    }
+}
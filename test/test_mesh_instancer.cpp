@@ -0,0 +1,101 @@
+#include "gtest/gtest.h"
+#include <sstream>
+#include <plateau/polygon_mesh/mesh_instancer.h>
+#include <plateau/polygon_mesh/model_serializer.h>
+#include "test_mesh_helper.h"
+
+using namespace plateau::polygonMesh;
+using plateau::polygonMesh::test::createSquare;
+
+namespace {
+    /// 同じ形状の正方形2つと、大きさの異なる正方形1つを持つ Model を作ります。
+    std::shared_ptr<Model> createModel() {
+        auto model = Model::createModel();
+        auto& root = model->addEmptyNode("root");
+        root.addChildNode(Node("lamp_1", createSquare(TVec3d(10, 20, 0), 1)));
+        root.addChildNode(Node("lamp_2", createSquare(TVec3d(-5, 3, 2), 1)));
+        root.addChildNode(Node("sign_1", createSquare(TVec3d(0, 0, 0), 2)));
+        return model;
+    }
+}
+
+TEST(MeshInstancerTest, same_shapes_are_merged_into_instances) { // NOLINT
+    auto model = createModel();
+    const auto removed_count = MeshInstancer::instantiate(*model);
+
+    ASSERT_EQ(removed_count, 1);
+    const auto& root = model->getRootNodeAt(0);
+    ASSERT_EQ(root.getChildCount(), 2);
+
+    const auto& lamp = root.getChildAt(0);
+    ASSERT_EQ(lamp.getName(), "lamp_1");
+    ASSERT_TRUE(lamp.isInstanced());
+    const auto& instances = lamp.getInstances();
+    ASSERT_EQ(instances.size(), 2);
+    ASSERT_EQ(instances[0].name, "lamp_1");
+    ASSERT_EQ(instances[1].name, "lamp_2");
+    ASSERT_DOUBLE_EQ(instances[0].translation.x, 10);
+    ASSERT_DOUBLE_EQ(instances[0].translation.y, 20);
+    ASSERT_DOUBLE_EQ(instances[1].translation.x, -5);
+    ASSERT_DOUBLE_EQ(instances[1].translation.z, 2);
+
+    // メッシュはインスタンスの原点からの相対座標になります。
+    const auto min = lamp.getMesh()->getVertexAt(0);
+    ASSERT_DOUBLE_EQ(min.x, 0);
+    ASSERT_DOUBLE_EQ(min.y, 0);
+    ASSERT_DOUBLE_EQ(min.z, 0);
+
+    const auto& sign = root.getChildAt(1);
+    ASSERT_EQ(sign.getName(), "sign_1");
+    ASSERT_FALSE(sign.isInstanced());
+    ASSERT_DOUBLE_EQ(sign.getMesh()->getVertexAt(1).x, 2);
+}
+
+TEST(MeshInstancerTest, instances_are_kept_after_serialization) { // NOLINT
+    auto model = createModel();
+    MeshInstancer::instantiate(*model);
+
+    std::stringstream ss;
+    ModelSerializer::write(*model, ss);
+    const auto data = ss.str();
+    const auto restored = ModelSerializer::read(data.data(), data.size());
+
+    const auto& expected = model->getRootNodeAt(0).getChildAt(0).getInstances();
+    const auto& actual = restored->getRootNodeAt(0).getChildAt(0).getInstances();
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ(expected[i].name, actual[i].name);
+        ASSERT_EQ(expected[i].translation.x, actual[i].translation.x);
+        ASSERT_EQ(expected[i].translation.y, actual[i].translation.y);
+        ASSERT_EQ(expected[i].translation.z, actual[i].translation.z);
+    }
+}
+
+TEST(MeshInstancerTest, meshes_in_different_lods_are_not_merged) { // NOLINT
+    // LOD1 と LOD2 に同じ形状のメッシュがあっても、LODをまたいでインスタンスにはまとめません。
+    auto model = Model::createModel();
+    auto& lod1 = model->addEmptyNode("LOD1");
+    lod1.addChildNode(Node("lamp_1", createSquare(TVec3d(10, 20, 0), 1)));
+    auto& lod2 = model->addEmptyNode("LOD2");
+    lod2.addChildNode(Node("lamp_1", createSquare(TVec3d(10, 20, 0), 1)));
+    lod2.addChildNode(Node("lamp_2", createSquare(TVec3d(-5, 3, 2), 1)));
+
+    const auto removed_count = MeshInstancer::instantiate(*model);
+
+    ASSERT_EQ(removed_count, 1);
+    ASSERT_EQ(model->getRootNodeCount(), 2);
+
+    const auto& lod1_root = model->getRootNodeAt(0);
+    ASSERT_EQ(lod1_root.getName(), "LOD1");
+    ASSERT_EQ(lod1_root.getChildCount(), 1);
+    ASSERT_FALSE(lod1_root.getChildAt(0).isInstanced());
+    ASSERT_DOUBLE_EQ(lod1_root.getChildAt(0).getMesh()->getVertexAt(0).x, 10);
+
+    const auto& lod2_root = model->getRootNodeAt(1);
+    ASSERT_EQ(lod2_root.getName(), "LOD2");
+    ASSERT_EQ(lod2_root.getChildCount(), 1);
+    const auto& instances = lod2_root.getChildAt(0).getInstances();
+    ASSERT_EQ(instances.size(), 2);
+    ASSERT_EQ(instances[0].name, "lamp_1");
+    ASSERT_EQ(instances[1].name, "lamp_2");
+}
@@ -0,0 +1,92 @@
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <tuple>
+#include <plateau/polygon_mesh/mesh_optimizer.h>
+#include <plateau/polygon_mesh/mesh_extractor.h>
+#include "citygml/citygml.h"
+#include "citygml/citymodel.h"
+#include "test_mesh_helper.h"
+
+using namespace citygml;
+using namespace plateau::polygonMesh;
+
+namespace {
+    /// 三角形ごとに頂点を複製した、 z=0 の正方形 (三角形2つ) と x=0 の正方形 (三角形2つ) からなるメッシュを作ります。
+    Mesh createMeshWithDuplicatedVertices() {
+        std::vector<TVec3d> vertices = {
+                // z=0 の面
+                {0, 0, 0}, {1, 0, 0}, {1, 1, 0},
+                {0, 0, 0}, {1, 1, 0}, {0, 1, 0},
+                // x=0 の面 (z=0 の面と辺 (0,0,0)-(0,1,0) を共有します)
+                {0, 0, 0}, {0, 1, 0}, {0, 1, 1},
+                {0, 0, 0}, {0, 1, 1}, {0, 0, 1}
+        };
+        std::vector<unsigned> indices;
+        for (unsigned i = 0; i < vertices.size(); ++i) {
+            indices.push_back(i);
+        }
+        return test::createMesh(std::move(vertices), std::move(indices));
+    }
+
+    void assertSameTriangles(const Mesh& before, const Mesh& after) {
+        ASSERT_EQ(before.getIndices().size(), after.getIndices().size());
+        // 三角形の並び順は変わるため、各三角形の重心の集合で比較します。
+        auto centers = [](const Mesh& mesh) {
+            std::vector<std::tuple<double, double, double>> result;
+            const auto& indices = mesh.getIndices();
+            for (size_t i = 0; i < indices.size(); i += 3) {
+                const auto v0 = mesh.getVertexAt(indices[i]);
+                const auto v1 = mesh.getVertexAt(indices[i + 1]);
+                const auto v2 = mesh.getVertexAt(indices[i + 2]);
+                result.emplace_back(v0.x + v1.x + v2.x, v0.y + v1.y + v2.y, v0.z + v1.z + v2.z);
+            }
+            std::sort(result.begin(), result.end());
+            return result;
+        };
+        ASSERT_EQ(centers(before), centers(after));
+    }
+}
+
+TEST(MeshOptimizerTest, weld_merges_vertices_on_same_face_only) { // NOLINT
+    auto mesh = createMeshWithDuplicatedVertices();
+    MeshOptimizer::weldVertices(mesh);
+
+    // 各面の4頂点ずつが残り、面をまたぐ頂点は溶接されません。
+    ASSERT_EQ(mesh.getVertexCount(), 8);
+    ASSERT_EQ(mesh.getUV1().size(), 8);
+    ASSERT_EQ(mesh.getUV4().size(), 8);
+    assertSameTriangles(createMeshWithDuplicatedVertices(), mesh);
+}
+
+TEST(MeshOptimizerTest, optimize_keeps_triangles_and_orders_vertices_by_first_use) { // NOLINT
+    auto mesh = createMeshWithDuplicatedVertices();
+    MeshOptimizer::optimize(mesh);
+
+    assertSameTriangles(createMeshWithDuplicatedVertices(), mesh);
+    unsigned next_new_index = 0;
+    for (const auto index : mesh.getIndices()) {
+        ASSERT_LE(index, next_new_index);
+        if (index == next_new_index) ++next_new_index;
+    }
+    ASSERT_EQ(next_new_index, mesh.getVertexCount());
+    ASSERT_TRUE(MeshOptimizer::fitsIn16BitIndices(mesh));
+}
+
+TEST(MeshOptimizerTest, extract_with_optimization_keeps_triangle_count) { // NOLINT
+    ParserParams params;
+    params.tesselate = true;
+    const auto city_model = load("../data/日本語パステスト/udx/bldg/53392642_bldg_6697_op2.gml", params);
+    MeshExtractOptions options;
+    options.mesh_granularity = MeshGranularity::PerPrimaryFeatureObject;
+    options.max_lod = 2;
+    options.min_lod = 2;
+    const auto model = MeshExtractor::extract(*city_model, options);
+    options.enable_mesh_optimization = true;
+    const auto optimized_model = MeshExtractor::extract(*city_model, options);
+
+    const auto& mesh = *model->getRootNodeAt(0).getChildAt(0).getMesh();
+    const auto& optimized_mesh = *optimized_model->getRootNodeAt(0).getChildAt(0).getMesh();
+    ASSERT_LE(optimized_mesh.getVertexCount(), mesh.getVertexCount());
+    ASSERT_EQ(optimized_mesh.getIndices().size(), mesh.getIndices().size());
+    ASSERT_EQ(optimized_mesh.getSubMeshes().size(), mesh.getSubMeshes().size());
+}
@@ -0,0 +1,106 @@
+#include "gtest/gtest.h"
+#include <plateau/polygon_mesh/mesh_simplifier.h>
+#include <plateau/polygon_mesh/mesh_extractor.h>
+#include "citygml/citygml.h"
+#include "citygml/citymodel.h"
+#include "test_mesh_helper.h"
+
+using namespace citygml;
+using namespace plateau::polygonMesh;
+
+namespace {
+    /**
+     * z=0 の平面上の n×n の格子を三角形に分割したメッシュを作ります。
+     * 左半分と右半分で SubMesh を分けます。
+     */
+    Mesh createGridMesh(unsigned n) {
+        std::vector<TVec3d> vertices;
+        for (unsigned y = 0; y <= n; ++y) {
+            for (unsigned x = 0; x <= n; ++x) {
+                vertices.emplace_back(x, y, 0);
+            }
+        }
+        std::vector<unsigned> indices;
+        const auto push_cell = [&indices, n](unsigned x, unsigned y) {
+            const auto v = y * (n + 1) + x;
+            indices.insert(indices.end(), { v, v + 1, v + n + 2, v, v + n + 2, v + n + 1 });
+        };
+        for (unsigned y = 0; y < n; ++y) {
+            for (unsigned x = 0; x < n / 2; ++x) push_cell(x, y);
+        }
+        const auto left_end = indices.size() - 1;
+        for (unsigned y = 0; y < n; ++y) {
+            for (unsigned x = n / 2; x < n; ++x) push_cell(x, y);
+        }
+        std::vector<SubMesh> sub_meshes = {
+                SubMesh(0, left_end, "left.png", nullptr),
+                SubMesh(left_end + 1, indices.size() - 1, "right.png", nullptr)
+        };
+        return test::createMesh(std::move(vertices), std::move(indices), std::move(sub_meshes));
+    }
+}
+
+TEST(MeshSimplifierTest, flat_grid_is_reduced_and_keeps_sub_meshes) { // NOLINT
+    auto mesh = createGridMesh(8);
+    const auto original_index_count = mesh.getIndices().size();
+    MeshSimplifier::simplify(mesh, 0.25f);
+
+    ASSERT_LT(mesh.getIndices().size(), original_index_count);
+    ASSERT_EQ(mesh.getIndices().size() % 3, 0);
+    ASSERT_EQ(mesh.getSubMeshes().size(), 2);
+    ASSERT_EQ(mesh.getSubMeshes().at(0).getTexturePath(), "left.png");
+    ASSERT_EQ(mesh.getSubMeshes().at(1).getTexturePath(), "right.png");
+    ASSERT_EQ(mesh.getSubMeshes().at(1).getEndIndex() + 1, mesh.getIndices().size());
+    ASSERT_EQ(mesh.getUV1().size(), mesh.getVertexCount());
+    ASSERT_EQ(mesh.getUV4().size(), mesh.getVertexCount());
+
+    // 外周の頂点は動かないため、四隅の頂点は残ります。
+    const auto has_vertex = [&mesh](double x, double y) {
+        for (size_t i = 0; i < mesh.getVertexCount(); ++i) {
+            const auto v = mesh.getVertexAt(i);
+            if (v.x == x && v.y == y) return true;
+        }
+        return false;
+    };
+    ASSERT_TRUE(has_vertex(0, 0));
+    ASSERT_TRUE(has_vertex(8, 0));
+    ASSERT_TRUE(has_vertex(0, 8));
+    ASSERT_TRUE(has_vertex(8, 8));
+}
+
+TEST(MeshSimplifierTest, zero_max_error_keeps_curved_surface) { // NOLINT
+    auto mesh = createGridMesh(4);
+    // 中央の頂点を持ち上げて平面でなくします。
+    mesh.getVertices().at(2 * 5 + 2).z = 1;
+    const auto original_index_count = mesh.getIndices().size();
+    MeshSimplifier::simplify(mesh, 0.0f, 0.0);
+
+    // 縮約の誤差が 0 より大きくなる辺は縮約されないため、持ち上げた頂点は残ります。
+    bool lifted_vertex_exists = false;
+    for (size_t i = 0; i < mesh.getVertexCount(); ++i) {
+        lifted_vertex_exists |= mesh.getVertexAt(i).z == 1;
+    }
+    ASSERT_TRUE(lifted_vertex_exists);
+    ASSERT_LE(mesh.getIndices().size(), original_index_count);
+}
+
+TEST(MeshSimplifierTest, extract_with_proxy_lod_adds_proxy_node) { // NOLINT
+    ParserParams params;
+    params.tesselate = true;
+    const auto city_model = load("../data/日本語パステスト/udx/bldg/53392642_bldg_6697_op2.gml", params);
+    MeshExtractOptions options;
+    options.mesh_granularity = MeshGranularity::PerCityModelArea;
+    options.max_lod = 2;
+    options.min_lod = 2;
+    options.generate_proxy_lod = true;
+    const auto model = MeshExtractor::extract(*city_model, options);
+
+    ASSERT_EQ(model->getRootNodeCount(), 2);
+    const auto& lod_node = model->getRootNodeAt(0);
+    const auto& proxy_node = model->getRootNodeAt(1);
+    ASSERT_EQ(proxy_node.getName(), lod_node.getName() + "_proxy");
+    ASSERT_EQ(proxy_node.getChildCount(), lod_node.getChildCount());
+    const auto* mesh = lod_node.getChildAt(0).getMesh();
+    const auto* proxy_mesh = proxy_node.getChildAt(0).getMesh();
+    ASSERT_LE(proxy_mesh->getIndices().size(), mesh->getIndices().size());
+}
@@ -0,0 +1,158 @@
+#include "gtest/gtest.h"
+#include <sstream>
+#include <plateau/polygon_mesh/mesh_extractor.h>
+#include <plateau/polygon_mesh/model_serializer.h>
+#include "citygml/citygml.h"
+#include "citygml/citymodel.h"
+
+using namespace citygml;
+using namespace plateau::polygonMesh;
+
+namespace {
+    void assertMeshEqual(const Mesh& expected, const Mesh& actual) {
+        ASSERT_EQ(expected.getVertices().size(), actual.getVertices().size());
+        for (size_t i = 0; i < expected.getVertices().size(); ++i) {
+            ASSERT_EQ(expected.getVertices()[i].x, actual.getVertices()[i].x);
+            ASSERT_EQ(expected.getVertices()[i].y, actual.getVertices()[i].y);
+            ASSERT_EQ(expected.getVertices()[i].z, actual.getVertices()[i].z);
+        }
+        ASSERT_EQ(expected.hasFloatVertices(), actual.hasFloatVertices());
+        ASSERT_EQ(expected.getFloatVertices().size(), actual.getFloatVertices().size());
+        for (size_t i = 0; i < expected.getFloatVertices().size(); ++i) {
+            ASSERT_EQ(expected.getFloatVertices()[i].x, actual.getFloatVertices()[i].x);
+            ASSERT_EQ(expected.getFloatVertices()[i].y, actual.getFloatVertices()[i].y);
+            ASSERT_EQ(expected.getFloatVertices()[i].z, actual.getFloatVertices()[i].z);
+        }
+        ASSERT_EQ(expected.getIndices(), actual.getIndices());
+        ASSERT_EQ(expected.getUV1().size(), actual.getUV1().size());
+        ASSERT_EQ(expected.getUV4().size(), actual.getUV4().size());
+        for (size_t i = 0; i < expected.getUV4().size(); ++i) {
+            ASSERT_EQ(expected.getUV4()[i].x, actual.getUV4()[i].x);
+            ASSERT_EQ(expected.getUV4()[i].y, actual.getUV4()[i].y);
+        }
+
+        ASSERT_EQ(expected.getSubMeshes().size(), actual.getSubMeshes().size());
+        for (size_t i = 0; i < expected.getSubMeshes().size(); ++i) {
+            const auto& expected_sub_mesh = expected.getSubMeshes()[i];
+            const auto& actual_sub_mesh = actual.getSubMeshes()[i];
+            ASSERT_EQ(expected_sub_mesh.getStartIndex(), actual_sub_mesh.getStartIndex());
+            ASSERT_EQ(expected_sub_mesh.getEndIndex(), actual_sub_mesh.getEndIndex());
+            ASSERT_EQ(expected_sub_mesh.getTexturePath(), actual_sub_mesh.getTexturePath());
+            ASSERT_EQ(expected_sub_mesh.getMaterial() == nullptr, actual_sub_mesh.getMaterial() == nullptr);
+        }
+
+        std::vector<CityObjectIndex> expected_keys;
+        expected.getCityObjectList().getAllKeys(expected_keys);
+        std::vector<CityObjectIndex> actual_keys;
+        actual.getCityObjectList().getAllKeys(actual_keys);
+        ASSERT_EQ(expected_keys.size(), actual_keys.size());
+        for (const auto& key : expected_keys) {
+            ASSERT_EQ(expected.getCityObjectList().getAtomicGmlID(key), actual.getCityObjectList().getAtomicGmlID(key));
+        }
+    }
+
+    void assertNodeEqual(const Node& expected, const Node& actual) {
+        ASSERT_EQ(expected.getName(), actual.getName());
+        ASSERT_EQ(expected.getMesh() == nullptr, actual.getMesh() == nullptr);
+        if (expected.getMesh() != nullptr) {
+            assertMeshEqual(*expected.getMesh(), *actual.getMesh());
+        }
+        ASSERT_EQ(expected.getChildCount(), actual.getChildCount());
+        for (unsigned i = 0; i < expected.getChildCount(); ++i) {
+            assertNodeEqual(expected.getChildAt(i), actual.getChildAt(i));
+        }
+    }
+}
+
+class ModelSerializerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        params_.tesselate = true;
+        options_.mesh_granularity = MeshGranularity::PerPrimaryFeatureObject;
+        options_.max_lod = 2;
+        options_.min_lod = 0;
+    }
+
+    std::vector<uint8_t> serialize(const Model& model) const {
+        std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+        ModelSerializer::write(model, ss);
+        const auto str = ss.str();
+        return { str.begin(), str.end() };
+    }
+
+    ParserParams params_;
+    MeshExtractOptions options_;
+    const std::string gml_path_ = "../data/日本語パステスト/udx/bldg/53392642_bldg_6697_op2.gml";
+};
+
+TEST_F(ModelSerializerTest, model_is_same_after_write_and_read) {
+    const auto city_model = load(gml_path_, params_);
+    const auto model = MeshExtractor::extract(*city_model, options_);
+    const auto data = serialize(*model);
+
+    const auto restored = ModelSerializer::read(data.data(), data.size());
+
+    ASSERT_EQ(model->getRootNodeCount(), restored->getRootNodeCount());
+    for (size_t i = 0; i < model->getRootNodeCount(); ++i) {
+        assertNodeEqual(model->getRootNodeAt(i), restored->getRootNodeAt(i));
+    }
+}
+
+TEST_F(ModelSerializerTest, model_with_float_vertices_is_same_after_write_and_read) {
+    const auto city_model = load(gml_path_, params_);
+    auto options = options_;
+    options.store_vertices_as_float = true;
+    const auto model = MeshExtractor::extract(*city_model, options);
+    const auto data = serialize(*model);
+
+    const auto restored = ModelSerializer::read(data.data(), data.size());
+
+    ASSERT_EQ(model->getRootNodeCount(), restored->getRootNodeCount());
+    for (size_t i = 0; i < model->getRootNodeCount(); ++i) {
+        assertNodeEqual(model->getRootNodeAt(i), restored->getRootNodeAt(i));
+    }
+}
+
+TEST_F(ModelSerializerTest, view_points_to_the_same_vertices_as_model) {
+    const auto city_model = load(gml_path_, params_);
+    const auto model = MeshExtractor::extract(*city_model, options_);
+    const auto data = serialize(*model);
+
+    const auto view = SerializedModelView(data.data(), data.size());
+    ASSERT_EQ(model->getRootNodeCount(), view.getRootNodeCount());
+
+    // LOD0 の子のうち、最初にメッシュを持つノードを比較します。
+    const auto& first_lod = model->getRootNodeAt(0);
+    const auto first_child = view.getNodeFirstChild(0);
+    ASSERT_EQ(first_lod.getChildCount(), view.getNodeChildCount(0));
+    for (unsigned i = 0; i < first_lod.getChildCount(); ++i) {
+        const auto& node = first_lod.getChildAt(i);
+        const auto mesh_index = view.getNodeMeshIndex(first_child + i);
+        ASSERT_EQ(node.getName(), view.getNodeName(first_child + i));
+        if (node.getMesh() == nullptr) {
+            ASSERT_EQ(mesh_index, -1);
+            continue;
+        }
+        const auto streams = view.getMeshStreams(mesh_index);
+        ASSERT_EQ(node.getMesh()->getVertices().size(), streams.vertex_count);
+        ASSERT_EQ(node.getMesh()->getIndices().size(), streams.index_count);
+        for (size_t v = 0; v < streams.vertex_count; ++v) {
+            ASSERT_EQ(node.getMesh()->getVertices()[v].x, streams.vertices[v].x);
+            ASSERT_EQ(node.getMesh()->getVertices()[v].z, streams.vertices[v].z);
+        }
+        return;
+    }
+}
+
+TEST_F(ModelSerializerTest, read_throws_when_data_is_invalid) {
+    const auto city_model = load(gml_path_, params_);
+    const auto model = MeshExtractor::extract(*city_model, options_);
+    auto data = serialize(*model);
+
+    // 途中で切れたデータ
+    ASSERT_THROW(ModelSerializer::read(data.data(), data.size() / 2), std::runtime_error);
+
+    // マジックナンバーが壊れたデータ
+    data[0] = 'X';
+    ASSERT_THROW(ModelSerializer::read(data.data(), data.size()), std::runtime_error);
+}
@@ -62,6 +62,41 @@ namespace plateau::meshWriter {
         fs::remove_all(u8"./tempTestDestDir");
     }
 
+    TEST_F(ObjWriterTest, vertices_are_written_in_default_notation_and_uvs_in_fixed_notation) { // NOLINT
+        std::vector<TVec3d> vertices = { {1.5, -0.25, 123456.0000004}, {-0.0000001, 2, 3}, {0, 1, 2} };
+        std::vector<unsigned> indices = { 0, 1, 2 };
+        plateau::polygonMesh::UV uv1 = { {0.5f, 1}, {0, 0}, {1, 0.125f} };
+        plateau::polygonMesh::UV uv4(vertices.size(), TVec2f(0, 0));
+        std::vector<plateau::polygonMesh::SubMesh> sub_meshes = { plateau::polygonMesh::SubMesh(0, 2, "", nullptr) };
+        auto model = plateau::polygonMesh::Model::createModel();
+        model->addNode(plateau::polygonMesh::Node("root", std::make_unique<plateau::polygonMesh::Mesh>(
+                std::move(vertices), std::move(indices), std::move(uv1), std::move(uv4),
+                std::move(sub_meshes), plateau::polygonMesh::CityObjectList())));
+
+        const auto output_obj = fs::u8path(output_directory_) / "fixed_notation.obj";
+        const auto expected_obj = fs::u8path(output_directory_) / "fixed_notation_root.obj";
+        ASSERT_TRUE(ObjWriter().write(output_obj.u8string(), *model));
+
+        std::ifstream ifs(expected_obj);
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(ifs, line);) {
+            lines.push_back(line);
+        }
+        const std::vector<std::string> expected = {
+                "mtllib fixed_notation_root.mtl",
+                "g root",
+                "v 1.5 -0.25 123456",
+                "v -1e-07 2 3",
+                "v 0 1 2",
+                "vt 0.500000 1.000000",
+                "vt 0.000000 0.000000",
+                "vt 1.000000 0.125000",
+                "usemtl Default-Material",
+                "f 1/1 2/2 3/3 "
+        };
+        ASSERT_EQ(lines, expected);
+    }
+
     void ObjWriterTest::assertFileExists(const fs::path& file_path) {
         std::ifstream ifs(file_path);
         ASSERT_TRUE(ifs.is_open());
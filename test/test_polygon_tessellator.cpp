@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include "../src/polygon_mesh/polygon_tessellator.h"
+
+namespace plateau::polygonMesh {
+    namespace {
+        /// 三角形の面積の和を、法線 (0, 0, 1) の側から見て反時計回りを正として返します。
+        double signedAreaOfTriangles(const std::vector<std::vector<TVec3d>>& rings, const std::vector<unsigned>& indices) {
+            std::vector<TVec3d> vertices;
+            for (const auto& ring : rings) {
+                vertices.insert(vertices.end(), ring.begin(), ring.end());
+            }
+            double area = 0;
+            for (size_t i = 0; i < indices.size(); i += 3) {
+                const auto& a = vertices.at(indices[i]);
+                const auto& b = vertices.at(indices[i + 1]);
+                const auto& c = vertices.at(indices[i + 2]);
+                area += ((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x)) / 2;
+            }
+            return area;
+        }
+    }
+
+    TEST(PolygonTessellator, tessellates_concave_polygon) { // NOLINT
+        const std::vector<std::vector<TVec3d>> rings = {
+                {{0, 0, 0}, {2, 0, 0}, {2, 1, 0}, {1, 1, 0}, {1, 2, 0}, {0, 2, 0}}};
+        const auto indices = PolygonTessellator::tessellate(rings);
+        ASSERT_EQ(indices.size(), 4u * 3);
+        ASSERT_DOUBLE_EQ(signedAreaOfTriangles(rings, indices), 3.0);
+    }
+
+    TEST(PolygonTessellator, tessellates_polygon_with_hole_without_adding_vertices) { // NOLINT
+        const std::vector<std::vector<TVec3d>> rings = {
+                {{0, 0, 0}, {4, 0, 0}, {4, 4, 0}, {0, 4, 0}},
+                {{1, 1, 0}, {3, 1, 0}, {3, 3, 0}, {1, 3, 0}}};
+        const auto indices = PolygonTessellator::tessellate(rings);
+        // 頂点数 n, 穴の数 h のとき、三角形の数は n - 2 + 2h です。
+        ASSERT_EQ(indices.size(), 8u * 3);
+        for (const auto index : indices) {
+            ASSERT_LT(index, 8u);
+        }
+        ASSERT_DOUBLE_EQ(signedAreaOfTriangles(rings, indices), 12.0);
+    }
+
+    TEST(PolygonTessellator, keeps_winding_of_exterior_ring) { // NOLINT
+        const std::vector<std::vector<TVec3d>> rings = {{{0, 0, 0}, {0, 1, 0}, {1, 1, 0}, {1, 0, 0}}};
+        const auto indices = PolygonTessellator::tessellate(rings);
+        ASSERT_DOUBLE_EQ(signedAreaOfTriangles(rings, indices), -1.0);
+    }
+
+    TEST(PolygonTessellator, returns_empty_for_degenerate_polygon) { // NOLINT
+        ASSERT_TRUE(PolygonTessellator::tessellate({{{0, 0, 0}, {1, 1, 1}, {2, 2, 2}}}).empty());
+        ASSERT_TRUE(PolygonTessellator::tessellate({{{0, 0, 0}, {1, 0, 0}}}).empty());
+    }
+}
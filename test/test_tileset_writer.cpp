@@ -0,0 +1,65 @@
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+
+#include <plateau/mesh_writer/tileset_writer.h>
+
+namespace fs = std::filesystem;
+namespace plateau::meshWriter {
+
+    class TilesetWriterTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            fs::remove_all(output_directory_);
+        }
+
+        void TearDown() override {
+            fs::remove_all(output_directory_);
+        }
+
+        const std::string gml_path_ = u8"../data/日本語パステスト/udx/bldg/53392642_bldg_6697_op2.gml";
+        const fs::path output_directory_ = fs::u8path(u8"./tempTilesetDir");
+        plateau::polygonMesh::MeshExtractOptions mesh_extract_options_;
+    };
+
+    TEST_F(TilesetWriterTest, writes_tileset_json_and_glb_per_tile) { // NOLINT
+        auto result = TilesetWriter().write(output_directory_.u8string(), { gml_path_ },
+                                            mesh_extract_options_, TilesetWriteOptions());
+
+        ASSERT_TRUE(result);
+        ASSERT_TRUE(fs::exists(output_directory_ / "tileset.json"));
+        // 粗いタイル (LOD1 以下) は GMLファイル名で出力されます。
+        ASSERT_TRUE(fs::exists(output_directory_ / "tiles" / "53392642_bldg_6697_op2.glb"));
+        int glb_count = 0;
+        for (const auto& entry : fs::directory_iterator(output_directory_ / "tiles")) {
+            if (entry.path().extension() == ".glb")
+                ++glb_count;
+        }
+        // LOD2 の地物を含むため、グリッドごとの詳細なタイルも出力されます。
+        ASSERT_GT(glb_count, 1);
+    }
+
+    TEST_F(TilesetWriterTest, returns_false_when_no_gml_can_be_loaded) { // NOLINT
+        auto result = TilesetWriter().write(output_directory_.u8string(), { "../data/not_exists.gml" },
+                                            mesh_extract_options_, TilesetWriteOptions());
+        ASSERT_FALSE(result);
+    }
+
+    TEST_F(TilesetWriterTest, skips_unreadable_gml_and_writes_others) { // NOLINT
+        fs::create_directories(output_directory_);
+        const auto broken_gml_path = output_directory_ / "53392643_bldg_6697_op2.gml";
+        {
+            std::ofstream ofs(broken_gml_path);
+            ofs << "<core:CityModel><core:cityObjectMember><bldg:Building>";
+        }
+        TilesetWriteOptions options;
+        options.max_parallel_files = 2;
+        auto result = TilesetWriter().write(output_directory_.u8string(),
+                                            { broken_gml_path.u8string(), "../data/not_exists.gml", gml_path_ },
+                                            mesh_extract_options_, options);
+
+        ASSERT_TRUE(result);
+        ASSERT_TRUE(fs::exists(output_directory_ / "tiles" / "53392642_bldg_6697_op2.glb"));
+        ASSERT_FALSE(fs::exists(output_directory_ / "tiles" / "53392643_bldg_6697_op2.glb"));
+    }
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <plateau/dataset/zip_archive.h>
+#include <plateau/dataset/dataset_source.h>
+#include <plateau/dataset/gml_file.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace plateau::dataset {
+    namespace fs = std::filesystem;
+
+    class ZipArchiveTest : public ::testing::Test {
+    protected:
+        static std::string readAll(std::istream& stream) {
+            std::ostringstream buffer;
+            buffer << stream.rdbuf();
+            return buffer.str();
+        }
+
+        // zip_dataset.zip は data/日本語パステスト のファイルの一部を "zip_dataset" フォルダ以下に格納したものです。
+        // GMLファイルとコードリストは Deflate で、画像は無圧縮で格納されています。
+        const std::string zip_path_ = u8"../data/日本語パステスト/zip_dataset.zip";
+        const std::string bldg_entry_path_ = u8"zip_dataset/udx/bldg/53392642_bldg_6697_op2.gml";
+        const std::string bldg_gml_path_ = u8"../data/日本語パステスト/udx/bldg/53392642_bldg_6697_op2.gml";
+    };
+
+    TEST_F(ZipArchiveTest, open_entry_reads_same_content_as_original_file) { // NOLINT
+        const auto zip_archive = ZipArchive::open(zip_path_);
+        ASSERT_NE(zip_archive, nullptr);
+        ASSERT_NE(zip_archive->findEntry(bldg_entry_path_), nullptr);
+
+        const auto stream = zip_archive->openEntry(bldg_entry_path_);
+        ASSERT_NE(stream, nullptr);
+        std::ifstream original(fs::u8path(bldg_gml_path_), std::ios::binary);
+        ASSERT_EQ(readAll(*stream), readAll(original));
+
+        const auto image_stream = zip_archive->openEntry(
+                u8"zip_dataset/udx/bldg/53392642_bldg_6697_appearance/hnap0034.png");
+        ASSERT_NE(image_stream, nullptr);
+        ASSERT_EQ(readAll(*image_stream).size(),
+                  fs::file_size(fs::u8path(u8"../data/日本語パステスト/udx/bldg/53392642_bldg_6697_appearance/hnap0034.png")));
+
+        ASSERT_EQ(zip_archive->openEntry(u8"zip_dataset/udx/bldg/not_exist.gml"), nullptr);
+    }
+
+    TEST_F(ZipArchiveTest, open_returns_cached_index_while_in_use) { // NOLINT
+        const auto zip_archive = ZipArchive::open(zip_path_);
+        ASSERT_EQ(ZipArchive::open(zip_path_), zip_archive);
+        ASSERT_EQ(ZipArchive::open(bldg_gml_path_), nullptr);
+    }
+
+    TEST_F(ZipArchiveTest, split_path_separates_zip_path_and_entry_path) { // NOLINT
+        std::string zip_path;
+        std::string entry_path;
+        ASSERT_TRUE(ZipArchive::splitPath(zip_path_ + "/" + bldg_entry_path_, zip_path, entry_path));
+        ASSERT_EQ(zip_path, zip_path_);
+        ASSERT_EQ(entry_path, bldg_entry_path_);
+        ASSERT_FALSE(ZipArchive::splitPath(bldg_gml_path_, zip_path, entry_path));
+    }
+
+    TEST_F(ZipArchiveTest, local_accessor_finds_gml_files_in_zip) { // NOLINT
+        const auto accessor = DatasetSource::createLocal(zip_path_).getAccessor();
+        const auto gml_files = accessor->getGmlFiles(PredefinedCityModelPackage::Building);
+        ASSERT_EQ(gml_files->size(), 1);
+        ASSERT_EQ(gml_files->at(0).getMeshCode().get(), "53392642");
+        ASSERT_EQ(accessor->getGmlFiles(PredefinedCityModelPackage::Road)->size(), 1);
+
+        auto gml_file = gml_files->at(0);
+        ASSERT_EQ(gml_file.getMaxLod(), 2);
+        ASSERT_EQ(gml_file.searchAllImagePathsInGML(), GmlFile(bldg_gml_path_).searchAllImagePathsInGML());
+    }
+
+    TEST_F(ZipArchiveTest, fetch_extracts_gml_and_related_files) { // NOLINT
+        const auto temp_test_dir = fs::u8path(u8"../テスト用一時ディレクトリ_zip");
+        fs::remove_all(temp_test_dir);
+        const auto gml_file = GmlFile(zip_path_ + "/" + bldg_entry_path_);
+        const auto fetched = gml_file.fetch(temp_test_dir.u8string());
+
+        const auto root_dir = temp_test_dir / fs::u8path(u8"zip_dataset");
+        const auto gml_path = (root_dir / fs::u8path(u8"udx/bldg/53392642_bldg_6697_op2.gml")).make_preferred();
+        ASSERT_TRUE(fs::exists(gml_path)) << gml_path << " does not exist.";
+        ASSERT_EQ(fs::u8path(fetched->getPath()), gml_path);
+        ASSERT_TRUE(fs::exists(root_dir / fs::u8path(u8"codelists/Common_prefecture.xml")));
+        ASSERT_TRUE(fs::exists(root_dir / fs::u8path(u8"udx/bldg/53392642_bldg_6697_appearance/hnap0034.png")));
+        fs::remove_all(temp_test_dir);
+    }
+
+    TEST_F(ZipArchiveTest, corrupted_entry_makes_stream_bad_and_is_not_extracted) { // NOLINT
+        const auto temp_test_dir = fs::u8path(u8"../テスト用一時ディレクトリ_zip_corrupted");
+        fs::remove_all(temp_test_dir);
+        fs::create_directories(temp_test_dir);
+        const auto corrupted_zip_path = temp_test_dir / "corrupted.zip";
+        fs::copy_file(fs::u8path(zip_path_), corrupted_zip_path);
+
+        // GMLファイルの Deflate データの中ほどを書き換えます。
+        const auto entry = *ZipArchive::open(zip_path_)->findEntry(bldg_entry_path_);
+        {
+            std::fstream zip_file(corrupted_zip_path, std::ios::in | std::ios::out | std::ios::binary);
+            zip_file.seekp(static_cast<std::streamoff>(
+                    entry.local_header_offset + 30 + bldg_entry_path_.size() + entry.compressed_size / 2));
+            const std::string garbage(64, '\xFF');
+            zip_file.write(garbage.data(), static_cast<std::streamsize>(garbage.size()));
+        }
+
+        const auto zip_archive = ZipArchive::open(corrupted_zip_path.u8string());
+        ASSERT_NE(zip_archive, nullptr);
+        const auto stream = zip_archive->openEntry(bldg_entry_path_);
+        ASSERT_NE(stream, nullptr);
+        std::vector<char> buffer(4096);
+        while (stream->read(buffer.data(), static_cast<std::streamsize>(buffer.size()))) {
+        }
+        ASSERT_TRUE(stream->bad());
+
+        const auto destination = temp_test_dir / "extracted.gml";
+        ASSERT_FALSE(zip_archive->extractEntry(bldg_entry_path_, destination.u8string()));
+        ASSERT_FALSE(fs::exists(destination));
+        fs::remove_all(temp_test_dir);
+    }
+}
@@ -40,6 +40,51 @@ namespace PLATEAU.CityGML
             return new CityModel(cityModelHandle);
         }
 
+        /// <summary>
+        /// gmlファイルを cityObjectMember の単位で分割し、複数のスレッドで並列にパースします。
+        /// 結果は分割した部分ごとの CityModel の配列です。
+        /// MeshExtractor の複数の CityModel を受け取る Extract に渡すと、1つの Model として抽出できます。
+        /// </summary>
+        /// <param name="gmlPath">gmlファイルのパスです。</param>
+        /// <param name="parserParams">変換の設定です。</param>
+        /// <param name="maxPartitions">分割数の上限です。0 以下のときは論理プロセッサ数とします。</param>
+        /// <param name="logCallbacks">ログを受け取るコールバックです。省略または null の場合は C# の標準出力にログを転送します。</param>
+        /// <param name="logLevel">ログの詳細度です。</param>
+        public static CityModel[] LoadParallel(
+            string gmlPath, CitygmlParserParams parserParams,
+            int maxPartitions = 0,
+            LogCallbacks logCallbacks = null,
+            DllLogLevel logLevel = DllLogLevel.Error
+        )
+        {
+            if (logCallbacks == null)
+            {
+                logCallbacks = LogCallbacks.StdOut;
+            }
+            if (maxPartitions <= 0)
+            {
+                maxPartitions = Environment.ProcessorCount;
+            }
+
+            var gmlPathUtf8 = DLLUtil.StrToUtf8Bytes(gmlPath);
+            var handles = new IntPtr[maxPartitions];
+            APIResult result = NativeMethods.plateau_load_citygml_parallel(
+                gmlPathUtf8, parserParams, maxPartitions, handles, out int count,
+                logLevel, logCallbacks.LogErrorFuncPtr, logCallbacks.LogWarnFuncPtr, logCallbacks.LogInfoFuncPtr);
+            if (result == APIResult.ErrorLoadingCityGml)
+            {
+                throw new FileLoadException(
+                    $"Loading gml failed.\nPlease check codelist xml files are located in (gmlFolder)/../../codelists\nAND gml file is located at {gmlPath}\nand ");
+            }
+            DLLUtil.CheckDllError(result);
+            var cityModels = new CityModel[count];
+            for (int i = 0; i < count; i++)
+            {
+                cityModels[i] = new CityModel(handles[i]);
+            }
+            return cityModels;
+        }
+
         private static class NativeMethods
         {
             [DllImport(DLLUtil.DllName, CharSet = CharSet.Ansi)]
@@ -51,6 +96,18 @@ namespace PLATEAU.CityGML
                 IntPtr logErrorCallbackFuncPtr,
                 IntPtr logWarnCallbackFuncPtr,
                 IntPtr logInfoCallbackFuncPtr);
+
+            [DllImport(DLLUtil.DllName, CharSet = CharSet.Ansi)]
+            internal static extern APIResult plateau_load_citygml_parallel(
+                [In] byte[] gmlPathUtf8,
+                [In] CitygmlParserParams parserParams,
+                int maxPartitions,
+                [Out] IntPtr[] cityModelHandles,
+                out int count,
+                DllLogLevel logLevel,
+                IntPtr logErrorCallbackFuncPtr,
+                IntPtr logWarnCallbackFuncPtr,
+                IntPtr logInfoCallbackFuncPtr);
         }
     }
 }
@@ -1,4 +1,5 @@
 ﻿using System.Runtime.InteropServices;
+using PLATEAU.Native;
 
 namespace PLATEAU.CityGML
 {
@@ -20,6 +21,18 @@ namespace PLATEAU.CityGML
         [MarshalAs(UnmanagedType.U1)]
         private bool ignoreGeometries;
 
+        private uint lodMask;
+
+        [MarshalAs(UnmanagedType.U1)]
+        private bool excludeCityObjectOutsideExtent;
+
+        private Extent extent;
+
+        private CityObjectType cityObjectTypeMask;
+
+        [MarshalAs(UnmanagedType.U1)]
+        private bool geometryOnly;
+
         public bool Optimize
         {
             get => this.optimize; set => this.optimize = value;
@@ -43,12 +56,71 @@ namespace PLATEAU.CityGML
             get => this.ignoreGeometries; set => this.ignoreGeometries = value;
         }
 
+        /// <summary>
+        /// 残す LOD のビットマスクです。LOD n の形状を残すとき、下から n ビット目を立てます。
+        /// 0 のときは LOD で絞り込みません。それ以外のときは、含まれない LOD の形状をパースする前に取り除きます。
+        /// </summary>
+        public uint LodMask
+        {
+            get => this.lodMask; set => this.lodMask = value;
+        }
+
+        /// <summary>
+        /// true のとき、位置が <see cref="Extent"/> の範囲外である都市オブジェクトをパースする前に取り除きます。
+        /// 位置の判定は MeshExtractOptions.ExcludeCityObjectOutsideExtent と同じく、Envelope の中心か最初の頂点で行います。
+        /// </summary>
+        public bool ExcludeCityObjectOutsideExtent
+        {
+            get => this.excludeCityObjectOutsideExtent; set => this.excludeCityObjectOutsideExtent = value;
+        }
+
+        public Extent Extent
+        {
+            get => this.extent; set => this.extent = value;
+        }
+
+        /// <summary>
+        /// 残す都市オブジェクトの型のビットマスクです。含まれない型の都市オブジェクトは、その子も含めてパースする前に取り除きます。
+        /// 0 のときは <see cref="CityObjectType.COT_All"/> と同じく型で絞り込みません。
+        /// </summary>
+        public CityObjectType CityObjectTypeMask
+        {
+            get => this.cityObjectTypeMask; set => this.cityObjectTypeMask = value;
+        }
+
+        /// <summary>
+        /// true のとき、属性 (gen, uro の属性と住所) とアピアランスをパースする前に取り除き、形状だけを読み込みます。
+        /// 範囲選択のプレビューや当たり判定用のメッシュなど、位置だけが必要な用途で読み込みが速くなります。
+        /// </summary>
+        public bool GeometryOnly
+        {
+            get => this.geometryOnly; set => this.geometryOnly = value;
+        }
+
         public CitygmlParserParams(bool optimize, bool keepVertices, bool tessellate, bool ignoreGeometries)
         {
             this.optimize = optimize;
             this.keepVertices = keepVertices;
             this.tessellate = tessellate;
             this.ignoreGeometries = ignoreGeometries;
+            this.lodMask = 0;
+            this.excludeCityObjectOutsideExtent = false;
+            this.extent = new Extent();
+            this.cityObjectTypeMask = CityObjectType.COT_All;
+            this.geometryOnly = false;
+        }
+
+        /// <summary>
+        /// <paramref name="minLod"/> 以上 <paramref name="maxLod"/> 以下の LOD を残す <see cref="LodMask"/> を返します。
+        /// </summary>
+        public static uint LodMaskOf(uint minLod, uint maxLod)
+        {
+            uint mask = 0;
+            for (uint lod = minLod; lod <= maxLod && lod < 32; lod++)
+            {
+                mask |= 1u << (int)lod;
+            }
+            return mask;
         }
     }
 }
@@ -8,6 +8,17 @@ using PLATEAU.Native;
 
 namespace PLATEAU.Dataset
 {
+    /// <summary>
+    /// <see cref="DatasetAccessor.StartWatching"/> の監視で検出したGMLファイルの変化です。
+    /// </summary>
+    public enum LocalDatasetChange
+    {
+        /// <summary> GMLファイルが追加されました。 </summary>
+        Added,
+        /// <summary> GMLファイルが削除されました。 </summary>
+        Removed
+    }
+
     /// <summary>
     /// GMLファイル群から利用可能なファイル、メッシュコード、LODを検索します。
     /// C++の内部ではこれは基底クラスとなっており、継承によりローカル向けとサーバー向けの両方に対応しています。
@@ -17,6 +28,11 @@ namespace PLATEAU.Dataset
     /// </summary>
     public class DatasetAccessor : PInvokeDisposable
     {
+        private delegate void ChangeCallbackFuncType(LocalDatasetChange change, IntPtr gmlPathUtf8, int gmlPathByteLength);
+
+        /// <summary> 監視中に DLL 側から呼ばれる関数が GC で回収されないよう保持します。 </summary>
+        private ChangeCallbackFuncType changeCallback;
+
         /// <summary> handle は C++側の基底クラス (IDatasetAccessor) のポインタです。 </summary>
         public DatasetAccessor(IntPtr handle) : base(handle)
         {
@@ -89,6 +105,40 @@ namespace PLATEAU.Dataset
             return new DatasetAccessor(filteredPtr);
         }
 
+        /// <summary>
+        /// GMLファイルの追加と削除を監視し、変化があるたびにこのアクセサへ反映してから <paramref name="onChange"/> を呼びます。
+        /// <paramref name="onChange"/> は監視スレッドから呼ばれます。
+        /// 監視を始めたら true を返します。サーバーや zip ファイル内のデータなど、監視できないときは false を返します。
+        /// </summary>
+        /// <param name="pollIntervalMilliseconds">変更通知を使えない環境でフォルダを走査する間隔です。</param>
+        public bool StartWatching(Action<LocalDatasetChange, GmlFile> onChange, int pollIntervalMilliseconds = 1000)
+        {
+            ChangeCallbackFuncType callback = (change, gmlPathUtf8, gmlPathByteLength) =>
+            {
+                var gmlPath = DLLUtil.ReadUtf8Str(gmlPathUtf8, gmlPathByteLength);
+                onChange(change, GmlFile.Create(gmlPath));
+            };
+            var result = NativeMethods.plateau_i_dataset_accessor_start_watching(
+                Handle, Marshal.GetFunctionPointerForDelegate(callback), pollIntervalMilliseconds, out var started);
+            DLLUtil.CheckDllError(result);
+            this.changeCallback = started ? callback : null;
+            return started;
+        }
+
+        /// <summary>
+        /// <see cref="StartWatching"/> で始めた監視を止めます。監視していなければ何もしません。
+        /// </summary>
+        public void StopWatching()
+        {
+            var result = NativeMethods.plateau_i_dataset_accessor_stop_watching(Handle);
+            DLLUtil.CheckDllError(result);
+            this.changeCallback = null;
+        }
+
+        public bool IsWatching =>
+            DLLUtil.GetNativeValue<bool>(Handle,
+                NativeMethods.plateau_i_dataset_accessor_is_watching);
+
         /// <summary>
         /// gmlのパスが "udx/(featureType)/aaa.gml" として、
         /// (featureType) の部分を <see cref="PredefinedCityModelPackage"/> に変換します。
@@ -141,6 +191,22 @@ namespace PLATEAU.Dataset
                 [In] IntPtr accessorPtr,
                 [In] IntPtr nativeVectorMeshCodePtr,
                 out IntPtr outFilteredAccessorPtr);
+
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_i_dataset_accessor_start_watching(
+                [In] IntPtr accessorPtr,
+                [In] IntPtr callbackFuncPtr,
+                int pollIntervalMilliseconds,
+                [MarshalAs(UnmanagedType.U1)] out bool outStarted);
+
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_i_dataset_accessor_stop_watching(
+                [In] IntPtr accessorPtr);
+
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_i_dataset_accessor_is_watching(
+                [In] IntPtr accessorPtr,
+                [MarshalAs(UnmanagedType.U1)] out bool outIsWatching);
         }
     }
 }
@@ -358,5 +358,32 @@ namespace PLATEAU.Interop
             return bytes.ToArray();
         }
 
+        /// <summary>
+        /// string の配列を、null終端の UTF-8 文字列へのポインタの配列に変換します。
+        /// 使い終わったら <see cref="FreeUtf8StrPtrArray"/> で解放してください。
+        /// </summary>
+        internal static IntPtr[] AllocUtf8StrPtrArray(string[] strs)
+        {
+            var ptrs = new IntPtr[strs.Length];
+            for (int i = 0; i < strs.Length; i++)
+            {
+                var bytes = StrToUtf8Bytes(strs[i]);
+                ptrs[i] = Marshal.AllocCoTaskMem(bytes.Length);
+                Marshal.Copy(bytes, 0, ptrs[i], bytes.Length);
+            }
+            return ptrs;
+        }
+
+        /// <summary>
+        /// <see cref="AllocUtf8StrPtrArray"/> で確保したメモリを解放します。
+        /// </summary>
+        internal static void FreeUtf8StrPtrArray(IntPtr[] ptrs)
+        {
+            foreach (var ptr in ptrs)
+            {
+                Marshal.FreeCoTaskMem(ptr);
+            }
+        }
+
     }
 }
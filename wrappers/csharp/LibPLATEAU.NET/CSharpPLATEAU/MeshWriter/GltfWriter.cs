@@ -1,4 +1,5 @@
-﻿using PLATEAU.Interop;
+﻿using PLATEAU.CityGML;
+using PLATEAU.Interop;
 using PLATEAU.PolygonMesh;
 using System;
 using System.Runtime.InteropServices;
@@ -10,10 +11,30 @@ namespace PLATEAU.MeshWriter
         public GltfFileFormat GltfFileFormat;
         public string TextureDirectoryPath;
 
+        /// <summary>
+        /// ノードごとにメッシュを分けず、ルートノード (LOD) ごとにテクスチャ単位のプリミティブへ結合して出力するかどうかです。
+        /// true のとき、地物IDを頂点属性 (EXT_mesh_features) として、gml:id と属性をバイナリの表 (EXT_structural_metadata) として書き出します。
+        /// </summary>
+        public bool WriteFeatureMetadata;
+
+        /// <summary>
+        /// <see cref="WriteFeatureMetadata"/> が true のとき、表に含める属性のキーです。
+        /// </summary>
+        public string[] FeatureAttributeKeys;
+
+        /// <summary>
+        /// 頂点を量子化して出力するかどうかです (KHR_mesh_quantization)。
+        /// 座標はメッシュの範囲に対する int16 で、0〜1 に収まる UV は正規化した uint16 で表します。
+        /// </summary>
+        public bool QuantizeVertices;
+
         public GltfWriteOptions(GltfFileFormat format, string path)
         {
             this.GltfFileFormat = format;
             this.TextureDirectoryPath = path;
+            this.WriteFeatureMetadata = false;
+            this.FeatureAttributeKeys = null;
+            this.QuantizeVertices = false;
         }
     }
     
@@ -30,15 +51,42 @@ namespace PLATEAU.MeshWriter
 
         public bool Write(string destination, Model model, GltfWriteOptions options)
         {
+            if (options.WriteFeatureMetadata)
+            {
+                return Write(destination, model, options, null);
+            }
             string texturePath = options.TextureDirectoryPath;
             GltfFileFormat format = options.GltfFileFormat;
             var result = NativeMethods.plateau_gltf_writer_write(
                 this.handle, out var flg, DLLUtil.StrToUtf8Bytes(destination), model.Handle,
-                DLLUtil.StrToUtf8Bytes(texturePath), format);
+                DLLUtil.StrToUtf8Bytes(texturePath), format, options.QuantizeVertices);
             DLLUtil.CheckDllError(result);
             return flg;
         }
 
+        /// <summary>
+        /// <see cref="GltfWriteOptions.WriteFeatureMetadata"/> を有効にして出力します。
+        /// 表に含める属性は <paramref name="cityModel"/> から取得します。null のときは gml:id のみを出力します。
+        /// </summary>
+        public bool Write(string destination, Model model, GltfWriteOptions options, CityModel cityModel)
+        {
+            var keys = options.FeatureAttributeKeys ?? new string[0];
+            var keyPtrs = DLLUtil.AllocUtf8StrPtrArray(keys);
+            try
+            {
+                var result = NativeMethods.plateau_gltf_writer_write_with_feature_metadata(
+                    this.handle, out var flg, DLLUtil.StrToUtf8Bytes(destination), model.Handle,
+                    DLLUtil.StrToUtf8Bytes(options.TextureDirectoryPath), options.GltfFileFormat,
+                    cityModel?.Handle ?? IntPtr.Zero, keyPtrs, keyPtrs.Length, options.QuantizeVertices);
+                DLLUtil.CheckDllError(result);
+                return flg;
+            }
+            finally
+            {
+                DLLUtil.FreeUtf8StrPtrArray(keyPtrs);
+            }
+        }
+
         public GltfWriter()
         {
             APIResult result = NativeMethods.plateau_create_gltf_writer(out IntPtr outPtr);
@@ -74,7 +122,21 @@ namespace PLATEAU.MeshWriter
                 [In] byte[] gltfFilePathUtf8,
                 [In] IntPtr modelPtr,
                 [In] byte[] texPathUtf8,
-                GltfFileFormat format);
+                GltfFileFormat format,
+                [MarshalAs(UnmanagedType.U1)] bool quantizeVertices);
+
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_gltf_writer_write_with_feature_metadata(
+                [In] IntPtr handle,
+                out bool flg,
+                [In] byte[] gltfFilePathUtf8,
+                [In] IntPtr modelPtr,
+                [In] byte[] texPathUtf8,
+                GltfFileFormat format,
+                [In] IntPtr cityModelPtr,
+                [In] IntPtr[] attributeKeysUtf8,
+                int attributeKeyCount,
+                [MarshalAs(UnmanagedType.U1)] bool quantizeVertices);
         }
     }
 }
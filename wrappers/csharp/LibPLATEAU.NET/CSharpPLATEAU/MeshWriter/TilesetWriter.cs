@@ -0,0 +1,99 @@
+﻿using PLATEAU.Interop;
+using PLATEAU.PolygonMesh;
+using System;
+using System.Runtime.InteropServices;
+
+namespace PLATEAU.MeshWriter
+{
+    /// <summary>
+    /// タイル分割出力の設定です。
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct TilesetWriteOptions
+    {
+        /// <summary>
+        /// 粗いタイルに含める最大の LOD です。これより高い LOD の形状はグリッドごとの詳細なタイルに出力します。
+        /// </summary>
+        public uint CoarseMaxLod;
+
+        /// <summary>
+        /// 同時に処理する GMLファイルの数の上限です。0 のときはハードウェアのスレッド数とします。
+        /// </summary>
+        public uint MaxParallelFiles;
+
+        public TilesetWriteOptions(uint coarseMaxLod, uint maxParallelFiles)
+        {
+            this.CoarseMaxLod = coarseMaxLod;
+            this.MaxParallelFiles = maxParallelFiles;
+        }
+    }
+
+    /// <summary>
+    /// 複数の GMLファイルの範囲を空間的な階層に分割し、3D Tiles 形式のタイルセット (tileset.json とタイルごとの GLB) として出力します。
+    /// </summary>
+    public class TilesetWriter : IDisposable
+    {
+        private readonly IntPtr handle;
+        private bool isDisposed;
+
+        /// <summary>
+        /// <paramref name="gmlPaths"/> の GMLファイルを読み込み、タイルセットを <paramref name="outputDirectory"/> に出力します。
+        /// タイルを1つ以上出力できたら true を返します。
+        /// </summary>
+        public bool Write(string outputDirectory, string[] gmlPaths, MeshExtractOptions extractOptions, TilesetWriteOptions options)
+        {
+            var pathPtrs = DLLUtil.AllocUtf8StrPtrArray(gmlPaths);
+            try
+            {
+                var result = NativeMethods.plateau_tileset_writer_write(
+                    this.handle, out var flg, DLLUtil.StrToUtf8Bytes(outputDirectory),
+                    pathPtrs, pathPtrs.Length, extractOptions, options);
+                DLLUtil.CheckDllError(result);
+                return flg;
+            }
+            finally
+            {
+                DLLUtil.FreeUtf8StrPtrArray(pathPtrs);
+            }
+        }
+
+        public TilesetWriter()
+        {
+            APIResult result = NativeMethods.plateau_create_tileset_writer(out IntPtr outPtr);
+            DLLUtil.CheckDllError(result);
+            this.handle = outPtr;
+        }
+
+        ~TilesetWriter()
+        {
+            Dispose();
+        }
+
+        public void Dispose()
+        {
+            if (this.isDisposed) return;
+            DLLUtil.ExecNativeVoidFunc(this.handle, NativeMethods.plateau_delete_tileset_writer);
+            GC.SuppressFinalize(this);
+            this.isDisposed = true;
+        }
+
+        private static class NativeMethods
+        {
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_create_tileset_writer(out IntPtr outHandle);
+
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_delete_tileset_writer([In] IntPtr tilesetWriter);
+
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_tileset_writer_write(
+                [In] IntPtr handle,
+                out bool flg,
+                [In] byte[] outputDirectoryUtf8,
+                [In] IntPtr[] gmlPathsUtf8,
+                int gmlPathCount,
+                MeshExtractOptions extractOptions,
+                TilesetWriteOptions options);
+        }
+    }
+}
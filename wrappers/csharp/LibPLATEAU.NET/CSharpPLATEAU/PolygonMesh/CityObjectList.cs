@@ -67,6 +67,23 @@ namespace PLATEAU.PolygonMesh
             return index;
         }
 
+        /// <summary>
+        /// 複数の gml:id に対応する<see cref="CityObjectIndex"/>を1回の呼び出しでまとめて取得します。
+        /// 存在しない gml:id に対応する要素は(-1, -1)になります。
+        /// </summary>
+        public CityObjectIndex[] GetCityObjectIndices(string[] gmlIDs)
+        {
+            var indices = new CityObjectIndex[gmlIDs.Length];
+            var result = NativeMethods.plateau_city_object_list_get_city_object_indices(Handle, gmlIDs, gmlIDs.Length, indices);
+            DLLUtil.CheckDllError(result);
+            return indices;
+        }
+
+        /// <summary>
+        /// 含まれる地物の数です。
+        /// </summary>
+        public int Count => DLLUtil.GetNativeValue<int>(Handle, NativeMethods.plateau_city_object_list_get_count);
+
         private static class NativeMethods
         {
             [DllImport(DLLUtil.DllName)]
@@ -93,6 +110,18 @@ namespace PLATEAU.PolygonMesh
                 out CityObjectIndex index,
                 [In] string gmlID);
 
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_city_object_list_get_city_object_indices(
+                [In] IntPtr handle,
+                [In] string[] gmlIDs,
+                int count,
+                [Out] CityObjectIndex[] outIndices);
+
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_city_object_list_get_count(
+                [In] IntPtr handle,
+                out int outCount);
+
             [DllImport(DLLUtil.DllName)]
             internal static extern APIResult plateau_city_object_list_get_all_keys(
                 [In] IntPtr handle,
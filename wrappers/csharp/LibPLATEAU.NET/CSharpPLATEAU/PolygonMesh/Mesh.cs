@@ -86,6 +86,31 @@ namespace PLATEAU.PolygonMesh
             return vert;
         }
 
+        /// <summary>
+        /// 頂点座標を float で保持しているかどうかです。
+        /// </summary>
+        public bool HasFloatVertices
+        {
+            get
+            {
+                ThrowIfInvalid();
+                return DLLUtil.GetNativeValue<bool>(Handle,
+                    NativeMethods.plateau_mesh_has_float_vertices);
+            }
+        }
+
+        /// <summary>
+        /// 全頂点の座標を float で取得します。
+        /// </summary>
+        public PlateauVector3f[] GetFloatVertices()
+        {
+            ThrowIfInvalid();
+            var vertices = new PlateauVector3f[VerticesCount];
+            var result = NativeMethods.plateau_mesh_get_float_vertices(Handle, vertices);
+            DLLUtil.CheckDllError(result);
+            return vertices;
+        }
+
         public int GetIndiceAt(int index)
         {
             ThrowIfInvalid();
@@ -112,6 +137,70 @@ namespace PLATEAU.PolygonMesh
             return uv4;
         }
 
+        /// <summary>
+        /// 全 Indices を取得します。
+        /// </summary>
+        public uint[] GetIndices()
+        {
+            ThrowIfInvalid();
+            var indices = new uint[IndicesCount];
+            var result = NativeMethods.plateau_mesh_get_indices(Handle, indices);
+            DLLUtil.CheckDllError(result);
+            return indices;
+        }
+
+        /// <summary>
+        /// Indices を 16bit で表現できるかどうかです。
+        /// true のとき <see cref="GetIndicesU16"/> で Indices を取得できます。
+        /// </summary>
+        public bool FitsIn16BitIndices
+        {
+            get
+            {
+                ThrowIfInvalid();
+                return DLLUtil.GetNativeValue<bool>(Handle,
+                    NativeMethods.plateau_mesh_fits_in_16bit_indices);
+            }
+        }
+
+        /// <summary>
+        /// Indices を 16bit で取得します。
+        /// <see cref="FitsIn16BitIndices"/> が false のメッシュではエラーになります。
+        /// </summary>
+        public ushort[] GetIndicesU16()
+        {
+            ThrowIfInvalid();
+            var indices = new ushort[IndicesCount];
+            var result = NativeMethods.plateau_mesh_get_indices_u16(Handle, indices);
+            DLLUtil.CheckDllError(result);
+            return indices;
+        }
+
+        /// <summary>
+        /// C++側の Mesh が保持する配列のアドレスと要素数を取得します。
+        /// コピーを伴わないため、エンジン側のバッファへ1回のメモリコピーで転送したり、直接参照したりできます。
+        /// アドレスは、この <see cref="Mesh"/> が廃棄されるかマージ等で変更されるまで有効です。
+        /// </summary>
+        public MeshBuffers GetBuffers()
+        {
+            ThrowIfInvalid();
+            var result = NativeMethods.plateau_mesh_get_buffers(Handle, out var buffers);
+            DLLUtil.CheckDllError(result);
+            return buffers;
+        }
+
+        /// <summary>
+        /// 頂点座標(float)、Indices、UV1、UV4 を1回の呼び出しでまとめて引数の配列にコピーします。
+        /// 不要なものには null を渡すとコピーを省略します。
+        /// 配列の長さは <see cref="GetBuffers"/> で得られる要素数以上である必要があります。
+        /// </summary>
+        public void FillBuffers(PlateauVector3f[] outVertices, uint[] outIndices, PlateauVector2f[] outUv1, PlateauVector2f[] outUv4)
+        {
+            ThrowIfInvalid();
+            var result = NativeMethods.plateau_mesh_fill_buffers(Handle, outVertices, outIndices, outUv1, outUv4);
+            DLLUtil.CheckDllError(result);
+        }
+
         public int SubMeshCount
         {
             get
@@ -215,6 +304,16 @@ namespace PLATEAU.PolygonMesh
                 out PlateauVector3d outVertPos,
                 int index);
 
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_mesh_has_float_vertices(
+                [In] IntPtr handle,
+                out bool outHasFloatVertices);
+
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_mesh_get_float_vertices(
+                [In] IntPtr plateauMeshPtr,
+                [Out] PlateauVector3f[] outVertices);
+
             [DllImport(DLLUtil.DllName)]
             internal static extern APIResult plateau_mesh_get_indices_count(
                 [In] IntPtr handle,
@@ -252,6 +351,34 @@ namespace PLATEAU.PolygonMesh
                 [In] IntPtr plateauMeshPtr,
                 [Out] PlateauVector2f[] outUvPosArray);
 
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_mesh_get_indices(
+                [In] IntPtr plateauMeshPtr,
+                [Out] uint[] outIndices);
+
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_mesh_fits_in_16bit_indices(
+                [In] IntPtr handle,
+                out bool outFits);
+
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_mesh_get_indices_u16(
+                [In] IntPtr plateauMeshPtr,
+                [Out] ushort[] outIndices);
+
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_mesh_get_buffers(
+                [In] IntPtr plateauMeshPtr,
+                out MeshBuffers outBuffers);
+
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_mesh_fill_buffers(
+                [In] IntPtr plateauMeshPtr,
+                [Out] PlateauVector3f[] outVertices,
+                [Out] uint[] outIndices,
+                [Out] PlateauVector2f[] outUv1,
+                [Out] PlateauVector2f[] outUv4);
+
             [DllImport(DLLUtil.DllName, CharSet = CharSet.Ansi)]
             internal static extern APIResult plateau_mesh_add_sub_mesh(
                 [In] IntPtr meshPtr,
@@ -0,0 +1,31 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace PLATEAU.PolygonMesh
+{
+    /// <summary>
+    /// C++側の <see cref="Mesh"/> が内部に持つ配列の先頭アドレスと要素数です。
+    /// <see cref="Mesh.GetBuffers"/> で取得します。
+    /// 頂点座標は保持形式に応じて <see cref="Vertices"/> (double) と <see cref="FloatVertices"/> (float) のどちらか一方に入り、
+    /// もう一方の要素数は 0 になります。
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct MeshBuffers
+    {
+        /// <summary> PlateauVector3d の配列のアドレスです。 </summary>
+        public IntPtr Vertices;
+        public int VerticesCount;
+        /// <summary> PlateauVector3f の配列のアドレスです。 </summary>
+        public IntPtr FloatVertices;
+        public int FloatVerticesCount;
+        /// <summary> uint の配列のアドレスです。 </summary>
+        public IntPtr Indices;
+        public int IndicesCount;
+        /// <summary> PlateauVector2f の配列のアドレスです。 </summary>
+        public IntPtr Uv1;
+        public int Uv1Count;
+        /// <summary> PlateauVector2f の配列のアドレスです。 </summary>
+        public IntPtr Uv4;
+        public int Uv4Count;
+    }
+}
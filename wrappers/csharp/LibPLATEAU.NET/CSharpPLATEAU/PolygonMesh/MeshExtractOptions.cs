@@ -1,5 +1,6 @@
 ﻿using System;
 using System.Runtime.InteropServices;
+using PLATEAU.CityGML;
 using PLATEAU.Geometries;
 using PLATEAU.Interop;
 using PLATEAU.Native;
@@ -49,6 +50,17 @@ namespace PLATEAU.PolygonMesh
             this.gridCountOfSide = gridCountOfSide;
             this.EnableTexturePacking = enableTexturePacking; 
             this.TexturePackingResolution = texturePackingResolution; 
+            this.CityObjectTypeMask = CityObjectType.COT_All;
+            // 以下は C++ 側のデフォルト値と同じ値で初期化します。
+            this.StoreVerticesAsFloat = false;
+            this.EnableMeshOptimization = false;
+            this.GenerateProxyLod = false;
+            this.ProxyLodTargetRatio = 0.25f;
+            this.AlignGridToMeshCode = false;
+            this.EnableAdaptiveGrid = false;
+            this.AdaptiveGridTriangleBudget = 200000;
+            this.EnableInstancing = false;
+            this.EnableLazyTessellation = false;
             
             // 上で全てのメンバー変数を設定できてますが、バリデーションをするため念のためメソッドやプロパティも呼びます。
             SetLODRange(minLOD, maxLOD);
@@ -150,6 +162,62 @@ namespace PLATEAU.PolygonMesh
         /// <summary>  対象範囲を緯度・経度・高さで指定します。 </summary>
         public Extent Extent;
 
+        /// <summary>
+        /// メッシュの頂点座標を float で保持するかどうかです。
+        /// true にするとメモリ使用量が減り、 <see cref="Mesh.GetFloatVertices"/> で変換なしに頂点を取得できます。
+        /// </summary>
+        [MarshalAs(UnmanagedType.U1)] public bool StoreVerticesAsFloat;
+
+        /// <summary>
+        /// メッシュの最適化 (頂点の溶接、三角形と頂点の並べ替え) を行うかどうかです。
+        /// true にすると頂点数が減り、描画時の頂点キャッシュの効率が上がります。
+        /// </summary>
+        [MarshalAs(UnmanagedType.U1)] public bool EnableMeshOptimization;
+
+        /// <summary>
+        /// LOD ごとに、メッシュを縮約した遠景用の代替ノードを追加するかどうかです。
+        /// 代替ノードは元の LOD ノードの名前に "_proxy" を付けた名前になります。
+        /// </summary>
+        [MarshalAs(UnmanagedType.U1)] public bool GenerateProxyLod;
+
+        /// <summary> 代替ノードのメッシュの三角形の数を、元のメッシュの何倍 (0 〜 1) にするかです。 </summary>
+        public float ProxyLodTargetRatio;
+
+        /// <summary>
+        /// <see cref="MeshGranularity.PerCityModelArea"/> のグリッドを地域メッシュ (3次メッシュ) に揃えるかどうかです。
+        /// true のとき、3次メッシュ1つを <see cref="GridCountOfSide"/> × <see cref="GridCountOfSide"/> に分割したものをグリッドとします。
+        /// 隣り合うGMLファイルのグリッドが揃い、複数の CityModel をまとめて抽出するとファイルをまたぐグリッドが結合されます。
+        /// </summary>
+        [MarshalAs(UnmanagedType.U1)] public bool AlignGridToMeshCode;
+
+        /// <summary>
+        /// <see cref="MeshGranularity.PerCityModelArea"/> のグリッドを、三角形の数に応じて適応的に分割するかどうかです。
+        /// 三角形の数が <see cref="AdaptiveGridTriangleBudget"/> を超えるグリッドを4分木で分割し、疎な隣接グリッドはまとめます。
+        /// </summary>
+        [MarshalAs(UnmanagedType.U1)] public bool EnableAdaptiveGrid;
+
+        /// <summary> 適応的な分割で、1つのグリッドに含める三角形の数の目安です。 </summary>
+        public uint AdaptiveGridTriangleBudget;
+
+        /// <summary>
+        /// 平行移動を除いて同一の形状を持つメッシュを、1つのメッシュと複数のインスタンスにまとめるかどうかです。
+        /// まとめたメッシュを持つノードでは <see cref="Node.InstanceCount"/> が 1 以上になります。
+        /// </summary>
+        [MarshalAs(UnmanagedType.U1)] public bool EnableInstancing;
+
+        /// <summary>
+        /// 抽出する都市オブジェクトの型のビットマスクです。含まれない型の都市オブジェクトは、その子も含めて抽出しません。
+        /// <see cref="CitygmlParserParams.CityObjectTypeMask"/> に同じ値を設定すると、パースする前に取り除かれます。
+        /// </summary>
+        public CityObjectType CityObjectTypeMask;
+
+        /// <summary>
+        /// ポリゴンの三角形分割を、パース時ではなく抽出時に行うかどうかです。
+        /// true のとき、抽出するポリゴンだけを抽出時に分割し、主要地物ごとのメッシュを並列に作ります。
+        /// <see cref="CitygmlParserParams.Tesselate"/> を false にして読み込んだ CityModel に対して使います。
+        /// </summary>
+        [MarshalAs(UnmanagedType.U1)] public bool EnableLazyTessellation;
+
         /// <summary> デフォルト値の設定を返します。 </summary>
         internal static MeshExtractOptions DefaultValue()
         {
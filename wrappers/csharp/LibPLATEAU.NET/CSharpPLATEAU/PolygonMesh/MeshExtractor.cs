@@ -24,6 +24,24 @@ namespace PLATEAU.PolygonMesh
             DLLUtil.CheckDllError(result);
         }
 
+        /// <summary>
+        /// 複数の <see cref="CityModel"/> から1つの <see cref="Model"/> を抽出します。
+        /// <see cref="MeshExtractOptions.AlignGridToMeshCode"/> を true にすると、GMLファイルをまたぐグリッドが1つのメッシュに結合されます。
+        /// 結果は <paramref name="outModel"/> に格納されます。
+        /// </summary>
+        public static void Extract(ref Model outModel, CityModel[] cityModels, MeshExtractOptions options)
+        {
+            var handles = new IntPtr[cityModels.Length];
+            for (int i = 0; i < cityModels.Length; i++)
+            {
+                handles[i] = cityModels[i].Handle;
+            }
+            var result = NativeMethods.plateau_mesh_extractor_extract_multiple(
+                handles, handles.Length, options, outModel.Handle
+            );
+            DLLUtil.CheckDllError(result);
+        }
+
         private static class NativeMethods
         {
             [DllImport(DLLUtil.DllName)]
@@ -31,6 +49,13 @@ namespace PLATEAU.PolygonMesh
                 [In] IntPtr cityModelPtr,
                 MeshExtractOptions options,
                 [In] IntPtr outModelPtr);
+
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_mesh_extractor_extract_multiple(
+                [In] IntPtr[] cityModelPtrs,
+                int count,
+                MeshExtractOptions options,
+                [In] IntPtr outModelPtr);
         }
     }
 }
@@ -82,6 +82,29 @@ namespace PLATEAU.PolygonMesh
             node.MarkInvalid();
         }
 
+        /// <summary>
+        /// <see cref="Model"/> をバイナリ形式でファイルに保存します。
+        /// OBJ や glTF と異なり、 <see cref="CityObjectList"/> や UV4 も保持されます。
+        /// </summary>
+        public void Serialize(string filePath)
+        {
+            var result = NativeMethods.plateau_model_serializer_write(
+                Handle, DLLUtil.StrToUtf8Bytes(filePath));
+            DLLUtil.CheckDllError(result);
+        }
+
+        /// <summary>
+        /// <see cref="Serialize"/> で保存したファイルから <see cref="Model"/> を復元します。
+        /// </summary>
+        public static Model Deserialize(string filePath)
+        {
+            var model = Create();
+            var result = NativeMethods.plateau_model_serializer_read(
+                model.Handle, DLLUtil.StrToUtf8Bytes(filePath));
+            DLLUtil.CheckDllError(result);
+            return model;
+        }
+
         protected override void DisposeNative()
         {
             NativeMethods.plateau_delete_model(Handle);
@@ -137,6 +160,16 @@ namespace PLATEAU.PolygonMesh
             internal static extern APIResult plateau_model_add_node_by_std_move(
                 [In] IntPtr modelPtr,
                 [In] IntPtr nodePtr);
+
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_model_serializer_write(
+                [In] IntPtr modelPtr,
+                [In] byte[] filePathUtf8);
+
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_model_serializer_read(
+                [In] IntPtr outModelPtr,
+                [In] byte[] filePathUtf8);
         }
     }
 }
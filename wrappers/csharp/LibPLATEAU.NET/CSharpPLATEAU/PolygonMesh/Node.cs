@@ -1,6 +1,7 @@
 ﻿using System;
 using System.Runtime.InteropServices;
 using PLATEAU.Interop;
+using PLATEAU.Native;
 using PLATEAU.Util;
 
 namespace PLATEAU.PolygonMesh
@@ -93,6 +94,43 @@ namespace PLATEAU.PolygonMesh
             }
         }
 
+        /// <summary>
+        /// メッシュを配置するインスタンスの数を返します。
+        /// 1 以上のとき、<see cref="Mesh"/> はインスタンスの原点からの相対座標であり、
+        /// インスタンスごとに <see cref="GetInstanceTranslationAt"/> だけ平行移動して配置します。
+        /// </summary>
+        public int InstanceCount
+        {
+            get
+            {
+                ThrowIfInvalid();
+                return DLLUtil.GetNativeValue<int>(Handle,
+                    NativeMethods.plateau_node_get_instance_count);
+            }
+        }
+
+        /// <summary>
+        /// <paramref name="index"/> 番目のインスタンスの平行移動量を返します。
+        /// </summary>
+        public PlateauVector3d GetInstanceTranslationAt(int index)
+        {
+            ThrowIfInvalid();
+            return DLLUtil.GetNativeValue<PlateauVector3d>(Handle, index,
+                NativeMethods.plateau_node_get_instance_translation_at_index);
+        }
+
+        /// <summary>
+        /// <paramref name="index"/> 番目のインスタンスの名称を返します。
+        /// </summary>
+        public string GetInstanceNameAt(int index)
+        {
+            ThrowIfInvalid();
+            var result = NativeMethods.plateau_node_get_instance_name_at_index(
+                Handle, out var strPtr, out int strLength, index);
+            DLLUtil.CheckDllError(result);
+            return DLLUtil.ReadUtf8Str(strPtr, strLength - 1);
+        }
+
         /// <summary>
         /// <see cref="Mesh"/> を <see cref="Node"/>にセットします。
         /// 取扱注意:
@@ -190,6 +228,24 @@ namespace PLATEAU.PolygonMesh
                 out IntPtr childNodePtr,
                 int index);
 
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_node_get_instance_count(
+                [In] IntPtr nodeHandle,
+                out int outInstanceCount);
+
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_node_get_instance_translation_at_index(
+                [In] IntPtr nodeHandle,
+                out PlateauVector3d outTranslation,
+                int index);
+
+            [DllImport(DLLUtil.DllName)]
+            internal static extern APIResult plateau_node_get_instance_name_at_index(
+                [In] IntPtr nodeHandle,
+                out IntPtr strPtr,
+                out int strLength,
+                int index);
+
             [DllImport(DLLUtil.DllName)]
             internal static extern APIResult plateau_node_get_mesh(
                 [In] IntPtr nodeHandle,